@@ -30,12 +30,13 @@
 -keep class me.magnum.melonds.domain.model.AudioLatency { *; }
 -keep class me.magnum.melonds.domain.model.ConsoleType { *; }
 -keep class me.magnum.melonds.domain.model.MicSource { *; }
+-keep class me.magnum.melonds.domain.model.RomMetadata { *; }
+-keep interface me.magnum.melonds.MelonRomMetadataReader$RomScanCallback { *; }
 -keep class me.magnum.melonds.domain.model.Cheat { *; }
 -keep class me.magnum.melonds.domain.model.DSiWareTitle { *; }
 -keep class me.magnum.melonds.domain.model.VideoRenderer { *; }
 -keep class me.magnum.melonds.domain.model.retroachievements.RASimpleAchievement { *; }
 -keep class me.magnum.melonds.domain.model.retroachievements.RASimpleLeaderboard { *; }
--keep class me.magnum.melonds.domain.model.retroachievements.RASimpleRuntimeAchievement { *; }
 -keep class me.magnum.melonds.ui.emulator.render.FrameRenderCallback { *; }
 -keep class me.magnum.melonds.ui.emulator.rewind.model.RewindSaveState { *; }
 -keep class me.magnum.melonds.ui.emulator.rewind.model.RewindWindow { *; }
@@ -44,7 +45,7 @@
     public int open(java.lang.String, java.lang.String);
 }
 -keep interface me.magnum.melonds.common.camera.DSiCameraSource { *; }
--keep interface me.magnum.melonds.common.ir.IRManager { *; }
+-keep class me.magnum.melonds.common.ir.IRManager { *; }
 -keep interface me.magnum.melonds.common.RetroAchievementsCallback { *; }
 -keep interface me.magnum.melonds.ui.emulator.EmulatorFrameRenderedListener { *; }
 
@@ -1,5 +1,7 @@
 #include "AndroidMelonEventMessenger.h"
 #include "EmulatorMessageQueueJNI.h"
+#include <string.h>
+#include <vector>
 
 void AndroidMelonEventMessenger::onRumbleStart(int durationMs)
 {
@@ -96,4 +98,54 @@ void AndroidMelonEventMessenger::onLeaderboardAttemptCompleted(long leaderboardI
     strncpy(data.formattedValue, formattedValue.c_str(), sizeof(data.formattedValue));
 
     MelonDSAndroid::fireEmulatorEvent(EVENT_RA_LBOARD_ATTEMPT_COMPLETED, sizeof(data), &data);
+}
+
+void AndroidMelonEventMessenger::onRichPresenceUpdated(const std::string& status)
+{
+    // Variable length: string size (i32) followed by the string
+    int32_t statusSize = (int32_t) status.size();
+    std::vector<uint8_t> data(sizeof(statusSize) + statusSize);
+    memcpy(data.data(), &statusSize, sizeof(statusSize));
+    memcpy(data.data() + sizeof(statusSize), status.data(), statusSize);
+
+    MelonDSAndroid::fireEmulatorEvent(EVENT_RA_RICH_PRESENCE_UPDATED, (int) data.size(), data.data());
+}
+
+void AndroidMelonEventMessenger::onSaveStateWriteProgress(int requestId, int progress)
+{
+    struct {
+        int32_t requestId;
+        int32_t progress;
+    } data = {
+        .requestId = (int32_t) requestId,
+        .progress = (int32_t) progress,
+    };
+
+    MelonDSAndroid::fireEmulatorEvent(EVENT_SAVE_STATE_WRITE_PROGRESS, sizeof(data), &data);
+}
+
+void AndroidMelonEventMessenger::onSaveStateWriteCompleted(int requestId, int result)
+{
+    struct {
+        int32_t requestId;
+        int32_t result;
+    } data = {
+        .requestId = (int32_t) requestId,
+        .result = (int32_t) result,
+    };
+
+    MelonDSAndroid::fireEmulatorEvent(EVENT_SAVE_STATE_WRITE_COMPLETED, sizeof(data), &data);
+}
+
+void AndroidMelonEventMessenger::onConfigurationApplied(int changes, int64_t durationNs)
+{
+    struct {
+        int64_t durationNs;
+        int32_t changes;
+    } data = {
+        .durationNs = durationNs,
+        .changes = (int32_t) changes,
+    };
+
+    MelonDSAndroid::fireEmulatorEvent(EVENT_CONFIGURATION_APPLIED, sizeof(data), &data);
 }
\ No newline at end of file
@@ -18,6 +18,12 @@ public:
     void onLeaderboardAttemptUpdated(long leaderboardId, std::string formattedValue) override;
     void onLeaderboardAttemptCanceled(long leaderboardId) override;
     void onLeaderboardAttemptCompleted(long leaderboardId, int value, std::string formattedValue) override;
+    void onRichPresenceUpdated(const std::string& status);
+
+    void onSaveStateWriteProgress(int requestId, int progress);
+    void onSaveStateWriteCompleted(int requestId, int result);
+
+    void onConfigurationApplied(int changes, int64_t durationNs);
 
 private:
     // Event type constants
@@ -33,6 +39,12 @@ private:
     static constexpr int EVENT_RA_LBOARD_ATTEMPT_UPDATED = 211;
     static constexpr int EVENT_RA_LBOARD_ATTEMPT_CANCELED = 212;
     static constexpr int EVENT_RA_LBOARD_ATTEMPT_COMPLETED = 213;
+    static constexpr int EVENT_RA_RICH_PRESENCE_UPDATED = 220;
+
+    static constexpr int EVENT_SAVE_STATE_WRITE_PROGRESS = 300;
+    static constexpr int EVENT_SAVE_STATE_WRITE_COMPLETED = 301;
+
+    static constexpr int EVENT_CONFIGURATION_APPLIED = 400;
 };
 
 #endif // ANDROIDMELONEVENTMESSENGER_H
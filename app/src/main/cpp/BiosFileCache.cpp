@@ -0,0 +1,135 @@
+#include "BiosFileCache.h"
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <zlib.h>
+#include <android/log.h>
+
+#define LOG_TAG "BiosFileCache"
+#define LOGD(...) __android_log_print(ANDROID_LOG_DEBUG, LOG_TAG, __VA_ARGS__)
+
+using namespace melonDS;
+
+BiosFileCache::BiosFileCache(MemoryFileStore* memoryFileStore) : memoryFileStore(memoryFileStore)
+{
+}
+
+BiosFileCache::~BiosFileCache()
+{
+    clear();
+}
+
+void BiosFileCache::setCachedFiles(const std::vector<std::string>& paths)
+{
+    std::lock_guard<std::mutex> lock(imagesMutex);
+
+    auto removedImages = std::stable_partition(images.begin(), images.end(), [&paths](const CachedImage& image) {
+        return std::find(paths.begin(), paths.end(), image.path) != paths.end();
+    });
+    for (auto it = removedImages; it != images.end(); it++)
+        releaseImage(*it);
+
+    images.erase(removedImages, images.end());
+
+    for (const std::string& path : paths)
+    {
+        if (!findImage(path.c_str()))
+            images.push_back({ .path = path, .crc = 0, .isInvalid = false });
+    }
+}
+
+bool BiosFileCache::isCachedFile(const char* path)
+{
+    std::lock_guard<std::mutex> lock(imagesMutex);
+    return findImage(path) != nullptr;
+}
+
+std::string BiosFileCache::getImageFile(const char* path, const FileDescriptorOpener& openFileDescriptor)
+{
+    std::lock_guard<std::mutex> lock(imagesMutex);
+    CachedImage* image = findImage(path);
+    if (!image || image->isInvalid)
+        return "";
+
+    if (image->memoryFilePath.empty() && !loadImage(*image, openFileDescriptor))
+        return "";
+
+    return image->memoryFilePath;
+}
+
+void BiosFileCache::invalidate(const char* path)
+{
+    std::lock_guard<std::mutex> lock(imagesMutex);
+    CachedImage* image = findImage(path);
+    if (image)
+    {
+        releaseImage(*image);
+        image->isInvalid = false;
+    }
+}
+
+void BiosFileCache::clear()
+{
+    std::lock_guard<std::mutex> lock(imagesMutex);
+    for (CachedImage& image : images)
+    {
+        releaseImage(image);
+        image.isInvalid = false;
+    }
+}
+
+BiosFileCache::CachedImage* BiosFileCache::findImage(const char* path)
+{
+    for (CachedImage& image : images)
+    {
+        if (image.path == path)
+            return &image;
+    }
+
+    return nullptr;
+}
+
+void BiosFileCache::releaseImage(CachedImage& image)
+{
+    if (!image.memoryFilePath.empty())
+    {
+        memoryFileStore->deleteFile(image.memoryFilePath);
+        image.memoryFilePath.clear();
+    }
+}
+
+bool BiosFileCache::loadImage(CachedImage& image, const FileDescriptorOpener& openFileDescriptor)
+{
+    int fd = openFileDescriptor(image.path.c_str());
+    if (fd == -1)
+        // The file may become available later, so it's not marked as invalid
+        return false;
+
+    struct stat64 fileStat {};
+    if (fstat64(fd, &fileStat) != 0 || std::find(std::begin(VALID_IMAGE_SIZES), std::end(VALID_IMAGE_SIZES), (u64) fileStat.st_size) == std::end(VALID_IMAGE_SIZES))
+    {
+        close(fd);
+        image.isInvalid = true;
+        return false;
+    }
+
+    auto contents = std::make_shared<std::vector<u8>>(fileStat.st_size);
+    size_t totalBytesRead = 0;
+    while (totalBytesRead < contents->size())
+    {
+        ssize_t bytesRead = pread64(fd, contents->data() + totalBytesRead, contents->size() - totalBytesRead, totalBytesRead);
+        if (bytesRead <= 0)
+            break;
+
+        totalBytesRead += bytesRead;
+    }
+    close(fd);
+
+    if (totalBytesRead != contents->size())
+        return false;
+
+    image.crc = crc32(0, contents->data(), contents->size());
+    image.memoryFilePath = memoryFileStore->createFile(std::move(contents));
+    LOGD("Cached %s (%llu bytes, CRC %08x)", image.path.c_str(), (unsigned long long) fileStat.st_size, image.crc);
+    return true;
+}
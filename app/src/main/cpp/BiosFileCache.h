@@ -0,0 +1,69 @@
+#ifndef MELONDS_ANDROID_BIOSFILECACHE_H
+#define MELONDS_ANDROID_BIOSFILECACHE_H
+
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "MemoryFileStore.h"
+#include "types.h"
+
+/**
+ * Process-wide cache of the BIOS and firmware images configured by the user. The core reads them every time the emulator is set up,
+ * and the DSi NAND manager reads the DSi BIOS to get the ES key, so keeping them in memory avoids going through the content resolver
+ * every time. Images are loaded the first time they are opened, and served as read-only memory files. The set of cached files
+ * follows the configuration, so images are dropped as soon as the user configures different files.
+ */
+class BiosFileCache
+{
+public:
+    /**
+     * Function used to open files that are not cached yet. Must return a file descriptor opened for reading.
+     */
+    using FileDescriptorOpener = std::function<int(const char*)>;
+
+    explicit BiosFileCache(MemoryFileStore* memoryFileStore);
+    ~BiosFileCache();
+
+    /**
+     * Sets the files that should be cached. The images of files that are not in the list are released.
+     */
+    void setCachedFiles(const std::vector<std::string>& paths);
+    bool isCachedFile(const char* path);
+
+    /**
+     * Returns the memory file with the image of the given file, loading the image if needed.
+     * @return The path of the memory file, or an empty string if the file can't be read or is not a valid BIOS or firmware image
+     */
+    std::string getImageFile(const char* path, const FileDescriptorOpener& openFileDescriptor);
+
+    /**
+     * Releases the image of the given file, which will be loaded again the next time it's opened. Must be called when the file is
+     * modified.
+     */
+    void invalidate(const char* path);
+    void clear();
+
+private:
+    // DS BIOS9, DS BIOS7, DSi BIOS, and DS and DSi firmware images
+    static constexpr melonDS::u64 VALID_IMAGE_SIZES[] = { 0x1000, 0x4000, 0x10000, 0x20000, 0x40000, 0x80000 };
+
+    struct CachedImage
+    {
+        std::string path;
+        std::string memoryFilePath;
+        melonDS::u32 crc;
+        // Set when the file is not a valid image, so that it's not read again every time it's opened
+        bool isInvalid;
+    };
+
+    MemoryFileStore* memoryFileStore;
+    std::vector<CachedImage> images;
+    std::mutex imagesMutex;
+
+    CachedImage* findImage(const char* path);
+    void releaseImage(CachedImage& image);
+    bool loadImage(CachedImage& image, const FileDescriptorOpener& openFileDescriptor);
+};
+
+#endif //MELONDS_ANDROID_BIOSFILECACHE_H
@@ -1,62 +1,70 @@
 #include <jni.h>
-#include <unistd.h>
-#include <fcntl.h>
 #include <Platform.h>
+#include "EventRing.h"
+#include "types.h"
 
-// messagePipes[0] -> read
-// messagePipes[1] -> write
-static int messagePipes[2] = { -1, -1 };
+using namespace melonDS;
+
+// Must be a power of 2. Bursts of events (achievement progress updates, rumble) are small, so a few KB would already do, but the
+// extra space gives the app thread room to fall behind without dropping events
+static constexpr size_t EVENT_RING_CAPACITY = 64 * 1024;
+
+static EventRing* getEventRing()
+{
+    // Never freed. See EventRing
+    static EventRing* eventRing = new EventRing(EVENT_RING_CAPACITY);
+    return eventRing;
+}
 
 extern "C"
 {
 
 JNIEXPORT jint JNICALL
-Java_me_magnum_melonds_impl_emulator_EmulatorMessageQueue_initMessagePipe(JNIEnv* env, jobject thiz)
+Java_me_magnum_melonds_impl_emulator_EmulatorMessageQueue_initEventRing(JNIEnv* env, jobject thiz)
 {
-    if (messagePipes[0] != -1) {
-        return messagePipes[0];
-    }
-
-    if (pipe(messagePipes) == -1) {
-        melonDS::Platform::Log(melonDS::Platform::LogLevel::Error, "Failed to create message queue pipes");
+    EventRing* eventRing = getEventRing();
+    if (!eventRing->isValid()) {
+        melonDS::Platform::Log(melonDS::Platform::LogLevel::Error, "Failed to create event ring\n");
         return -1;
     }
 
-    // Make read end non-blocking
-    int flags = fcntl(messagePipes[0], F_GETFL, 0);
-    fcntl(messagePipes[0], F_SETFL, flags | O_NONBLOCK);
+    eventRing->setOpen(true);
+    return eventRing->getEventFd();
+}
+
+JNIEXPORT jobject JNICALL
+Java_me_magnum_melonds_impl_emulator_EmulatorMessageQueue_getEventRingBuffer(JNIEnv* env, jobject thiz)
+{
+    EventRing* eventRing = getEventRing();
+    return env->NewDirectByteBuffer(eventRing->getMemory(), (jlong) eventRing->getMemorySize());
+}
+
+JNIEXPORT jlong JNICALL
+Java_me_magnum_melonds_impl_emulator_EmulatorMessageQueue_getEventRingReadPosition(JNIEnv* env, jobject thiz)
+{
+    return (jlong) getEventRing()->getReadPosition();
+}
 
-    return messagePipes[0];
+JNIEXPORT jlong JNICALL
+Java_me_magnum_melonds_impl_emulator_EmulatorMessageQueue_acquireEvents(JNIEnv* env, jobject thiz, jlong consumedPosition)
+{
+    return (jlong) getEventRing()->acquire((u64) consumedPosition);
 }
 
 JNIEXPORT void JNICALL
-Java_me_magnum_melonds_impl_emulator_EmulatorMessageQueue_closeMessagePipe(JNIEnv* env, jobject thiz)
+Java_me_magnum_melonds_impl_emulator_EmulatorMessageQueue_closeEventRing(JNIEnv* env, jobject thiz)
 {
-    if (messagePipes[0] != -1) {
-        close(messagePipes[0]);
-        messagePipes[0] = -1;
-    }
-    if (messagePipes[1] != -1) {
-        close(messagePipes[1]);
-        messagePipes[1] = -1;
-    }
+    getEventRing()->setOpen(false);
 }
 
 }
 
 namespace MelonDSAndroid {
     void fireEmulatorEvent(int type, int dataLength, void* data) {
-        if (messagePipes[1] == -1) {
-            return;
-        }
-
-        struct {
-            int type;
-            int dataLength;
-        } event = { type, dataLength };
-
-        write(messagePipes[1], &event, sizeof(event));
-        if (data != nullptr)
-            write(messagePipes[1], data, dataLength);
+        if (data == nullptr || dataLength < 0)
+            dataLength = 0;
+
+        // Events are fired from multiple threads (emulator, save state writer), which the ring supports without locking
+        getEventRing()->push(type, data, (u32) dataLength);
     }
-}
\ No newline at end of file
+}
@@ -3,7 +3,7 @@
 
 namespace MelonDSAndroid {
     void fireEmulatorEvent(int type, int dataLength, void* data);
-    void fireEmulatorEvent(int type) { fireEmulatorEvent(type, 0, nullptr); };
+    inline void fireEmulatorEvent(int type) { fireEmulatorEvent(type, 0, nullptr); };
 }
 
 #endif // MELONDS_ANDROID_MESSAGEQUEUE_JNI_H
\ No newline at end of file
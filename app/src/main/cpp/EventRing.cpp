@@ -0,0 +1,156 @@
+#include "EventRing.h"
+#include <algorithm>
+#include <new>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+using namespace melonDS;
+
+namespace
+{
+    u64 alignRecordSize(u64 size)
+    {
+        return (size + 7) & ~(u64) 7;
+    }
+}
+
+EventRing::EventRing(size_t capacity) : capacity(capacity)
+{
+    void* mapping = mmap(nullptr, CONTROL_BLOCK_SIZE + capacity, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mapping == MAP_FAILED)
+        return;
+
+    // Anonymous mappings are zeroed, which is the initial state of both the control block and the records
+    memory = mapping;
+    control = new (mapping) ControlBlock();
+    records = (u8*) mapping + CONTROL_BLOCK_SIZE;
+    eventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+}
+
+void EventRing::setOpen(bool open)
+{
+    if (open)
+        release(findCommittedEnd(getReadPosition()));
+
+    isOpen.store(open, std::memory_order_release);
+}
+
+bool EventRing::push(int type, const void* data, u32 size)
+{
+    if (!isOpen.load(std::memory_order_acquire))
+        return false;
+
+    if (size > getMaxPayloadSize())
+    {
+        control->oversizedEventCount.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    u64 recordSize = alignRecordSize(RECORD_HEADER_SIZE + size);
+    u64 position = control->reservePosition.load(std::memory_order_relaxed);
+    u64 paddingSize;
+    do
+    {
+        u64 offset = position & (capacity - 1);
+        paddingSize = offset + recordSize > capacity ? capacity - offset : 0;
+
+        // The consumer only releases space once it's done reading it, so acquire its position before overwriting that space
+        u64 readPosition = control->readPosition.load(std::memory_order_acquire);
+        if (position + paddingSize + recordSize - readPosition > capacity)
+        {
+            control->droppedEventCount.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+    }
+    while (!control->reservePosition.compare_exchange_weak(position, position + paddingSize + recordSize, std::memory_order_relaxed));
+
+    if (paddingSize > 0)
+    {
+        commit(position, STATE_PADDING | (u32) (paddingSize - RECORD_HEADER_SIZE));
+        position += paddingSize;
+    }
+
+    u8* record = records + (position & (capacity - 1));
+    memcpy(record + sizeof(u32), &type, sizeof(type));
+    if (size > 0)
+        memcpy(record + RECORD_HEADER_SIZE, data, size);
+
+    commit(position, size);
+    return true;
+}
+
+u64 EventRing::getReadPosition()
+{
+    return control->readPosition.load(std::memory_order_relaxed);
+}
+
+u64 EventRing::acquire(u64 consumedPosition)
+{
+    release(consumedPosition);
+
+    u64 end = findCommittedEnd(consumedPosition);
+    if (end == consumedPosition)
+    {
+        // Going to sleep. Clear the eventfd so that the consumer waits for the next signal, and ask producers to signal it. Events
+        // committed in the meantime are found by the second search
+        u64 signalCount;
+        read(eventFd, &signalCount, sizeof(signalCount));
+        isConsumerWaiting.store(true, std::memory_order_seq_cst);
+        end = findCommittedEnd(consumedPosition);
+    }
+
+    return end;
+}
+
+std::atomic<u32>& EventRing::stateAt(u64 position)
+{
+    return *reinterpret_cast<std::atomic<u32>*>(records + (position & (capacity - 1)));
+}
+
+void EventRing::commit(u64 position, u32 state)
+{
+    // Sequentially consistent, so that either the consumer sees the record when it checks again before going to sleep, or the
+    // producer sees that the consumer is waiting
+    stateAt(position).store(STATE_COMMITTED | state, std::memory_order_seq_cst);
+
+    if (isConsumerWaiting.load(std::memory_order_seq_cst) && isConsumerWaiting.exchange(false, std::memory_order_seq_cst))
+    {
+        u64 signal = 1;
+        write(eventFd, &signal, sizeof(signal));
+    }
+}
+
+u64 EventRing::findCommittedEnd(u64 position)
+{
+    u64 reservePosition = control->reservePosition.load(std::memory_order_acquire);
+    while (position < reservePosition)
+    {
+        u32 state = stateAt(position).load(std::memory_order_seq_cst);
+        if (!(state & STATE_COMMITTED))
+            break;
+
+        position += alignRecordSize(RECORD_HEADER_SIZE + (state & STATE_SIZE_MASK));
+    }
+
+    return position;
+}
+
+void EventRing::release(u64 position)
+{
+    u64 readPosition = control->readPosition.load(std::memory_order_relaxed);
+    if (position <= readPosition)
+        return;
+
+    // Zero the consumed space, so that headers that producers have reserved but not committed yet read as not committed. Records
+    // don't wrap, but the released range can
+    u64 startOffset = readPosition & (capacity - 1);
+    u64 length = position - readPosition;
+    u64 firstLength = std::min<u64>(length, capacity - startOffset);
+    memset(records + startOffset, 0, firstLength);
+    if (length > firstLength)
+        memset(records, 0, length - firstLength);
+
+    control->readPosition.store(position, std::memory_order_release);
+}
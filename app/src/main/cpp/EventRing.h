@@ -0,0 +1,97 @@
+#ifndef MELONDS_ANDROID_EVENTRING_H
+#define MELONDS_ANDROID_EVENTRING_H
+
+#include <atomic>
+#include <cstddef>
+#include "types.h"
+
+/**
+ * Lock-free ring buffer through which the emulator sends events to the app. Any number of threads can push events at the same time,
+ * and a single consumer reads them straight from the ring memory, which is shared with Kotlin as a direct ByteBuffer. The consumer
+ * is woken up through an eventfd, which is only signalled when the consumer has run out of events, so that a burst of events
+ * costs at most one syscall.
+ *
+ * The memory starts with a control block, followed by the records. Each record is aligned to 8 bytes and starts with a header:
+ * * state (`u32`): payload size in the lower bits, and the COMMITTED and PADDING flags
+ * * event type (`i32`)
+ * * payload (`u8[size]`)
+ *
+ * Records never wrap around the end of the ring. When a record doesn't fit in the space left before the end, that space is filled
+ * with a padding record that the consumer skips. Consumed space is zeroed, so a header that is not committed yet always reads as 0.
+ *
+ * The ring is never freed, so that threads that are still pushing events when the consumer goes away never touch released memory.
+ */
+class EventRing
+{
+public:
+    // Offsets and flags of the shared memory layout. Must match EmulatorMessageQueue.kt
+    static constexpr size_t CONTROL_BLOCK_SIZE = 256;
+    static constexpr size_t DROPPED_EVENT_COUNT_OFFSET = 128;
+    static constexpr size_t OVERSIZED_EVENT_COUNT_OFFSET = 136;
+    static constexpr size_t RECORD_HEADER_SIZE = 8;
+    static constexpr melonDS::u32 STATE_COMMITTED = 1u << 31;
+    static constexpr melonDS::u32 STATE_PADDING = 1u << 30;
+    static constexpr melonDS::u32 STATE_SIZE_MASK = STATE_PADDING - 1;
+
+    /**
+     * @param capacity Size of the record area. Must be a power of 2
+     */
+    explicit EventRing(size_t capacity);
+
+    bool isValid() const { return memory != nullptr && eventFd >= 0; }
+    int getEventFd() const { return eventFd; }
+    void* getMemory() const { return memory; }
+    size_t getMemorySize() const { return CONTROL_BLOCK_SIZE + capacity; }
+    size_t getMaxPayloadSize() const { return capacity / 4; }
+
+    /**
+     * Enables or disables pushing events. Opening the ring discards the events left from the last time it was open.
+     */
+    void setOpen(bool open);
+
+    /**
+     * Adds an event to the ring. Can be called from any thread.
+     * @return False if the event was dropped, because the ring is closed or full, or because the payload is too big
+     */
+    bool push(int type, const void* data, melonDS::u32 size);
+
+    /**
+     * Position up to which the consumer has consumed events. Positions keep growing as events are pushed, the offset of a position in
+     * the record area is obtained by masking it with the capacity minus 1.
+     */
+    melonDS::u64 getReadPosition();
+
+    /**
+     * Releases the records before [consumedPosition], and returns the position up to which records can be read. Must only be called
+     * by the consumer. When there are no records left, the consumer is marked as waiting, so that the next event signals the eventfd.
+     */
+    melonDS::u64 acquire(melonDS::u64 consumedPosition);
+
+private:
+    struct ControlBlock
+    {
+        alignas(64) std::atomic<melonDS::u64> reservePosition;
+        alignas(64) std::atomic<melonDS::u64> readPosition;
+        alignas(64) std::atomic<melonDS::u64> droppedEventCount;
+        std::atomic<melonDS::u64> oversizedEventCount;
+    };
+
+    static_assert(offsetof(ControlBlock, droppedEventCount) == DROPPED_EVENT_COUNT_OFFSET);
+    static_assert(offsetof(ControlBlock, oversizedEventCount) == OVERSIZED_EVENT_COUNT_OFFSET);
+    static_assert(sizeof(ControlBlock) <= CONTROL_BLOCK_SIZE);
+
+    size_t capacity;
+    void* memory = nullptr;
+    ControlBlock* control = nullptr;
+    melonDS::u8* records = nullptr;
+    int eventFd = -1;
+    std::atomic_bool isOpen = false;
+    std::atomic_bool isConsumerWaiting = true;
+
+    std::atomic<melonDS::u32>& stateAt(melonDS::u64 position);
+    void commit(melonDS::u64 position, melonDS::u32 state);
+    melonDS::u64 findCommittedEnd(melonDS::u64 position);
+    void release(melonDS::u64 position);
+};
+
+#endif //MELONDS_ANDROID_EVENTRING_H
@@ -0,0 +1,80 @@
+#include "FileDescriptorCache.h"
+#include <sys/stat.h>
+#include <unistd.h>
+
+FileDescriptorCache::~FileDescriptorCache()
+{
+    clear();
+}
+
+int FileDescriptorCache::get(const std::string& path)
+{
+    std::lock_guard<std::mutex> lock(descriptorsMutex);
+    for (auto it = descriptors.begin(); it != descriptors.end(); it++)
+    {
+        if (it->path != path)
+            continue;
+
+        // A file that has been deleted or replaced by another one no longer has links, and must be opened again
+        struct stat64 fileStat {};
+        if (fstat64(it->fd, &fileStat) != 0 || fileStat.st_nlink == 0)
+        {
+            close(it->fd);
+            descriptors.erase(it);
+            return -1;
+        }
+
+        descriptors.splice(descriptors.begin(), descriptors, it);
+        return dup(it->fd);
+    }
+
+    return -1;
+}
+
+void FileDescriptorCache::put(const std::string& path, int fd)
+{
+    int cachedFd = dup(fd);
+    if (cachedFd == -1)
+        return;
+
+    std::lock_guard<std::mutex> lock(descriptorsMutex);
+    for (auto it = descriptors.begin(); it != descriptors.end(); it++)
+    {
+        if (it->path == path)
+        {
+            close(it->fd);
+            descriptors.erase(it);
+            break;
+        }
+    }
+
+    descriptors.push_front({ path, cachedFd });
+    if (descriptors.size() > MAX_CACHED_DESCRIPTORS)
+    {
+        close(descriptors.back().fd);
+        descriptors.pop_back();
+    }
+}
+
+void FileDescriptorCache::invalidate(const std::string& path)
+{
+    std::lock_guard<std::mutex> lock(descriptorsMutex);
+    for (auto it = descriptors.begin(); it != descriptors.end(); it++)
+    {
+        if (it->path == path)
+        {
+            close(it->fd);
+            descriptors.erase(it);
+            return;
+        }
+    }
+}
+
+void FileDescriptorCache::clear()
+{
+    std::lock_guard<std::mutex> lock(descriptorsMutex);
+    for (const CachedDescriptor& descriptor : descriptors)
+        close(descriptor.fd);
+
+    descriptors.clear();
+}
@@ -0,0 +1,45 @@
+#ifndef MELONDS_ANDROID_FILEDESCRIPTORCACHE_H
+#define MELONDS_ANDROID_FILEDESCRIPTORCACHE_H
+
+#include <list>
+#include <mutex>
+#include <string>
+
+/**
+ * Keeps the descriptors of the files that the core has opened for reading, so that opening them again (BIOS, firmware and saves are
+ * opened on every boot and save state load) doesn't need a round-trip through Java and the content resolver. Cached descriptors are
+ * handed out as duplicates, which share the file offset, so they must only be accessed with positional reads.
+ */
+class FileDescriptorCache
+{
+public:
+    ~FileDescriptorCache();
+
+    /**
+     * @return A duplicate of the cached descriptor of the file, owned by the caller, or -1 if the file is not cached
+     */
+    int get(const std::string& path);
+
+    /**
+     * Caches a duplicate of the given descriptor. The caller keeps the ownership of the descriptor.
+     */
+    void put(const std::string& path, int fd);
+
+    void invalidate(const std::string& path);
+    void clear();
+
+private:
+    static constexpr size_t MAX_CACHED_DESCRIPTORS = 16;
+
+    struct CachedDescriptor
+    {
+        std::string path;
+        int fd;
+    };
+
+    // Most recently used first
+    std::list<CachedDescriptor> descriptors;
+    std::mutex descriptorsMutex;
+};
+
+#endif //MELONDS_ANDROID_FILEDESCRIPTORCACHE_H
@@ -0,0 +1,29 @@
+#include "FrameBoundaryTaskQueue.h"
+
+void FrameBoundaryTaskQueue::post(std::function<void()> task)
+{
+    std::lock_guard<std::mutex> lock(tasksMutex);
+    tasks.push_back(std::move(task));
+}
+
+bool FrameBoundaryTaskQueue::hasPendingTasks()
+{
+    std::lock_guard<std::mutex> lock(tasksMutex);
+    return !tasks.empty();
+}
+
+void FrameBoundaryTaskQueue::runPendingTasks()
+{
+    std::deque<std::function<void()>> currentTasks;
+    {
+        std::lock_guard<std::mutex> lock(tasksMutex);
+        if (tasks.empty())
+            return;
+
+        currentTasks.swap(tasks);
+    }
+
+    // Tasks are executed outside the lock so that they can schedule new tasks. Those will only run at the next boundary
+    for (auto& task : currentTasks)
+        task();
+}
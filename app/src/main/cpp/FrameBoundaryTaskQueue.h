@@ -0,0 +1,30 @@
+#ifndef MELONDS_ANDROID_FRAMEBOUNDARYTASKQUEUE_H
+#define MELONDS_ANDROID_FRAMEBOUNDARYTASKQUEUE_H
+
+#include <deque>
+#include <functional>
+#include <mutex>
+
+/**
+ * Queue of tasks that must be executed by the emulator thread between two frames, when the emulator state is consistent and
+ * nothing else is touching it. Tasks are executed both while the emulator is running and while it is paused.
+ */
+class FrameBoundaryTaskQueue
+{
+public:
+    void post(std::function<void()> task);
+    bool hasPendingTasks();
+    void runPendingTasks();
+
+private:
+    std::deque<std::function<void()>> tasks;
+    std::mutex tasksMutex;
+};
+
+/**
+ * Schedules a task to be executed by the emulator thread at the next frame boundary. Implemented in MelonDSAndroidJNI.cpp.
+ * @return True if the task was scheduled. False if the emulator thread is not running, in which case the task is discarded
+ */
+bool runAtFrameBoundary(std::function<void()> task);
+
+#endif //MELONDS_ANDROID_FRAMEBOUNDARYTASKQUEUE_H
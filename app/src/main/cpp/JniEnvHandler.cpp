@@ -46,15 +46,26 @@ JniEnvHandler::JniEnvHandler(JavaVM* vm) {
 
 JNIEnv* JniEnvHandler::getCurrentThreadEnv()
 {
+    // The environment of a thread doesn't change while the thread is attached, and threads attached here stay attached until they
+    // exit, so it only has to be looked up once per thread
+    static thread_local JNIEnv* threadEnv = nullptr;
+    if (threadEnv) {
+        return threadEnv;
+    }
+
     JNIEnv* env = nullptr;
     // Check if the current thread is attached to the VM
     auto getEnvResult = this->vm->GetEnv((void**) &env, JNI_VERSION_1_6);
     if (getEnvResult == JNI_EDETACHED) {
         if (vm->AttachCurrentThread(&env, NULL) == JNI_OK) {
             DeferThreadDetach(this->vm);
+        } else {
+            env = nullptr;
         }
     } else if (getEnvResult == JNI_EVERSION) {
         // Unsupported JNI version
     }
+
+    threadEnv = env;
     return env;
 }
@@ -0,0 +1,244 @@
+#include "JniRegistry.h"
+#include <android/log.h>
+#include <stdio.h>
+
+#define LOG_TAG "JniRegistry"
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+namespace
+{
+    /**
+     * Looks up JNI members, logging the ones that can't be found instead of stopping at the first one, so that a single run shows
+     * everything that is out of date.
+     */
+    class Resolver
+    {
+    public:
+        explicit Resolver(JNIEnv* env) : env(env)
+        {
+        }
+
+        jclass findClass(const char* name)
+        {
+            jclass localClass = env->FindClass(name);
+            if (!localClass)
+            {
+                fail("class %s", name, "");
+                return nullptr;
+            }
+
+            jclass globalClass = (jclass) env->NewGlobalRef(localClass);
+            env->DeleteLocalRef(localClass);
+            return globalClass;
+        }
+
+        jmethodID getMethod(jclass clazz, const char* name, const char* signature)
+        {
+            // The missing class has already been reported
+            if (!clazz)
+                return nullptr;
+
+            jmethodID method = env->GetMethodID(clazz, name, signature);
+            if (!method)
+                fail("method %s%s", name, signature);
+
+            return method;
+        }
+
+        jfieldID getField(jclass clazz, const char* name, const char* signature)
+        {
+            if (!clazz)
+                return nullptr;
+
+            jfieldID field = env->GetFieldID(clazz, name, signature);
+            if (!field)
+                fail("field %s %s", name, signature);
+
+            return field;
+        }
+
+        bool hasFailed() const
+        {
+            return failed;
+        }
+
+    private:
+        JNIEnv* env;
+        bool failed = false;
+
+        void fail(const char* format, const char* name, const char* signature)
+        {
+            // Clear the NoClassDefFoundError or NoSuchMethodError, otherwise no other lookup can be made
+            env->ExceptionClear();
+            failed = true;
+
+            char description[256];
+            snprintf(description, sizeof(description), format, name, signature);
+            LOGE("Failed to resolve %s", description);
+        }
+    };
+}
+
+namespace JniRegistry
+{
+    UriClass uri;
+    ArrayListClass arrayList;
+    EmulatorConfigurationClass emulatorConfiguration;
+    FirmwareConfigurationClass firmwareConfiguration;
+    RendererConfigurationClass rendererConfiguration;
+    ValueEnumClass consoleType;
+    ValueEnumClass audioBitrate;
+    ValueEnumClass audioInterpolation;
+    ValueEnumClass audioLatency;
+    ValueEnumClass micSource;
+    ValueEnumClass videoRenderer;
+    FrameRenderCallbackClass frameRenderCallback;
+    DSiCameraSourceClass dsiCameraSource;
+    IRManagerClass irManager;
+    UriFileHandlerClass uriFileHandler;
+    CheatClass cheat;
+    RASimpleAchievementClass raSimpleAchievement;
+    RASimpleLeaderboardClass raSimpleLeaderboard;
+    RewindSaveStateClass rewindSaveState;
+    RewindWindowClass rewindWindow;
+    DSiWareTitleClass dsiWareTitle;
+    RomMetadataClass romMetadata;
+    RomScanCallbackClass romScanCallback;
+
+    bool initialize(JNIEnv* env)
+    {
+        Resolver resolver(env);
+
+        uri.clazz = resolver.findClass("android/net/Uri");
+        uri.toString = resolver.getMethod(uri.clazz, "toString", "()Ljava/lang/String;");
+
+        arrayList.clazz = resolver.findClass("java/util/ArrayList");
+        arrayList.constructor = resolver.getMethod(arrayList.clazz, "<init>", "()V");
+        arrayList.add = resolver.getMethod(arrayList.clazz, "add", "(ILjava/lang/Object;)V");
+
+        jclass configurationClass = resolver.findClass("me/magnum/melonds/domain/model/EmulatorConfiguration");
+        emulatorConfiguration = EmulatorConfigurationClass {
+            .clazz = configurationClass,
+            .firmwareConfiguration = resolver.getField(configurationClass, "firmwareConfiguration", "Lme/magnum/melonds/domain/model/FirmwareConfiguration;"),
+            .rendererConfiguration = resolver.getField(configurationClass, "rendererConfiguration", "Lme/magnum/melonds/domain/model/RendererConfiguration;"),
+            .useCustomBios = resolver.getField(configurationClass, "useCustomBios", "Z"),
+            .showBootScreen = resolver.getField(configurationClass, "showBootScreen", "Z"),
+            .dsBios7Uri = resolver.getField(configurationClass, "dsBios7Uri", "Landroid/net/Uri;"),
+            .dsBios9Uri = resolver.getField(configurationClass, "dsBios9Uri", "Landroid/net/Uri;"),
+            .dsFirmwareUri = resolver.getField(configurationClass, "dsFirmwareUri", "Landroid/net/Uri;"),
+            .dsiBios7Uri = resolver.getField(configurationClass, "dsiBios7Uri", "Landroid/net/Uri;"),
+            .dsiBios9Uri = resolver.getField(configurationClass, "dsiBios9Uri", "Landroid/net/Uri;"),
+            .dsiFirmwareUri = resolver.getField(configurationClass, "dsiFirmwareUri", "Landroid/net/Uri;"),
+            .dsiNandUri = resolver.getField(configurationClass, "dsiNandUri", "Landroid/net/Uri;"),
+            .internalDirectory = resolver.getField(configurationClass, "internalDirectory", "Ljava/lang/String;"),
+            .fastForwardSpeedMultiplier = resolver.getField(configurationClass, "fastForwardSpeedMultiplier", "F"),
+            .rewindEnabled = resolver.getField(configurationClass, "rewindEnabled", "Z"),
+            .rewindPeriodSeconds = resolver.getField(configurationClass, "rewindPeriodSeconds", "I"),
+            .rewindWindowSeconds = resolver.getField(configurationClass, "rewindWindowSeconds", "I"),
+            .useJit = resolver.getField(configurationClass, "useJit", "Z"),
+            .consoleType = resolver.getField(configurationClass, "consoleType", "Lme/magnum/melonds/domain/model/ConsoleType;"),
+            .soundEnabled = resolver.getField(configurationClass, "soundEnabled", "Z"),
+            .volume = resolver.getField(configurationClass, "volume", "I"),
+            .audioInterpolation = resolver.getField(configurationClass, "audioInterpolation", "Lme/magnum/melonds/domain/model/AudioInterpolation;"),
+            .audioBitrate = resolver.getField(configurationClass, "audioBitrate", "Lme/magnum/melonds/domain/model/AudioBitrate;"),
+            .audioLatency = resolver.getField(configurationClass, "audioLatency", "Lme/magnum/melonds/domain/model/AudioLatency;"),
+            .micSource = resolver.getField(configurationClass, "micSource", "Lme/magnum/melonds/domain/model/MicSource;"),
+        };
+
+        jclass firmwareClass = resolver.findClass("me/magnum/melonds/domain/model/FirmwareConfiguration");
+        firmwareConfiguration = FirmwareConfigurationClass {
+            .clazz = firmwareClass,
+            .nickname = resolver.getField(firmwareClass, "nickname", "Ljava/lang/String;"),
+            .message = resolver.getField(firmwareClass, "message", "Ljava/lang/String;"),
+            .language = resolver.getField(firmwareClass, "language", "I"),
+            .favouriteColour = resolver.getField(firmwareClass, "favouriteColour", "I"),
+            .birthdayDay = resolver.getField(firmwareClass, "birthdayDay", "I"),
+            .birthdayMonth = resolver.getField(firmwareClass, "birthdayMonth", "I"),
+            .randomizeMacAddress = resolver.getField(firmwareClass, "randomizeMacAddress", "Z"),
+            .internalMacAddress = resolver.getField(firmwareClass, "internalMacAddress", "Ljava/lang/String;"),
+        };
+
+        jclass rendererClass = resolver.findClass("me/magnum/melonds/domain/model/RendererConfiguration");
+        rendererConfiguration = RendererConfigurationClass {
+            .clazz = rendererClass,
+            .renderer = resolver.getField(rendererClass, "renderer", "Lme/magnum/melonds/domain/model/VideoRenderer;"),
+            .threadedRendering = resolver.getField(rendererClass, "threadedRendering", "Z"),
+            .getResolutionScaling = resolver.getMethod(rendererClass, "getResolutionScaling", "()I"),
+        };
+
+        auto resolveValueEnum = [&resolver](const char* className, const char* valueField) {
+            jclass enumClass = resolver.findClass(className);
+            return ValueEnumClass {
+                .clazz = enumClass,
+                .value = resolver.getField(enumClass, valueField, "I"),
+            };
+        };
+        consoleType = resolveValueEnum("me/magnum/melonds/domain/model/ConsoleType", "consoleType");
+        audioBitrate = resolveValueEnum("me/magnum/melonds/domain/model/AudioBitrate", "bitrateValue");
+        audioInterpolation = resolveValueEnum("me/magnum/melonds/domain/model/AudioInterpolation", "interpolationValue");
+        audioLatency = resolveValueEnum("me/magnum/melonds/domain/model/AudioLatency", "latencyValue");
+        micSource = resolveValueEnum("me/magnum/melonds/domain/model/MicSource", "sourceValue");
+        videoRenderer = resolveValueEnum("me/magnum/melonds/domain/model/VideoRenderer", "renderer");
+
+        frameRenderCallback.clazz = resolver.findClass("me/magnum/melonds/ui/emulator/render/FrameRenderCallback");
+        frameRenderCallback.renderFrame = resolver.getMethod(frameRenderCallback.clazz, "renderFrame", "(ZI)V");
+
+        dsiCameraSource.clazz = resolver.findClass("me/magnum/melonds/common/camera/DSiCameraSource");
+        dsiCameraSource.startCamera = resolver.getMethod(dsiCameraSource.clazz, "startCamera", "(I)V");
+        dsiCameraSource.stopCamera = resolver.getMethod(dsiCameraSource.clazz, "stopCamera", "(I)V");
+        dsiCameraSource.captureFrame = resolver.getMethod(dsiCameraSource.clazz, "captureFrame", "(I[BIIZ)V");
+
+        jclass irManagerClass = resolver.findClass("me/magnum/melonds/common/ir/IRManager");
+        irManager = IRManagerClass {
+            .clazz = irManagerClass,
+            .openSerial = resolver.getMethod(irManagerClass, "openSerial", "()Z"),
+            .closeSerial = resolver.getMethod(irManagerClass, "closeSerial", "()V"),
+            .writeSerial = resolver.getMethod(irManagerClass, "writeSerial", "([BI)I"),
+            .readSerial = resolver.getMethod(irManagerClass, "readSerial", "([BI)I"),
+            .readSerialBlocking = resolver.getMethod(irManagerClass, "readSerialBlocking", "([BIJ)I"),
+            .isSerialOpen = resolver.getMethod(irManagerClass, "isSerialOpen", "()Z"),
+            .openTCP = resolver.getMethod(irManagerClass, "openTCP", "()Z"),
+            .closeTCP = resolver.getMethod(irManagerClass, "closeTCP", "()V"),
+            .writeTCP = resolver.getMethod(irManagerClass, "writeTCP", "([BI)I"),
+            .readTCP = resolver.getMethod(irManagerClass, "readTCP", "([BI)I"),
+            .isTCPOpen = resolver.getMethod(irManagerClass, "isTCPOpen", "()Z"),
+            .hasDataAvailable = resolver.getMethod(irManagerClass, "hasDataAvailable", "()Z"),
+        };
+
+        uriFileHandler.clazz = resolver.findClass("me/magnum/melonds/common/UriFileHandler");
+        uriFileHandler.open = resolver.getMethod(uriFileHandler.clazz, "open", "(Ljava/lang/String;Ljava/lang/String;)I");
+
+        cheat.clazz = resolver.findClass("me/magnum/melonds/domain/model/Cheat");
+        cheat.code = resolver.getField(cheat.clazz, "code", "Ljava/lang/String;");
+
+        raSimpleAchievement.clazz = resolver.findClass("me/magnum/melonds/domain/model/retroachievements/RASimpleAchievement");
+        raSimpleAchievement.id = resolver.getField(raSimpleAchievement.clazz, "id", "J");
+        raSimpleAchievement.memoryAddress = resolver.getField(raSimpleAchievement.clazz, "memoryAddress", "Ljava/lang/String;");
+
+        raSimpleLeaderboard.clazz = resolver.findClass("me/magnum/melonds/domain/model/retroachievements/RASimpleLeaderboard");
+        raSimpleLeaderboard.id = resolver.getField(raSimpleLeaderboard.clazz, "id", "J");
+        raSimpleLeaderboard.memoryAddress = resolver.getField(raSimpleLeaderboard.clazz, "memoryAddress", "Ljava/lang/String;");
+        raSimpleLeaderboard.format = resolver.getField(raSimpleLeaderboard.clazz, "format", "Ljava/lang/String;");
+
+        rewindSaveState.clazz = resolver.findClass("me/magnum/melonds/ui/emulator/rewind/model/RewindSaveState");
+        rewindSaveState.constructor = resolver.getMethod(rewindSaveState.clazz, "<init>", "(Ljava/nio/ByteBuffer;JLjava/nio/ByteBuffer;I)V");
+        rewindSaveState.buffer = resolver.getField(rewindSaveState.clazz, "buffer", "Ljava/nio/ByteBuffer;");
+        rewindSaveState.bufferContentSize = resolver.getField(rewindSaveState.clazz, "bufferContentSize", "J");
+        rewindSaveState.screenshotBuffer = resolver.getField(rewindSaveState.clazz, "screenshotBuffer", "Ljava/nio/ByteBuffer;");
+        rewindSaveState.frame = resolver.getField(rewindSaveState.clazz, "frame", "I");
+
+        rewindWindow.clazz = resolver.findClass("me/magnum/melonds/ui/emulator/rewind/model/RewindWindow");
+        rewindWindow.constructor = resolver.getMethod(rewindWindow.clazz, "<init>", "(ILjava/util/ArrayList;)V");
+
+        dsiWareTitle.clazz = resolver.findClass("me/magnum/melonds/domain/model/DSiWareTitle");
+        dsiWareTitle.constructor = resolver.getMethod(dsiWareTitle.clazz, "<init>", "(Ljava/lang/String;Ljava/lang/String;J[BJJI)V");
+
+        romMetadata.clazz = resolver.findClass("me/magnum/melonds/domain/model/RomMetadata");
+        romMetadata.constructor = resolver.getMethod(romMetadata.clazz, "<init>", "(Ljava/lang/String;Ljava/lang/String;ZLjava/lang/String;)V");
+
+        romScanCallback.clazz = resolver.findClass("me/magnum/melonds/MelonRomMetadataReader$RomScanCallback");
+        romScanCallback.onRomsScanned = resolver.getMethod(romScanCallback.clazz, "onRomsScanned", "([I[Lme/magnum/melonds/domain/model/RomMetadata;I)Z");
+
+        return !resolver.hasFailed();
+    }
+}
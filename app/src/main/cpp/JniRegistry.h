@@ -0,0 +1,209 @@
+#ifndef MELONDS_ANDROID_JNIREGISTRY_H
+#define MELONDS_ANDROID_JNIREGISTRY_H
+
+#include <jni.h>
+
+/**
+ * Java classes, methods and fields used by the native code. Everything is resolved once when the library is loaded, instead of every
+ * time Java is called, which matters in paths like frame presentation, camera capture and IR transfers. Classes are kept as global
+ * references, so they can also be used from threads attached by native code, where FindClass only sees system classes.
+ */
+namespace JniRegistry
+{
+    struct UriClass
+    {
+        jclass clazz;
+        jmethodID toString;
+    };
+
+    struct ArrayListClass
+    {
+        jclass clazz;
+        jmethodID constructor;
+        jmethodID add;
+    };
+
+    struct EmulatorConfigurationClass
+    {
+        jclass clazz;
+        jfieldID firmwareConfiguration;
+        jfieldID rendererConfiguration;
+        jfieldID useCustomBios;
+        jfieldID showBootScreen;
+        jfieldID dsBios7Uri;
+        jfieldID dsBios9Uri;
+        jfieldID dsFirmwareUri;
+        jfieldID dsiBios7Uri;
+        jfieldID dsiBios9Uri;
+        jfieldID dsiFirmwareUri;
+        jfieldID dsiNandUri;
+        jfieldID internalDirectory;
+        jfieldID fastForwardSpeedMultiplier;
+        jfieldID rewindEnabled;
+        jfieldID rewindPeriodSeconds;
+        jfieldID rewindWindowSeconds;
+        jfieldID useJit;
+        jfieldID consoleType;
+        jfieldID soundEnabled;
+        jfieldID volume;
+        jfieldID audioInterpolation;
+        jfieldID audioBitrate;
+        jfieldID audioLatency;
+        jfieldID micSource;
+    };
+
+    struct FirmwareConfigurationClass
+    {
+        jclass clazz;
+        jfieldID nickname;
+        jfieldID message;
+        jfieldID language;
+        jfieldID favouriteColour;
+        jfieldID birthdayDay;
+        jfieldID birthdayMonth;
+        jfieldID randomizeMacAddress;
+        jfieldID internalMacAddress;
+    };
+
+    struct RendererConfigurationClass
+    {
+        jclass clazz;
+        jfieldID renderer;
+        jfieldID threadedRendering;
+        jmethodID getResolutionScaling;
+    };
+
+    /**
+     * Enum whose entries hold the value that is passed to the core.
+     */
+    struct ValueEnumClass
+    {
+        jclass clazz;
+        jfieldID value;
+    };
+
+    struct FrameRenderCallbackClass
+    {
+        jclass clazz;
+        jmethodID renderFrame;
+    };
+
+    struct DSiCameraSourceClass
+    {
+        jclass clazz;
+        jmethodID startCamera;
+        jmethodID stopCamera;
+        jmethodID captureFrame;
+    };
+
+    struct IRManagerClass
+    {
+        jclass clazz;
+        jmethodID openSerial;
+        jmethodID closeSerial;
+        jmethodID writeSerial;
+        jmethodID readSerial;
+        jmethodID readSerialBlocking;
+        jmethodID isSerialOpen;
+        jmethodID openTCP;
+        jmethodID closeTCP;
+        jmethodID writeTCP;
+        jmethodID readTCP;
+        jmethodID isTCPOpen;
+        jmethodID hasDataAvailable;
+    };
+
+    struct UriFileHandlerClass
+    {
+        jclass clazz;
+        jmethodID open;
+    };
+
+    struct CheatClass
+    {
+        jclass clazz;
+        jfieldID code;
+    };
+
+    struct RASimpleAchievementClass
+    {
+        jclass clazz;
+        jfieldID id;
+        jfieldID memoryAddress;
+    };
+
+    struct RASimpleLeaderboardClass
+    {
+        jclass clazz;
+        jfieldID id;
+        jfieldID memoryAddress;
+        jfieldID format;
+    };
+
+    struct RewindSaveStateClass
+    {
+        jclass clazz;
+        jmethodID constructor;
+        jfieldID buffer;
+        jfieldID bufferContentSize;
+        jfieldID screenshotBuffer;
+        jfieldID frame;
+    };
+
+    struct RewindWindowClass
+    {
+        jclass clazz;
+        jmethodID constructor;
+    };
+
+    struct DSiWareTitleClass
+    {
+        jclass clazz;
+        jmethodID constructor;
+    };
+
+    struct RomMetadataClass
+    {
+        jclass clazz;
+        jmethodID constructor;
+    };
+
+    struct RomScanCallbackClass
+    {
+        jclass clazz;
+        jmethodID onRomsScanned;
+    };
+
+    extern UriClass uri;
+    extern ArrayListClass arrayList;
+    extern EmulatorConfigurationClass emulatorConfiguration;
+    extern FirmwareConfigurationClass firmwareConfiguration;
+    extern RendererConfigurationClass rendererConfiguration;
+    extern ValueEnumClass consoleType;
+    extern ValueEnumClass audioBitrate;
+    extern ValueEnumClass audioInterpolation;
+    extern ValueEnumClass audioLatency;
+    extern ValueEnumClass micSource;
+    extern ValueEnumClass videoRenderer;
+    extern FrameRenderCallbackClass frameRenderCallback;
+    extern DSiCameraSourceClass dsiCameraSource;
+    extern IRManagerClass irManager;
+    extern UriFileHandlerClass uriFileHandler;
+    extern CheatClass cheat;
+    extern RASimpleAchievementClass raSimpleAchievement;
+    extern RASimpleLeaderboardClass raSimpleLeaderboard;
+    extern RewindSaveStateClass rewindSaveState;
+    extern RewindWindowClass rewindWindow;
+    extern DSiWareTitleClass dsiWareTitle;
+    extern RomMetadataClass romMetadata;
+    extern RomScanCallbackClass romScanCallback;
+
+    /**
+     * Resolves everything in the registry. Must be called from JNI_OnLoad, where FindClass uses the class loader of the app.
+     * @return False if anything can't be found, which means that the native code doesn't match the Java classes. Every member that is
+     * missing is logged
+     */
+    bool initialize(JNIEnv* env);
+}
+
+#endif //MELONDS_ANDROID_JNIREGISTRY_H
@@ -0,0 +1,108 @@
+#include "MappedFileReader.h"
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+
+using namespace melonDS;
+
+namespace MappedFileReader
+{
+    struct MappedFileCookie
+    {
+        int fd;
+        const char* data;
+        size_t size;
+        size_t position;
+        size_t furthestPosition;
+        std::atomic<u64>* bytesReadCounter;
+    };
+
+    static int readMappedFile(void* cookie, char* buffer, int size)
+    {
+        auto file = (MappedFileCookie*) cookie;
+        if (file->position >= file->size)
+            return 0;
+
+        size_t bytesToRead = std::min((size_t) size, file->size - file->position);
+        memcpy(buffer, file->data + file->position, bytesToRead);
+        file->position += bytesToRead;
+        file->furthestPosition = std::max(file->furthestPosition, file->position);
+        *file->bytesReadCounter += bytesToRead;
+        return (int) bytesToRead;
+    }
+
+    static fpos_t seekMappedFile(void* cookie, fpos_t offset, int whence)
+    {
+        auto file = (MappedFileCookie*) cookie;
+        fpos_t newPosition;
+        switch (whence)
+        {
+            case SEEK_SET:
+                newPosition = offset;
+                break;
+            case SEEK_CUR:
+                newPosition = (fpos_t) file->position + offset;
+                break;
+            case SEEK_END:
+                newPosition = (fpos_t) file->size + offset;
+                break;
+            default:
+                return -1;
+        }
+
+        if (newPosition < 0)
+            return -1;
+
+        file->position = (size_t) newPosition;
+        return newPosition;
+    }
+
+    static int closeMappedFile(void* cookie)
+    {
+        auto file = (MappedFileCookie*) cookie;
+        munmap((void*) file->data, file->size);
+
+        // The core keeps its own copy of files that it reads completely, so there's no point in keeping them cached
+        if (file->furthestPosition >= file->size)
+            posix_fadvise(file->fd, 0, 0, POSIX_FADV_DONTNEED);
+
+        close(file->fd);
+        delete file;
+        return 0;
+    }
+
+    FILE* open(int fd, std::atomic<u64>* bytesReadCounter)
+    {
+        struct stat64 fileStat {};
+        if (fstat64(fd, &fileStat) != 0 || !S_ISREG(fileStat.st_mode) || fileStat.st_size < MIN_MAPPED_FILE_SIZE)
+            return nullptr;
+
+        size_t size = (size_t) fileStat.st_size;
+        void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED)
+            return nullptr;
+
+        madvise(data, size, MADV_SEQUENTIAL);
+
+        auto cookie = new MappedFileCookie {
+            .fd = fd,
+            .data = (const char*) data,
+            .size = size,
+            .position = 0,
+            .furthestPosition = 0,
+            .bytesReadCounter = bytesReadCounter,
+        };
+
+        FILE* mappedFile = funopen(cookie, readMappedFile, nullptr, seekMappedFile, closeMappedFile);
+        if (!mappedFile)
+        {
+            munmap(data, size);
+            delete cookie;
+        }
+
+        return mappedFile;
+    }
+}
@@ -0,0 +1,26 @@
+#ifndef MELONDS_ANDROID_MAPPEDFILEREADER_H
+#define MELONDS_ANDROID_MAPPEDFILEREADER_H
+
+#include <stdio.h>
+#include <atomic>
+#include "types.h"
+
+/**
+ * Serves read-only files to the core from a memory mapping instead of through stdio. Big files, like ROMs, are read by the core once
+ * into its own buffers, so the mapping is read sequentially with aggressive readahead and, once the file has been read completely,
+ * its pages are dropped from the page cache so that the file is not kept in memory twice.
+ */
+namespace MappedFileReader
+{
+    // Smaller files (BIOS, firmware, saves) are not worth mapping
+    constexpr long MIN_MAPPED_FILE_SIZE = 4 * 1024 * 1024;
+
+    /**
+     * Opens the file in the given descriptor for reading. On success, the returned file takes ownership of the descriptor.
+     * @param bytesReadCounter Counter to which the number of bytes read from the file is added
+     * @return Null if the file is too small or can't be mapped, in which case the descriptor is left untouched
+     */
+    FILE* open(int fd, std::atomic<melonDS::u64>* bytesReadCounter);
+}
+
+#endif //MELONDS_ANDROID_MAPPEDFILEREADER_H
@@ -0,0 +1,26 @@
+#include <jni.h>
+#include <vector>
+#include "cheats/CheatCodeParser.h"
+
+extern "C"
+{
+JNIEXPORT jintArray JNICALL
+Java_me_magnum_melonds_MelonCheatCodeParser_validateCheatCodesInternal(JNIEnv* env, jobject thiz, jobjectArray codes)
+{
+    jsize codeCount = env->GetArrayLength(codes);
+    std::vector<CheatCodeParser::ParseResult> results;
+    results.reserve(codeCount);
+
+    // The same buffer is reused for all codes, since only the results are needed
+    std::vector<melonDS::u32> words;
+    for (jsize i = 0; i < codeCount; i++)
+    {
+        auto code = (jstring) env->GetObjectArrayElement(codes, i);
+        words.clear();
+        results.push_back(CheatCodeParser::parse(env, code, words));
+        env->DeleteLocalRef(code);
+    }
+
+    return CheatCodeParser::buildResultArray(env, results);
+}
+}
@@ -1,4 +1,5 @@
 #include "MelonDSAndroidCameraHandler.h"
+#include "JniRegistry.h"
 
 MelonDSAndroidCameraHandler::MelonDSAndroidCameraHandler(JniEnvHandler* jniEnvHandler, jobject cameraManager) : jniEnvHandler(jniEnvHandler), cameraManager(cameraManager)
 {
@@ -7,34 +8,32 @@ MelonDSAndroidCameraHandler::MelonDSAndroidCameraHandler(JniEnvHandler* jniEnvHa
 void MelonDSAndroidCameraHandler::startCamera(int camera)
 {
     JNIEnv* env = jniEnvHandler->getCurrentThreadEnv();
-
-    jclass cameraManagerClass = env->GetObjectClass(cameraManager);
-    jmethodID startCameraMethod = env->GetMethodID(cameraManagerClass, "startCamera", "(I)V");
-    env->CallVoidMethod(cameraManager, startCameraMethod, camera);
+    env->CallVoidMethod(cameraManager, JniRegistry::dsiCameraSource.startCamera, camera);
 }
 
 void MelonDSAndroidCameraHandler::stopCamera(int camera)
 {
     JNIEnv* env = jniEnvHandler->getCurrentThreadEnv();
-
-    jclass cameraManagerClass = env->GetObjectClass(cameraManager);
-    jmethodID stopCameraMethod = env->GetMethodID(cameraManagerClass, "stopCamera", "(I)V");
-    env->CallVoidMethod(cameraManager, stopCameraMethod, camera);
+    env->CallVoidMethod(cameraManager, JniRegistry::dsiCameraSource.stopCamera, camera);
 }
 
 void MelonDSAndroidCameraHandler::captureFrame(int camera, u32* frameBuffer, int width, int height, bool isYuv)
 {
     JNIEnv* env = jniEnvHandler->getCurrentThreadEnv();
-    jbyteArray javaBuffer = env->NewByteArray(BUFFER_SIZE);
-    jclass cameraManagerClass = env->GetObjectClass(cameraManager);
-    jmethodID captureFrameMethod = env->GetMethodID(cameraManagerClass, "captureFrame", "(I[BIIZ)V");
-    env->CallVoidMethod(cameraManager, captureFrameMethod, camera, javaBuffer, width, height, isYuv);
-
-    env->GetByteArrayRegion(javaBuffer, 0, BUFFER_SIZE, (jbyte*) frameBuffer);
-
-    env->DeleteLocalRef(javaBuffer);
+    // Frames are captured continuously while the camera is active, so the same Java buffer is used for all of them
+    if (!javaFrameBuffer)
+    {
+        jbyteArray localBuffer = env->NewByteArray(BUFFER_SIZE);
+        javaFrameBuffer = (jbyteArray) env->NewGlobalRef(localBuffer);
+        env->DeleteLocalRef(localBuffer);
+    }
+
+    env->CallVoidMethod(cameraManager, JniRegistry::dsiCameraSource.captureFrame, camera, javaFrameBuffer, width, height, isYuv);
+    env->GetByteArrayRegion(javaFrameBuffer, 0, BUFFER_SIZE, (jbyte*) frameBuffer);
 }
 
 MelonDSAndroidCameraHandler::~MelonDSAndroidCameraHandler()
 {
+    if (javaFrameBuffer)
+        jniEnvHandler->getCurrentThreadEnv()->DeleteGlobalRef(javaFrameBuffer);
 }
\ No newline at end of file
@@ -14,6 +14,7 @@ private:
 
     JniEnvHandler* jniEnvHandler;
     jobject cameraManager;
+    jbyteArray javaFrameBuffer = nullptr;
 
 public:
     MelonDSAndroidCameraHandler(JniEnvHandler* jniEnvHandler, jobject cameraManager);
@@ -1,59 +1,49 @@
 #include <jni.h>
+#include <tuple>
 #include "MelonDSAndroidConfiguration.h"
+#include "JniRegistry.h"
 #include "renderer/Renderer.h"
 
 MelonDSAndroid::EmulatorConfiguration MelonDSAndroidConfiguration::buildEmulatorConfiguration(JNIEnv* env, jobject emulatorConfiguration) {
-    jclass emulatorConfigurationClass = env->GetObjectClass(emulatorConfiguration);
-    jclass uriClass = env->FindClass("android/net/Uri");
-    jclass consoleTypeEnumClass = env->FindClass("me/magnum/melonds/domain/model/ConsoleType");
-    jclass audioBitrateEnumClass = env->FindClass("me/magnum/melonds/domain/model/AudioBitrate");
-    jclass audioInterpolationEnumClass = env->FindClass("me/magnum/melonds/domain/model/AudioInterpolation");
-    jclass audioLatencyEnumClass = env->FindClass("me/magnum/melonds/domain/model/AudioLatency");
-    jclass micSourceEnumClass = env->FindClass("me/magnum/melonds/domain/model/MicSource");
-    jclass videoRendererEnumClass = env->FindClass("me/magnum/melonds/domain/model/VideoRenderer");
-    jclass renderConfigurationClass = env->FindClass("me/magnum/melonds/domain/model/RendererConfiguration");
-
-    jmethodID uriToStringMethod = env->GetMethodID(uriClass, "toString", "()Ljava/lang/String;");
-
-    jobject firmwareConfigurationObject = env->GetObjectField(emulatorConfiguration, env->GetFieldID(emulatorConfigurationClass, "firmwareConfiguration", "Lme/magnum/melonds/domain/model/FirmwareConfiguration;"));
-    jobject rendererConfigurationObject = env->GetObjectField(emulatorConfiguration, env->GetFieldID(emulatorConfigurationClass, "rendererConfiguration", "Lme/magnum/melonds/domain/model/RendererConfiguration;"));
-    jboolean useCustomBios = env->GetBooleanField(emulatorConfiguration, env->GetFieldID(emulatorConfigurationClass, "useCustomBios", "Z"));
-    jboolean showBootScreen = env->GetBooleanField(emulatorConfiguration, env->GetFieldID(emulatorConfigurationClass, "showBootScreen", "Z"));
-    jobject dsBios7Uri = env->GetObjectField(emulatorConfiguration, env->GetFieldID(emulatorConfigurationClass, "dsBios7Uri", "Landroid/net/Uri;"));
-    jobject dsBios9Uri = env->GetObjectField(emulatorConfiguration, env->GetFieldID(emulatorConfigurationClass, "dsBios9Uri", "Landroid/net/Uri;"));
-    jobject dsFirmwareUri = env->GetObjectField(emulatorConfiguration, env->GetFieldID(emulatorConfigurationClass, "dsFirmwareUri", "Landroid/net/Uri;"));
-    jobject dsiBios7Uri = env->GetObjectField(emulatorConfiguration, env->GetFieldID(emulatorConfigurationClass, "dsiBios7Uri", "Landroid/net/Uri;"));
-    jobject dsiBios9Uri = env->GetObjectField(emulatorConfiguration, env->GetFieldID(emulatorConfigurationClass, "dsiBios9Uri", "Landroid/net/Uri;"));
-    jobject dsiFirmwareUri = env->GetObjectField(emulatorConfiguration, env->GetFieldID(emulatorConfigurationClass, "dsiFirmwareUri", "Landroid/net/Uri;"));
-    jobject dsiNandUri = env->GetObjectField(emulatorConfiguration, env->GetFieldID(emulatorConfigurationClass, "dsiNandUri", "Landroid/net/Uri;"));
-    jstring internalFilesDir = (jstring) env->GetObjectField(emulatorConfiguration, env->GetFieldID(emulatorConfigurationClass, "internalDirectory", "Ljava/lang/String;"));
-    jfloat fastForwardMaxSpeed = env->GetFloatField(emulatorConfiguration, env->GetFieldID(emulatorConfigurationClass, "fastForwardSpeedMultiplier", "F"));
-    jboolean enableRewind = env->GetBooleanField(emulatorConfiguration, env->GetFieldID(emulatorConfigurationClass, "rewindEnabled", "Z"));
-    jint rewindPeriodSeconds = env->GetIntField(emulatorConfiguration, env->GetFieldID(emulatorConfigurationClass, "rewindPeriodSeconds", "I"));
-    jint rewindWindowSeconds = env->GetIntField(emulatorConfiguration, env->GetFieldID(emulatorConfigurationClass, "rewindWindowSeconds", "I"));
-    jboolean useJit = env->GetBooleanField(emulatorConfiguration, env->GetFieldID(emulatorConfigurationClass, "useJit", "Z"));
-    jobject consoleTypeEnum = env->GetObjectField(emulatorConfiguration, env->GetFieldID(emulatorConfigurationClass, "consoleType", "Lme/magnum/melonds/domain/model/ConsoleType;"));
-    jint consoleType = env->GetIntField(consoleTypeEnum, env->GetFieldID(consoleTypeEnumClass, "consoleType", "I"));
-    jboolean soundEnabled = env->GetBooleanField(emulatorConfiguration, env->GetFieldID(emulatorConfigurationClass, "soundEnabled", "Z"));
-    jint volume = env->GetIntField(emulatorConfiguration, env->GetFieldID(emulatorConfigurationClass, "volume", "I"));
-    jobject audioInterpolationEnum = env->GetObjectField(emulatorConfiguration, env->GetFieldID(emulatorConfigurationClass, "audioInterpolation", "Lme/magnum/melonds/domain/model/AudioInterpolation;"));
-    jint audioInterpolation = env->GetIntField(audioInterpolationEnum, env->GetFieldID(audioInterpolationEnumClass, "interpolationValue", "I"));
-    jobject audioBitrateEnum = env->GetObjectField(emulatorConfiguration, env->GetFieldID(emulatorConfigurationClass, "audioBitrate", "Lme/magnum/melonds/domain/model/AudioBitrate;"));
-    jint audioBitrate = env->GetIntField(audioBitrateEnum, env->GetFieldID(audioBitrateEnumClass, "bitrateValue", "I"));
-    jobject audioLatencyEnum = env->GetObjectField(emulatorConfiguration, env->GetFieldID(emulatorConfigurationClass, "audioLatency", "Lme/magnum/melonds/domain/model/AudioLatency;"));
-    jint audioLatency = env->GetIntField(audioLatencyEnum, env->GetFieldID(audioLatencyEnumClass, "latencyValue", "I"));
-    jobject micSourceEnum = env->GetObjectField(emulatorConfiguration, env->GetFieldID(emulatorConfigurationClass, "micSource", "Lme/magnum/melonds/domain/model/MicSource;"));
-    jint micSource = env->GetIntField(micSourceEnum, env->GetFieldID(micSourceEnumClass, "sourceValue", "I"));
-    jobject videoRendererEnum = env->GetObjectField(rendererConfigurationObject, env->GetFieldID(renderConfigurationClass, "renderer", "Lme/magnum/melonds/domain/model/VideoRenderer;"));
-    MelonDSAndroid::Renderer videoRenderer = static_cast<MelonDSAndroid::Renderer>(env->GetIntField(videoRendererEnum, env->GetFieldID(videoRendererEnumClass, "renderer", "I")));
+    jobject firmwareConfigurationObject = env->GetObjectField(emulatorConfiguration, JniRegistry::emulatorConfiguration.firmwareConfiguration);
+    jobject rendererConfigurationObject = env->GetObjectField(emulatorConfiguration, JniRegistry::emulatorConfiguration.rendererConfiguration);
+    jboolean useCustomBios = env->GetBooleanField(emulatorConfiguration, JniRegistry::emulatorConfiguration.useCustomBios);
+    jboolean showBootScreen = env->GetBooleanField(emulatorConfiguration, JniRegistry::emulatorConfiguration.showBootScreen);
+    jobject dsBios7Uri = env->GetObjectField(emulatorConfiguration, JniRegistry::emulatorConfiguration.dsBios7Uri);
+    jobject dsBios9Uri = env->GetObjectField(emulatorConfiguration, JniRegistry::emulatorConfiguration.dsBios9Uri);
+    jobject dsFirmwareUri = env->GetObjectField(emulatorConfiguration, JniRegistry::emulatorConfiguration.dsFirmwareUri);
+    jobject dsiBios7Uri = env->GetObjectField(emulatorConfiguration, JniRegistry::emulatorConfiguration.dsiBios7Uri);
+    jobject dsiBios9Uri = env->GetObjectField(emulatorConfiguration, JniRegistry::emulatorConfiguration.dsiBios9Uri);
+    jobject dsiFirmwareUri = env->GetObjectField(emulatorConfiguration, JniRegistry::emulatorConfiguration.dsiFirmwareUri);
+    jobject dsiNandUri = env->GetObjectField(emulatorConfiguration, JniRegistry::emulatorConfiguration.dsiNandUri);
+    jstring internalFilesDir = (jstring) env->GetObjectField(emulatorConfiguration, JniRegistry::emulatorConfiguration.internalDirectory);
+    jfloat fastForwardMaxSpeed = env->GetFloatField(emulatorConfiguration, JniRegistry::emulatorConfiguration.fastForwardSpeedMultiplier);
+    jboolean enableRewind = env->GetBooleanField(emulatorConfiguration, JniRegistry::emulatorConfiguration.rewindEnabled);
+    jint rewindPeriodSeconds = env->GetIntField(emulatorConfiguration, JniRegistry::emulatorConfiguration.rewindPeriodSeconds);
+    jint rewindWindowSeconds = env->GetIntField(emulatorConfiguration, JniRegistry::emulatorConfiguration.rewindWindowSeconds);
+    jboolean useJit = env->GetBooleanField(emulatorConfiguration, JniRegistry::emulatorConfiguration.useJit);
+    jobject consoleTypeEnum = env->GetObjectField(emulatorConfiguration, JniRegistry::emulatorConfiguration.consoleType);
+    jint consoleType = env->GetIntField(consoleTypeEnum, JniRegistry::consoleType.value);
+    jboolean soundEnabled = env->GetBooleanField(emulatorConfiguration, JniRegistry::emulatorConfiguration.soundEnabled);
+    jint volume = env->GetIntField(emulatorConfiguration, JniRegistry::emulatorConfiguration.volume);
+    jobject audioInterpolationEnum = env->GetObjectField(emulatorConfiguration, JniRegistry::emulatorConfiguration.audioInterpolation);
+    jint audioInterpolation = env->GetIntField(audioInterpolationEnum, JniRegistry::audioInterpolation.value);
+    jobject audioBitrateEnum = env->GetObjectField(emulatorConfiguration, JniRegistry::emulatorConfiguration.audioBitrate);
+    jint audioBitrate = env->GetIntField(audioBitrateEnum, JniRegistry::audioBitrate.value);
+    jobject audioLatencyEnum = env->GetObjectField(emulatorConfiguration, JniRegistry::emulatorConfiguration.audioLatency);
+    jint audioLatency = env->GetIntField(audioLatencyEnum, JniRegistry::audioLatency.value);
+    jobject micSourceEnum = env->GetObjectField(emulatorConfiguration, JniRegistry::emulatorConfiguration.micSource);
+    jint micSource = env->GetIntField(micSourceEnum, JniRegistry::micSource.value);
+    jobject videoRendererEnum = env->GetObjectField(rendererConfigurationObject, JniRegistry::rendererConfiguration.renderer);
+    MelonDSAndroid::Renderer videoRenderer = static_cast<MelonDSAndroid::Renderer>(env->GetIntField(videoRendererEnum, JniRegistry::videoRenderer.value));
     jboolean isCopy = JNI_FALSE;
-    jstring dsBios7String = dsBios7Uri ? (jstring) env->CallObjectMethod(dsBios7Uri, uriToStringMethod) : nullptr;
-    jstring dsBios9String = dsBios9Uri ? (jstring) env->CallObjectMethod(dsBios9Uri, uriToStringMethod) : nullptr;
-    jstring dsFirmwareString = dsFirmwareUri ? (jstring) env->CallObjectMethod(dsFirmwareUri, uriToStringMethod) : nullptr;
-    jstring dsiBios7String = dsiBios7Uri ? (jstring) env->CallObjectMethod(dsiBios7Uri, uriToStringMethod) : nullptr;
-    jstring dsiBios9String = dsiBios9Uri ? (jstring) env->CallObjectMethod(dsiBios9Uri, uriToStringMethod) : nullptr;
-    jstring dsiFirmwareString = dsiFirmwareUri ? (jstring) env->CallObjectMethod(dsiFirmwareUri, uriToStringMethod) : nullptr;
-    jstring dsiNandString = dsiNandUri ? (jstring) env->CallObjectMethod(dsiNandUri, uriToStringMethod) : nullptr;
+    jstring dsBios7String = dsBios7Uri ? (jstring) env->CallObjectMethod(dsBios7Uri, JniRegistry::uri.toString) : nullptr;
+    jstring dsBios9String = dsBios9Uri ? (jstring) env->CallObjectMethod(dsBios9Uri, JniRegistry::uri.toString) : nullptr;
+    jstring dsFirmwareString = dsFirmwareUri ? (jstring) env->CallObjectMethod(dsFirmwareUri, JniRegistry::uri.toString) : nullptr;
+    jstring dsiBios7String = dsiBios7Uri ? (jstring) env->CallObjectMethod(dsiBios7Uri, JniRegistry::uri.toString) : nullptr;
+    jstring dsiBios9String = dsiBios9Uri ? (jstring) env->CallObjectMethod(dsiBios9Uri, JniRegistry::uri.toString) : nullptr;
+    jstring dsiFirmwareString = dsiFirmwareUri ? (jstring) env->CallObjectMethod(dsiFirmwareUri, JniRegistry::uri.toString) : nullptr;
+    jstring dsiNandString = dsiNandUri ? (jstring) env->CallObjectMethod(dsiNandUri, JniRegistry::uri.toString) : nullptr;
     const char* dsBios7Path = dsBios7Uri ? env->GetStringUTFChars(dsBios7String, &isCopy) : nullptr;
     const char* dsBios9Path = dsBios9Uri ? env->GetStringUTFChars(dsBios9String, &isCopy) : nullptr;
     const char* dsFirmwarePath = dsFirmwareUri ? env->GetStringUTFChars(dsFirmwareString, &isCopy) : nullptr;
@@ -97,15 +87,14 @@ MelonDSAndroid::EmulatorConfiguration MelonDSAndroidConfiguration::buildEmulator
 }
 
 MelonDSAndroid::FirmwareConfiguration MelonDSAndroidConfiguration::buildFirmwareConfiguration(JNIEnv* env, jobject firmwareConfiguration) {
-    jclass firmwareConfigurationClass = env->GetObjectClass(firmwareConfiguration);
-    jstring nicknameString = (jstring) env->GetObjectField(firmwareConfiguration, env->GetFieldID(firmwareConfigurationClass, "nickname", "Ljava/lang/String;"));
-    jstring messageString = (jstring) env->GetObjectField(firmwareConfiguration, env->GetFieldID(firmwareConfigurationClass, "message", "Ljava/lang/String;"));
-    int language = env->GetIntField(firmwareConfiguration, env->GetFieldID(firmwareConfigurationClass, "language", "I"));
-    int colour = env->GetIntField(firmwareConfiguration, env->GetFieldID(firmwareConfigurationClass, "favouriteColour", "I"));
-    int birthdayDay = env->GetIntField(firmwareConfiguration, env->GetFieldID(firmwareConfigurationClass, "birthdayDay", "I"));
-    int birthdayMonth = env->GetIntField(firmwareConfiguration, env->GetFieldID(firmwareConfigurationClass, "birthdayMonth", "I"));
-    bool randomizeMacAddress = env->GetBooleanField(firmwareConfiguration, env->GetFieldID(firmwareConfigurationClass, "randomizeMacAddress", "Z"));
-    jstring macAddressString = (jstring) env->GetObjectField(firmwareConfiguration, env->GetFieldID(firmwareConfigurationClass, "internalMacAddress", "Ljava/lang/String;"));
+    jstring nicknameString = (jstring) env->GetObjectField(firmwareConfiguration, JniRegistry::firmwareConfiguration.nickname);
+    jstring messageString = (jstring) env->GetObjectField(firmwareConfiguration, JniRegistry::firmwareConfiguration.message);
+    int language = env->GetIntField(firmwareConfiguration, JniRegistry::firmwareConfiguration.language);
+    int colour = env->GetIntField(firmwareConfiguration, JniRegistry::firmwareConfiguration.favouriteColour);
+    int birthdayDay = env->GetIntField(firmwareConfiguration, JniRegistry::firmwareConfiguration.birthdayDay);
+    int birthdayMonth = env->GetIntField(firmwareConfiguration, JniRegistry::firmwareConfiguration.birthdayMonth);
+    bool randomizeMacAddress = env->GetBooleanField(firmwareConfiguration, JniRegistry::firmwareConfiguration.randomizeMacAddress);
+    jstring macAddressString = (jstring) env->GetObjectField(firmwareConfiguration, JniRegistry::firmwareConfiguration.internalMacAddress);
 
     jboolean isCopy = JNI_FALSE;
     const char* nickname = env->GetStringUTFChars(nicknameString, &isCopy);
@@ -142,10 +131,8 @@ MelonDSAndroid::FirmwareConfiguration MelonDSAndroidConfiguration::buildFirmware
 }
 
 std::unique_ptr<MelonDSAndroid::RenderSettings> MelonDSAndroidConfiguration::buildRenderSettings(JNIEnv* env, MelonDSAndroid::Renderer renderer, jobject renderSettings) {
-    jclass renderSettingsClass = env->GetObjectClass(renderSettings);
-    jmethodID getResolutionScalingMethod = env->GetMethodID(renderSettingsClass, "getResolutionScaling", "()I");
-    jboolean threadedRendering = env->GetBooleanField(renderSettings, env->GetFieldID(renderSettingsClass, "threadedRendering", "Z"));
-    jint internalResolutionScaling = env->CallIntMethod(renderSettings, getResolutionScalingMethod);
+    jboolean threadedRendering = env->GetBooleanField(renderSettings, JniRegistry::rendererConfiguration.threadedRendering);
+    jint internalResolutionScaling = env->CallIntMethod(renderSettings, JniRegistry::rendererConfiguration.getResolutionScaling);
 
     std::unique_ptr<MelonDSAndroid::RenderSettings> settings;
     if (renderer == MelonDSAndroid::Renderer::OpenGl)
@@ -176,4 +163,115 @@ std::unique_ptr<MelonDSAndroid::RenderSettings> MelonDSAndroidConfiguration::bui
     }
 
     return settings;
-}
\ No newline at end of file
+}
+std::vector<std::string> MelonDSAndroidConfiguration::getBiosAndFirmwarePaths(const MelonDSAndroid::EmulatorConfiguration& emulatorConfiguration) {
+    std::vector<std::string> paths;
+    if (emulatorConfiguration.userInternalFirmwareAndBios)
+        return paths;
+
+    const char* configuredPaths[] = {
+        emulatorConfiguration.dsBios7Path,
+        emulatorConfiguration.dsBios9Path,
+        emulatorConfiguration.dsFirmwarePath,
+        emulatorConfiguration.dsiBios7Path,
+        emulatorConfiguration.dsiBios9Path,
+        emulatorConfiguration.dsiFirmwarePath,
+    };
+
+    for (const char* path : configuredPaths)
+    {
+        if (path != nullptr)
+            paths.emplace_back(path);
+    }
+
+    return paths;
+}
+
+bool MelonDSAndroidConfiguration::CoreSetupKey::operator==(const CoreSetupKey& other) const {
+    auto fields = [](const CoreSetupKey& key) {
+        return std::tie(key.consoleType, key.userInternalFirmwareAndBios, key.useJit, key.renderer, key.paths, key.username, key.message, key.language,
+                        key.favouriteColour, key.birthdayDay, key.birthdayMonth, key.randomizeMacAddress, key.macAddress);
+    };
+    return fields(*this) == fields(other);
+}
+
+MelonDSAndroidConfiguration::CoreSetupKey MelonDSAndroidConfiguration::getCoreSetupKey(const MelonDSAndroid::EmulatorConfiguration& emulatorConfiguration) {
+    std::vector<std::string> paths = getBiosAndFirmwarePaths(emulatorConfiguration);
+    if (emulatorConfiguration.dsiNandPath != nullptr)
+        paths.emplace_back(emulatorConfiguration.dsiNandPath);
+
+    const MelonDSAndroid::FirmwareConfiguration& firmwareConfiguration = emulatorConfiguration.firmwareConfiguration;
+    return CoreSetupKey {
+        .consoleType = emulatorConfiguration.consoleType,
+        .userInternalFirmwareAndBios = emulatorConfiguration.userInternalFirmwareAndBios,
+        .useJit = emulatorConfiguration.useJit,
+        .renderer = emulatorConfiguration.renderer,
+        .paths = std::move(paths),
+        .username = firmwareConfiguration.username,
+        .message = firmwareConfiguration.message,
+        .language = firmwareConfiguration.language,
+        .favouriteColour = firmwareConfiguration.favouriteColour,
+        .birthdayDay = firmwareConfiguration.birthdayDay,
+        .birthdayMonth = firmwareConfiguration.birthdayMonth,
+        .randomizeMacAddress = firmwareConfiguration.randomizeMacAddress,
+        .macAddress = firmwareConfiguration.macAddress,
+    };
+}
+
+MelonDSAndroidConfiguration::LiveSettings MelonDSAndroidConfiguration::getLiveSettings(const MelonDSAndroid::EmulatorConfiguration& emulatorConfiguration) {
+    int resolutionScale = 1;
+    bool threadedRendering = false;
+    if (emulatorConfiguration.renderer == MelonDSAndroid::Renderer::OpenGl)
+        resolutionScale = static_cast<const MelonDSAndroid::OpenGlRenderSettings*>(emulatorConfiguration.renderSettings.get())->scale;
+    else if (emulatorConfiguration.renderer == MelonDSAndroid::Renderer::Compute)
+        resolutionScale = static_cast<const MelonDSAndroid::ComputeRenderSettings*>(emulatorConfiguration.renderSettings.get())->scale;
+    else
+        threadedRendering = static_cast<const MelonDSAndroid::SoftwareRenderSettings*>(emulatorConfiguration.renderSettings.get())->threadedRendering;
+
+    const MelonDSAndroid::AudioSettings& audioSettings = emulatorConfiguration.audioSettings;
+    return LiveSettings {
+        .soundEnabled = audioSettings.soundEnabled,
+        .volume = audioSettings.volume,
+        .audioInterpolation = audioSettings.audioInterpolation,
+        .audioBitrate = audioSettings.audioBitrate,
+        .audioLatency = audioSettings.audioLatency,
+        .micSource = audioSettings.micSource,
+        .resolutionScale = resolutionScale,
+        .threadedRendering = threadedRendering,
+        .fastForwardSpeedMultiplier = emulatorConfiguration.fastForwardSpeedMultiplier,
+        .rewindEnabled = emulatorConfiguration.rewindEnabled != 0,
+        .rewindCaptureSpacingSeconds = emulatorConfiguration.rewindCaptureSpacingSeconds,
+        .rewindLengthSeconds = emulatorConfiguration.rewindLengthSeconds,
+        .showBootScreen = emulatorConfiguration.showBootScreen,
+    };
+}
+
+int MelonDSAndroidConfiguration::getConfigurationChanges(const CoreSetupKey& oldCoreSetupKey, const LiveSettings& oldSettings, const CoreSetupKey& newCoreSetupKey, const LiveSettings& newSettings) {
+    auto audio = [](const LiveSettings& settings) {
+        return std::tie(settings.soundEnabled, settings.volume, settings.audioInterpolation, settings.audioBitrate, settings.audioLatency);
+    };
+    auto renderer = [](const LiveSettings& settings) {
+        return std::tie(settings.resolutionScale, settings.threadedRendering);
+    };
+    auto rewind = [](const LiveSettings& settings) {
+        return std::tie(settings.rewindEnabled, settings.rewindCaptureSpacingSeconds, settings.rewindLengthSeconds);
+    };
+
+    int changes = 0;
+    if (audio(oldSettings) != audio(newSettings))
+        changes |= CONFIGURATION_CHANGE_AUDIO;
+    if (oldSettings.micSource != newSettings.micSource)
+        changes |= CONFIGURATION_CHANGE_MIC_SOURCE;
+    if (renderer(oldSettings) != renderer(newSettings))
+        changes |= CONFIGURATION_CHANGE_RENDERER;
+    if (oldSettings.fastForwardSpeedMultiplier != newSettings.fastForwardSpeedMultiplier)
+        changes |= CONFIGURATION_CHANGE_FAST_FORWARD;
+    if (rewind(oldSettings) != rewind(newSettings))
+        changes |= CONFIGURATION_CHANGE_REWIND;
+    if (oldSettings.showBootScreen != newSettings.showBootScreen)
+        changes |= CONFIGURATION_CHANGE_BOOT;
+    if (!(oldCoreSetupKey == newCoreSetupKey))
+        changes |= CONFIGURATION_CHANGE_CORE_SETUP;
+
+    return changes;
+}
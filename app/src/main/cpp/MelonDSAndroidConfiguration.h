@@ -1,13 +1,80 @@
 #ifndef MELONDSANDROIDCONFIGURATION_H
 #define MELONDSANDROIDCONFIGURATION_H
 
+#include <string>
+#include <vector>
 #include "Configuration.h"
 #include "MelonDS.h"
 
 namespace MelonDSAndroidConfiguration {
+    /**
+     * The parts of the configuration that the core only applies when it's set up. A core that is kept set up between sessions can
+     * only be reused if these don't change. The rest of the configuration can be applied with updateEmulatorConfiguration().
+     */
+    struct CoreSetupKey {
+        int consoleType;
+        bool userInternalFirmwareAndBios;
+        bool useJit;
+        MelonDSAndroid::Renderer renderer;
+        std::vector<std::string> paths;
+        std::string username;
+        std::string message;
+        int language;
+        int favouriteColour;
+        int birthdayDay;
+        int birthdayMonth;
+        bool randomizeMacAddress;
+        std::string macAddress;
+
+        bool operator==(const CoreSetupKey& other) const;
+    };
+
+    /**
+     * The parts of the configuration that can be changed while a game is running.
+     */
+    struct LiveSettings {
+        bool soundEnabled;
+        int volume;
+        int audioInterpolation;
+        int audioBitrate;
+        int audioLatency;
+        int micSource;
+        int resolutionScale;
+        bool threadedRendering;
+        float fastForwardSpeedMultiplier;
+        bool rewindEnabled;
+        int rewindCaptureSpacingSeconds;
+        int rewindLengthSeconds;
+        bool showBootScreen;
+    };
+
+    /**
+     * Subsystems affected by a configuration change. Must match the values in AndroidEmulatorManager.kt.
+     */
+    enum ConfigurationChange {
+        CONFIGURATION_CHANGE_AUDIO = 1 << 0,
+        CONFIGURATION_CHANGE_MIC_SOURCE = 1 << 1,
+        CONFIGURATION_CHANGE_RENDERER = 1 << 2,
+        // Only used by the frontend, which limits the frame rate. The core doesn't have to be updated
+        CONFIGURATION_CHANGE_FAST_FORWARD = 1 << 3,
+        CONFIGURATION_CHANGE_REWIND = 1 << 4,
+        // Applied the next time the machine boots
+        CONFIGURATION_CHANGE_BOOT = 1 << 5,
+        // Only applied when the core is set up again, which requires relaunching the game
+        CONFIGURATION_CHANGE_CORE_SETUP = 1 << 6,
+    };
+
     MelonDSAndroid::EmulatorConfiguration buildEmulatorConfiguration(JNIEnv* env, jobject emulatorConfiguration);
     MelonDSAndroid::FirmwareConfiguration buildFirmwareConfiguration(JNIEnv* env, jobject firmwareConfiguration);
     std::unique_ptr<MelonDSAndroid::RenderSettings> buildRenderSettings(JNIEnv* env, MelonDSAndroid::Renderer renderer, jobject renderSettings);
+    std::vector<std::string> getBiosAndFirmwarePaths(const MelonDSAndroid::EmulatorConfiguration& emulatorConfiguration);
+    CoreSetupKey getCoreSetupKey(const MelonDSAndroid::EmulatorConfiguration& emulatorConfiguration);
+    LiveSettings getLiveSettings(const MelonDSAndroid::EmulatorConfiguration& emulatorConfiguration);
+
+    /**
+     * @return The ConfigurationChange flags of the subsystems whose settings differ between the two configurations
+     */
+    int getConfigurationChanges(const CoreSetupKey& oldCoreSetupKey, const LiveSettings& oldSettings, const CoreSetupKey& newCoreSetupKey, const LiveSettings& newSettings);
 }
 
 #endif //MELONDSANDROIDCONFIGURATION_H
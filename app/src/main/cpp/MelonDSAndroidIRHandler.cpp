@@ -1,4 +1,5 @@
 #include "MelonDSAndroidIRHandler.h"
+#include "JniRegistry.h"
 #include <android/log.h>
 
 #define LOG_TAG "IRHandler"
@@ -29,21 +30,7 @@ bool MelonDSAndroidIRHandler::openSerial()
         return false;
     }
 
-    jclass irManagerClass = env->GetObjectClass(irManager);
-    if (!irManagerClass) {
-        LOGE("openSerial: Failed to get IRManager class");
-        return false;
-    }
-
-    jmethodID openMethod = env->GetMethodID(irManagerClass, "openSerial", "()Z");
-    if (!openMethod) {
-        LOGE("openSerial: Failed to get openSerial method");
-        env->DeleteLocalRef(irManagerClass);
-        return false;
-    }
-
-    jboolean result = env->CallBooleanMethod(irManager, openMethod);
-    env->DeleteLocalRef(irManagerClass);
+    jboolean result = env->CallBooleanMethod(irManager, JniRegistry::irManager.openSerial);
 
     LOGD("openSerial() = %d", result);
     return result;
@@ -58,17 +45,7 @@ void MelonDSAndroidIRHandler::closeSerial()
     JNIEnv* env = jniEnvHandler->getCurrentThreadEnv();
     if (!env) return;
 
-    jclass irManagerClass = env->GetObjectClass(irManager);
-    if (!irManagerClass) return;
-
-    jmethodID closeMethod = env->GetMethodID(irManagerClass, "closeSerial", "()V");
-    if (!closeMethod) {
-        env->DeleteLocalRef(irManagerClass);
-        return;
-    }
-
-    env->CallVoidMethod(irManager, closeMethod);
-    env->DeleteLocalRef(irManagerClass);
+    env->CallVoidMethod(irManager, JniRegistry::irManager.closeSerial);
 
     LOGD("closeSerial() called");
 }
@@ -90,22 +67,8 @@ int MelonDSAndroidIRHandler::writeSerial(const char* data, int length)
 
     env->SetByteArrayRegion(javaData, 0, length, (const jbyte*) data);
 
-    jclass irManagerClass = env->GetObjectClass(irManager);
-    if (!irManagerClass) {
-        env->DeleteLocalRef(javaData);
-        return -1;
-    }
-
-    jmethodID writeMethod = env->GetMethodID(irManagerClass, "writeSerial", "([BI)I");
-    if (!writeMethod) {
-        env->DeleteLocalRef(irManagerClass);
-        env->DeleteLocalRef(javaData);
-        return -1;
-    }
+    jint result = env->CallIntMethod(irManager, JniRegistry::irManager.writeSerial, javaData, length);
 
-    jint result = env->CallIntMethod(irManager, writeMethod, javaData, length);
-
-    env->DeleteLocalRef(irManagerClass);
     env->DeleteLocalRef(javaData);
 
     return result;
@@ -126,26 +89,12 @@ int MelonDSAndroidIRHandler::readSerial(char* buffer, int maxLength)
         return 0;
     }
 
-    jclass irManagerClass = env->GetObjectClass(irManager);
-    if (!irManagerClass) {
-        env->DeleteLocalRef(javaBuffer);
-        return 0;
-    }
-
-    jmethodID readMethod = env->GetMethodID(irManagerClass, "readSerial", "([BI)I");
-    if (!readMethod) {
-        env->DeleteLocalRef(irManagerClass);
-        env->DeleteLocalRef(javaBuffer);
-        return 0;
-    }
-
-    jint bytesRead = env->CallIntMethod(irManager, readMethod, javaBuffer, maxLength);
+    jint bytesRead = env->CallIntMethod(irManager, JniRegistry::irManager.readSerial, javaBuffer, maxLength);
 
     if (bytesRead > 0) {
         env->GetByteArrayRegion(javaBuffer, 0, bytesRead, (jbyte*) buffer);
     }
 
-    env->DeleteLocalRef(irManagerClass);
     env->DeleteLocalRef(javaBuffer);
 
     return bytesRead;
@@ -161,26 +110,12 @@ int MelonDSAndroidIRHandler::readSerialBlocking(char* buffer, int maxLength, lon
     jbyteArray javaBuffer = env->NewByteArray(maxLength);
     if (javaBuffer == nullptr) return 0;
 
-    jclass irManagerClass = env->GetObjectClass(irManager);
-    if (!irManagerClass) {
-        env->DeleteLocalRef(javaBuffer);
-        return 0;
-    }
-
-    jmethodID readMethod = env->GetMethodID(irManagerClass, "readSerialBlocking", "([BIJ)I");
-    if (!readMethod) {
-        env->DeleteLocalRef(irManagerClass);
-        env->DeleteLocalRef(javaBuffer);
-        return 0;
-    }
-
-    jint bytesRead = env->CallIntMethod(irManager, readMethod, javaBuffer, maxLength, (jlong) timeoutMs);
+    jint bytesRead = env->CallIntMethod(irManager, JniRegistry::irManager.readSerialBlocking, javaBuffer, maxLength, (jlong) timeoutMs);
 
     if (bytesRead > 0) {
         env->GetByteArrayRegion(javaBuffer, 0, bytesRead, (jbyte*) buffer);
     }
 
-    env->DeleteLocalRef(irManagerClass);
     env->DeleteLocalRef(javaBuffer);
 
     return bytesRead;
@@ -195,19 +130,7 @@ bool MelonDSAndroidIRHandler::isSerialOpen()
     JNIEnv* env = jniEnvHandler->getCurrentThreadEnv();
     if (!env) return false;
 
-    jclass irManagerClass = env->GetObjectClass(irManager);
-    if (!irManagerClass) return false;
-
-    jmethodID isOpenMethod = env->GetMethodID(irManagerClass, "isSerialOpen", "()Z");
-    if (!isOpenMethod) {
-        env->DeleteLocalRef(irManagerClass);
-        return false;
-    }
-
-    jboolean result = env->CallBooleanMethod(irManager, isOpenMethod);
-    env->DeleteLocalRef(irManagerClass);
-
-    return result;
+    return env->CallBooleanMethod(irManager, JniRegistry::irManager.isSerialOpen);
 }
 
 bool MelonDSAndroidIRHandler::openTCP()
@@ -223,21 +146,7 @@ bool MelonDSAndroidIRHandler::openTCP()
         return false;
     }
 
-    jclass irManagerClass = env->GetObjectClass(irManager);
-    if (!irManagerClass) {
-        LOGE("openTCP: Failed to get IRManager class");
-        return false;
-    }
-
-    jmethodID openMethod = env->GetMethodID(irManagerClass, "openTCP", "()Z");
-    if (!openMethod) {
-        LOGE("openTCP: Failed to get openTCP method");
-        env->DeleteLocalRef(irManagerClass);
-        return false;
-    }
-
-    jboolean result = env->CallBooleanMethod(irManager, openMethod);
-    env->DeleteLocalRef(irManagerClass);
+    jboolean result = env->CallBooleanMethod(irManager, JniRegistry::irManager.openTCP);
 
     LOGD("openTCP() = %d", result);
     return result;
@@ -252,17 +161,7 @@ void MelonDSAndroidIRHandler::closeTCP()
     JNIEnv* env = jniEnvHandler->getCurrentThreadEnv();
     if (!env) return;
 
-    jclass irManagerClass = env->GetObjectClass(irManager);
-    if (!irManagerClass) return;
-
-    jmethodID closeMethod = env->GetMethodID(irManagerClass, "closeTCP", "()V");
-    if (!closeMethod) {
-        env->DeleteLocalRef(irManagerClass);
-        return;
-    }
-
-    env->CallVoidMethod(irManager, closeMethod);
-    env->DeleteLocalRef(irManagerClass);
+    env->CallVoidMethod(irManager, JniRegistry::irManager.closeTCP);
 
     LOGD("closeTCP() called");
     return;
@@ -285,22 +184,8 @@ int MelonDSAndroidIRHandler::writeTCP(const char* data, int length)
 
     env->SetByteArrayRegion(javaData, 0, length, (const jbyte*) data);
 
-    jclass irManagerClass = env->GetObjectClass(irManager);
-    if (!irManagerClass) {
-        env->DeleteLocalRef(javaData);
-        return -1;
-    }
-
-    jmethodID writeMethod = env->GetMethodID(irManagerClass, "writeTCP", "([BI)I");
-    if (!writeMethod) {
-        env->DeleteLocalRef(irManagerClass);
-        env->DeleteLocalRef(javaData);
-        return -1;
-    }
+    jint result = env->CallIntMethod(irManager, JniRegistry::irManager.writeTCP, javaData, length);
 
-    jint result = env->CallIntMethod(irManager, writeMethod, javaData, length);
-
-    env->DeleteLocalRef(irManagerClass);
     env->DeleteLocalRef(javaData);
 
     return result;
@@ -321,26 +206,12 @@ int MelonDSAndroidIRHandler::readTCP(char* buffer, int maxLength)
         return 0;
     }
 
-    jclass irManagerClass = env->GetObjectClass(irManager);
-    if (!irManagerClass) {
-        env->DeleteLocalRef(javaBuffer);
-        return 0;
-    }
-
-    jmethodID readMethod = env->GetMethodID(irManagerClass, "readTCP", "([BI)I");
-    if (!readMethod) {
-        env->DeleteLocalRef(irManagerClass);
-        env->DeleteLocalRef(javaBuffer);
-        return 0;
-    }
-
-    jint bytesRead = env->CallIntMethod(irManager, readMethod, javaBuffer, maxLength);
+    jint bytesRead = env->CallIntMethod(irManager, JniRegistry::irManager.readTCP, javaBuffer, maxLength);
 
     if (bytesRead > 0) {
         env->GetByteArrayRegion(javaBuffer, 0, bytesRead, (jbyte*) buffer);
     }
 
-    env->DeleteLocalRef(irManagerClass);
     env->DeleteLocalRef(javaBuffer);
 
     return bytesRead;
@@ -355,19 +226,7 @@ bool MelonDSAndroidIRHandler::isTCPOpen()
     JNIEnv* env = jniEnvHandler->getCurrentThreadEnv();
     if (!env) return false;
 
-    jclass irManagerClass = env->GetObjectClass(irManager);
-    if (!irManagerClass) return false;
-
-    jmethodID isOpenMethod = env->GetMethodID(irManagerClass, "isTCPOpen", "()Z");
-    if (!isOpenMethod) {
-        env->DeleteLocalRef(irManagerClass);
-        return false;
-    }
-
-    jboolean result = env->CallBooleanMethod(irManager, isOpenMethod);
-    env->DeleteLocalRef(irManagerClass);
-
-    return result;
+    return env->CallBooleanMethod(irManager, JniRegistry::irManager.isTCPOpen);
 }
 
 bool MelonDSAndroidIRHandler::hasDataAvailable()
@@ -379,19 +238,7 @@ bool MelonDSAndroidIRHandler::hasDataAvailable()
     JNIEnv* env = jniEnvHandler->getCurrentThreadEnv();
     if (!env) return false;
 
-    jclass irManagerClass = env->GetObjectClass(irManager);
-    if (!irManagerClass) return false;
-
-    jmethodID hasDataMethod = env->GetMethodID(irManagerClass, "hasDataAvailable", "()Z");
-    if (!hasDataMethod) {
-        env->DeleteLocalRef(irManagerClass);
-        return false;
-    }
-
-    jboolean result = env->CallBooleanMethod(irManager, hasDataMethod);
-    env->DeleteLocalRef(irManagerClass);
-
-    return result;
+    return env->CallBooleanMethod(irManager, JniRegistry::irManager.hasDataAvailable);
 }
 
 MelonDSAndroidIRHandler::~MelonDSAndroidIRHandler()
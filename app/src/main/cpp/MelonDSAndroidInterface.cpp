@@ -1,9 +1,21 @@
 #include "JniEnvHandler.h"
+#include "JniRegistry.h"
 #include "UriFileHandler.h"
+#include "MemoryFileStore.h"
+#include "cheats/MemoryWatch.h"
+#include "savestate/SaveStateCache.h"
+#include "savestate/SaveStateChunkStore.h"
 #include "MelonDS.h"
 #include "OpenGLContext.h"
 
 JniEnvHandler* jniEnvHandler;
+MemoryFileStore* memoryFileStore;
+SaveStateCache* saveStateCache;
+SaveStateChunkStore* saveStateChunkStore;
+MemoryWatch* memoryWatch;
+
+// Enough to keep a few of the most recently used states of a DSi session, which are bigger than those of a DS session
+static const size_t SAVE_STATE_CACHE_SIZE = 64 * 1024 * 1024;
 
 JavaVM* vm;
 jobject androidUriFileHandler;
@@ -11,13 +23,31 @@ UriFileHandler* fileHandler;
 
 extern "C"
 {
+JNIEXPORT jint JNICALL
+JNI_OnLoad(JavaVM* javaVm, void* reserved)
+{
+    JNIEnv* env;
+    if (javaVm->GetEnv((void**) &env, JNI_VERSION_1_6) != JNI_OK)
+        return JNI_ERR;
+
+    // Fail loading the library if the Java classes don't match, instead of crashing later in the middle of a session
+    if (!JniRegistry::initialize(env))
+        return JNI_ERR;
+
+    return JNI_VERSION_1_6;
+}
+
 JNIEXPORT void JNICALL
 Java_me_magnum_melonds_MelonDSAndroidInterface_setup(JNIEnv* env, jobject thiz, jobject uriFileHandler)
 {
     env->GetJavaVM(&vm);
     jniEnvHandler = new JniEnvHandler(vm);
     androidUriFileHandler = env->NewGlobalRef(uriFileHandler);
-    fileHandler = new UriFileHandler(jniEnvHandler, androidUriFileHandler);
+    memoryFileStore = new MemoryFileStore();
+    saveStateCache = new SaveStateCache(SAVE_STATE_CACHE_SIZE);
+    saveStateChunkStore = new SaveStateChunkStore();
+    memoryWatch = new MemoryWatch();
+    fileHandler = new UriFileHandler(jniEnvHandler, androidUriFileHandler, memoryFileStore);
 
     auto* openGlContext = new OpenGLContext();
     openGlContext->InitContext(0);
@@ -32,6 +62,49 @@ Java_me_magnum_melonds_MelonDSAndroidInterface_getEmulatorGlContext(JNIEnv* env,
     return (jlong) MelonDSAndroid::openGlContext->GetContext();
 }
 
+JNIEXPORT void JNICALL
+Java_me_magnum_melonds_MelonDSAndroidInterface_trimMemory(JNIEnv* env, jobject thiz, jboolean releaseAll)
+{
+    if (releaseAll)
+        saveStateCache->trimToSize(0);
+    else
+        saveStateCache->trimToSize(saveStateCache->getMaxSize() / 2);
+
+    fileHandler->clearDescriptorCache();
+    if (releaseAll)
+        fileHandler->getBiosFileCache().clear();
+}
+
+JNIEXPORT void JNICALL
+Java_me_magnum_melonds_MelonDSAndroidInterface_setSramWriteBackOptions(JNIEnv* env, jobject thiz, jint coalescingWindowMs, jstring journalDirectory)
+{
+    std::string journalDirectoryPath;
+    if (journalDirectory)
+    {
+        const char* path = env->GetStringUTFChars(journalDirectory, nullptr);
+        journalDirectoryPath = path;
+        env->ReleaseStringUTFChars(journalDirectory, path);
+    }
+
+    fileHandler->getSramWriteBack().setOptions(std::chrono::milliseconds(coalescingWindowMs), journalDirectoryPath);
+}
+
+JNIEXPORT jlongArray JNICALL
+Java_me_magnum_melonds_MelonDSAndroidInterface_getFileAccessStatsInternal(JNIEnv* env, jobject thiz)
+{
+    const FileAccessStats& stats = fileHandler->getStats();
+    jlong values[] = {
+        (jlong) stats.openCount.load(),
+        (jlong) stats.cachedOpenCount.load(),
+        (jlong) (stats.openTimeNs.load() / 1000),
+        (jlong) stats.bytesRead.load(),
+    };
+
+    jlongArray result = env->NewLongArray(4);
+    env->SetLongArrayRegion(result, 0, 4, values);
+    return result;
+}
+
 JNIEXPORT void JNICALL
 Java_me_magnum_melonds_MelonDSAndroidInterface_cleanup(JNIEnv* env, jobject thiz)
 {
@@ -43,6 +116,10 @@ Java_me_magnum_melonds_MelonDSAndroidInterface_cleanup(JNIEnv* env, jobject thiz
 
     delete MelonDSAndroid::openGlContext;
     delete fileHandler;
+    delete memoryWatch;
+    delete saveStateChunkStore;
+    delete saveStateCache;
+    delete memoryFileStore;
     delete jniEnvHandler;
 
     MelonDSAndroid::openGlContext = nullptr;
@@ -2,7 +2,17 @@
 #define MELONDSANDROIDINTERFACE_H
 
 #include "JniEnvHandler.h"
+#include "MemoryFileStore.h"
+#include "UriFileHandler.h"
+#include "cheats/MemoryWatch.h"
+#include "savestate/SaveStateCache.h"
+#include "savestate/SaveStateChunkStore.h"
 
 extern JniEnvHandler* jniEnvHandler;
+extern MemoryFileStore* memoryFileStore;
+extern SaveStateCache* saveStateCache;
+extern SaveStateChunkStore* saveStateChunkStore;
+extern MemoryWatch* memoryWatch;
+extern UriFileHandler* fileHandler;
 
 #endif //MELONDSANDROIDINTERFACE_H
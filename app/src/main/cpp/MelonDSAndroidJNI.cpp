@@ -15,14 +15,23 @@
 #include <IR.h>
 #include "UriFileHandler.h"
 #include "JniEnvHandler.h"
+#include "JniRegistry.h"
 #include "AndroidMelonEventMessenger.h"
 #include "MelonDSAndroidInterface.h"
 #include "MelonDSAndroidConfiguration.h"
 #include "MelonDSAndroidCameraHandler.h"
 #include "RetroAchievementsMapper.h"
+#include "RichPresenceMonitor.h"
+#include "RuntimeAchievementTable.h"
 #include "performancehint/ThreadSafePerformanceHintSession.h"
 #include "performancehint/PerformanceHintManagerFactory.h"
 #include "MelonDSAndroidIRHandler.h"
+#include "FrameBoundaryTaskQueue.h"
+#include "cheats/CheatCodeParser.h"
+#include "cheats/CheatEngine.h"
+#include "cheats/CheatRegistry.h"
+#include "savestate/SaveStateReader.h"
+#include "savestate/SaveStateWriter.h"
 
 #include "Platform.h"
 
@@ -34,6 +43,7 @@ enum GbaSlotType {
 };
 
 void* emulate(void*);
+void releaseCore(JNIEnv* env);
 MelonDSAndroid::RomGbaSlotConfig* buildGbaSlotConfig(GbaSlotType slotType, const char* romPath, const char* savePath);
 
 pthread_t emuThread;
@@ -56,17 +66,66 @@ jobject globalIRManager;
 MelonDSAndroidCameraHandler* androidCameraHandler;
 MelonDSAndroidIRHandler* androidIRHandler;
 
+FrameBoundaryTaskQueue frameBoundaryTaskQueue;
+std::atomic<u64> emulatedFrameCount = 0;
+std::unique_ptr<SaveStateWriter> saveStateWriter;
+std::unique_ptr<SaveStateReader> saveStateReader;
+CheatEngine cheatEngine;
+CheatRegistry cheatRegistry(&cheatEngine);
+RuntimeAchievementTable runtimeAchievementTable;
+RichPresenceMonitor richPresenceMonitor;
+
 static const int64_t FRAME_DURATION_60FPS_NS = 16666666;
 static const int64_t FRAME_DURATION_1000FPS_NS = 1000000; // 1ms. Used as frame time when fast-forward is enabled
 ThreadSafePerformanceHintSession* performanceHintSession = nullptr;
 
+// Set when the core is kept set up after the emulation is stopped, so that the next session can skip setting it up again (which
+// creates the renderer and compiles its shaders, and allocates the JIT code cache). Only true while the core is stopped: it's cleared
+// as soon as the next session takes the core over, so that releasing the warm core never tears down a core that is in use
+bool isCoreWarm = false;
+MelonDSAndroidConfiguration::CoreSetupKey warmCoreSetupKey;
+u32* warmCoreScreenshotBuffer = nullptr;
+
+// Configuration that was last handed to the core, which configuration updates are compared with to find what changed
+MelonDSAndroidConfiguration::CoreSetupKey currentCoreSetupKey;
+MelonDSAndroidConfiguration::LiveSettings currentLiveSettings;
+
 extern "C"
 {
-JNIEXPORT void JNICALL
+JNIEXPORT jboolean JNICALL
 Java_me_magnum_melonds_MelonEmulator_setupEmulator(JNIEnv* env, jobject thiz, jobject emulatorConfiguration, jobject cameraManager, jobject irManager, jobject screenshotBuffer)
 {
     MelonDSAndroid::EmulatorConfiguration finalEmulatorConfiguration = MelonDSAndroidConfiguration::buildEmulatorConfiguration(env, emulatorConfiguration);
     fastForwardSpeedMultiplier = finalEmulatorConfiguration.fastForwardSpeedMultiplier;
+    fileHandler->getBiosFileCache().setCachedFiles(MelonDSAndroidConfiguration::getBiosAndFirmwarePaths(finalEmulatorConfiguration));
+
+    MelonDSAndroidConfiguration::CoreSetupKey coreSetupKey = MelonDSAndroidConfiguration::getCoreSetupKey(finalEmulatorConfiguration);
+    currentCoreSetupKey = coreSetupKey;
+    currentLiveSettings = MelonDSAndroidConfiguration::getLiveSettings(finalEmulatorConfiguration);
+    u32* screenshotBufferPointer = (u32*) env->GetDirectBufferAddress(screenshotBuffer);
+
+    // Replacing the writer waits for the states of the previous session to be written
+    saveStateWriter = std::make_unique<SaveStateWriter>(memoryFileStore, saveStateCache, saveStateChunkStore, screenshotBufferPointer, emulatedFrameCount);
+    saveStateReader = std::make_unique<SaveStateReader>(memoryFileStore, saveStateCache, saveStateChunkStore, emulatedFrameCount);
+    paused = false;
+
+    if (isCoreWarm)
+    {
+        isCoreWarm = false;
+        bool canReuseCore = coreSetupKey == warmCoreSetupKey
+                && screenshotBufferPointer == warmCoreScreenshotBuffer
+                && env->IsSameObject(cameraManager, globalCameraManager)
+                && env->IsSameObject(irManager, globalIRManager);
+
+        if (canReuseCore)
+        {
+            // Loading the ROM resets the machine, so only the settings that can change at runtime have to be applied
+            MelonDSAndroid::updateEmulatorConfiguration(std::make_unique<MelonDSAndroid::EmulatorConfiguration>(std::move(finalEmulatorConfiguration)));
+            return JNI_TRUE;
+        }
+
+        releaseCore(env);
+    }
 
     globalCameraManager = env->NewGlobalRef(cameraManager);
     globalIRManager = env->NewGlobalRef(irManager);
@@ -74,90 +133,65 @@ Java_me_magnum_melonds_MelonEmulator_setupEmulator(JNIEnv* env, jobject thiz, jo
     auto androidEventMessenger = std::make_shared<AndroidMelonEventMessenger>();
     androidCameraHandler = new MelonDSAndroidCameraHandler(jniEnvHandler, globalCameraManager);
     androidIRHandler = new MelonDSAndroidIRHandler(jniEnvHandler, globalIRManager);
-    u32* screenshotBufferPointer = (u32*) env->GetDirectBufferAddress(screenshotBuffer);
 
     MelonDSAndroid::setConfiguration(std::move(finalEmulatorConfiguration));
     MelonDSAndroid::setup(androidCameraHandler, androidIRHandler, std::move(androidEventMessenger), screenshotBufferPointer, 0);
-    paused = false;
+    warmCoreSetupKey = std::move(coreSetupKey);
+    warmCoreScreenshotBuffer = screenshotBufferPointer;
+    return JNI_FALSE;
 }
 
-JNIEXPORT void JNICALL
-Java_me_magnum_melonds_MelonEmulator_setupCheats(JNIEnv* env, jobject thiz, jobjectArray cheats)
+JNIEXPORT jintArray JNICALL
+Java_me_magnum_melonds_MelonEmulator_setupCheatsInternal(JNIEnv* env, jobject thiz, jobjectArray cheats, jlongArray cheatIds)
 {
     jsize cheatCount = env->GetArrayLength(cheats);
+    std::vector<CheatCodeParser::ParseResult> results;
+    results.reserve(cheatCount);
+
+    cheatRegistry.clear();
     if (cheatCount < 1) {
-        MelonDSAndroid::setCodeList(std::list<MelonDSAndroid::Cheat>());
-        return;
+        return CheatCodeParser::buildResultArray(env, results);
     }
 
-    jclass cheatClass = env->GetObjectClass(env->GetObjectArrayElement(cheats, 0));
-    jfieldID codeField = env->GetFieldID(cheatClass, "code", "Ljava/lang/String;");
-
-    std::list<MelonDSAndroid::Cheat> internalCheats;
+    std::vector<jlong> ids(cheatCount);
+    env->GetLongArrayRegion(cheatIds, 0, cheatCount, ids.data());
 
     for (int i = 0; i < cheatCount; ++i) {
         jobject cheat = env->GetObjectArrayElement(cheats, i);
-        jstring code = (jstring) env->GetObjectField(cheat, codeField);
-        const char* codeStringPtr = env->GetStringUTFChars(code, JNI_FALSE);
-        std::string codeString = codeStringPtr;
-        // Since each part of a cheat code has 8 characters (4 bytes), we can add 1 to the length (to ensure that each part has a matching space separator) and divide by 9
-        // (part length + space separator) to calculate the total number of parts in the cheat
-        size_t codeLength = (codeString.size() + 1) / 9;
-
-        bool isBad = false;
-        std::size_t start = 0;
-        std::size_t end = 0;
-
-        MelonDSAndroid::Cheat internalCheat;
-        internalCheat.code.reserve(codeLength);
-
-        // Split code string into sections separated by a space
-        while ((end = codeString.find(' ', start)) != std::string::npos) {
-            if (end != start) {
-                char* endPointer;
-                std::string sectionString = codeString.substr(start, end - start);
-                // Each code section must be 4 bytes (8 hex characters)
-                if (sectionString.size() != 8) {
-                    isBad = true;
-                    break;
-                }
+        jstring code = (jstring) env->GetObjectField(cheat, JniRegistry::cheat.code);
 
-                unsigned long section = strtoul(sectionString.c_str(), &endPointer, 16);
-                if (*endPointer == 0) {
-                    internalCheat.code.push_back((u32) section);
-                } else {
-                    isBad = true;
-                    break;
-                }
-            }
-            start = end + 1;
-        }
+        results.push_back(cheatRegistry.addCheat(ids[i], env, code, true));
 
-        if (!isBad && end != start) {
-            char* endPointer;
-            std::string sectionString = codeString.substr(start, end - start);
-            if (sectionString.size() != 8) {
-                isBad = true;
-            } else {
-                unsigned long section = strtoul(sectionString.c_str(), &endPointer, 16);
-                internalCheat.code.push_back((u32) section);
-            }
-        }
+        // Local references would otherwise pile up with big cheat lists
+        env->DeleteLocalRef(code);
+        env->DeleteLocalRef(cheat);
+    }
 
-        env->ReleaseStringUTFChars(code, codeStringPtr);
+    return CheatCodeParser::buildResultArray(env, results);
+}
 
-        if (isBad) {
-            continue;
-        }
+JNIEXPORT jintArray JNICALL
+Java_me_magnum_melonds_MelonEmulator_addCheatInternal(JNIEnv* env, jobject thiz, jlong id, jstring code, jboolean enabled)
+{
+    std::vector<CheatCodeParser::ParseResult> results;
+    results.push_back(cheatRegistry.addCheat(id, env, code, enabled == JNI_TRUE));
+    return CheatCodeParser::buildResultArray(env, results);
+}
 
-        internalCheats.push_back(internalCheat);
-    }
+JNIEXPORT void JNICALL
+Java_me_magnum_melonds_MelonEmulator_removeCheat(JNIEnv* env, jobject thiz, jlong id)
+{
+    cheatRegistry.removeCheat(id);
+}
 
-    MelonDSAndroid::setCodeList(internalCheats);
+JNIEXPORT void JNICALL
+Java_me_magnum_melonds_MelonEmulator_setCheatEnabled(JNIEnv* env, jobject thiz, jlong id, jboolean enabled)
+{
+    cheatRegistry.setCheatEnabled(id, enabled == JNI_TRUE);
 }
 
 JNIEXPORT void JNICALL
-Java_me_magnum_melonds_MelonEmulator_setupAchievements(JNIEnv* env, jobject thiz, jobjectArray achievements, jobjectArray leaderboards, jstring richPresenceScript)
+Java_me_magnum_melonds_MelonEmulator_setupAchievements(JNIEnv* env, jobject thiz, jobjectArray achievements, jobjectArray leaderboards, jstring richPresenceScript, jint richPresenceUpdateIntervalFrames)
 {
     std::list<MelonDSAndroid::RetroAchievements::RAAchievement> internalAchievements;
     std::list<MelonDSAndroid::RetroAchievements::RALeaderboard> internalLeaderboards;
@@ -177,42 +211,36 @@ Java_me_magnum_melonds_MelonEmulator_setupAchievements(JNIEnv* env, jobject thiz
     }
 
     MelonDSAndroid::setupAchievements(internalAchievements, internalLeaderboards, richPresence);
+    richPresenceMonitor.setUpdateInterval(richPresence ? (u32) richPresenceUpdateIntervalFrames : 0);
 }
 
 JNIEXPORT void JNICALL
 Java_me_magnum_melonds_MelonEmulator_unloadRetroAchievementsData(JNIEnv* env, jobject thiz)
 {
+    richPresenceMonitor.setUpdateInterval(0);
     MelonDSAndroid::unloadRetroAchievementsData();
 }
 
-JNIEXPORT jstring JNICALL
-Java_me_magnum_melonds_MelonEmulator_getRichPresenceStatus(JNIEnv* env, jobject thiz)
-{
-    std::string richPresenceString = MelonDSAndroid::getRichPresenceStatus();
-    if (richPresenceString.empty())
-        return nullptr;
-    else
-        return env->NewStringUTF(richPresenceString.c_str());
-}
-
-JNIEXPORT jobjectArray JNICALL
-Java_me_magnum_melonds_MelonEmulator_getRuntimeAchievements(JNIEnv* env, jobject thiz)
+JNIEXPORT jboolean JNICALL
+Java_me_magnum_melonds_MelonEmulator_updateRuntimeAchievementTable(JNIEnv* env, jobject thiz)
 {
-    jclass simpleRuntimeAchievementClass = env->FindClass("me/magnum/melonds/domain/model/retroachievements/RASimpleRuntimeAchievement");
-    jmethodID simpleRuntimeAchievementConstructor = env->GetMethodID(simpleRuntimeAchievementClass, "<init>", "(JII)V");
-
     auto runtimeAchievements = MelonDSAndroid::getRuntimeAchievements();
 
-    jobjectArray achievements = env->NewObjectArray(runtimeAchievements.size(), simpleRuntimeAchievementClass, nullptr);
+    bool reallocated = runtimeAchievementTable.beginUpdate(runtimeAchievements.size());
 
-    int index = 0;
+    size_t index = 0;
     for (const auto &item: runtimeAchievements)
     {
-        jobject simpleRuntimeAchievement = env->NewObject(simpleRuntimeAchievementClass, simpleRuntimeAchievementConstructor, item.id, (jint) item.value, (jint) item.target);
-        env->SetObjectArrayElement(achievements, index++, simpleRuntimeAchievement);
+        runtimeAchievementTable.setRow(index++, item.id, (s32) item.value, (s32) item.target);
     }
 
-    return achievements;
+    return reallocated;
+}
+
+JNIEXPORT jobject JNICALL
+Java_me_magnum_melonds_MelonEmulator_getRuntimeAchievementTable(JNIEnv* env, jobject thiz)
+{
+    return env->NewDirectByteBuffer(runtimeAchievementTable.getMemory(), (jlong) runtimeAchievementTable.getMemorySize());
 }
 
 JNIEXPORT jint JNICALL
@@ -224,6 +252,12 @@ Java_me_magnum_melonds_MelonEmulator_loadRomInternal(JNIEnv* env, jobject thiz,
     const char* gbaRom = gbaRomPath == nullptr ? nullptr : env->GetStringUTFChars(gbaRomPath, &isCopy);
     const char* gbaSram = gbaSramPath == nullptr ? nullptr : env->GetStringUTFChars(gbaSramPath, &isCopy);
 
+    // Writes to the save file are captured from the start, so that the core never writes it synchronously
+    if (sram)
+        fileHandler->getSramWriteBack().attach(sram);
+    else
+        fileHandler->getSramWriteBack().detach();
+
     MelonDSAndroid::RomGbaSlotConfig* gbaSlotConfig = buildGbaSlotConfig((GbaSlotType) gbaSlotType, gbaRom, gbaSram);
     int result = MelonDSAndroid::loadRom(rom, sram, gbaSlotConfig);
     delete gbaSlotConfig;
@@ -240,6 +274,7 @@ Java_me_magnum_melonds_MelonEmulator_loadRomInternal(JNIEnv* env, jobject thiz,
 
 JNIEXPORT jint JNICALL
 Java_me_magnum_melonds_MelonEmulator_bootFirmwareInternal(JNIEnv* env, jobject thiz) {
+    fileHandler->getSramWriteBack().detach();
     return MelonDSAndroid::bootFirmware();
 }
 
@@ -263,9 +298,6 @@ Java_me_magnum_melonds_MelonEmulator_startEmulation(JNIEnv* env, jobject thiz)
 JNIEXPORT void JNICALL
 Java_me_magnum_melonds_MelonEmulator_presentFrame(JNIEnv* env, jobject thiz, jlong deadlineNs, jobject renderFrameCallback)
 {
-    jclass presentFrameWrapperClass = env->GetObjectClass(renderFrameCallback);
-    jmethodID renderFrameMethodId = env->GetMethodID(presentFrameWrapperClass, "renderFrame", "(ZI)V");
-
     std::optional<std::chrono::time_point<std::chrono::steady_clock>> deadlineTime;
     if (deadlineNs > 0)
     {
@@ -289,13 +321,13 @@ Java_me_magnum_melonds_MelonEmulator_presentFrame(JNIEnv* env, jobject thiz, jlo
     if (presentationFrame != nullptr)
     {
         eglWaitSyncKHR(currentDisplay, presentationFrame->renderFence, 0);
-        env->CallVoidMethod(renderFrameCallback, renderFrameMethodId, true, (jint) presentationFrame->frameTexture);
+        env->CallVoidMethod(renderFrameCallback, JniRegistry::frameRenderCallback.renderFrame, true, (jint) presentationFrame->frameTexture);
         EGLSyncKHR presentFence = eglCreateSyncKHR(currentDisplay, EGL_SYNC_FENCE_KHR, nullptr);
         presentationFrame->presentFence = presentFence;
     }
     else
     {
-        env->CallVoidMethod(renderFrameCallback, renderFrameMethodId, false, 0);
+        env->CallVoidMethod(renderFrameCallback, JniRegistry::frameRenderCallback.renderFrame, false, 0);
     }
 }
 
@@ -305,6 +337,12 @@ Java_me_magnum_melonds_MelonEmulator_getFPS(JNIEnv* env, jobject thiz)
     return fps;
 }
 
+JNIEXPORT jfloat JNICALL
+Java_me_magnum_melonds_MelonEmulator_getCheatEngineFrameTime(JNIEnv* env, jobject thiz)
+{
+    return cheatEngine.getAverageFrameTime();
+}
+
 JNIEXPORT void JNICALL
 Java_me_magnum_melonds_MelonEmulator_pauseEmulation(JNIEnv* env, jobject thiz)
 {
@@ -321,6 +359,8 @@ Java_me_magnum_melonds_MelonEmulator_pauseEmulation(JNIEnv* env, jobject thiz)
     }
 
     MelonDSAndroid::pause();
+    // The app may not come back from the background, so save changes shouldn't wait for the coalescing window
+    fileHandler->getSramWriteBack().flush(false);
 }
 
 JNIEXPORT void JNICALL
@@ -358,6 +398,7 @@ Java_me_magnum_melonds_MelonEmulator_resetEmulation(JNIEnv* env, jobject thiz) {
         // Make sure that the thread is really paused to avoid data corruption
         while (!isThreadReallyPaused);
         MelonDSAndroid::reset();
+        emulatedFrameCount = 0;
         Java_me_magnum_melonds_MelonEmulator_resumeEmulation(env, thiz);
     } else {
         // If the emulation is stopping, just ignore it
@@ -366,17 +407,40 @@ Java_me_magnum_melonds_MelonEmulator_resetEmulation(JNIEnv* env, jobject thiz) {
 }
 
 JNIEXPORT jboolean JNICALL
-Java_me_magnum_melonds_MelonEmulator_saveStateInternal(JNIEnv* env, jobject thiz, jstring path)
+Java_me_magnum_melonds_MelonEmulator_saveStateInternal(JNIEnv* env, jobject thiz, jstring path, jstring chunkStorePath, jint requestId, jstring romHash, jstring emulatorVersion)
 {
-    const char* saveStatePath = path == nullptr ? nullptr : env->GetStringUTFChars(path, JNI_FALSE);
-    return MelonDSAndroid::saveState(saveStatePath);
+    const char* saveStatePath = env->GetStringUTFChars(path, nullptr);
+    const char* chunkStorePathString = env->GetStringUTFChars(chunkStorePath, nullptr);
+    const char* romHashString = env->GetStringUTFChars(romHash, nullptr);
+    const char* emulatorVersionString = env->GetStringUTFChars(emulatorVersion, nullptr);
+
+    std::string saveStatePathString = saveStatePath;
+    std::string saveStateChunkStorePath = chunkStorePathString;
+    SaveStateFormat::SaveStateMetadata metadata {
+        .romHash = romHashString,
+        .emulatorVersion = emulatorVersionString,
+    };
+
+    env->ReleaseStringUTFChars(path, saveStatePath);
+    env->ReleaseStringUTFChars(chunkStorePath, chunkStorePathString);
+    env->ReleaseStringUTFChars(romHash, romHashString);
+    env->ReleaseStringUTFChars(emulatorVersion, emulatorVersionString);
+
+    return saveStateWriter->saveState(saveStatePathString, saveStateChunkStorePath, requestId, metadata);
 }
 
 JNIEXPORT jboolean JNICALL
-Java_me_magnum_melonds_MelonEmulator_loadStateInternal(JNIEnv* env, jobject thiz, jstring path)
+Java_me_magnum_melonds_MelonEmulator_loadStateInternal(JNIEnv* env, jobject thiz, jstring path, jstring chunkStorePath, jstring romHash)
 {
-    const char* saveStatePath = path == nullptr ? nullptr : env->GetStringUTFChars(path, JNI_FALSE);
-    return MelonDSAndroid::loadState(saveStatePath);
+    const char* saveStatePath = env->GetStringUTFChars(path, nullptr);
+    const char* chunkStorePathString = env->GetStringUTFChars(chunkStorePath, nullptr);
+    const char* romHashString = env->GetStringUTFChars(romHash, nullptr);
+    bool result = saveStateReader->loadState(saveStatePath, chunkStorePathString, romHashString);
+    env->ReleaseStringUTFChars(path, saveStatePath);
+    env->ReleaseStringUTFChars(chunkStorePath, chunkStorePathString);
+    env->ReleaseStringUTFChars(romHash, romHashString);
+
+    return result;
 }
 
 JNIEXPORT jboolean JNICALL
@@ -393,15 +457,10 @@ Java_me_magnum_melonds_MelonEmulator_loadRewindState(JNIEnv* env, jobject thiz,
             Java_me_magnum_melonds_MelonEmulator_pauseEmulation(env, thiz);
         }
 
-        jclass rewindSaveStateClass = env->FindClass("me/magnum/melonds/ui/emulator/rewind/model/RewindSaveState");
-        jfieldID bufferField = env->GetFieldID(rewindSaveStateClass, "buffer", "Ljava/nio/ByteBuffer;");
-        jfieldID bufferContentSizeField = env->GetFieldID(rewindSaveStateClass, "bufferContentSize", "J");
-        jfieldID screenshotBufferField = env->GetFieldID(rewindSaveStateClass, "screenshotBuffer", "Ljava/nio/ByteBuffer;");
-        jfieldID frameField = env->GetFieldID(rewindSaveStateClass, "frame", "I");
-        jobject buffer = env->GetObjectField(rewindSaveState, bufferField);
-        jlong bufferContentSize = env->GetLongField(rewindSaveState, bufferContentSizeField);
-        jobject screenshotBuffer = env->GetObjectField(rewindSaveState, screenshotBufferField);
-        jint frame = (int) env->GetIntField(rewindSaveState, frameField);
+        jobject buffer = env->GetObjectField(rewindSaveState, JniRegistry::rewindSaveState.buffer);
+        jlong bufferContentSize = env->GetLongField(rewindSaveState, JniRegistry::rewindSaveState.bufferContentSize);
+        jobject screenshotBuffer = env->GetObjectField(rewindSaveState, JniRegistry::rewindSaveState.screenshotBuffer);
+        jint frame = (int) env->GetIntField(rewindSaveState, JniRegistry::rewindSaveState.frame);
 
         // Make sure that the thread is really paused to avoid data corruption
         while (!isThreadReallyPaused);
@@ -433,30 +492,22 @@ JNIEXPORT jobject JNICALL
 Java_me_magnum_melonds_MelonEmulator_getRewindWindow(JNIEnv* env, jobject thiz) {
     auto currentRewindWindow = MelonDSAndroid::getRewindWindow();
 
-    jclass rewindSaveStateClass = env->FindClass("me/magnum/melonds/ui/emulator/rewind/model/RewindSaveState");
-    jmethodID rewindSaveStateConstructor = env->GetMethodID(rewindSaveStateClass, "<init>", "(Ljava/nio/ByteBuffer;JLjava/nio/ByteBuffer;I)V");
-
-    jclass listClass = env->FindClass("java/util/ArrayList");
-    jmethodID listConstructor = env->GetMethodID(listClass, "<init>", "()V");
-    jmethodID listAddMethod = env->GetMethodID(listClass, "add", "(ILjava/lang/Object;)V");
-    jobject rewindStateList = env->NewObject(listClass, listConstructor);
+    jobject rewindStateList = env->NewObject(JniRegistry::arrayList.clazz, JniRegistry::arrayList.constructor);
 
     int index = 0;
     for (auto state : currentRewindWindow.rewindStates) {
         jobject stateBuffer = env->NewDirectByteBuffer(state.buffer, state.bufferSize);
         jobject stateScreenshot = env->NewDirectByteBuffer(state.screenshot, state.screenshotSize);
-        jobject rewindSaveState = env->NewObject(rewindSaveStateClass, rewindSaveStateConstructor, stateBuffer, (jlong) state.bufferContentSize, stateScreenshot, state.frame);
-        env->CallVoidMethod(rewindStateList, listAddMethod, index++, rewindSaveState);
+        jobject rewindSaveState = env->NewObject(JniRegistry::rewindSaveState.clazz, JniRegistry::rewindSaveState.constructor, stateBuffer, (jlong) state.bufferContentSize, stateScreenshot, state.frame);
+        env->CallVoidMethod(rewindStateList, JniRegistry::arrayList.add, index++, rewindSaveState);
     }
 
-    jclass rewindWindowClass = env->FindClass("me/magnum/melonds/ui/emulator/rewind/model/RewindWindow");
-    jmethodID rewindWindowConstructor = env->GetMethodID(rewindWindowClass, "<init>", "(ILjava/util/ArrayList;)V");
-    jobject rewindWindow = env->NewObject(rewindWindowClass, rewindWindowConstructor, currentRewindWindow.currentFrame, rewindStateList);
+    jobject rewindWindow = env->NewObject(JniRegistry::rewindWindow.clazz, JniRegistry::rewindWindow.constructor, currentRewindWindow.currentFrame, rewindStateList);
     return rewindWindow;
 }
 
 JNIEXPORT void JNICALL
-Java_me_magnum_melonds_MelonEmulator_stopEmulation(JNIEnv* env, jobject thiz)
+Java_me_magnum_melonds_MelonEmulator_stopEmulation(JNIEnv* env, jobject thiz, jboolean keepWarm)
 {
     if (started)
     {
@@ -472,13 +523,19 @@ Java_me_magnum_melonds_MelonEmulator_stopEmulation(JNIEnv* env, jobject thiz)
         pthread_cond_destroy(&emuThreadCond);
     }
 
-    MelonDSAndroid::cleanup();
-
-    env->DeleteGlobalRef(globalCameraManager);
+    if (keepWarm)
+        isCoreWarm = true;
+    else
+        releaseCore(env);
 
-    globalCameraManager = nullptr;
+    fileHandler->getSramWriteBack().detach();
+}
 
-    delete androidCameraHandler;
+JNIEXPORT void JNICALL
+Java_me_magnum_melonds_MelonEmulator_releaseWarmEmulator(JNIEnv* env, jobject thiz)
+{
+    if (isCoreWarm && !started)
+        releaseCore(env);
 }
 
 JNIEXPORT void JNICALL
@@ -544,11 +601,41 @@ JNIEXPORT void JNICALL
 Java_me_magnum_melonds_MelonEmulator_updateEmulatorConfiguration(JNIEnv* env, jobject thiz, jobject emulatorConfiguration)
 {
     MelonDSAndroid::EmulatorConfiguration newConfiguration = MelonDSAndroidConfiguration::buildEmulatorConfiguration(env, emulatorConfiguration);
+    MelonDSAndroidConfiguration::CoreSetupKey newCoreSetupKey = MelonDSAndroidConfiguration::getCoreSetupKey(newConfiguration);
+    MelonDSAndroidConfiguration::LiveSettings newLiveSettings = MelonDSAndroidConfiguration::getLiveSettings(newConfiguration);
 
-    fastForwardSpeedMultiplier = newConfiguration.fastForwardSpeedMultiplier;
+    int changes = MelonDSAndroidConfiguration::getConfigurationChanges(currentCoreSetupKey, currentLiveSettings, newCoreSetupKey, newLiveSettings);
+    if (changes == 0)
+        return;
 
-    MelonDSAndroid::updateEmulatorConfiguration(std::make_unique<MelonDSAndroid::EmulatorConfiguration>(std::move(newConfiguration)));
+    currentCoreSetupKey = std::move(newCoreSetupKey);
+    currentLiveSettings = newLiveSettings;
 
+    if (changes & MelonDSAndroidConfiguration::CONFIGURATION_CHANGE_CORE_SETUP)
+        fileHandler->getBiosFileCache().setCachedFiles(MelonDSAndroidConfiguration::getBiosAndFirmwarePaths(newConfiguration));
+
+    if (changes & ~MelonDSAndroidConfiguration::CONFIGURATION_CHANGE_FAST_FORWARD) {
+        // The core takes the whole configuration, so it's only updated when something it uses has changed. The update is applied
+        // between two frames, and the time it takes is reported, since that is how long the emulation stalls
+        auto configuration = std::make_shared<MelonDSAndroid::EmulatorConfiguration>(std::move(newConfiguration));
+        auto applyConfiguration = [configuration, changes]() {
+            auto startTime = std::chrono::steady_clock::now();
+            MelonDSAndroid::updateEmulatorConfiguration(std::make_unique<MelonDSAndroid::EmulatorConfiguration>(std::move(*configuration)));
+            auto duration = std::chrono::steady_clock::now() - startTime;
+
+            AndroidMelonEventMessenger().onConfigurationApplied(changes, std::chrono::nanoseconds(duration).count());
+        };
+
+        if (!runAtFrameBoundary(applyConfiguration))
+            applyConfiguration();
+    } else {
+        AndroidMelonEventMessenger().onConfigurationApplied(changes, 0);
+    }
+
+    if (!(changes & MelonDSAndroidConfiguration::CONFIGURATION_CHANGE_FAST_FORWARD))
+        return;
+
+    fastForwardSpeedMultiplier = newLiveSettings.fastForwardSpeedMultiplier;
     if (isFastForwardEnabled) {
         limitFps = fastForwardSpeedMultiplier > 0;
         targetFps = 60 * fastForwardSpeedMultiplier;
@@ -571,6 +658,23 @@ Java_me_magnum_melonds_MelonEmulator_setIRMode(JNIEnv* env, jobject thiz, jint m
 
 }
 
+void releaseCore(JNIEnv* env)
+{
+    MelonDSAndroid::cleanup();
+    isCoreWarm = false;
+
+    env->DeleteGlobalRef(globalCameraManager);
+    env->DeleteGlobalRef(globalIRManager);
+
+    globalCameraManager = nullptr;
+    globalIRManager = nullptr;
+
+    delete androidCameraHandler;
+    delete androidIRHandler;
+    androidCameraHandler = nullptr;
+    androidIRHandler = nullptr;
+}
+
 MelonDSAndroid::RomGbaSlotConfig* buildGbaSlotConfig(GbaSlotType slotType, const char* romPath, const char* savePath)
 {
     if (slotType == GbaSlotType::GBA_ROM && romPath != nullptr)
@@ -595,6 +699,24 @@ MelonDSAndroid::RomGbaSlotConfig* buildGbaSlotConfig(GbaSlotType slotType, const
     }
 }
 
+bool runAtFrameBoundary(std::function<void()> task)
+{
+    if (!started)
+        return false;
+
+    pthread_mutex_lock(&emuThreadMutex);
+    if (stop) {
+        pthread_mutex_unlock(&emuThreadMutex);
+        return false;
+    }
+
+    frameBoundaryTaskQueue.post(std::move(task));
+    // Wake up the emulator thread in case it's paused
+    pthread_cond_broadcast(&emuThreadCond);
+    pthread_mutex_unlock(&emuThreadMutex);
+    return true;
+}
+
 double getCurrentMillis() {
     timespec now;
     clock_gettime(CLOCK_MONOTONIC, &now);
@@ -609,6 +731,7 @@ void* emulate(void*)
     double frameLimitError = 0.0;
 
     MelonDSAndroid::start();
+    emulatedFrameCount = 0;
 
     auto manager = PerformanceHintManagerFactory::create(jniEnvHandler);
     performanceHintSession = new ThreadSafePerformanceHintSession(std::move(manager));
@@ -621,8 +744,19 @@ void* emulate(void*)
         pthread_mutex_lock(&emuThreadMutex);
         if (paused) {
             isThreadReallyPaused = true;
-            while (paused && !stop)
-                pthread_cond_wait(&emuThreadCond, &emuThreadMutex);
+            while (paused && !stop) {
+                if (frameBoundaryTaskQueue.hasPendingTasks()) {
+                    // Tasks also need to run while paused. Flag the thread as not paused while they run so that nothing else
+                    // touches the emulator state at the same time
+                    isThreadReallyPaused = false;
+                    pthread_mutex_unlock(&emuThreadMutex);
+                    frameBoundaryTaskQueue.runPendingTasks();
+                    pthread_mutex_lock(&emuThreadMutex);
+                    isThreadReallyPaused = true;
+                } else {
+                    pthread_cond_wait(&emuThreadCond, &emuThreadMutex);
+                }
+            }
 
             frameLimitError = 0;
             lastTick = getCurrentMillis();
@@ -638,7 +772,12 @@ void* emulate(void*)
 
         auto frameStart = std::chrono::steady_clock::now();
 
+        cheatEngine.runCheats();
         u32 nLines = MelonDSAndroid::loop();
+        emulatedFrameCount++;
+        memoryWatch->update();
+        richPresenceMonitor.onFrame();
+        frameBoundaryTaskQueue.runPendingTasks();
 
         auto frameDuration = std::chrono::steady_clock::now() - frameStart;
         if (performanceHintSession != nullptr)
@@ -693,6 +832,9 @@ void* emulate(void*)
         performanceHintSession = nullptr;
     }
 
+    // Make sure that nobody is left waiting for a task that was scheduled just before the emulator stopped
+    frameBoundaryTaskQueue.runPendingTasks();
+
     MelonDSAndroid::stop();
     pthread_exit(NULL);
 }
\ No newline at end of file
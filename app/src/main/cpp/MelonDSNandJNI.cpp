@@ -8,6 +8,8 @@
 #include "MelonDSAndroidConfiguration.h"
 #include "MelonDS.h"
 #include "RomIconBuilder.h"
+#include "JniRegistry.h"
+#include "MelonDSAndroidInterface.h"
 #include "UriFileHandler.h"
 
 #define NAND_INIT_OK 0
@@ -38,6 +40,8 @@ Java_me_magnum_melonds_MelonDSiNand_openNand(JNIEnv* env, jobject thiz, jobject
         return NAND_INIT_ERROR_ALREADY_OPEN;
 
     MelonDSAndroid::EmulatorConfiguration configuration = MelonDSAndroidConfiguration::buildEmulatorConfiguration(env, emulatorConfiguration);
+    // The ES key is read from the cached DSi BIOS7, which the emulator will also use
+    fileHandler->getBiosFileCache().setCachedFiles(MelonDSAndroidConfiguration::getBiosAndFirmwarePaths(configuration));
     MelonDSAndroid::setConfiguration(std::move(configuration));
 
     auto bios7file = Platform::OpenFile(configuration.dsiBios7Path, melonDS::Platform::FileMode::Read);
@@ -72,17 +76,14 @@ Java_me_magnum_melonds_MelonDSiNand_listTitles(JNIEnv* env, jobject thiz)
     std::vector<u32> titleList;
     nandMount->ListTitles(category, titleList);
 
-    jclass listClass = env->FindClass("java/util/ArrayList");
-    jmethodID listConstructor = env->GetMethodID(listClass, "<init>", "()V");
-    jmethodID listAddMethod = env->GetMethodID(listClass, "add", "(ILjava/lang/Object;)V");
-    jobject jniTitleList = env->NewObject(listClass, listConstructor);
+    jobject jniTitleList = env->NewObject(JniRegistry::arrayList.clazz, JniRegistry::arrayList.constructor);
 
     int index = 0;
     for (std::vector<u32>::iterator it = titleList.begin(); it != titleList.end(); it++)
     {
         u32 titleId = *it;
         jobject titleData = getTitleData(env, category, titleId);
-        env->CallVoidMethod(jniTitleList, listAddMethod, index++, titleData);
+        env->CallVoidMethod(jniTitleList, JniRegistry::arrayList.add, index++, titleData);
     }
 
     return jniTitleList;
@@ -202,9 +203,6 @@ jobject getTitleData(JNIEnv* env, u32 category, u32 titleId)
     memcpy(iconArrayElements, iconData, sizeof(iconData));
     env->ReleaseByteArrayElements(iconBytes, iconArrayElements, 0);
 
-    jclass dsiWareTitleClass = env->FindClass("me/magnum/melonds/domain/model/DSiWareTitle");
-    jmethodID dsiWareTitleConstructor = env->GetMethodID(dsiWareTitleClass, "<init>", "(Ljava/lang/String;Ljava/lang/String;J[BJJI)V");
-
     std::wstring_convert<std::codecvt_utf8_utf16<char16_t>, char16_t> convert;
     std::string englishTitle = convert.to_bytes(banner.EnglishTitle);
 
@@ -213,8 +211,8 @@ jobject getTitleData(JNIEnv* env, u32 category, u32 titleId)
     std::string producer = englishTitle.substr(pos + 1);
 
     jobject titleObject = env->NewObject(
-        dsiWareTitleClass,
-        dsiWareTitleConstructor,
+        JniRegistry::dsiWareTitle.clazz,
+        JniRegistry::dsiWareTitle.constructor,
         env->NewStringUTF(title.c_str()),
         env->NewStringUTF(producer.c_str()),
         (jlong) titleId,
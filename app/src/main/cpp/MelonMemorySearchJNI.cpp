@@ -0,0 +1,37 @@
+#include <jni.h>
+#include "cheats/MemorySearch.h"
+
+MemorySearch memorySearch;
+
+extern "C"
+{
+JNIEXPORT jboolean JNICALL
+Java_me_magnum_melonds_MelonMemorySearch_startSearchInternal(JNIEnv* env, jobject thiz, jint width)
+{
+    return memorySearch.startSearch((melonDS::u32) width);
+}
+
+JNIEXPORT jlong JNICALL
+Java_me_magnum_melonds_MelonMemorySearch_filterCandidatesInternal(JNIEnv* env, jobject thiz, jint comparison, jint value)
+{
+    return memorySearch.filterCandidates((MemorySearch::Comparison) comparison, (melonDS::u32) value);
+}
+
+JNIEXPORT jobject JNICALL
+Java_me_magnum_melonds_MelonMemorySearch_getResultsInternal(JNIEnv* env, jobject thiz, jint maxResults)
+{
+    const melonDS::u32* resultBuffer = nullptr;
+    melonDS::u32 resultCount = memorySearch.getResults((melonDS::u32) maxResults, &resultBuffer);
+    if (resultCount == 0)
+        return nullptr;
+
+    // Each result is an address followed by its value
+    return env->NewDirectByteBuffer((void*) resultBuffer, resultCount * 2 * sizeof(melonDS::u32));
+}
+
+JNIEXPORT void JNICALL
+Java_me_magnum_melonds_MelonMemorySearch_resetSearch(JNIEnv* env, jobject thiz)
+{
+    memorySearch.resetSearch();
+}
+}
@@ -0,0 +1,43 @@
+#include <jni.h>
+#include <vector>
+#include "MelonDSAndroidInterface.h"
+#include "cheats/MemoryWatch.h"
+
+extern "C"
+{
+JNIEXPORT jobject JNICALL
+Java_me_magnum_melonds_MelonMemoryWatch_setWatchedRangesInternal(JNIEnv* env, jobject thiz, jintArray addresses, jintArray sizes)
+{
+    jsize rangeCount = env->GetArrayLength(addresses);
+    std::vector<jint> rangeAddresses(rangeCount);
+    std::vector<jint> rangeSizes(rangeCount);
+    env->GetIntArrayRegion(addresses, 0, rangeCount, rangeAddresses.data());
+    env->GetIntArrayRegion(sizes, 0, rangeCount, rangeSizes.data());
+
+    std::vector<MemoryWatch::WatchedRange> ranges;
+    ranges.reserve(rangeCount);
+    for (jsize i = 0; i < rangeCount; i++)
+        ranges.push_back({ (melonDS::u32) rangeAddresses[i], (melonDS::u32) rangeSizes[i] });
+
+    melonDS::u32 bufferSize = 0;
+    melonDS::u8* buffer = memoryWatch->setWatchedRanges(ranges, &bufferSize);
+    if (buffer == nullptr)
+        return nullptr;
+
+    return env->NewDirectByteBuffer(buffer, bufferSize);
+}
+
+JNIEXPORT jint JNICALL
+Java_me_magnum_melonds_MelonMemoryWatch_readRangeInternal(JNIEnv* env, jobject thiz, jobject buffer, jint valuesSize, jint valueOffset, jbyteArray destination, jint size)
+{
+    auto* watchBuffer = (const melonDS::u8*) env->GetDirectBufferAddress(buffer);
+    if (watchBuffer == nullptr)
+        return -1;
+
+    // The copy is short and never blocks, so it's done straight into the array
+    auto* values = (melonDS::u8*) env->GetPrimitiveArrayCritical(destination, nullptr);
+    melonDS::u32 frameCounter = MemoryWatch::readValues(watchBuffer, valuesSize, valueOffset, values, size);
+    env->ReleasePrimitiveArrayCritical(destination, values, 0);
+    return (jint) frameCounter;
+}
+}
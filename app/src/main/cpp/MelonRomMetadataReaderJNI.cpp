@@ -0,0 +1,96 @@
+#include <jni.h>
+#include <memory>
+#include <vector>
+#include "JniRegistry.h"
+#include "rom/RomBatchScanner.h"
+#include "rom/RomIdentityReader.h"
+#include "rom/RomMetadataReader.h"
+
+jobject buildRomMetadata(JNIEnv* env, const RomMetadataReader::RomMetadata& metadata);
+
+extern "C"
+{
+JNIEXPORT jobject JNICALL
+Java_me_magnum_melonds_MelonRomMetadataReader_readRomMetadata(JNIEnv* env, jobject thiz, jint fd)
+{
+    auto metadata = std::make_unique<RomMetadataReader::RomMetadata>();
+    if (!RomMetadataReader::readRomMetadata(fd, *metadata))
+        return nullptr;
+
+    return buildRomMetadata(env, *metadata);
+}
+
+JNIEXPORT jboolean JNICALL
+Java_me_magnum_melonds_MelonRomMetadataReader_readRomIcon(JNIEnv* env, jobject thiz, jint fd, jbyteArray icon)
+{
+    melonDS::u32 iconPixels[32 * 32];
+    if (env->GetArrayLength(icon) < (jsize) sizeof(iconPixels) || !RomMetadataReader::readRomIcon(fd, iconPixels))
+        return JNI_FALSE;
+
+    env->SetByteArrayRegion(icon, 0, sizeof(iconPixels), (const jbyte*) iconPixels);
+    return JNI_TRUE;
+}
+
+JNIEXPORT jboolean JNICALL
+Java_me_magnum_melonds_MelonRomMetadataReader_readRomMetadataBatch(JNIEnv* env, jobject thiz, jintArray fileDescriptors, jobject callback)
+{
+    jsize romCount = env->GetArrayLength(fileDescriptors);
+    std::vector<int> fds(romCount);
+    env->GetIntArrayRegion(fileDescriptors, 0, romCount, (jint*) fds.data());
+
+    bool result = RomBatchScanner::scanRoms(fds, [&](std::vector<RomBatchScanner::ScanResult>& results, melonDS::u32 scannedCount) {
+        jsize resultCount = (jsize) results.size();
+        jintArray indices = env->NewIntArray(resultCount);
+        jobjectArray metadataArray = env->NewObjectArray(resultCount, JniRegistry::romMetadata.clazz, nullptr);
+
+        std::vector<jint> resultIndices(resultCount);
+        for (jsize i = 0; i < resultCount; i++)
+        {
+            resultIndices[i] = (jint) results[i].index;
+            if (results[i].metadata)
+            {
+                jobject romMetadata = buildRomMetadata(env, *results[i].metadata);
+                env->SetObjectArrayElement(metadataArray, i, romMetadata);
+                env->DeleteLocalRef(romMetadata);
+            }
+        }
+        env->SetIntArrayRegion(indices, 0, resultCount, resultIndices.data());
+
+        jboolean shouldContinue = env->CallBooleanMethod(callback, JniRegistry::romScanCallback.onRomsScanned, indices, metadataArray, (jint) scannedCount);
+        env->DeleteLocalRef(indices);
+        env->DeleteLocalRef(metadataArray);
+
+        // Stop if the callback threw, since no more Java calls can be made until the exception is handled
+        return shouldContinue == JNI_TRUE && !env->ExceptionCheck();
+    });
+
+    return result;
+}
+
+JNIEXPORT jlongArray JNICALL
+Java_me_magnum_melonds_MelonRomMetadataReader_readRomIdentityInternal(JNIEnv* env, jobject thiz, jint fd, jboolean computeContentHash)
+{
+    RomIdentityReader::RomIdentity identity {};
+    if (!RomIdentityReader::readRomIdentity(fd, computeContentHash == JNI_TRUE, identity))
+        return nullptr;
+
+    jlong values[] = { (jlong) identity.size, (jlong) identity.headerCrc, (jlong) identity.contentHash };
+    jlongArray result = env->NewLongArray(3);
+    env->SetLongArrayRegion(result, 0, 3, values);
+    return result;
+}
+}
+
+jobject buildRomMetadata(JNIEnv* env, const RomMetadataReader::RomMetadata& metadata)
+{
+    jstring title = env->NewString((const jchar*) metadata.title.data(), (jsize) metadata.title.size());
+    jstring developer = env->NewString((const jchar*) metadata.developer.data(), (jsize) metadata.developer.size());
+    jstring retroAchievementsHash = env->NewStringUTF(metadata.retroAchievementsHash.c_str());
+
+    jobject romMetadata = env->NewObject(JniRegistry::romMetadata.clazz, JniRegistry::romMetadata.constructor, title, developer, (jboolean) metadata.isDsiWareTitle, retroAchievementsHash);
+
+    env->DeleteLocalRef(title);
+    env->DeleteLocalRef(developer);
+    env->DeleteLocalRef(retroAchievementsHash);
+    return romMetadata;
+}
@@ -0,0 +1,101 @@
+#include <jni.h>
+#include <string>
+#include <unordered_set>
+#include "MelonDSAndroidInterface.h"
+#include "savestate/SaveStateReader.h"
+
+bool readReferencedChunks(JNIEnv* env, jobjectArray saveStateUris, std::unordered_set<ChunkHash>& referencedChunks);
+
+extern "C"
+{
+JNIEXPORT jfloat JNICALL
+Java_me_magnum_melonds_MelonSaveStateStore_getUnreferencedChunkRatio(JNIEnv* env, jobject thiz, jstring chunkStoreUri, jobjectArray saveStateUris)
+{
+    std::unordered_set<ChunkHash> referencedChunks;
+    if (!readReferencedChunks(env, saveStateUris, referencedChunks))
+        return -1;
+
+    const char* chunkStorePath = env->GetStringUTFChars(chunkStoreUri, nullptr);
+    float ratio = saveStateChunkStore->getUnreferencedRatio(chunkStorePath, referencedChunks);
+    env->ReleaseStringUTFChars(chunkStoreUri, chunkStorePath);
+
+    return ratio;
+}
+
+JNIEXPORT void JNICALL
+Java_me_magnum_melonds_MelonSaveStateStore_beginChunkStoreCompaction(JNIEnv* env, jobject thiz, jstring chunkStoreUri)
+{
+    const char* chunkStorePath = env->GetStringUTFChars(chunkStoreUri, nullptr);
+    saveStateChunkStore->beginCompaction(chunkStorePath);
+    env->ReleaseStringUTFChars(chunkStoreUri, chunkStorePath);
+}
+
+JNIEXPORT void JNICALL
+Java_me_magnum_melonds_MelonSaveStateStore_endChunkStoreCompaction(JNIEnv* env, jobject thiz, jstring chunkStoreUri)
+{
+    const char* chunkStorePath = env->GetStringUTFChars(chunkStoreUri, nullptr);
+    saveStateChunkStore->endCompaction(chunkStorePath);
+    env->ReleaseStringUTFChars(chunkStoreUri, chunkStorePath);
+}
+
+JNIEXPORT jboolean JNICALL
+Java_me_magnum_melonds_MelonSaveStateStore_compactChunkStore(JNIEnv* env, jobject thiz, jstring chunkStoreUri, jstring temporaryChunkStoreUri, jobjectArray saveStateUris)
+{
+    const char* chunkStorePath = env->GetStringUTFChars(chunkStoreUri, nullptr);
+    const char* temporaryChunkStorePath = env->GetStringUTFChars(temporaryChunkStoreUri, nullptr);
+    bool result = saveStateChunkStore->compact(chunkStorePath, temporaryChunkStorePath, [env, saveStateUris](std::unordered_set<ChunkHash>& referencedChunks) {
+        return readReferencedChunks(env, saveStateUris, referencedChunks);
+    });
+    env->ReleaseStringUTFChars(chunkStoreUri, chunkStorePath);
+    env->ReleaseStringUTFChars(temporaryChunkStoreUri, temporaryChunkStorePath);
+
+    return result;
+}
+
+JNIEXPORT jboolean JNICALL
+Java_me_magnum_melonds_MelonSaveStateStore_recoverChunkStore(JNIEnv* env, jobject thiz, jstring chunkStoreUri, jstring temporaryChunkStoreUri)
+{
+    const char* chunkStorePath = env->GetStringUTFChars(chunkStoreUri, nullptr);
+    const char* temporaryChunkStorePath = env->GetStringUTFChars(temporaryChunkStoreUri, nullptr);
+    bool result = saveStateChunkStore->recover(chunkStorePath, temporaryChunkStorePath);
+    env->ReleaseStringUTFChars(chunkStoreUri, chunkStorePath);
+    env->ReleaseStringUTFChars(temporaryChunkStoreUri, temporaryChunkStorePath);
+
+    return result;
+}
+
+JNIEXPORT void JNICALL
+Java_me_magnum_melonds_MelonSaveStateStore_invalidateChunkStore(JNIEnv* env, jobject thiz, jstring chunkStoreUri)
+{
+    const char* chunkStorePath = env->GetStringUTFChars(chunkStoreUri, nullptr);
+    saveStateChunkStore->invalidate(chunkStorePath);
+    env->ReleaseStringUTFChars(chunkStoreUri, chunkStorePath);
+}
+
+JNIEXPORT void JNICALL
+Java_me_magnum_melonds_MelonSaveStateStore_evictCachedState(JNIEnv* env, jobject thiz, jstring saveStateUri)
+{
+    const char* saveStatePath = env->GetStringUTFChars(saveStateUri, nullptr);
+    saveStateCache->remove(saveStatePath);
+    env->ReleaseStringUTFChars(saveStateUri, saveStatePath);
+}
+}
+
+bool readReferencedChunks(JNIEnv* env, jobjectArray saveStateUris, std::unordered_set<ChunkHash>& referencedChunks)
+{
+    jsize saveStateCount = env->GetArrayLength(saveStateUris);
+    for (jsize i = 0; i < saveStateCount; i++)
+    {
+        auto saveStateUri = (jstring) env->GetObjectArrayElement(saveStateUris, i);
+        const char* saveStatePath = env->GetStringUTFChars(saveStateUri, nullptr);
+        bool result = SaveStateReader::readReferencedChunks(saveStatePath, referencedChunks);
+        env->ReleaseStringUTFChars(saveStateUri, saveStatePath);
+        env->DeleteLocalRef(saveStateUri);
+
+        // If a state can't be read, its chunks can't be known. Chunks must not be removed in that case
+        if (!result)
+            return false;
+    }
+
+    return true;
+}
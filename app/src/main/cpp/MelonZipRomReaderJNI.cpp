@@ -0,0 +1,17 @@
+#include <jni.h>
+#include <unistd.h>
+#include "rom/ZipEntryReader.h"
+
+extern "C"
+{
+JNIEXPORT jboolean JNICALL
+Java_me_magnum_melonds_MelonZipRomReader_canReadRomInPlace(JNIEnv* env, jobject thiz, jint fd)
+{
+    // The reader takes ownership of the descriptor, which belongs to the caller
+    int readerFd = dup(fd);
+    if (readerFd == -1)
+        return JNI_FALSE;
+
+    return ZipEntryReader::open(readerFd) != nullptr;
+}
+}
@@ -0,0 +1,127 @@
+#include "MemoryFileStore.h"
+#include <string.h>
+
+using namespace melonDS::Platform;
+
+namespace
+{
+    struct MemoryFileCookie
+    {
+        std::shared_ptr<std::vector<melonDS::u8>> contents;
+        size_t position;
+    };
+
+    int readMemoryFile(void* cookie, char* buffer, int size)
+    {
+        auto file = (MemoryFileCookie*) cookie;
+        size_t fileSize = file->contents->size();
+        if (file->position >= fileSize)
+            return 0;
+
+        size_t bytesToRead = std::min((size_t) size, fileSize - file->position);
+        memcpy(buffer, file->contents->data() + file->position, bytesToRead);
+        file->position += bytesToRead;
+        return (int) bytesToRead;
+    }
+
+    int writeMemoryFile(void* cookie, const char* buffer, int size)
+    {
+        auto file = (MemoryFileCookie*) cookie;
+        auto& contents = *file->contents;
+
+        if (file->position == contents.size())
+        {
+            contents.insert(contents.end(), buffer, buffer + size);
+        }
+        else
+        {
+            if (file->position + size > contents.size())
+                contents.resize(file->position + size);
+
+            memcpy(contents.data() + file->position, buffer, size);
+        }
+
+        file->position += size;
+        return size;
+    }
+
+    fpos_t seekMemoryFile(void* cookie, fpos_t offset, int whence)
+    {
+        auto file = (MemoryFileCookie*) cookie;
+        fpos_t newPosition;
+        switch (whence)
+        {
+            case SEEK_SET:
+                newPosition = offset;
+                break;
+            case SEEK_CUR:
+                newPosition = (fpos_t) file->position + offset;
+                break;
+            case SEEK_END:
+                newPosition = (fpos_t) file->contents->size() + offset;
+                break;
+            default:
+                return -1;
+        }
+
+        if (newPosition < 0)
+            return -1;
+
+        file->position = (size_t) newPosition;
+        return newPosition;
+    }
+
+    int closeMemoryFile(void* cookie)
+    {
+        delete (MemoryFileCookie*) cookie;
+        return 0;
+    }
+}
+
+bool MemoryFileStore::isMemoryFile(const char* path)
+{
+    return path != nullptr && strncmp(path, MEMORY_FILE_SCHEME, strlen(MEMORY_FILE_SCHEME)) == 0;
+}
+
+std::string MemoryFileStore::createFile(std::shared_ptr<std::vector<melonDS::u8>> contents)
+{
+    std::lock_guard<std::mutex> lock(filesMutex);
+    std::string path = std::string(MEMORY_FILE_SCHEME) + std::to_string(nextFileId++);
+    files[path] = std::move(contents);
+    return path;
+}
+
+void MemoryFileStore::deleteFile(const std::string& path)
+{
+    std::lock_guard<std::mutex> lock(filesMutex);
+    files.erase(path);
+}
+
+FILE* MemoryFileStore::open(const char* path, FileMode mode)
+{
+    std::shared_ptr<std::vector<melonDS::u8>> contents;
+    {
+        std::lock_guard<std::mutex> lock(filesMutex);
+        auto file = files.find(path);
+        if (file == files.end())
+            return nullptr;
+
+        contents = file->second;
+    }
+
+    bool canWrite = mode & (FileMode::Write | FileMode::Append);
+    if ((mode & FileMode::Write) && !(mode & (FileMode::Preserve | FileMode::Append | FileMode::NoCreate)))
+        contents->clear();
+
+    size_t initialPosition = (mode & FileMode::Append) ? contents->size() : 0;
+    auto cookie = new MemoryFileCookie {
+        .contents = std::move(contents),
+        .position = initialPosition,
+    };
+
+    FILE* memoryFile = funopen(cookie, (mode & FileMode::Read) ? readMemoryFile : nullptr, canWrite ? writeMemoryFile : nullptr, seekMemoryFile, closeMemoryFile);
+    if (!memoryFile)
+        delete cookie;
+
+    return memoryFile;
+}
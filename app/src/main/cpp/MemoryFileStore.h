@@ -0,0 +1,40 @@
+#ifndef MELONDS_ANDROID_MEMORYFILESTORE_H
+#define MELONDS_ANDROID_MEMORYFILESTORE_H
+
+#include <stdio.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Platform.h"
+#include "types.h"
+
+/**
+ * Registry of files that only exist in memory. The core accesses files through the Platform file API, which ends up in the
+ * UriFileHandler, so registering a buffer here allows the core to read from or write to it as if it were a regular file.
+ * This is used to snapshot and restore save states without touching storage.
+ */
+class MemoryFileStore
+{
+public:
+    static bool isMemoryFile(const char* path);
+
+    /**
+     * Registers a buffer as a memory file. The buffer is shared with the store until the file is deleted. Files opened for
+     * writing reuse the buffer's capacity, so pre-allocating it avoids reallocations while the file is being written.
+     * @return The path through which the file can be opened
+     */
+    std::string createFile(std::shared_ptr<std::vector<melonDS::u8>> contents);
+    void deleteFile(const std::string& path);
+    FILE* open(const char* path, melonDS::Platform::FileMode mode);
+
+private:
+    static constexpr const char* MEMORY_FILE_SCHEME = "memory://";
+
+    std::unordered_map<std::string, std::shared_ptr<std::vector<melonDS::u8>>> files;
+    std::mutex filesMutex;
+    unsigned int nextFileId = 0;
+};
+
+#endif //MELONDS_ANDROID_MEMORYFILESTORE_H
@@ -0,0 +1,87 @@
+#include "PositionalFileReader.h"
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace melonDS;
+
+namespace PositionalFileReader
+{
+    struct PositionalFileCookie
+    {
+        int fd;
+        off64_t position;
+        std::atomic<u64>* bytesReadCounter;
+    };
+
+    static int readPositionalFile(void* cookie, char* buffer, int size)
+    {
+        auto file = (PositionalFileCookie*) cookie;
+        ssize_t bytesRead = pread64(file->fd, buffer, size, file->position);
+        if (bytesRead > 0)
+        {
+            file->position += bytesRead;
+            *file->bytesReadCounter += bytesRead;
+        }
+
+        return (int) bytesRead;
+    }
+
+    static fpos_t seekPositionalFile(void* cookie, fpos_t offset, int whence)
+    {
+        auto file = (PositionalFileCookie*) cookie;
+        off64_t newPosition;
+        switch (whence)
+        {
+            case SEEK_SET:
+                newPosition = offset;
+                break;
+            case SEEK_CUR:
+                newPosition = file->position + offset;
+                break;
+            case SEEK_END:
+            {
+                struct stat64 fileStat {};
+                if (fstat64(file->fd, &fileStat) != 0)
+                    return -1;
+
+                newPosition = fileStat.st_size + offset;
+                break;
+            }
+            default:
+                return -1;
+        }
+
+        if (newPosition < 0)
+            return -1;
+
+        file->position = newPosition;
+        return (fpos_t) newPosition;
+    }
+
+    static int closePositionalFile(void* cookie)
+    {
+        auto file = (PositionalFileCookie*) cookie;
+        close(file->fd);
+        delete file;
+        return 0;
+    }
+
+    FILE* open(int fd, size_t bufferSize, std::atomic<u64>* bytesReadCounter)
+    {
+        auto cookie = new PositionalFileCookie {
+            .fd = fd,
+            .position = 0,
+            .bytesReadCounter = bytesReadCounter,
+        };
+
+        FILE* file = funopen(cookie, readPositionalFile, nullptr, seekPositionalFile, closePositionalFile);
+        if (!file)
+        {
+            delete cookie;
+            return nullptr;
+        }
+
+        setvbuf(file, nullptr, _IOFBF, bufferSize);
+        return file;
+    }
+}
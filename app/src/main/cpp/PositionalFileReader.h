@@ -0,0 +1,22 @@
+#ifndef MELONDS_ANDROID_POSITIONALFILEREADER_H
+#define MELONDS_ANDROID_POSITIONALFILEREADER_H
+
+#include <stdio.h>
+#include <atomic>
+#include "types.h"
+
+/**
+ * Opens files for reading with a position of their own, using positional reads on the descriptor. This allows multiple files to be
+ * opened from duplicates of the same descriptor, which would otherwise share the file offset.
+ */
+namespace PositionalFileReader
+{
+    /**
+     * Opens the file in the given descriptor for reading. On success, the returned file takes ownership of the descriptor.
+     * @param bufferSize The size of the stdio buffer of the file
+     * @param bytesReadCounter Counter to which the number of bytes read from the file is added
+     */
+    FILE* open(int fd, size_t bufferSize, std::atomic<melonDS::u64>* bytesReadCounter);
+}
+
+#endif //MELONDS_ANDROID_POSITIONALFILEREADER_H
@@ -1,4 +1,5 @@
 #include "RetroAchievementsMapper.h"
+#include "JniRegistry.h"
 
 void mapAchievementsFromJava(JNIEnv *env, jobjectArray javaAchievements, std::list<MelonDSAndroid::RetroAchievements::RAAchievement> &outputList)
 {
@@ -6,9 +7,8 @@ void mapAchievementsFromJava(JNIEnv *env, jobjectArray javaAchievements, std::li
     if (achievementCount < 1)
         return;
 
-    jclass cheatClass = env->GetObjectClass(env->GetObjectArrayElement(javaAchievements, 0));
-    jfieldID idField = env->GetFieldID(cheatClass, "id", "J");
-    jfieldID memoryAddressField = env->GetFieldID(cheatClass, "memoryAddress", "Ljava/lang/String;");
+    jfieldID idField = JniRegistry::raSimpleAchievement.id;
+    jfieldID memoryAddressField = JniRegistry::raSimpleAchievement.memoryAddress;
 
     for (int i = 0; i < achievementCount; ++i)
     {
@@ -36,10 +36,9 @@ void mapLeaderboardsFromJava(JNIEnv *env, jobjectArray javaLeaderboards, std::li
     if (leaderboardsCount < 1)
         return;
 
-    jclass cheatClass = env->GetObjectClass(env->GetObjectArrayElement(javaLeaderboards, 0));
-    jfieldID idField = env->GetFieldID(cheatClass, "id", "J");
-    jfieldID memoryAddressField = env->GetFieldID(cheatClass, "memoryAddress", "Ljava/lang/String;");
-    jfieldID formatField = env->GetFieldID(cheatClass, "format", "Ljava/lang/String;");
+    jfieldID idField = JniRegistry::raSimpleLeaderboard.id;
+    jfieldID memoryAddressField = JniRegistry::raSimpleLeaderboard.memoryAddress;
+    jfieldID formatField = JniRegistry::raSimpleLeaderboard.format;
 
     for (int i = 0; i < leaderboardsCount; ++i)
     {
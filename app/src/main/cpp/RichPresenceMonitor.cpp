@@ -0,0 +1,38 @@
+#include "RichPresenceMonitor.h"
+#include <MelonDS.h>
+
+using namespace melonDS;
+
+void RichPresenceMonitor::setUpdateInterval(u32 updateIntervalFrames)
+{
+    updateInterval = updateIntervalFrames;
+    isResetPending = true;
+}
+
+void RichPresenceMonitor::onFrame()
+{
+    if (isResetPending.exchange(false))
+    {
+        currentStatus.clear();
+        framesUntilUpdate = 0;
+    }
+
+    u32 interval = updateInterval.load(std::memory_order_relaxed);
+    if (interval == 0)
+        return;
+
+    if (framesUntilUpdate > 0)
+    {
+        framesUntilUpdate--;
+        return;
+    }
+
+    framesUntilUpdate = interval - 1;
+
+    std::string status = MelonDSAndroid::getRichPresenceStatus();
+    if (status != currentStatus)
+    {
+        currentStatus = std::move(status);
+        eventMessenger.onRichPresenceUpdated(currentStatus);
+    }
+}
@@ -0,0 +1,35 @@
+#ifndef MELONDS_ANDROID_RICHPRESENCEMONITOR_H
+#define MELONDS_ANDROID_RICHPRESENCEMONITOR_H
+
+#include <atomic>
+#include <string>
+#include "AndroidMelonEventMessenger.h"
+#include "types.h"
+
+/**
+ * Evaluates the rich presence of the current game every few frames and notifies the app when its text changes, so that the app never
+ * has to poll it. Must only be updated from the emulator thread, but can be configured from any thread.
+ */
+class RichPresenceMonitor
+{
+public:
+    /**
+     * Sets how often the rich presence is evaluated, and discards the cached text, so that the next evaluation is always notified.
+     * @param updateIntervalFrames Number of frames between evaluations. 0 disables the evaluation
+     */
+    void setUpdateInterval(melonDS::u32 updateIntervalFrames);
+
+    /**
+     * Must be called by the emulator thread after every frame.
+     */
+    void onFrame();
+
+private:
+    AndroidMelonEventMessenger eventMessenger;
+    std::atomic<melonDS::u32> updateInterval = 0;
+    std::atomic_bool isResetPending = false;
+    melonDS::u32 framesUntilUpdate = 0;
+    std::string currentStatus;
+};
+
+#endif //MELONDS_ANDROID_RICHPRESENCEMONITOR_H
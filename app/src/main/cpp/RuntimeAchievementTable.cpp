@@ -0,0 +1,67 @@
+#include "RuntimeAchievementTable.h"
+#include <string.h>
+
+using namespace melonDS;
+
+bool RuntimeAchievementTable::beginUpdate(size_t rowCount)
+{
+    bool reallocated = false;
+    size_t previousRowCount = 0;
+
+    if (memory.empty() || rowCount > capacityField())
+    {
+        // Rows are not carried over, so every row is flagged as dirty below
+        size_t capacity = (rowCount + 63) & ~(size_t) 63;
+        size_t bitmapWords = capacity / 64;
+        memory.assign(HEADER_SIZE / sizeof(u64) + bitmapWords + capacity * ROW_SIZE / sizeof(u64), 0);
+        capacityField() = (u32) capacity;
+        reallocated = true;
+    }
+    else
+    {
+        previousRowCount = rowCountField();
+    }
+
+    memset(getDirtyBitmap(), 0, capacityField() / 8);
+    rowCountField() = (u32) rowCount;
+
+    Row* rows = getRows();
+    u64* dirtyBitmap = getDirtyBitmap();
+    for (size_t i = previousRowCount; i < rowCount; i++)
+    {
+        rows[i] = {};
+        dirtyBitmap[i / 64] |= 1ull << (i % 64);
+    }
+
+    return reallocated;
+}
+
+void RuntimeAchievementTable::setRow(size_t index, s64 id, s32 value, s32 target)
+{
+    Row& row = getRows()[index];
+    if (row.id == id && row.value == value && row.target == target)
+        return;
+
+    row = { .id = id, .value = value, .target = target };
+    getDirtyBitmap()[index / 64] |= 1ull << (index % 64);
+}
+
+u32& RuntimeAchievementTable::rowCountField()
+{
+    return reinterpret_cast<u32*>(memory.data())[0];
+}
+
+u32& RuntimeAchievementTable::capacityField()
+{
+    return reinterpret_cast<u32*>(memory.data())[1];
+}
+
+u64* RuntimeAchievementTable::getDirtyBitmap()
+{
+    return memory.data() + HEADER_SIZE / sizeof(u64);
+}
+
+RuntimeAchievementTable::Row* RuntimeAchievementTable::getRows()
+{
+    return reinterpret_cast<Row*>(getDirtyBitmap() + capacityField() / 64);
+}
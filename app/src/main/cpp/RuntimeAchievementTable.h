@@ -0,0 +1,55 @@
+#ifndef MELONDS_ANDROID_RUNTIMEACHIEVEMENTTABLE_H
+#define MELONDS_ANDROID_RUNTIMEACHIEVEMENTTABLE_H
+
+#include <cstddef>
+#include <vector>
+#include "types.h"
+
+/**
+ * Progress of the runtime achievements, packed in memory that is shared with Kotlin as a direct ByteBuffer. The table is refreshed
+ * every time the app asks for the progress, and the rows that changed since the previous refresh are flagged in a dirty bitmap, so
+ * that the app only has to read those rows.
+ *
+ * Layout:
+ * * row count (`u32`)
+ * * row capacity (`u32`). Always a multiple of 64
+ * * dirty bitmap (`u64[capacity / 64]`). Bit N of word W flags row W * 64 + N
+ * * rows (`Row[capacity]`)
+ */
+class RuntimeAchievementTable
+{
+public:
+    // Must match RuntimeAchievementProgressTable.kt
+    static constexpr size_t HEADER_SIZE = 8;
+    static constexpr size_t ROW_SIZE = 16;
+
+    struct Row
+    {
+        melonDS::s64 id;
+        melonDS::s32 value;
+        melonDS::s32 target;
+    };
+
+    static_assert(sizeof(Row) == ROW_SIZE);
+
+    /**
+     * Starts a refresh of the table with [rowCount] rows, clearing the dirty bitmap. Rows past the previous row count are flagged as dirty.
+     * @return True if the table memory was reallocated, which invalidates the buffers that point to the previous memory
+     */
+    bool beginUpdate(size_t rowCount);
+    void setRow(size_t index, melonDS::s64 id, melonDS::s32 value, melonDS::s32 target);
+
+    void* getMemory() { return memory.data(); }
+    size_t getMemorySize() const { return memory.size() * sizeof(melonDS::u64); }
+
+private:
+    // Stored as u64 to keep the bitmap and the rows aligned
+    std::vector<melonDS::u64> memory;
+
+    melonDS::u32& rowCountField();
+    melonDS::u32& capacityField();
+    melonDS::u64* getDirtyBitmap();
+    Row* getRows();
+};
+
+#endif //MELONDS_ANDROID_RUNTIMEACHIEVEMENTTABLE_H
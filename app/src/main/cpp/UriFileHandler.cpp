@@ -1,30 +1,152 @@
 #include "UriFileHandler.h"
+#include <chrono>
+#include <sys/stat.h>
+#include <unistd.h>
 #include "Platform.h"
+#include "JniRegistry.h"
+#include "MappedFileReader.h"
+#include "PositionalFileReader.h"
 
 using namespace melonDS::Platform;
 
-UriFileHandler::UriFileHandler(JniEnvHandler* jniEnvHandler, jobject uriFileHandler)
+UriFileHandler::UriFileHandler(JniEnvHandler* jniEnvHandler, jobject uriFileHandler, MemoryFileStore* memoryFileStore) :
+    biosFileCache(memoryFileStore),
+    sramWriteBack([this](const char* path) {
+        return openFileDescriptor(path, (FileMode) (FileMode::ReadWrite | FileMode::Preserve));
+    })
 {
     this->jniEnvHandler = jniEnvHandler;
     this->uriFileHandler = uriFileHandler;
+    this->memoryFileStore = memoryFileStore;
 }
 
 FILE* UriFileHandler::open(const char* path, FileMode mode)
+{
+    auto startTime = std::chrono::steady_clock::now();
+    FILE* file = openFile(path, mode);
+    auto openTime = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startTime);
+
+    stats.openCount++;
+    stats.openTimeNs += openTime.count();
+    return file;
+}
+
+void UriFileHandler::clearDescriptorCache()
+{
+    descriptorCache.clear();
+}
+
+FILE* UriFileHandler::openFile(const char* path, FileMode mode)
+{
+    if (MemoryFileStore::isMemoryFile(path))
+        return memoryFileStore->open(path, mode);
+
+    if (ZipRomFileStore::isZipRomFile(path))
+    {
+        // ROMs inside archives can only be read
+        if (mode & (FileMode::Write | FileMode::Append))
+            return nullptr;
+
+        return zipRomFileStore.open(path, [this](const char* archivePath) {
+            return openFileDescriptor(archivePath, FileMode::Read);
+        });
+    }
+
+    if (sramWriteBack.isAttachedFile(path))
+    {
+        if (mode & (FileMode::Write | FileMode::Append))
+            return sramWriteBack.openForWrite(mode);
+
+        // Pending changes must be in storage before the file is read from it
+        sramWriteBack.flush(true);
+    }
+
+    if (biosFileCache.isCachedFile(path))
+    {
+        if (mode & (FileMode::Write | FileMode::Append))
+        {
+            // The core writes user settings back to the firmware
+            biosFileCache.invalidate(path);
+        }
+        else
+        {
+            std::string imageFile = biosFileCache.getImageFile(path, [this](const char* imagePath) {
+                return openFileDescriptor(imagePath, FileMode::Read);
+            });
+            if (!imageFile.empty())
+            {
+                stats.cachedOpenCount++;
+                return memoryFileStore->open(imageFile.c_str(), FileMode::Read);
+            }
+        }
+    }
+
+    if (!(mode & (FileMode::Write | FileMode::Append)))
+        return openReadOnlyFile(path);
+
+    // Cached descriptors of the file would keep serving its old contents if the file is truncated or replaced
+    descriptorCache.invalidate(path);
+
+    int fileDescriptor = openFileDescriptor(path, mode);
+    if (fileDescriptor == -1)
+        return nullptr;
+
+    std::string nativeMode = getNativeAccessMode(mode, false);
+    FILE* file = fdopen(fileDescriptor, nativeMode.c_str());
+    if (!file)
+    {
+        close(fileDescriptor);
+        return nullptr;
+    }
+
+    struct stat64 fileStat {};
+    if (fstat64(fileDescriptor, &fileStat) == 0 && fileStat.st_size >= LARGE_FILE_SIZE)
+        setvbuf(file, nullptr, _IOFBF, LARGE_FILE_BUFFER_SIZE);
+
+    return file;
+}
+
+FILE* UriFileHandler::openReadOnlyFile(const char* path)
+{
+    int fileDescriptor = descriptorCache.get(path);
+    if (fileDescriptor != -1)
+    {
+        stats.cachedOpenCount++;
+    }
+    else
+    {
+        fileDescriptor = openFileDescriptor(path, FileMode::Read);
+        if (fileDescriptor == -1)
+            return nullptr;
+
+        descriptorCache.put(path, fileDescriptor);
+    }
+
+    FILE* file = MappedFileReader::open(fileDescriptor, &stats.bytesRead);
+    if (!file)
+        // Descriptors are shared with the cache, so reads can't rely on the file offset
+        file = PositionalFileReader::open(fileDescriptor, READ_BUFFER_SIZE, &stats.bytesRead);
+
+    if (!file)
+        close(fileDescriptor);
+
+    return file;
+}
+
+int UriFileHandler::openFileDescriptor(const char* path, FileMode mode)
 {
     JNIEnv* env = this->jniEnvHandler->getCurrentThreadEnv();
 
     jstring pathString = env->NewStringUTF(path);
     jstring modeString = env->NewStringUTF(getAccessMode(mode, false).c_str());
-    jclass handlerClass = env->GetObjectClass(this->uriFileHandler);
-    jmethodID openMethod = env->GetMethodID(handlerClass, "open", "(Ljava/lang/String;Ljava/lang/String;)I");
-    jint fileDescriptor = env->CallIntMethod(this->uriFileHandler, openMethod, pathString, modeString);
+    jint fileDescriptor = env->CallIntMethod(this->uriFileHandler, JniRegistry::uriFileHandler.open, pathString, modeString);
 
-    if (fileDescriptor == -1) {
-        return nullptr;
-    } else {
-        std::string nativeMode = getNativeAccessMode(mode, false);
-        return fdopen(fileDescriptor, nativeMode.c_str());
-    }
+    // Files are also opened from native threads that never return to Java (like the save state writer), so local references must
+    // be released explicitly
+    env->DeleteLocalRef(modeString);
+    env->DeleteLocalRef(pathString);
+
+    return fileDescriptor;
 }
 
 std::string UriFileHandler::getNativeAccessMode(FileMode mode, bool fileExists)
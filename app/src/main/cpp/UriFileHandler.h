@@ -3,20 +3,58 @@
 
 #include <jni.h>
 #include <stdio.h>
+#include <atomic>
 #include <AndroidFileHandler.h>
+#include "BiosFileCache.h"
+#include "FileDescriptorCache.h"
 #include "JniEnvHandler.h"
+#include "MemoryFileStore.h"
+#include "rom/ZipRomFileStore.h"
+#include "sram/SramWriteBack.h"
+
+struct FileAccessStats
+{
+    std::atomic<melonDS::u64> openCount { 0 };
+    // Opens served from the descriptor cache, without going through Java
+    std::atomic<melonDS::u64> cachedOpenCount { 0 };
+    std::atomic<melonDS::u64> openTimeNs { 0 };
+    // Bytes read from files opened for reading only
+    std::atomic<melonDS::u64> bytesRead { 0 };
+};
 
 class UriFileHandler : public MelonDSAndroid::AndroidFileHandler {
 private:
+    // Buffer sizes of files opened through stdio. Big writable files (NAND images) get a bigger buffer, since the core accesses them
+    // in clusters
+    static constexpr size_t READ_BUFFER_SIZE = 64 * 1024;
+    static constexpr size_t LARGE_FILE_BUFFER_SIZE = 256 * 1024;
+    static constexpr long LARGE_FILE_SIZE = 4 * 1024 * 1024;
+
     JniEnvHandler* jniEnvHandler;
     jobject uriFileHandler;
+    MemoryFileStore* memoryFileStore;
+    ZipRomFileStore zipRomFileStore;
+    FileDescriptorCache descriptorCache;
+    FileAccessStats stats;
+    BiosFileCache biosFileCache;
+    SramWriteBack sramWriteBack;
 
 public:
-    UriFileHandler(JniEnvHandler* jniEnvHandler, jobject uriFileHandler);
+    UriFileHandler(JniEnvHandler* jniEnvHandler, jobject uriFileHandler, MemoryFileStore* memoryFileStore);
     FILE* open(const char* path, melonDS::Platform::FileMode mode);
+    const FileAccessStats& getStats() const { return stats; }
+    BiosFileCache& getBiosFileCache() { return biosFileCache; }
+    SramWriteBack& getSramWriteBack() { return sramWriteBack; }
+    /**
+     * Closes the cached descriptors of the files that are not currently open.
+     */
+    void clearDescriptorCache();
     virtual ~UriFileHandler();
 
 private:
+    FILE* openFile(const char* path, melonDS::Platform::FileMode mode);
+    FILE* openReadOnlyFile(const char* path);
+    int openFileDescriptor(const char* path, melonDS::Platform::FileMode mode);
     std::string getNativeAccessMode(melonDS::Platform::FileMode mode, bool fileExists);
     std::string getAccessMode(melonDS::Platform::FileMode mode, bool fileExists);
 };
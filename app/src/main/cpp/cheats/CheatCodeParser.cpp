@@ -0,0 +1,120 @@
+#include "CheatCodeParser.h"
+#include <array>
+
+namespace CheatCodeParser
+{
+
+static constexpr melonDS::u8 INVALID_HEX_DIGIT = 0xFF;
+static constexpr size_t WORD_LENGTH = 8;
+
+static constexpr std::array<melonDS::u8, 128> buildHexDigitTable()
+{
+    std::array<melonDS::u8, 128> table {};
+    for (size_t i = 0; i < table.size(); i++)
+        table[i] = INVALID_HEX_DIGIT;
+
+    for (melonDS::u8 i = 0; i < 10; i++)
+        table['0' + i] = i;
+
+    for (melonDS::u8 i = 0; i < 6; i++)
+    {
+        table['A' + i] = 10 + i;
+        table['a' + i] = 10 + i;
+    }
+
+    return table;
+}
+
+static constexpr std::array<melonDS::u8, 128> HEX_DIGITS = buildHexDigitTable();
+
+static inline bool isSeparator(jchar character)
+{
+    return character == ' ' || character == '\n' || character == '\r' || character == '\t';
+}
+
+ParseResult parse(const jchar* code, size_t length, std::vector<melonDS::u32>& words)
+{
+    size_t initialWordCount = words.size();
+    // Each word takes 8 characters plus a separator
+    words.reserve(initialWordCount + (length + 1) / (WORD_LENGTH + 1));
+
+    size_t position = 0;
+    while (position < length)
+    {
+        if (isSeparator(code[position]))
+        {
+            position++;
+            continue;
+        }
+
+        size_t wordStart = position;
+        melonDS::u32 word = 0;
+        while (position < length && !isSeparator(code[position]))
+        {
+            jchar character = code[position];
+            melonDS::u8 digit = character < HEX_DIGITS.size() ? HEX_DIGITS[character] : INVALID_HEX_DIGIT;
+            if (digit == INVALID_HEX_DIGIT)
+            {
+                words.resize(initialWordCount);
+                return { PARSE_ERROR_INVALID_CHARACTER, (melonDS::u32) position };
+            }
+
+            word = (word << 4) | digit;
+            position++;
+        }
+
+        if (position - wordStart != WORD_LENGTH)
+        {
+            words.resize(initialWordCount);
+            return { PARSE_ERROR_INVALID_WORD_LENGTH, (melonDS::u32) wordStart };
+        }
+
+        words.push_back(word);
+    }
+
+    size_t wordCount = words.size() - initialWordCount;
+    if (wordCount == 0)
+        return { PARSE_ERROR_EMPTY, 0 };
+
+    if (wordCount % 2 != 0)
+    {
+        words.resize(initialWordCount);
+        return { PARSE_ERROR_INCOMPLETE_LINE, (melonDS::u32) length };
+    }
+
+    return { PARSE_OK, 0 };
+}
+
+ParseResult parse(JNIEnv* env, jstring code, std::vector<melonDS::u32>& words)
+{
+    if (!code)
+        return { PARSE_ERROR_EMPTY, 0 };
+
+    jsize length = env->GetStringLength(code);
+    // No JNI calls can be made until the string is released, which parse() doesn't need
+    const jchar* characters = env->GetStringCritical(code, nullptr);
+    if (!characters)
+        return { PARSE_ERROR_EMPTY, 0 };
+
+    ParseResult result = parse(characters, (size_t) length, words);
+    env->ReleaseStringCritical(code, characters);
+
+    return result;
+}
+
+jintArray buildResultArray(JNIEnv* env, const std::vector<ParseResult>& results)
+{
+    std::vector<jint> values;
+    values.reserve(results.size() * 2);
+    for (const ParseResult& result : results)
+    {
+        values.push_back(result.error);
+        values.push_back((jint) result.position);
+    }
+
+    jintArray resultArray = env->NewIntArray((jsize) values.size());
+    env->SetIntArrayRegion(resultArray, 0, (jsize) values.size(), values.data());
+    return resultArray;
+}
+
+}
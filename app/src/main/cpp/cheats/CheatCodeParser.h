@@ -0,0 +1,45 @@
+#ifndef MELONDS_ANDROID_CHEATCODEPARSER_H
+#define MELONDS_ANDROID_CHEATCODEPARSER_H
+
+#include <jni.h>
+#include <vector>
+#include "types.h"
+
+/**
+ * Parses Action Replay cheat codes, made of 32-bit words written as 8 hex characters and separated by whitespace. Words come in
+ * pairs, so a valid code always has an even number of words. Codes are parsed directly from the characters of the Java string,
+ * without building intermediate strings.
+ */
+namespace CheatCodeParser
+{
+    // Must match the values in MelonCheatCodeParser.kt
+    enum ParseError : int
+    {
+        PARSE_OK = 0,
+        PARSE_ERROR_EMPTY = 1,
+        PARSE_ERROR_INVALID_CHARACTER = 2,
+        PARSE_ERROR_INVALID_WORD_LENGTH = 3,
+        PARSE_ERROR_INCOMPLETE_LINE = 4,
+    };
+
+    struct ParseResult
+    {
+        ParseError error;
+        // Index of the character where the error was found. For invalid words, this is the start of the word
+        melonDS::u32 position;
+    };
+
+    /**
+     * Appends the words of the given code to the given vector. If the code is not valid, the vector is left as it was.
+     */
+    ParseResult parse(const jchar* code, size_t length, std::vector<melonDS::u32>& words);
+
+    ParseResult parse(JNIEnv* env, jstring code, std::vector<melonDS::u32>& words);
+
+    /**
+     * Stores the given results in a Java int array, with two entries per result: the error and its position.
+     */
+    jintArray buildResultArray(JNIEnv* env, const std::vector<ParseResult>& results);
+}
+
+#endif //MELONDS_ANDROID_CHEATCODEPARSER_H
@@ -0,0 +1,132 @@
+#include "CheatCompiler.h"
+
+using namespace melonDS;
+
+namespace CheatCompiler
+{
+    static bool isConditional(CheatOpcode opcode)
+    {
+        return opcode >= OP_IF_GREATER32 && opcode <= OP_IF_COUNTER;
+    }
+
+    static void appendInstruction(CompiledCheat& cheat, CheatOpcode opcode, u32 address, u32 value)
+    {
+        cheat.instructions.push_back({ opcode, address, value, 0 });
+    }
+
+    static void appendWrite(CompiledCheat& cheat, CheatOpcode opcode, u32 address, u32 value)
+    {
+        // Jumps only land after conditionals, loops and D codes, never in the middle of a run of writes, so consecutive writes can
+        // always be merged
+        if (!cheat.instructions.empty() && cheat.instructions.back().opcode == opcode)
+            cheat.instructions.back().value++;
+        else
+            appendInstruction(cheat, opcode, (u32) cheat.writes.size(), 1);
+
+        cheat.writes.push_back({ address, value });
+    }
+
+    static bool runsWhileFalse(CheatOpcode opcode)
+    {
+        return opcode == OP_IF_COUNTER || opcode == OP_END_IF || opcode == OP_NEXT || opcode == OP_END_CODE;
+    }
+
+    /**
+     * While the condition is false, the Action Replay only runs C5, D0, D1 and D2, so every instruction that can make the condition
+     * false continues at the next one of them. Loops store it too, for when they jump back with a false condition.
+     */
+    static void resolveSkipTargets(CompiledCheat& cheat)
+    {
+        u32 nextTarget = (u32) cheat.instructions.size();
+        for (u32 i = (u32) cheat.instructions.size(); i-- > 0;)
+        {
+            CheatInstruction& instruction = cheat.instructions[i];
+            if (isConditional(instruction.opcode) || runsWhileFalse(instruction.opcode) || instruction.opcode == OP_LOOP)
+                instruction.target = nextTarget;
+
+            if (runsWhileFalse(instruction.opcode))
+                nextTarget = i;
+        }
+    }
+
+    std::shared_ptr<const CompiledCheat> compile(const std::vector<u32>& code)
+    {
+        auto cheat = std::make_shared<CompiledCheat>();
+
+        size_t i = 0;
+        while (i + 1 < code.size())
+        {
+            u32 a = code[i];
+            u32 b = code[i + 1];
+            i += 2;
+
+            u32 address = a & 0x0FFFFFFF;
+            switch (a >> 28)
+            {
+                case 0x0: appendWrite(*cheat, OP_WRITE32, address, b); break;
+                case 0x1: appendWrite(*cheat, OP_WRITE16, address, b & 0xFFFF); break;
+                case 0x2: appendWrite(*cheat, OP_WRITE8, address, b & 0xFF); break;
+                case 0x3: appendInstruction(*cheat, OP_IF_GREATER32, address, b); break;
+                case 0x4: appendInstruction(*cheat, OP_IF_LESS32, address, b); break;
+                case 0x5: appendInstruction(*cheat, OP_IF_EQUAL32, address, b); break;
+                case 0x6: appendInstruction(*cheat, OP_IF_NOT_EQUAL32, address, b); break;
+                case 0x7: appendInstruction(*cheat, OP_IF_GREATER16, address, b); break;
+                case 0x8: appendInstruction(*cheat, OP_IF_LESS16, address, b); break;
+                case 0x9: appendInstruction(*cheat, OP_IF_EQUAL16, address, b); break;
+                case 0xA: appendInstruction(*cheat, OP_IF_NOT_EQUAL16, address, b); break;
+                case 0xB: appendInstruction(*cheat, OP_LOAD_OFFSET, address, 0); break;
+                case 0xC:
+                    switch (a >> 24)
+                    {
+                        case 0xC0: appendInstruction(*cheat, OP_LOOP, 0, b); break;
+                        case 0xC5: appendInstruction(*cheat, OP_IF_COUNTER, 0, b); break;
+                        case 0xC6: appendInstruction(*cheat, OP_STORE_OFFSET, b, 0); break;
+                        default: break;
+                    }
+                    break;
+                case 0xD:
+                    switch (a >> 24)
+                    {
+                        case 0xD0: appendInstruction(*cheat, OP_END_IF, 0, 0); break;
+                        case 0xD1: appendInstruction(*cheat, OP_NEXT, 0, 0); break;
+                        case 0xD2: appendInstruction(*cheat, OP_END_CODE, 0, 0); break;
+                        case 0xD3: appendInstruction(*cheat, OP_SET_OFFSET, 0, b); break;
+                        case 0xD4: appendInstruction(*cheat, OP_ADD_DATA, 0, b); break;
+                        case 0xD5: appendInstruction(*cheat, OP_SET_DATA, 0, b); break;
+                        case 0xD6: appendInstruction(*cheat, OP_WRITE_DATA32, 0, b); break;
+                        case 0xD7: appendInstruction(*cheat, OP_WRITE_DATA16, 0, b); break;
+                        case 0xD8: appendInstruction(*cheat, OP_WRITE_DATA8, 0, b); break;
+                        case 0xD9: appendInstruction(*cheat, OP_LOAD_DATA32, 0, b); break;
+                        case 0xDA: appendInstruction(*cheat, OP_LOAD_DATA16, 0, b); break;
+                        case 0xDB: appendInstruction(*cheat, OP_LOAD_DATA8, 0, b); break;
+                        case 0xDC: appendInstruction(*cheat, OP_ADD_OFFSET, 0, b); break;
+                        default: break;
+                    }
+                    break;
+                case 0xE:
+                {
+                    // The bytes to write follow the line, padded to a whole number of lines. The byte count is checked against the
+                    // remaining code first, so that a bogus count can't overflow the size of the padding
+                    if (b > (u64) (code.size() - i) * 4)
+                        return nullptr;
+
+                    u64 patchWords = (((u64) b + 7) / 8) * 2;
+                    if (code.size() - i < patchWords)
+                        return nullptr;
+
+                    u32 patchDataStart = (u32) cheat->patchData.size();
+                    for (u32 byte = 0; byte < b; byte++)
+                        cheat->patchData.push_back((u8) (code[i + byte / 4] >> ((byte % 4) * 8)));
+
+                    cheat->instructions.push_back({ OP_PATCH, address, b, patchDataStart });
+                    i += patchWords;
+                    break;
+                }
+                case 0xF: appendInstruction(*cheat, OP_COPY, address, b); break;
+            }
+        }
+
+        resolveSkipTargets(*cheat);
+        return cheat;
+    }
+}
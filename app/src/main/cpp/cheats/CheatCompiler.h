@@ -0,0 +1,18 @@
+#ifndef MELONDS_ANDROID_CHEATCOMPILER_H
+#define MELONDS_ANDROID_CHEATCOMPILER_H
+
+#include <memory>
+#include <vector>
+#include "CompiledCheat.h"
+#include "types.h"
+
+namespace CheatCompiler
+{
+    /**
+     * Compiles a parsed Action Replay code. Lines with unsupported operations are ignored.
+     * @return The compiled code, or null if the code is truncated
+     */
+    std::shared_ptr<const CompiledCheat> compile(const std::vector<melonDS::u32>& code);
+}
+
+#endif //MELONDS_ANDROID_CHEATCOMPILER_H
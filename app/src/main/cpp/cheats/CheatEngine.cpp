@@ -0,0 +1,55 @@
+#include "CheatEngine.h"
+#include "CheatInterpreter.h"
+#include <NDS.h>
+
+using namespace melonDS;
+
+void CheatEngine::setCheats(std::vector<std::shared_ptr<const CompiledCheat>> cheats)
+{
+    this->cheats = std::move(cheats);
+}
+
+void CheatEngine::runCheats()
+{
+    NDS* nds = NDS::Current;
+    if (nds != nullptr && !cheats.empty())
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (const auto& cheat : cheats)
+            runCheat(nds, *cheat);
+
+        measuredTime += std::chrono::steady_clock::now() - start;
+    }
+
+    measuredFrames++;
+    if (measuredFrames >= MEASURED_FRAMES)
+    {
+        averageFrameTime = std::chrono::duration<float, std::micro>(measuredTime).count() / measuredFrames;
+        measuredTime = std::chrono::nanoseconds::zero();
+        measuredFrames = 0;
+    }
+}
+
+float CheatEngine::getAverageFrameTime() const
+{
+    return averageFrameTime;
+}
+
+void CheatEngine::runCheat(NDS* nds, const CompiledCheat& cheat)
+{
+    // Memory is accessed through the ARM7 bus, which sees main RAM without going through the caches and TCMs of the ARM9
+    struct Arm7Bus
+    {
+        NDS* nds;
+
+        u8 read8(u32 address) { return nds->ARM7Read8(address); }
+        u16 read16(u32 address) { return nds->ARM7Read16(address); }
+        u32 read32(u32 address) { return nds->ARM7Read32(address); }
+        void write8(u32 address, u8 value) { nds->ARM7Write8(address, value); }
+        void write16(u32 address, u16 value) { nds->ARM7Write16(address, value); }
+        void write32(u32 address, u32 value) { nds->ARM7Write32(address, value); }
+    };
+
+    Arm7Bus bus { nds };
+    CheatInterpreter::run(bus, cheat);
+}
@@ -0,0 +1,43 @@
+#ifndef MELONDS_ANDROID_CHEATENGINE_H
+#define MELONDS_ANDROID_CHEATENGINE_H
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include "CompiledCheat.h"
+#include "types.h"
+
+namespace melonDS
+{
+    class NDS;
+}
+
+/**
+ * Runs compiled Action Replay codes once per frame, and keeps track of how long it takes. Must only be used from the emulator thread,
+ * except for getAverageFrameTime().
+ */
+class CheatEngine
+{
+public:
+    void setCheats(std::vector<std::shared_ptr<const CompiledCheat>> cheats);
+    void runCheats();
+
+    /**
+     * @return The average time spent running cheats in each of the last measured frames, in microseconds
+     */
+    float getAverageFrameTime() const;
+
+private:
+    static constexpr int MEASURED_FRAMES = 30;
+
+    std::vector<std::shared_ptr<const CompiledCheat>> cheats;
+
+    std::chrono::nanoseconds measuredTime = std::chrono::nanoseconds::zero();
+    int measuredFrames = 0;
+    std::atomic<float> averageFrameTime = 0;
+
+    void runCheat(melonDS::NDS* nds, const CompiledCheat& cheat);
+};
+
+#endif //MELONDS_ANDROID_CHEATENGINE_H
@@ -0,0 +1,154 @@
+#ifndef MELONDS_ANDROID_CHEATINTERPRETER_H
+#define MELONDS_ANDROID_CHEATINTERPRETER_H
+
+#include "CompiledCheat.h"
+#include "types.h"
+
+namespace CheatInterpreter
+{
+    /**
+     * Runs a compiled Action Replay code once, with the same semantics as the core's AR engine. While the condition is false, only
+     * C5, D0, D1 and D2 run, so execution jumps straight to the next one of them. Conditionals skipped this way don't push onto the
+     * condition stack, which is what makes the D0 of a skipped conditional close the enclosing one, just like on the Action Replay.
+     *
+     * @param bus Memory accessors, with read8(), read16(), read32(), write8(), write16() and write32() methods
+     */
+    template <typename Bus>
+    void run(Bus& bus, const CompiledCheat& cheat)
+    {
+        using namespace melonDS;
+
+        u32 offset = 0;
+        u32 data = 0;
+        bool condition = true;
+        u32 conditionStack = 0;
+        u32 counter = 0;
+
+        size_t loopStart = 0;
+        size_t loopSkipTarget = 0;
+        u32 loopCount = 0;
+        bool loopCondition = true;
+        u32 loopConditionStack = 0;
+
+        const std::vector<CheatInstruction>& instructions = cheat.instructions;
+        size_t pc = 0;
+
+        while (pc < instructions.size())
+        {
+            const CheatInstruction& instruction = instructions[pc++];
+
+            // Conditionals other than C5 are only reached while the current condition is true
+            auto branch = [&](bool result) {
+                conditionStack = (conditionStack << 1) | 1;
+                condition = result;
+            };
+            auto conditionAddress = [&]() {
+                return instruction.address != 0 ? instruction.address : offset;
+            };
+            auto maskedRead16 = [&]() {
+                return (u16) (bus.read16(conditionAddress()) & ~(instruction.value >> 16));
+            };
+
+            switch (instruction.opcode)
+            {
+                case OP_WRITE32:
+                    for (u32 i = instruction.address; i < instruction.address + instruction.value; i++)
+                        bus.write32(cheat.writes[i].address + offset, cheat.writes[i].value);
+                    break;
+                case OP_WRITE16:
+                    for (u32 i = instruction.address; i < instruction.address + instruction.value; i++)
+                        bus.write16(cheat.writes[i].address + offset, (u16) cheat.writes[i].value);
+                    break;
+                case OP_WRITE8:
+                    for (u32 i = instruction.address; i < instruction.address + instruction.value; i++)
+                        bus.write8(cheat.writes[i].address + offset, (u8) cheat.writes[i].value);
+                    break;
+                case OP_IF_GREATER32: branch(instruction.value > bus.read32(conditionAddress())); break;
+                case OP_IF_LESS32: branch(instruction.value < bus.read32(conditionAddress())); break;
+                case OP_IF_EQUAL32: branch(instruction.value == bus.read32(conditionAddress())); break;
+                case OP_IF_NOT_EQUAL32: branch(instruction.value != bus.read32(conditionAddress())); break;
+                case OP_IF_GREATER16: branch((instruction.value & 0xFFFF) > maskedRead16()); break;
+                case OP_IF_LESS16: branch((instruction.value & 0xFFFF) < maskedRead16()); break;
+                case OP_IF_EQUAL16: branch((instruction.value & 0xFFFF) == maskedRead16()); break;
+                case OP_IF_NOT_EQUAL16: branch((instruction.value & 0xFFFF) != maskedRead16()); break;
+                case OP_IF_COUNTER:
+                    // Runs even while the condition is false, so the counter always advances, but it can't make the condition true
+                    counter++;
+                    conditionStack = (conditionStack << 1) | (condition ? 1 : 0);
+                    if (condition)
+                        condition = (counter & (instruction.value & 0xFFFF)) == (instruction.value >> 16);
+                    break;
+                case OP_LOAD_OFFSET:
+                    offset = bus.read32(instruction.address + offset);
+                    break;
+                case OP_LOOP:
+                    loopStart = pc;
+                    loopSkipTarget = instruction.target;
+                    loopCount = instruction.value;
+                    loopCondition = condition;
+                    loopConditionStack = conditionStack;
+                    break;
+                case OP_STORE_OFFSET:
+                    bus.write32(instruction.address, offset);
+                    break;
+                case OP_END_IF:
+                    condition = conditionStack & 1;
+                    conditionStack >>= 1;
+                    break;
+                case OP_NEXT:
+                case OP_END_CODE:
+                    // The condition is kept while looping, and only restored once the loop is done
+                    if (loopCount > 0)
+                    {
+                        loopCount--;
+                        pc = condition ? loopStart : loopSkipTarget;
+                        continue;
+                    }
+
+                    if (instruction.opcode == OP_END_CODE)
+                    {
+                        offset = 0;
+                        data = 0;
+                    }
+                    condition = loopCondition;
+                    conditionStack = loopConditionStack;
+                    break;
+                case OP_SET_OFFSET: offset = instruction.value; break;
+                case OP_ADD_DATA: data += instruction.value; break;
+                case OP_SET_DATA: data = instruction.value; break;
+                case OP_WRITE_DATA32:
+                    bus.write32(instruction.value + offset, data);
+                    offset += 4;
+                    break;
+                case OP_WRITE_DATA16:
+                    bus.write16(instruction.value + offset, (u16) data);
+                    offset += 2;
+                    break;
+                case OP_WRITE_DATA8:
+                    bus.write8(instruction.value + offset, (u8) data);
+                    offset += 1;
+                    break;
+                case OP_LOAD_DATA32: data = bus.read32(instruction.value + offset); break;
+                case OP_LOAD_DATA16: data = bus.read16(instruction.value + offset); break;
+                case OP_LOAD_DATA8: data = bus.read8(instruction.value + offset); break;
+                case OP_ADD_OFFSET: offset += instruction.value; break;
+                case OP_PATCH:
+                {
+                    u32 address = instruction.address + offset;
+                    for (u32 i = 0; i < instruction.value; i++)
+                        bus.write8(address + i, cheat.patchData[instruction.target + i]);
+                    break;
+                }
+                case OP_COPY:
+                    for (u32 i = 0; i < instruction.value; i++)
+                        bus.write8(instruction.address + i, bus.read8(offset + i));
+                    break;
+            }
+
+            if (!condition)
+                pc = instruction.target;
+        }
+    }
+}
+
+#endif //MELONDS_ANDROID_CHEATINTERPRETER_H
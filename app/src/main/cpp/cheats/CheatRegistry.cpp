@@ -0,0 +1,115 @@
+#include "CheatRegistry.h"
+#include "CheatCompiler.h"
+#include "../FrameBoundaryTaskQueue.h"
+
+CheatRegistry::CheatRegistry(CheatEngine* cheatEngine) : cheatEngine(cheatEngine)
+{
+}
+
+CheatCodeParser::ParseResult CheatRegistry::addCheat(melonDS::s64 id, JNIEnv* env, jstring code, bool enabled)
+{
+    std::vector<melonDS::u32> words;
+    CheatCodeParser::ParseResult result = CheatCodeParser::parse(env, code, words);
+
+    std::shared_ptr<const CompiledCheat> compiledCheat;
+    if (result.error == CheatCodeParser::PARSE_OK)
+    {
+        compiledCheat = CheatCompiler::compile(words);
+        // Patch lines must be followed by the data to write
+        if (!compiledCheat)
+            result = { CheatCodeParser::PARSE_ERROR_INCOMPLETE_LINE, (melonDS::u32) env->GetStringLength(code) };
+    }
+
+    if (compiledCheat)
+        queueChange(Change { CHANGE_ADD, id, { std::move(compiledCheat), enabled } });
+    else
+        // The cheat may have been valid before. Make sure that the old code is no longer applied
+        removeCheat(id);
+
+    return result;
+}
+
+void CheatRegistry::removeCheat(melonDS::s64 id)
+{
+    queueChange(Change { CHANGE_REMOVE, id, { {}, false } });
+}
+
+void CheatRegistry::setCheatEnabled(melonDS::s64 id, bool enabled)
+{
+    queueChange(Change { CHANGE_SET_ENABLED, id, { {}, enabled } });
+}
+
+void CheatRegistry::clear()
+{
+    queueChange(Change { CHANGE_CLEAR, 0, { {}, false } });
+}
+
+void CheatRegistry::queueChange(Change change)
+{
+    {
+        std::lock_guard<std::mutex> lock(changesMutex);
+        pendingChanges.push_back(std::move(change));
+
+        // All changes made before the next frame boundary are applied together
+        if (isApplyScheduled)
+            return;
+
+        isApplyScheduled = true;
+    }
+
+    if (!runAtFrameBoundary([this] { applyPendingChanges(); }))
+        applyPendingChanges();
+}
+
+void CheatRegistry::applyPendingChanges()
+{
+    std::lock_guard<std::mutex> applyLock(applyMutex);
+
+    std::vector<Change> changes;
+    {
+        std::lock_guard<std::mutex> lock(changesMutex);
+        changes.swap(pendingChanges);
+        isApplyScheduled = false;
+    }
+
+    bool isCheatListModified = false;
+    for (Change& change : changes)
+    {
+        switch (change.type)
+        {
+            case CHANGE_ADD:
+                cheats[change.id] = std::move(change.cheat);
+                isCheatListModified = true;
+                break;
+            case CHANGE_REMOVE:
+                isCheatListModified |= cheats.erase(change.id) > 0;
+                break;
+            case CHANGE_SET_ENABLED:
+            {
+                auto cheat = cheats.find(change.id);
+                if (cheat != cheats.end() && cheat->second.enabled != change.cheat.enabled)
+                {
+                    cheat->second.enabled = change.cheat.enabled;
+                    isCheatListModified = true;
+                }
+                break;
+            }
+            case CHANGE_CLEAR:
+                isCheatListModified |= !cheats.empty();
+                cheats.clear();
+                break;
+        }
+    }
+
+    if (!isCheatListModified)
+        return;
+
+    std::vector<std::shared_ptr<const CompiledCheat>> enabledCheats;
+    for (const auto& [id, cheat] : cheats)
+    {
+        if (cheat.enabled)
+            enabledCheats.push_back(cheat.code);
+    }
+
+    cheatEngine->setCheats(std::move(enabledCheats));
+}
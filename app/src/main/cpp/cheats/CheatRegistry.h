@@ -0,0 +1,70 @@
+#ifndef MELONDS_ANDROID_CHEATREGISTRY_H
+#define MELONDS_ANDROID_CHEATREGISTRY_H
+
+#include <jni.h>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "CheatCodeParser.h"
+#include "CheatEngine.h"
+#include "CompiledCheat.h"
+#include "types.h"
+
+/**
+ * Keeps track of the cheats run by the cheat engine, identified by their ID in the cheat database. Codes are parsed and compiled
+ * once, when the cheat is added, so changing a single cheat doesn't require processing all other enabled cheats again.
+ *
+ * Changes are queued and applied together at the next frame boundary, so that the cheats of the engine are never replaced while
+ * they are running, and are updated at most once per frame. If the emulator is not running, changes are applied right away.
+ */
+class CheatRegistry
+{
+public:
+    CheatRegistry(CheatEngine* cheatEngine);
+
+    /**
+     * Adds a cheat, replacing any existing cheat with the same ID. Invalid cheats are not added.
+     */
+    CheatCodeParser::ParseResult addCheat(melonDS::s64 id, JNIEnv* env, jstring code, bool enabled);
+    void removeCheat(melonDS::s64 id);
+    void setCheatEnabled(melonDS::s64 id, bool enabled);
+    void clear();
+
+private:
+    struct RegisteredCheat
+    {
+        std::shared_ptr<const CompiledCheat> code;
+        bool enabled;
+    };
+
+    enum ChangeType
+    {
+        CHANGE_ADD,
+        CHANGE_REMOVE,
+        CHANGE_SET_ENABLED,
+        CHANGE_CLEAR,
+    };
+
+    struct Change
+    {
+        ChangeType type;
+        melonDS::s64 id;
+        RegisteredCheat cheat;
+    };
+
+    CheatEngine* cheatEngine;
+
+    // Only accessed when changes are applied. Ordered by ID so that cheats always run in the same order
+    std::map<melonDS::s64, RegisteredCheat> cheats;
+    std::mutex applyMutex;
+
+    std::vector<Change> pendingChanges;
+    bool isApplyScheduled = false;
+    std::mutex changesMutex;
+
+    void queueChange(Change change);
+    void applyPendingChanges();
+};
+
+#endif //MELONDS_ANDROID_CHEATREGISTRY_H
@@ -0,0 +1,74 @@
+#ifndef MELONDS_ANDROID_COMPILEDCHEAT_H
+#define MELONDS_ANDROID_COMPILEDCHEAT_H
+
+#include <vector>
+#include "types.h"
+
+enum CheatOpcode : melonDS::u8
+{
+    // address: index of the first write in CompiledCheat::writes. value: number of consecutive writes
+    OP_WRITE32,
+    OP_WRITE16,
+    OP_WRITE8,
+    // address: address to check, or 0 to check the address in the offset register. target: instruction to jump to if the
+    // condition is false, which is the next C5, D0, D1 or D2
+    OP_IF_GREATER32,
+    OP_IF_LESS32,
+    OP_IF_EQUAL32,
+    OP_IF_NOT_EQUAL32,
+    // Same as the 32-bit conditions. The upper 16 bits of value hold the mask of the bits to ignore
+    OP_IF_GREATER16,
+    OP_IF_LESS16,
+    OP_IF_EQUAL16,
+    OP_IF_NOT_EQUAL16,
+    OP_IF_COUNTER,
+    OP_LOAD_OFFSET,
+    // target: instruction to jump to when looping back with a false condition
+    OP_LOOP,
+    OP_STORE_OFFSET,
+    // target: instruction to jump to if the condition is false afterwards
+    OP_END_IF,
+    OP_NEXT,
+    OP_END_CODE,
+    OP_SET_OFFSET,
+    OP_ADD_DATA,
+    OP_SET_DATA,
+    OP_WRITE_DATA32,
+    OP_WRITE_DATA16,
+    OP_WRITE_DATA8,
+    OP_LOAD_DATA32,
+    OP_LOAD_DATA16,
+    OP_LOAD_DATA8,
+    OP_ADD_OFFSET,
+    // value: number of bytes. target: index of the first byte in CompiledCheat::patchData
+    OP_PATCH,
+    // value: number of bytes. The source address is in the offset register
+    OP_COPY,
+};
+
+struct CheatInstruction
+{
+    CheatOpcode opcode;
+    melonDS::u32 address;
+    melonDS::u32 value;
+    melonDS::u32 target;
+};
+
+struct CheatWrite
+{
+    melonDS::u32 address;
+    melonDS::u32 value;
+};
+
+/**
+ * An Action Replay code in a form that can be executed without decoding it again. Consecutive writes of the same size are merged
+ * into a single instruction and instructions that can make the condition false already know where execution continues.
+ */
+struct CompiledCheat
+{
+    std::vector<CheatInstruction> instructions;
+    std::vector<CheatWrite> writes;
+    std::vector<melonDS::u8> patchData;
+};
+
+#endif //MELONDS_ANDROID_COMPILEDCHEAT_H
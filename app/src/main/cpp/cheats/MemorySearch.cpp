@@ -0,0 +1,171 @@
+#include "MemorySearch.h"
+#include <future>
+#include <string.h>
+#include <NDS.h>
+#include "../FrameBoundaryTaskQueue.h"
+
+using namespace melonDS;
+
+template <typename T>
+static inline T readValue(const u8* memory, size_t index)
+{
+    T value;
+    memcpy(&value, memory + index * sizeof(T), sizeof(T));
+    return value;
+}
+
+/**
+ * Values are compared in groups of 64, producing one bitmap word per group. The inner loop has a fixed length and no branches, so
+ * that the compiler can vectorize it.
+ */
+template <typename T, typename Compare>
+static s64 filterValues(const u8* previous, const u8* current, std::vector<u64>& candidates, Compare compare)
+{
+    s64 remainingCandidates = 0;
+    for (size_t word = 0; word < candidates.size(); word++)
+    {
+        u64 candidateWord = candidates[word];
+        if (candidateWord == 0)
+            continue;
+
+        u64 matches = 0;
+        size_t firstValue = word * 64;
+        for (u32 bit = 0; bit < 64; bit++)
+        {
+            bool match = compare(readValue<T>(previous, firstValue + bit), readValue<T>(current, firstValue + bit));
+            matches |= (u64) match << bit;
+        }
+
+        candidateWord &= matches;
+        candidates[word] = candidateWord;
+        remainingCandidates += __builtin_popcountll(candidateWord);
+    }
+
+    return remainingCandidates;
+}
+
+template <typename T>
+static s64 filterValuesWithComparison(const u8* previous, const u8* current, std::vector<u64>& candidates, MemorySearch::Comparison comparison, u32 value)
+{
+    T targetValue = (T) value;
+    switch (comparison)
+    {
+        case MemorySearch::COMPARISON_EQUAL_TO_VALUE:
+            return filterValues<T>(previous, current, candidates, [targetValue](T, T currentValue) { return currentValue == targetValue; });
+        case MemorySearch::COMPARISON_CHANGED:
+            return filterValues<T>(previous, current, candidates, [](T previousValue, T currentValue) { return currentValue != previousValue; });
+        case MemorySearch::COMPARISON_UNCHANGED:
+            return filterValues<T>(previous, current, candidates, [](T previousValue, T currentValue) { return currentValue == previousValue; });
+        case MemorySearch::COMPARISON_INCREASED:
+            return filterValues<T>(previous, current, candidates, [](T previousValue, T currentValue) { return currentValue > previousValue; });
+        case MemorySearch::COMPARISON_DECREASED:
+            return filterValues<T>(previous, current, candidates, [](T previousValue, T currentValue) { return currentValue < previousValue; });
+    }
+
+    return -1;
+}
+
+bool MemorySearch::startSearch(u32 width)
+{
+    if (width != 1 && width != 2 && width != 4)
+        return false;
+
+    std::lock_guard<std::mutex> lock(searchMutex);
+    if (!takeSnapshot(previousSnapshot))
+        return false;
+
+    searchWidth = width;
+    // Main RAM is always a multiple of 64 values, so every bit of the bitmap maps to a value
+    candidates.assign(previousSnapshot.size() / width / 64, ~0ULL);
+    results.clear();
+    return true;
+}
+
+s64 MemorySearch::filterCandidates(Comparison comparison, u32 value)
+{
+    std::lock_guard<std::mutex> lock(searchMutex);
+    if (searchWidth == 0 || !takeSnapshot(currentSnapshot))
+        return -1;
+
+    // The console may have been switched since the search started
+    if (currentSnapshot.size() != previousSnapshot.size())
+        return -1;
+
+    s64 remainingCandidates = filterCandidatesWithWidth(comparison, value);
+    previousSnapshot.swap(currentSnapshot);
+    return remainingCandidates;
+}
+
+s64 MemorySearch::filterCandidatesWithWidth(Comparison comparison, u32 value)
+{
+    const u8* previous = previousSnapshot.data();
+    const u8* current = currentSnapshot.data();
+
+    switch (searchWidth)
+    {
+        case 1: return filterValuesWithComparison<u8>(previous, current, candidates, comparison, value);
+        case 2: return filterValuesWithComparison<u16>(previous, current, candidates, comparison, value);
+        case 4: return filterValuesWithComparison<u32>(previous, current, candidates, comparison, value);
+        default: return -1;
+    }
+}
+
+u32 MemorySearch::getResults(u32 maxResults, const u32** resultBuffer)
+{
+    std::lock_guard<std::mutex> lock(searchMutex);
+    results.clear();
+
+    for (size_t word = 0; word < candidates.size() && results.size() / 2 < maxResults; word++)
+    {
+        u64 candidateWord = candidates[word];
+        while (candidateWord != 0 && results.size() / 2 < maxResults)
+        {
+            size_t valueIndex = word * 64 + __builtin_ctzll(candidateWord);
+            candidateWord &= candidateWord - 1;
+
+            u32 value = 0;
+            memcpy(&value, previousSnapshot.data() + valueIndex * searchWidth, searchWidth);
+            results.push_back(MAIN_RAM_ADDRESS + (u32) (valueIndex * searchWidth));
+            results.push_back(value);
+        }
+    }
+
+    *resultBuffer = results.data();
+    return (u32) (results.size() / 2);
+}
+
+void MemorySearch::resetSearch()
+{
+    std::lock_guard<std::mutex> lock(searchMutex);
+    searchWidth = 0;
+
+    // Snapshots can take up to 16 MB each. Release the memory instead of keeping it around
+    std::vector<u8>().swap(previousSnapshot);
+    std::vector<u8>().swap(currentSnapshot);
+    std::vector<u64>().swap(candidates);
+    std::vector<u32>().swap(results);
+}
+
+bool MemorySearch::takeSnapshot(std::vector<u8>& snapshot)
+{
+    std::promise<bool> snapshotPromise;
+    std::future<bool> snapshotFuture = snapshotPromise.get_future();
+
+    bool scheduled = runAtFrameBoundary([&snapshot, &snapshotPromise] {
+        NDS* nds = NDS::Current;
+        if (nds == nullptr)
+        {
+            snapshotPromise.set_value(false);
+            return;
+        }
+
+        snapshot.resize(nds->MainRAMMask + 1);
+        memcpy(snapshot.data(), nds->MainRAM, snapshot.size());
+        snapshotPromise.set_value(true);
+    });
+
+    if (!scheduled)
+        return false;
+
+    return snapshotFuture.get();
+}
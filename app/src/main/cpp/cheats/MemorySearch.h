@@ -0,0 +1,66 @@
+#ifndef MELONDS_ANDROID_MEMORYSEARCH_H
+#define MELONDS_ANDROID_MEMORYSEARCH_H
+
+#include <mutex>
+#include <vector>
+#include "types.h"
+
+/**
+ * Searches the main RAM of the emulated console for values that match a sequence of comparisons, to help users find the addresses
+ * for their own cheats.
+ *
+ * Every pass snapshots main RAM at a frame boundary and compares it against the snapshot of the previous pass. The addresses that
+ * still match are kept in a bitmap with one bit per value, so memory use stays low even on DSi, and values that were already
+ * discarded are skipped 64 at a time.
+ */
+class MemorySearch
+{
+public:
+    // Must match the values in MelonMemorySearch.kt
+    enum Comparison : int
+    {
+        COMPARISON_EQUAL_TO_VALUE = 0,
+        COMPARISON_CHANGED = 1,
+        COMPARISON_UNCHANGED = 2,
+        COMPARISON_INCREASED = 3,
+        COMPARISON_DECREASED = 4,
+    };
+
+    static constexpr melonDS::u32 MAIN_RAM_ADDRESS = 0x02000000;
+
+    /**
+     * Starts a new search where every aligned value of the given width is a candidate.
+     * @param width The size of the values to search, in bytes. Must be 1, 2 or 4
+     * @return False if the emulator is not running or the width is not valid
+     */
+    bool startSearch(melonDS::u32 width);
+
+    /**
+     * Takes a new snapshot of main RAM and discards the candidates that don't match the given comparison.
+     * @param value The value to compare with, if the comparison needs one
+     * @return The number of remaining candidates, or -1 if the search could not be performed
+     */
+    melonDS::s64 filterCandidates(Comparison comparison, melonDS::u32 value);
+
+    /**
+     * Collects up to maxResults candidates as pairs of address and current value. The returned buffer remains valid until the next
+     * call to any other method.
+     * @return The number of results in the buffer
+     */
+    melonDS::u32 getResults(melonDS::u32 maxResults, const melonDS::u32** resultBuffer);
+
+    void resetSearch();
+
+private:
+    std::mutex searchMutex;
+    melonDS::u32 searchWidth = 0;
+    std::vector<melonDS::u8> previousSnapshot;
+    std::vector<melonDS::u8> currentSnapshot;
+    std::vector<melonDS::u64> candidates;
+    std::vector<melonDS::u32> results;
+
+    bool takeSnapshot(std::vector<melonDS::u8>& snapshot);
+    melonDS::s64 filterCandidatesWithWidth(Comparison comparison, melonDS::u32 value);
+};
+
+#endif //MELONDS_ANDROID_MEMORYSEARCH_H
@@ -0,0 +1,121 @@
+#include "MemoryWatch.h"
+#include <string.h>
+#include <NDS.h>
+#include "MemorySearch.h"
+#include "../FrameBoundaryTaskQueue.h"
+
+using namespace melonDS;
+
+u8* MemoryWatch::setWatchedRanges(const std::vector<WatchedRange>& ranges, u32* bufferSize)
+{
+    std::unique_ptr<WatchSet> watchSet = createWatchSet(ranges);
+    u8* buffer = nullptr;
+    if (watchSet)
+    {
+        *bufferSize = HEADER_SIZE + watchSet->valuesSize * 2;
+        buffer = watchSet->buffer.get();
+    }
+
+    // If the new ranges are not valid, the previous ones are still cleared, since their buffer is no longer used
+    auto* pendingWatchSet = watchSet.release();
+    bool scheduled = runAtFrameBoundary([this, pendingWatchSet] {
+        setActiveWatchSet(std::unique_ptr<WatchSet>(pendingWatchSet));
+    });
+
+    if (!scheduled)
+        setActiveWatchSet(std::unique_ptr<WatchSet>(pendingWatchSet));
+
+    return buffer;
+}
+
+std::unique_ptr<MemoryWatch::WatchSet> MemoryWatch::createWatchSet(const std::vector<WatchedRange>& ranges)
+{
+    if (ranges.empty())
+        return nullptr;
+
+    auto watchSet = std::make_unique<WatchSet>();
+    watchSet->ranges = ranges;
+    watchSet->valuesSize = 0;
+    watchSet->sequence = 0;
+
+    for (const WatchedRange& range : ranges)
+    {
+        // Only main RAM can be watched. Its mirrors are mapped to the main range when the values are copied
+        if ((range.address >> 24) != (MemorySearch::MAIN_RAM_ADDRESS >> 24) || range.size == 0 || range.size > MAX_WATCHED_BYTES)
+            return nullptr;
+
+        watchSet->rangeOffsets.push_back(watchSet->valuesSize);
+        watchSet->valuesSize += (range.size + 3) & ~3u;
+        if (watchSet->valuesSize > MAX_WATCHED_BYTES)
+            return nullptr;
+    }
+
+    u32 bufferSize = HEADER_SIZE + watchSet->valuesSize * 2;
+    watchSet->buffer = std::make_unique<u8[]>(bufferSize);
+    memset(watchSet->buffer.get(), 0, bufferSize);
+    return watchSet;
+}
+
+void MemoryWatch::setActiveWatchSet(std::unique_ptr<WatchSet> watchSet)
+{
+    activeWatchSet = std::move(watchSet);
+}
+
+void MemoryWatch::update()
+{
+    WatchSet* watchSet = activeWatchSet.get();
+    NDS* nds = NDS::Current;
+    if (watchSet == nullptr || nds == nullptr)
+        return;
+
+    u8* buffer = watchSet->buffer.get();
+    u32 backBufferIndex = __atomic_load_n((u32*) buffer, __ATOMIC_RELAXED) ^ 1;
+
+    // Readers that are still copying the back buffer from two frames ago see the odd sequence and retry
+    __atomic_store_n((u32*) (buffer + 4), ++watchSet->sequence, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    u8* backBuffer = buffer + HEADER_SIZE + backBufferIndex * watchSet->valuesSize;
+
+    u32 mainRamSize = nds->MainRAMMask + 1;
+    for (size_t i = 0; i < watchSet->ranges.size(); i++)
+    {
+        const WatchedRange& range = watchSet->ranges[i];
+        u8* destination = backBuffer + watchSet->rangeOffsets[i];
+        u32 start = range.address & nds->MainRAMMask;
+
+        if (start + range.size <= mainRamSize)
+        {
+            memcpy(destination, nds->MainRAM + start, range.size);
+        }
+        else
+        {
+            // The range wraps around the end of main RAM
+            for (u32 byte = 0; byte < range.size; byte++)
+                destination[byte] = nds->MainRAM[(start + byte) & nds->MainRAMMask];
+        }
+    }
+
+    __atomic_store_n((u32*) buffer, backBufferIndex, __ATOMIC_RELAXED);
+    __atomic_store_n((u32*) (buffer + 4), ++watchSet->sequence, __ATOMIC_RELEASE);
+}
+
+u32 MemoryWatch::readValues(const u8* buffer, u32 valuesSize, u32 valueOffset, u8* destination, u32 size)
+{
+    u32 sequence;
+    u32 endSequence;
+    do
+    {
+        sequence = __atomic_load_n((const u32*) (buffer + 4), __ATOMIC_ACQUIRE);
+        u32 frontBufferIndex = __atomic_load_n((const u32*) buffer, __ATOMIC_RELAXED);
+        memcpy(destination, buffer + HEADER_SIZE + frontBufferIndex * valuesSize + valueOffset, size);
+
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        endSequence = __atomic_load_n((const u32*) (buffer + 4), __ATOMIC_RELAXED);
+
+        // The front buffer is only written again once the frame after the next one starts being copied. That's two increments away
+        // from an even sequence, and one from an odd one, since the back buffer was already being written
+    }
+    while (endSequence - sequence > 2 - (sequence & 1));
+
+    return endSequence / 2;
+}
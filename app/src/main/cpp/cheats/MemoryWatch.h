@@ -0,0 +1,71 @@
+#ifndef MELONDS_ANDROID_MEMORYWATCH_H
+#define MELONDS_ANDROID_MEMORYWATCH_H
+
+#include <memory>
+#include <vector>
+#include "types.h"
+
+/**
+ * Copies a set of main RAM ranges into a buffer shared with Kotlin once per frame, so that the app can display live values without
+ * calling into native code for each of them.
+ *
+ * The buffer has the following layout, where the values of each range start at a 4-byte aligned offset:
+ *
+ * [u32 front buffer index][u32 sequence][buffer 0: range 0, range 1...][buffer 1: range 0, range 1...]
+ *
+ * The emulator thread always writes to the back buffer and then publishes it by updating the front buffer index. The sequence is
+ * odd while the back buffer is being written and is incremented again once it's published, so it's twice the number of published
+ * frames. Readers use it to detect a front buffer that was overwritten while they were copying it, which only happens when they
+ * take longer than a frame. Values must be read with readValues(), which retries in that case.
+ */
+class MemoryWatch
+{
+public:
+    struct WatchedRange
+    {
+        melonDS::u32 address;
+        melonDS::u32 size;
+    };
+
+    static constexpr melonDS::u32 HEADER_SIZE = 8;
+    static constexpr melonDS::u32 MAX_WATCHED_BYTES = 64 * 1024;
+
+    /**
+     * Replaces the watched ranges. The buffer of the previous ranges must not be accessed after this is called, since it is released
+     * at the next frame boundary.
+     * @return The buffer where the values of the new ranges are published, or null if the ranges are empty or not valid
+     */
+    melonDS::u8* setWatchedRanges(const std::vector<WatchedRange>& ranges, melonDS::u32* bufferSize);
+
+    /**
+     * Publishes the current values of the watched ranges. Must be called from the emulator thread, after a frame is emulated.
+     */
+    void update();
+
+    /**
+     * Copies the latest published values of a range out of a buffer returned by setWatchedRanges(). Can be called from any thread,
+     * as long as the buffer is still in use.
+     * @param valuesSize The size of each of the two value buffers
+     * @param valueOffset The offset of the range in each value buffer
+     * @return The number of frames that have been published since the ranges were set
+     */
+    static melonDS::u32 readValues(const melonDS::u8* buffer, melonDS::u32 valuesSize, melonDS::u32 valueOffset, melonDS::u8* destination, melonDS::u32 size);
+
+private:
+    struct WatchSet
+    {
+        std::vector<WatchedRange> ranges;
+        std::vector<melonDS::u32> rangeOffsets;
+        melonDS::u32 valuesSize;
+        std::unique_ptr<melonDS::u8[]> buffer;
+        melonDS::u32 sequence;
+    };
+
+    // Only accessed from the emulator thread, or while the emulator is not running
+    std::unique_ptr<WatchSet> activeWatchSet;
+
+    static std::unique_ptr<WatchSet> createWatchSet(const std::vector<WatchedRange>& ranges);
+    void setActiveWatchSet(std::unique_ptr<WatchSet> watchSet);
+};
+
+#endif //MELONDS_ANDROID_MEMORYWATCH_H
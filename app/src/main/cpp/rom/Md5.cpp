@@ -0,0 +1,144 @@
+#include "Md5.h"
+#include <algorithm>
+#include <string.h>
+
+using namespace melonDS;
+
+namespace
+{
+    constexpr u32 K[64] = {
+        0xD76AA478, 0xE8C7B756, 0x242070DB, 0xC1BDCEEE, 0xF57C0FAF, 0x4787C62A, 0xA8304613, 0xFD469501,
+        0x698098D8, 0x8B44F7AF, 0xFFFF5BB1, 0x895CD7BE, 0x6B901122, 0xFD987193, 0xA679438E, 0x49B40821,
+        0xF61E2562, 0xC040B340, 0x265E5A51, 0xE9B6C7AA, 0xD62F105D, 0x02441453, 0xD8A1E681, 0xE7D3FBC8,
+        0x21E1CDE6, 0xC33707D6, 0xF4D50D87, 0x455A14ED, 0xA9E3E905, 0xFCEFA3F8, 0x676F02D9, 0x8D2A4C8A,
+        0xFFFA3942, 0x8771F681, 0x6D9D6122, 0xFDE5380C, 0xA4BEEA44, 0x4BDECFA9, 0xF6BB4B60, 0xBEBFBC70,
+        0x289B7EC6, 0xEAA127FA, 0xD4EF3085, 0x04881D05, 0xD9D4D039, 0xE6DB99E5, 0x1FA27CF8, 0xC4AC5665,
+        0xF4292244, 0x432AFF97, 0xAB9423A7, 0xFC93A039, 0x655B59C3, 0x8F0CCC92, 0xFFEFF47D, 0x85845DD1,
+        0x6FA87E4F, 0xFE2CE6E0, 0xA3014314, 0x4E0811A1, 0xF7537E82, 0xBD3AF235, 0x2AD7D2BB, 0xEB86D391,
+    };
+
+    constexpr int SHIFTS[64] = {
+        7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22,
+        5, 9, 14, 20, 5, 9, 14, 20, 5, 9, 14, 20, 5, 9, 14, 20,
+        4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23,
+        6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21,
+    };
+
+    inline u32 rotl32(u32 x, int r)
+    {
+        return (x << r) | (x >> (32 - r));
+    }
+}
+
+Md5::Md5() : state { 0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476 }, totalLength(0), block {}, blockLength(0)
+{
+}
+
+void Md5::update(const u8* data, size_t length)
+{
+    totalLength += length;
+
+    if (blockLength > 0)
+    {
+        size_t toCopy = std::min(length, sizeof(block) - blockLength);
+        memcpy(block + blockLength, data, toCopy);
+        blockLength += toCopy;
+        data += toCopy;
+        length -= toCopy;
+
+        if (blockLength < sizeof(block))
+            return;
+
+        processBlock(block);
+        blockLength = 0;
+    }
+
+    while (length >= sizeof(block))
+    {
+        processBlock(data);
+        data += sizeof(block);
+        length -= sizeof(block);
+    }
+
+    memcpy(block, data, length);
+    blockLength = length;
+}
+
+std::string Md5::finish()
+{
+    u64 bitLength = totalLength * 8;
+
+    u8 padding[64] = { 0x80 };
+    size_t paddingLength = blockLength < 56 ? 56 - blockLength : 120 - blockLength;
+    update(padding, paddingLength);
+
+    u8 lengthData[8];
+    for (int i = 0; i < 8; i++)
+        lengthData[i] = (u8) (bitLength >> (i * 8));
+
+    update(lengthData, sizeof(lengthData));
+
+    static constexpr char HEX_DIGITS[] = "0123456789abcdef";
+    std::string hash;
+    hash.reserve(32);
+    for (u32 word : state)
+    {
+        for (int i = 0; i < 4; i++)
+        {
+            u8 byte = (u8) (word >> (i * 8));
+            hash.push_back(HEX_DIGITS[byte >> 4]);
+            hash.push_back(HEX_DIGITS[byte & 0xF]);
+        }
+    }
+
+    return hash;
+}
+
+void Md5::processBlock(const u8* data)
+{
+    u32 words[16];
+    for (int i = 0; i < 16; i++)
+        words[i] = data[i * 4] | (data[i * 4 + 1] << 8) | (data[i * 4 + 2] << 16) | ((u32) data[i * 4 + 3] << 24);
+
+    u32 a = state[0];
+    u32 b = state[1];
+    u32 c = state[2];
+    u32 d = state[3];
+
+    for (int i = 0; i < 64; i++)
+    {
+        u32 f;
+        int g;
+        if (i < 16)
+        {
+            f = (b & c) | (~b & d);
+            g = i;
+        }
+        else if (i < 32)
+        {
+            f = (d & b) | (~d & c);
+            g = (5 * i + 1) % 16;
+        }
+        else if (i < 48)
+        {
+            f = b ^ c ^ d;
+            g = (3 * i + 5) % 16;
+        }
+        else
+        {
+            f = c ^ (b | ~d);
+            g = (7 * i) % 16;
+        }
+
+        u32 temp = d;
+        d = c;
+        c = b;
+        b = b + rotl32(a + f + K[i] + words[g], SHIFTS[i]);
+        a = temp;
+    }
+
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+}
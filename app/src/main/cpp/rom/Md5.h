@@ -0,0 +1,32 @@
+#ifndef MELONDS_ANDROID_MD5_H
+#define MELONDS_ANDROID_MD5_H
+
+#include <stddef.h>
+#include <string>
+#include "types.h"
+
+/**
+ * Streaming MD5 (RFC 1321). Data can be fed in pieces of any size, so big inputs can be hashed without having them in memory at once.
+ */
+class Md5
+{
+public:
+    Md5();
+
+    void update(const melonDS::u8* data, size_t length);
+
+    /**
+     * Finishes the hash and returns it as a lowercase hex string. The object must not be updated afterwards.
+     */
+    std::string finish();
+
+private:
+    melonDS::u32 state[4];
+    melonDS::u64 totalLength;
+    melonDS::u8 block[64];
+    size_t blockLength;
+
+    void processBlock(const melonDS::u8* data);
+};
+
+#endif //MELONDS_ANDROID_MD5_H
@@ -0,0 +1,83 @@
+#include "RomBatchScanner.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <pthread.h>
+#include <thread>
+
+using namespace melonDS;
+
+namespace RomBatchScanner
+{
+    bool scanRoms(const std::vector<int>& fds, const ResultCallback& onResults)
+    {
+        std::atomic<u32> nextIndex = 0;
+        std::atomic_bool isCancelled = false;
+
+        std::mutex resultsMutex;
+        std::condition_variable resultsCondition;
+        std::vector<ScanResult> pendingResults;
+        u32 finishedWorkers = 0;
+
+        u32 workerCount = std::min<u32>({ MAX_WORKER_COUNT, std::max(1u, std::thread::hardware_concurrency()), (u32) fds.size() });
+        std::vector<std::thread> workers;
+        workers.reserve(workerCount);
+
+        for (u32 i = 0; i < workerCount; i++)
+        {
+            workers.emplace_back([&] {
+                for (;;)
+                {
+                    u32 index = nextIndex++;
+                    if (index >= fds.size() || isCancelled)
+                        break;
+
+                    auto metadata = std::make_unique<RomMetadataReader::RomMetadata>();
+                    if (!RomMetadataReader::readRomMetadata(fds[index], *metadata))
+                        metadata = nullptr;
+
+                    std::lock_guard<std::mutex> lock(resultsMutex);
+                    pendingResults.push_back(ScanResult { index, std::move(metadata) });
+                    if (pendingResults.size() >= RESULT_CHUNK_SIZE)
+                        resultsCondition.notify_one();
+                }
+
+                std::lock_guard<std::mutex> lock(resultsMutex);
+                finishedWorkers++;
+                resultsCondition.notify_one();
+            });
+            pthread_setname_np(workers.back().native_handle(), "RomScanner");
+        }
+
+        u32 scannedCount = 0;
+        std::vector<ScanResult> results;
+        for (;;)
+        {
+            bool isFinished;
+            {
+                std::unique_lock<std::mutex> lock(resultsMutex);
+                resultsCondition.wait(lock, [&] {
+                    return pendingResults.size() >= RESULT_CHUNK_SIZE || finishedWorkers == workerCount;
+                });
+
+                results.clear();
+                results.swap(pendingResults);
+                isFinished = finishedWorkers == workerCount;
+            }
+
+            // The callback runs without holding the lock, so workers keep scanning while the results are being consumed
+            scannedCount += results.size();
+            if (!results.empty() && !isCancelled && !onResults(results, scannedCount))
+                isCancelled = true;
+
+            if (isFinished)
+                break;
+        }
+
+        for (std::thread& worker : workers)
+            worker.join();
+
+        return !isCancelled;
+    }
+}
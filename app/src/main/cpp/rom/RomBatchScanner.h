@@ -0,0 +1,40 @@
+#ifndef MELONDS_ANDROID_ROMBATCHSCANNER_H
+#define MELONDS_ANDROID_ROMBATCHSCANNER_H
+
+#include <functional>
+#include <memory>
+#include <vector>
+#include "RomMetadataReader.h"
+#include "types.h"
+
+/**
+ * Reads the metadata of many ROMs in parallel. ROMs are processed by a small pool of worker threads, while results are handed to
+ * the caller in chunks on the thread that started the scan, so the caller can report progress and call into Java safely.
+ */
+namespace RomBatchScanner
+{
+    struct ScanResult
+    {
+        // Index of the ROM in the list of descriptors
+        melonDS::u32 index;
+        // Null if the file is not a valid ROM
+        std::unique_ptr<RomMetadataReader::RomMetadata> metadata;
+    };
+
+    /**
+     * Called with each chunk of results. Results are not in any particular order.
+     * @return False to cancel the scan. ROMs that are being processed when the scan is cancelled are discarded
+     */
+    using ResultCallback = std::function<bool(std::vector<ScanResult>& results, melonDS::u32 scannedCount)>;
+
+    static constexpr melonDS::u32 MAX_WORKER_COUNT = 4;
+    static constexpr melonDS::u32 RESULT_CHUNK_SIZE = 16;
+
+    /**
+     * Scans the ROMs in the given descriptors. Blocks until all ROMs have been scanned or the scan is cancelled.
+     * @return False if the scan was cancelled
+     */
+    bool scanRoms(const std::vector<int>& fds, const ResultCallback& onResults);
+}
+
+#endif //MELONDS_ANDROID_ROMBATCHSCANNER_H
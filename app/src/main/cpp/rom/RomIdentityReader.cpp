@@ -0,0 +1,94 @@
+#include "RomIdentityReader.h"
+#include <algorithm>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+#include <zlib.h>
+#include "../savestate/ChunkHash.h"
+
+using namespace melonDS;
+
+namespace RomIdentityReader
+{
+    static constexpr size_t HEADER_SIZE = 0x200;
+    static constexpr size_t HASHED_START_SIZE = 0x8000;
+    static constexpr size_t SAMPLE_SIZE = 0x1000;
+    static constexpr size_t SAMPLE_COUNT = 32;
+
+    static bool readFully(int fd, u8* buffer, size_t length, off64_t offset)
+    {
+        while (length > 0)
+        {
+            ssize_t bytesRead = pread64(fd, buffer, length, offset);
+            if (bytesRead <= 0)
+                return false;
+
+            buffer += bytesRead;
+            length -= bytesRead;
+            offset += bytesRead;
+        }
+
+        return true;
+    }
+
+    static bool hashContent(int fd, u64 fileSize, u64& contentHash)
+    {
+        // The size is hashed too, so that files that only differ in the parts that are not sampled are still told apart when their
+        // sizes differ
+        std::vector<u8> hashedData(sizeof(fileSize));
+        memcpy(hashedData.data(), &fileSize, sizeof(fileSize));
+
+        size_t sampledSize = HASHED_START_SIZE + SAMPLE_SIZE * (SAMPLE_COUNT + 1);
+        if (fileSize <= sampledSize)
+        {
+            hashedData.resize(hashedData.size() + fileSize);
+            if (!readFully(fd, hashedData.data() + sizeof(fileSize), fileSize, 0))
+                return false;
+        }
+        else
+        {
+            hashedData.resize(hashedData.size() + sampledSize);
+            u8* output = hashedData.data() + sizeof(fileSize);
+            if (!readFully(fd, output, HASHED_START_SIZE, 0))
+                return false;
+
+            output += HASHED_START_SIZE;
+            u64 sampleSpacing = (fileSize - HASHED_START_SIZE - SAMPLE_SIZE) / SAMPLE_COUNT;
+            for (size_t i = 0; i < SAMPLE_COUNT; i++)
+            {
+                if (!readFully(fd, output, SAMPLE_SIZE, HASHED_START_SIZE + i * sampleSpacing))
+                    return false;
+                output += SAMPLE_SIZE;
+            }
+
+            if (!readFully(fd, output, SAMPLE_SIZE, fileSize - SAMPLE_SIZE))
+                return false;
+        }
+
+        contentHash = ChunkHash::compute(hashedData.data(), hashedData.size()).low;
+        return true;
+    }
+
+    bool readRomIdentity(int fd, bool computeContentHash, RomIdentity& identity)
+    {
+        struct stat64 fileStat {};
+        if (fstat64(fd, &fileStat) != 0 || !S_ISREG(fileStat.st_mode))
+            return false;
+
+        identity.size = (u64) fileStat.st_size;
+        identity.contentHash = 0;
+
+        u8 header[HEADER_SIZE];
+        size_t headerSize = (size_t) std::min<u64>(identity.size, HEADER_SIZE);
+        if (!readFully(fd, header, headerSize, 0))
+            return false;
+
+        identity.headerCrc = (u32) crc32(0L, header, (uInt) headerSize);
+
+        if (computeContentHash)
+            return hashContent(fd, identity.size, identity.contentHash);
+
+        return true;
+    }
+}
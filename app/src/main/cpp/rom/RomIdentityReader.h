@@ -0,0 +1,29 @@
+#ifndef MELONDS_ANDROID_ROMIDENTITYREADER_H
+#define MELONDS_ANDROID_ROMIDENTITYREADER_H
+
+#include "types.h"
+
+/**
+ * Computes cheap fingerprints of ROM files, used by the ROM index to recognise files that have been moved without reading their
+ * metadata again. The content hash only covers the start and the end of the file and a fixed number of evenly spaced samples, so
+ * its cost doesn't depend on the size of the file. Matching hashes don't prove that two files are the same.
+ */
+namespace RomIdentityReader
+{
+    struct RomIdentity
+    {
+        melonDS::u64 size;
+        // CRC32 of the first 0x200 bytes of the file
+        melonDS::u32 headerCrc;
+        // Only valid if requested, since it needs more reads
+        melonDS::u64 contentHash;
+    };
+
+    /**
+     * Reads the identity of the file. The file offset of the descriptor is not modified.
+     * @return False if the file could not be read
+     */
+    bool readRomIdentity(int fd, bool computeContentHash, RomIdentity& identity);
+}
+
+#endif //MELONDS_ANDROID_ROMIDENTITYREADER_H
@@ -0,0 +1,181 @@
+#include "RomMetadataReader.h"
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+#include "Md5.h"
+#include "../RomIconBuilder.h"
+
+using namespace melonDS;
+
+namespace RomMetadataReader
+{
+    static constexpr size_t HASHED_HEADER_SIZE = 0x160;
+    static constexpr size_t BANNER_SIZE = 0xA00;
+    static constexpr size_t BANNER_ICON_END = 0x240;
+    static constexpr size_t READ_CHUNK_SIZE = 64 * 1024;
+    static constexpr u32 DSIWARE_CATEGORY = 0x00030004;
+
+    static u32 readU32(const u8* data, size_t offset)
+    {
+        return data[offset] | (data[offset + 1] << 8) | (data[offset + 2] << 16) | ((u32) data[offset + 3] << 24);
+    }
+
+    static bool readFully(int fd, u8* buffer, size_t length, off64_t offset)
+    {
+        while (length > 0)
+        {
+            ssize_t bytesRead = pread64(fd, buffer, length, offset);
+            if (bytesRead <= 0)
+                return false;
+
+            buffer += bytesRead;
+            length -= bytesRead;
+            offset += bytesRead;
+        }
+
+        return true;
+    }
+
+    static bool hashSection(int fd, off64_t offset, size_t length, Md5& md5, std::vector<u8>& buffer)
+    {
+        while (length > 0)
+        {
+            size_t chunkSize = std::min(length, buffer.size());
+            if (!readFully(fd, buffer.data(), chunkSize, offset))
+                return false;
+
+            md5.update(buffer.data(), chunkSize);
+            offset += chunkSize;
+            length -= chunkSize;
+        }
+
+        return true;
+    }
+
+    // Same as Kotlin's Char.isWhitespace(), so that names are the same as when they were read in Kotlin
+    static bool isWhitespace(char16_t c)
+    {
+        return (c >= 0x09 && c <= 0x0D) || (c >= 0x1C && c <= 0x20) || c == 0xA0 || c == 0x1680 || (c >= 0x2000 && c <= 0x200A)
+            || c == 0x2028 || c == 0x2029 || c == 0x202F || c == 0x205F || c == 0x3000;
+    }
+
+    /**
+     * The English title of the banner has the name of the game and the developer separated by a new line. The name itself can also
+     * span multiple lines.
+     */
+    static void parseBannerTitle(const u8* titleData, size_t titleLength, RomMetadata& metadata)
+    {
+        std::u16string titleString;
+        for (size_t i = 0; i < titleLength; i++)
+            titleString.push_back((char16_t) (titleData[i * 2] | (titleData[i * 2 + 1] << 8)));
+
+        size_t start = 0;
+        size_t end = titleString.size();
+        while (start < end && isWhitespace(titleString[start]))
+            start++;
+        while (end > start && isWhitespace(titleString[end - 1]))
+            end--;
+
+        std::u16string trimmedTitle;
+        for (size_t i = start; i < end; i++)
+        {
+            if (titleString[i] != u'\0')
+                trimmedTitle.push_back(titleString[i]);
+        }
+
+        size_t lastNewLine = trimmedTitle.rfind(u'\n');
+        if (lastNewLine == std::u16string::npos)
+        {
+            metadata.title = trimmedTitle;
+            metadata.developer = trimmedTitle;
+            return;
+        }
+
+        metadata.title = trimmedTitle.substr(0, lastNewLine);
+        for (char16_t& c : metadata.title)
+        {
+            if (c == u'\n')
+                c = u' ';
+        }
+        metadata.developer = trimmedTitle.substr(lastNewLine + 1);
+    }
+
+    static void buildIcon(const u8* banner, u32 (&icon)[32 * 32])
+    {
+        u8 iconData[512];
+        u16 palette[16];
+        memcpy(iconData, banner + 0x20, sizeof(iconData));
+        for (int i = 0; i < 16; i++)
+            palette[i] = banner[0x220 + i * 2] | (banner[0x220 + i * 2 + 1] << 8);
+
+        MelonDSAndroid::BuildRomIcon(iconData, palette, icon);
+    }
+
+    bool readRomMetadata(int fd, RomMetadata& metadata)
+    {
+        struct stat64 fileStat {};
+        if (fstat64(fd, &fileStat) != 0)
+            return false;
+
+        u64 fileSize = fileStat.st_size;
+
+        // The DSiWare category is stored in the extended header
+        u8 header[0x238];
+        if (fileSize < sizeof(header) || !readFully(fd, header, sizeof(header), 0))
+            return false;
+
+        u32 arm9Offset = readU32(header, 0x20);
+        u32 arm9Size = readU32(header, 0x2C);
+        u32 arm7Offset = readU32(header, 0x30);
+        u32 arm7Size = readU32(header, 0x3C);
+        u32 bannerOffset = readU32(header, 0x68);
+
+        // Anything that points outside of the file is not a valid ROM. Checking this first avoids hashing garbage sizes
+        if ((u64) arm9Offset + arm9Size > fileSize || (u64) arm7Offset + arm7Size > fileSize || (u64) bannerOffset + BANNER_SIZE > fileSize)
+            return false;
+
+        u8 banner[BANNER_SIZE];
+        if (!readFully(fd, banner, sizeof(banner), bannerOffset))
+            return false;
+
+        std::vector<u8> buffer(READ_CHUNK_SIZE);
+        Md5 md5;
+        md5.update(header, HASHED_HEADER_SIZE);
+        if (!hashSection(fd, arm9Offset, arm9Size, md5, buffer) || !hashSection(fd, arm7Offset, arm7Size, md5, buffer))
+            return false;
+
+        md5.update(banner, sizeof(banner));
+        metadata.retroAchievementsHash = md5.finish();
+
+        char cartCategory = (char) header[0x0C];
+        metadata.isDsiWareTitle = (cartCategory == 'H' || cartCategory == 'K') && readU32(header, 0x234) == DSIWARE_CATEGORY;
+
+        parseBannerTitle(banner + 0x340, 128, metadata);
+        buildIcon(banner, metadata.icon);
+        return true;
+    }
+
+    bool readRomIcon(int fd, u32 (&icon)[32 * 32])
+    {
+        struct stat64 fileStat {};
+        if (fstat64(fd, &fileStat) != 0)
+            return false;
+
+        u8 header[0x6C];
+        if ((u64) fileStat.st_size < sizeof(header) || !readFully(fd, header, sizeof(header), 0))
+            return false;
+
+        u32 bannerOffset = readU32(header, 0x68);
+        if ((u64) bannerOffset + BANNER_SIZE > (u64) fileStat.st_size)
+            return false;
+
+        // Only the banner parts up to the end of the palette are needed
+        u8 banner[BANNER_ICON_END];
+        if (!readFully(fd, banner, sizeof(banner), bannerOffset))
+            return false;
+
+        buildIcon(banner, icon);
+        return true;
+    }
+}
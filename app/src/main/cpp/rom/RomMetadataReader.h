@@ -0,0 +1,39 @@
+#ifndef MELONDS_ANDROID_ROMMETADATAREADER_H
+#define MELONDS_ANDROID_ROMMETADATAREADER_H
+
+#include <string>
+#include "types.h"
+
+/**
+ * Reads the metadata that the ROM list needs from an NDS ROM file. Only the sections that are needed are read, in small pieces, so
+ * scanning a big library doesn't allocate memory proportional to the size of the boot code of each ROM.
+ */
+namespace RomMetadataReader
+{
+    struct RomMetadata
+    {
+        std::u16string title;
+        std::u16string developer;
+        bool isDsiWareTitle;
+        // MD5 of the header, the ARM9 and ARM7 boot code and the banner, as computed by RetroAchievements
+        std::string retroAchievementsHash;
+        // RGBA8888
+        melonDS::u32 icon[32 * 32];
+    };
+
+    /**
+     * Reads the metadata of the ROM in the given file. The file offset of the descriptor is not modified.
+     * @return False if the file is not a valid ROM
+     */
+    bool readRomMetadata(int fd, RomMetadata& metadata);
+
+    /**
+     * Reads only the icon of the ROM in the given file, without hashing its boot code. The file offset of the descriptor is not
+     * modified.
+     * @param icon Where the icon is written to, as RGBA8888
+     * @return False if the file is not a valid ROM
+     */
+    bool readRomIcon(int fd, melonDS::u32 (&icon)[32 * 32]);
+}
+
+#endif //MELONDS_ANDROID_ROMMETADATAREADER_H
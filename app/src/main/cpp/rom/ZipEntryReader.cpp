@@ -0,0 +1,304 @@
+#include "ZipEntryReader.h"
+#include <algorithm>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+
+using namespace melonDS;
+
+namespace
+{
+    constexpr u32 END_OF_CENTRAL_DIRECTORY_SIGNATURE = 0x06054B50;
+    constexpr u32 CENTRAL_DIRECTORY_ENTRY_SIGNATURE = 0x02014B50;
+    constexpr u32 LOCAL_HEADER_SIGNATURE = 0x04034B50;
+    constexpr size_t END_OF_CENTRAL_DIRECTORY_SIZE = 22;
+    constexpr size_t CENTRAL_DIRECTORY_ENTRY_SIZE = 46;
+    constexpr size_t LOCAL_HEADER_SIZE = 30;
+    constexpr size_t MAX_COMMENT_SIZE = 0xFFFF;
+    // Archives bigger than 4 GB need ZIP64 records, which are not supported, but no ROM is that big
+    constexpr u32 ZIP64_MARKER = 0xFFFFFFFF;
+
+    u16 readU16(const u8* data)
+    {
+        return data[0] | (data[1] << 8);
+    }
+
+    u32 readU32(const u8* data)
+    {
+        return data[0] | (data[1] << 8) | (data[2] << 16) | ((u32) data[3] << 24);
+    }
+
+    bool readFully(int fd, u8* buffer, size_t length, off64_t offset)
+    {
+        while (length > 0)
+        {
+            ssize_t bytesRead = pread64(fd, buffer, length, offset);
+            if (bytesRead <= 0)
+                return false;
+
+            buffer += bytesRead;
+            length -= bytesRead;
+            offset += bytesRead;
+        }
+
+        return true;
+    }
+
+    bool isRomFileName(const char* name, size_t length)
+    {
+        if (length == 0 || name[length - 1] == '/')
+            return false;
+
+        const char* extensions[] = { ".nds", ".dsi", ".ids" };
+        for (const char* extension : extensions)
+        {
+            size_t extensionLength = strlen(extension);
+            if (length > extensionLength && strncasecmp(name + length - extensionLength, extension, extensionLength) == 0)
+                return true;
+        }
+
+        return false;
+    }
+}
+
+std::unique_ptr<ZipEntryReader> ZipEntryReader::open(int fd)
+{
+    off64_t fileSize = lseek64(fd, 0, SEEK_END);
+    if (fileSize < (off64_t) END_OF_CENTRAL_DIRECTORY_SIZE)
+    {
+        close(fd);
+        return nullptr;
+    }
+
+    // The end of central directory record is at the end of the archive, followed by a comment of unknown size
+    size_t tailSize = (size_t) std::min<off64_t>(fileSize, END_OF_CENTRAL_DIRECTORY_SIZE + MAX_COMMENT_SIZE);
+    std::vector<u8> tail(tailSize);
+    if (!readFully(fd, tail.data(), tailSize, fileSize - tailSize))
+    {
+        close(fd);
+        return nullptr;
+    }
+
+    const u8* endOfCentralDirectory = nullptr;
+    for (size_t i = tailSize - END_OF_CENTRAL_DIRECTORY_SIZE + 1; i-- > 0;)
+    {
+        if (readU32(&tail[i]) == END_OF_CENTRAL_DIRECTORY_SIGNATURE)
+        {
+            endOfCentralDirectory = &tail[i];
+            break;
+        }
+    }
+
+    if (!endOfCentralDirectory || readU32(endOfCentralDirectory + 16) == ZIP64_MARKER)
+    {
+        close(fd);
+        return nullptr;
+    }
+
+    u32 centralDirectorySize = readU32(endOfCentralDirectory + 12);
+    u32 centralDirectoryOffset = readU32(endOfCentralDirectory + 16);
+    std::vector<u8> centralDirectory(centralDirectorySize);
+    if ((off64_t) centralDirectoryOffset + centralDirectorySize > fileSize || !readFully(fd, centralDirectory.data(), centralDirectorySize, centralDirectoryOffset))
+    {
+        close(fd);
+        return nullptr;
+    }
+
+    size_t position = 0;
+    while (position + CENTRAL_DIRECTORY_ENTRY_SIZE <= centralDirectory.size())
+    {
+        const u8* entry = &centralDirectory[position];
+        if (readU32(entry) != CENTRAL_DIRECTORY_ENTRY_SIGNATURE)
+            break;
+
+        u16 method = readU16(entry + 10);
+        u32 compressedSize = readU32(entry + 20);
+        u32 uncompressedSize = readU32(entry + 24);
+        u16 nameLength = readU16(entry + 28);
+        u16 extraLength = readU16(entry + 30);
+        u16 commentLength = readU16(entry + 32);
+        u32 localHeaderOffset = readU32(entry + 42);
+        if (position + CENTRAL_DIRECTORY_ENTRY_SIZE + nameLength > centralDirectory.size())
+            break;
+
+        if (isRomFileName((const char*) entry + CENTRAL_DIRECTORY_ENTRY_SIZE, nameLength))
+        {
+            bool isSupported = (method == METHOD_STORED || method == METHOD_DEFLATED) && compressedSize != ZIP64_MARKER && uncompressedSize != ZIP64_MARKER;
+
+            // The sizes of the name and the extra field in the local header can differ from the ones in the central directory
+            u8 localHeader[LOCAL_HEADER_SIZE];
+            if (!isSupported || !readFully(fd, localHeader, LOCAL_HEADER_SIZE, localHeaderOffset) || readU32(localHeader) != LOCAL_HEADER_SIGNATURE)
+                break;
+
+            u64 dataOffset = (u64) localHeaderOffset + LOCAL_HEADER_SIZE + readU16(localHeader + 26) + readU16(localHeader + 28);
+            if (dataOffset + compressedSize > (u64) fileSize)
+                break;
+
+            return std::unique_ptr<ZipEntryReader>(new ZipEntryReader(fd, method, dataOffset, compressedSize, uncompressedSize));
+        }
+
+        position += CENTRAL_DIRECTORY_ENTRY_SIZE + nameLength + extraLength + commentLength;
+    }
+
+    close(fd);
+    return nullptr;
+}
+
+ZipEntryReader::ZipEntryReader(int fd, u16 method, u64 dataOffset, u64 compressedSize, u64 uncompressedSize) :
+    fd(fd),
+    method(method),
+    dataOffset(dataOffset),
+    compressedSize(compressedSize),
+    uncompressedSize(uncompressedSize)
+{
+}
+
+ZipEntryReader::~ZipEntryReader()
+{
+    endStream();
+    close(fd);
+}
+
+ssize_t ZipEntryReader::read(u8* buffer, u64 offset, size_t length)
+{
+    if (offset >= uncompressedSize)
+        return 0;
+
+    length = (size_t) std::min<u64>(length, uncompressedSize - offset);
+    if (method == METHOD_STORED)
+        return readFully(fd, buffer, length, dataOffset + offset) ? (ssize_t) length : -1;
+
+    std::lock_guard<std::mutex> lock(readMutex);
+
+    // Go back to a checkpoint if the offset is behind the current position, or if there is a checkpoint closer to the offset than
+    // the current position. Otherwise, keep decompressing from where the previous read ended
+    auto checkpoint = std::upper_bound(checkpoints.begin(), checkpoints.end(), offset, [](u64 offset, const Checkpoint& checkpoint) {
+        return offset < checkpoint.outputOffset;
+    });
+    u64 restartOffset = checkpoint == checkpoints.begin() ? 0 : (checkpoint - 1)->outputOffset;
+    if (!isStreamActive || offset < streamOutputOffset || restartOffset > streamOutputOffset)
+    {
+        if (!restartStream(restartOffset))
+            return -1;
+    }
+
+    if (skipBuffer.empty())
+        skipBuffer.resize(INPUT_BUFFER_SIZE);
+
+    while (streamOutputOffset < offset)
+    {
+        size_t skipLength = (size_t) std::min<u64>(skipBuffer.size(), offset - streamOutputOffset);
+        if (!inflateTo(skipBuffer.data(), skipLength))
+        {
+            endStream();
+            return -1;
+        }
+    }
+
+    if (!inflateTo(buffer, length))
+    {
+        endStream();
+        return -1;
+    }
+
+    return (ssize_t) length;
+}
+
+bool ZipEntryReader::restartStream(u64 offset)
+{
+    endStream();
+
+    stream = {};
+    if (inflateInit2(&stream, -MAX_WBITS) != Z_OK)
+        return false;
+
+    isStreamActive = true;
+    streamOutputOffset = 0;
+    streamInputOffset = 0;
+    if (inputBuffer.empty())
+        inputBuffer.resize(INPUT_BUFFER_SIZE);
+
+    if (offset == 0)
+        return true;
+
+    auto checkpoint = std::find_if(checkpoints.begin(), checkpoints.end(), [offset](const Checkpoint& checkpoint) {
+        return checkpoint.outputOffset == offset;
+    });
+    if (checkpoint == checkpoints.end())
+        return false;
+
+    streamOutputOffset = checkpoint->outputOffset;
+    streamInputOffset = checkpoint->inputOffset;
+    if (checkpoint->bits != 0)
+    {
+        u8 partialByte;
+        if (!readFully(fd, &partialByte, 1, dataOffset + checkpoint->inputOffset - 1))
+            return false;
+
+        inflatePrime(&stream, checkpoint->bits, partialByte >> (8 - checkpoint->bits));
+    }
+
+    return inflateSetDictionary(&stream, checkpoint->window.get(), WINDOW_SIZE) == Z_OK;
+}
+
+bool ZipEntryReader::inflateTo(u8* output, size_t length)
+{
+    stream.next_out = output;
+    stream.avail_out = (uInt) length;
+
+    while (stream.avail_out > 0)
+    {
+        if (stream.avail_in == 0)
+        {
+            size_t inputLength = (size_t) std::min<u64>(inputBuffer.size(), compressedSize - streamInputOffset);
+            if (inputLength == 0 || !readFully(fd, inputBuffer.data(), inputLength, dataOffset + streamInputOffset))
+                return false;
+
+            stream.next_in = inputBuffer.data();
+            stream.avail_in = (uInt) inputLength;
+            streamInputOffset += inputLength;
+        }
+
+        uInt availableOutput = stream.avail_out;
+        // Stop at the end of each deflate block, since checkpoints can only be created there
+        int result = inflate(&stream, Z_BLOCK);
+        streamOutputOffset += availableOutput - stream.avail_out;
+
+        if (result == Z_STREAM_END)
+            return stream.avail_out == 0;
+        if (result != Z_OK && result != Z_BUF_ERROR)
+            return false;
+
+        bool isAtBlockBoundary = (stream.data_type & 128) && !(stream.data_type & 64);
+        u64 lastCheckpointOffset = checkpoints.empty() ? 0 : checkpoints.back().outputOffset;
+        if (isAtBlockBoundary && streamOutputOffset >= lastCheckpointOffset + CHECKPOINT_SPAN)
+            addCheckpoint();
+    }
+
+    return true;
+}
+
+void ZipEntryReader::endStream()
+{
+    if (isStreamActive)
+    {
+        inflateEnd(&stream);
+        isStreamActive = false;
+    }
+}
+
+void ZipEntryReader::addCheckpoint()
+{
+    Checkpoint checkpoint {
+        .outputOffset = streamOutputOffset,
+        .inputOffset = streamInputOffset - stream.avail_in,
+        .bits = stream.data_type & 7,
+        .window = std::make_unique<u8[]>(WINDOW_SIZE),
+    };
+
+    uInt windowLength = WINDOW_SIZE;
+    if (inflateGetDictionary(&stream, checkpoint.window.get(), &windowLength) != Z_OK || windowLength != WINDOW_SIZE)
+        return;
+
+    checkpoints.push_back(std::move(checkpoint));
+}
@@ -0,0 +1,78 @@
+#ifndef MELONDS_ANDROID_ZIPENTRYREADER_H
+#define MELONDS_ANDROID_ZIPENTRYREADER_H
+
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <zlib.h>
+#include "types.h"
+
+/**
+ * Random access reader for the NDS ROM inside a ZIP archive, which allows running zipped ROMs without extracting them first.
+ *
+ * Stored entries are read directly at their offset in the archive. Deflated entries are decompressed on demand, and checkpoints of
+ * the decompressor state are recorded every CHECKPOINT_SPAN bytes of output as the entry is decompressed (like zlib's zran example),
+ * so that reading at any offset only needs to decompress from the closest checkpoint. Sequential reads continue the current
+ * decompression without going back to a checkpoint.
+ */
+class ZipEntryReader
+{
+public:
+    /**
+     * Opens the first NDS ROM in the archive. The reader takes ownership of the file descriptor, even if opening fails.
+     * @return Null if the archive doesn't contain a ROM, or if the ROM uses a compression method that is not supported
+     */
+    static std::unique_ptr<ZipEntryReader> open(int fd);
+
+    ~ZipEntryReader();
+
+    melonDS::u64 getSize() const { return uncompressedSize; }
+
+    /**
+     * Reads up to [length] bytes of the ROM at the given offset.
+     * @return The number of bytes read, which is only less than [length] at the end of the ROM, or -1 if the archive is corrupted
+     */
+    ssize_t read(melonDS::u8* buffer, melonDS::u64 offset, size_t length);
+
+private:
+    static constexpr melonDS::u64 CHECKPOINT_SPAN = 4 * 1024 * 1024;
+    static constexpr size_t WINDOW_SIZE = 32 * 1024;
+    static constexpr size_t INPUT_BUFFER_SIZE = 64 * 1024;
+
+    static constexpr melonDS::u16 METHOD_STORED = 0;
+    static constexpr melonDS::u16 METHOD_DEFLATED = 8;
+
+    struct Checkpoint
+    {
+        melonDS::u64 outputOffset;
+        // Offset of the first compressed byte that has not been fully consumed
+        melonDS::u64 inputOffset;
+        // Number of bits of the previous byte that still have to be consumed
+        int bits;
+        std::unique_ptr<melonDS::u8[]> window;
+    };
+
+    int fd;
+    melonDS::u16 method;
+    melonDS::u64 dataOffset;
+    melonDS::u64 compressedSize;
+    melonDS::u64 uncompressedSize;
+
+    std::mutex readMutex;
+    std::vector<Checkpoint> checkpoints;
+    z_stream stream {};
+    bool isStreamActive = false;
+    melonDS::u64 streamOutputOffset = 0;
+    melonDS::u64 streamInputOffset = 0;
+    std::vector<melonDS::u8> inputBuffer;
+    std::vector<melonDS::u8> skipBuffer;
+
+    ZipEntryReader(int fd, melonDS::u16 method, melonDS::u64 dataOffset, melonDS::u64 compressedSize, melonDS::u64 uncompressedSize);
+
+    bool restartStream(melonDS::u64 offset);
+    void endStream();
+    bool inflateTo(melonDS::u8* output, size_t length);
+    void addCheckpoint();
+};
+
+#endif //MELONDS_ANDROID_ZIPENTRYREADER_H
@@ -0,0 +1,97 @@
+#include "ZipRomFileStore.h"
+#include <string.h>
+
+using namespace melonDS;
+
+namespace
+{
+    struct ZipRomFileCookie
+    {
+        std::shared_ptr<ZipEntryReader> reader;
+        u64 position;
+    };
+
+    int readZipRomFile(void* cookie, char* buffer, int size)
+    {
+        auto file = (ZipRomFileCookie*) cookie;
+        ssize_t bytesRead = file->reader->read((u8*) buffer, file->position, (size_t) size);
+        if (bytesRead > 0)
+            file->position += bytesRead;
+
+        return (int) bytesRead;
+    }
+
+    fpos_t seekZipRomFile(void* cookie, fpos_t offset, int whence)
+    {
+        auto file = (ZipRomFileCookie*) cookie;
+        fpos_t newPosition;
+        switch (whence)
+        {
+            case SEEK_SET:
+                newPosition = offset;
+                break;
+            case SEEK_CUR:
+                newPosition = (fpos_t) file->position + offset;
+                break;
+            case SEEK_END:
+                newPosition = (fpos_t) file->reader->getSize() + offset;
+                break;
+            default:
+                return -1;
+        }
+
+        if (newPosition < 0)
+            return -1;
+
+        file->position = (u64) newPosition;
+        return newPosition;
+    }
+
+    int closeZipRomFile(void* cookie)
+    {
+        delete (ZipRomFileCookie*) cookie;
+        return 0;
+    }
+}
+
+bool ZipRomFileStore::isZipRomFile(const char* path)
+{
+    return path != nullptr && strncmp(path, ZIP_ROM_SCHEME, strlen(ZIP_ROM_SCHEME)) == 0;
+}
+
+FILE* ZipRomFileStore::open(const char* path, const std::function<int(const char*)>& openArchive)
+{
+    std::string archivePath = path + strlen(ZIP_ROM_SCHEME);
+    std::shared_ptr<ZipEntryReader> reader;
+    {
+        std::lock_guard<std::mutex> lock(readerMutex);
+        if (currentReader && currentArchivePath == archivePath)
+        {
+            reader = currentReader;
+        }
+        else
+        {
+            int fd = openArchive(archivePath.c_str());
+            if (fd == -1)
+                return nullptr;
+
+            reader = ZipEntryReader::open(fd);
+            if (!reader)
+                return nullptr;
+
+            currentArchivePath = archivePath;
+            currentReader = reader;
+        }
+    }
+
+    auto cookie = new ZipRomFileCookie {
+        .reader = std::move(reader),
+        .position = 0,
+    };
+
+    FILE* romFile = funopen(cookie, readZipRomFile, nullptr, seekZipRomFile, closeZipRomFile);
+    if (!romFile)
+        delete cookie;
+
+    return romFile;
+}
@@ -0,0 +1,36 @@
+#ifndef MELONDS_ANDROID_ZIPROMFILESTORE_H
+#define MELONDS_ANDROID_ZIPROMFILESTORE_H
+
+#include <stdio.h>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include "ZipEntryReader.h"
+
+/**
+ * Opens the ROMs inside ZIP archives as regular files, so that the core can read them through the Platform file API without them
+ * being extracted first. ROMs are referenced by the path of their archive prefixed with ZIP_ROM_SCHEME.
+ */
+class ZipRomFileStore
+{
+public:
+    static bool isZipRomFile(const char* path);
+
+    /**
+     * Opens the ROM in the archive referenced by the given path for reading. The reader of the last opened archive is kept, so that
+     * the decompression checkpoints built while reading it are reused when the core opens the same ROM again.
+     * @param openArchive Opens the archive at the given path for reading and returns its file descriptor, or -1 on failure
+     */
+    FILE* open(const char* path, const std::function<int(const char*)>& openArchive);
+
+private:
+    // Must match the scheme used in MelonZipRomReader.kt
+    static constexpr const char* ZIP_ROM_SCHEME = "ziprom:";
+
+    std::string currentArchivePath;
+    std::shared_ptr<ZipEntryReader> currentReader;
+    std::mutex readerMutex;
+};
+
+#endif //MELONDS_ANDROID_ZIPROMFILESTORE_H
@@ -0,0 +1,88 @@
+#include "ChunkHash.h"
+#include <string.h>
+
+using namespace melonDS;
+
+namespace
+{
+    inline u64 rotl64(u64 x, int r)
+    {
+        return (x << r) | (x >> (64 - r));
+    }
+
+    inline u64 fmix64(u64 k)
+    {
+        k ^= k >> 33;
+        k *= 0xFF51AFD7ED558CCDULL;
+        k ^= k >> 33;
+        k *= 0xC4CEB9FE1A85EC53ULL;
+        k ^= k >> 33;
+        return k;
+    }
+}
+
+ChunkHash ChunkHash::compute(const u8* data, size_t length)
+{
+    constexpr u64 c1 = 0x87C37B91114253D5ULL;
+    constexpr u64 c2 = 0x4CF5AD432745937FULL;
+
+    const size_t blockCount = length / 16;
+    u64 h1 = 0;
+    u64 h2 = 0;
+
+    for (size_t i = 0; i < blockCount; i++)
+    {
+        u64 k1;
+        u64 k2;
+        memcpy(&k1, data + i * 16, sizeof(k1));
+        memcpy(&k2, data + i * 16 + 8, sizeof(k2));
+
+        k1 *= c1; k1 = rotl64(k1, 31); k1 *= c2; h1 ^= k1;
+        h1 = rotl64(h1, 27); h1 += h2; h1 = h1 * 5 + 0x52DCE729;
+
+        k2 *= c2; k2 = rotl64(k2, 33); k2 *= c1; h2 ^= k2;
+        h2 = rotl64(h2, 31); h2 += h1; h2 = h2 * 5 + 0x38495AB5;
+    }
+
+    const u8* tail = data + blockCount * 16;
+    u64 k1 = 0;
+    u64 k2 = 0;
+
+    switch (length & 15)
+    {
+        case 15: k2 ^= ((u64) tail[14]) << 48; [[fallthrough]];
+        case 14: k2 ^= ((u64) tail[13]) << 40; [[fallthrough]];
+        case 13: k2 ^= ((u64) tail[12]) << 32; [[fallthrough]];
+        case 12: k2 ^= ((u64) tail[11]) << 24; [[fallthrough]];
+        case 11: k2 ^= ((u64) tail[10]) << 16; [[fallthrough]];
+        case 10: k2 ^= ((u64) tail[9]) << 8; [[fallthrough]];
+        case 9:
+            k2 ^= ((u64) tail[8]);
+            k2 *= c2; k2 = rotl64(k2, 33); k2 *= c1; h2 ^= k2;
+            [[fallthrough]];
+        case 8: k1 ^= ((u64) tail[7]) << 56; [[fallthrough]];
+        case 7: k1 ^= ((u64) tail[6]) << 48; [[fallthrough]];
+        case 6: k1 ^= ((u64) tail[5]) << 40; [[fallthrough]];
+        case 5: k1 ^= ((u64) tail[4]) << 32; [[fallthrough]];
+        case 4: k1 ^= ((u64) tail[3]) << 24; [[fallthrough]];
+        case 3: k1 ^= ((u64) tail[2]) << 16; [[fallthrough]];
+        case 2: k1 ^= ((u64) tail[1]) << 8; [[fallthrough]];
+        case 1:
+            k1 ^= ((u64) tail[0]);
+            k1 *= c1; k1 = rotl64(k1, 31); k1 *= c2; h1 ^= k1;
+    }
+
+    h1 ^= length;
+    h2 ^= length;
+
+    h1 += h2;
+    h2 += h1;
+
+    h1 = fmix64(h1);
+    h2 = fmix64(h2);
+
+    h1 += h2;
+    h2 += h1;
+
+    return ChunkHash { .low = h1, .high = h2 };
+}
@@ -0,0 +1,40 @@
+#ifndef MELONDS_ANDROID_CHUNKHASH_H
+#define MELONDS_ANDROID_CHUNKHASH_H
+
+#include <functional>
+#include <stddef.h>
+#include "types.h"
+
+/**
+ * 128-bit hash that identifies the contents of a save state chunk. Computed with MurmurHash3 (x64, 128-bit variant), which is fast
+ * enough to hash a whole state on every save and wide enough for accidental collisions to be a non-issue.
+ */
+struct ChunkHash
+{
+    melonDS::u64 low;
+    melonDS::u64 high;
+
+    static ChunkHash compute(const melonDS::u8* data, size_t length);
+
+    bool operator==(const ChunkHash& other) const
+    {
+        return low == other.low && high == other.high;
+    }
+};
+
+static_assert(sizeof(ChunkHash) == 16, "Chunk hashes are stored as they are in save state files");
+
+namespace std
+{
+    template<>
+    struct hash<ChunkHash>
+    {
+        size_t operator()(const ChunkHash& hash) const
+        {
+            // The hash is already uniformly distributed
+            return (size_t) hash.low;
+        }
+    };
+}
+
+#endif //MELONDS_ANDROID_CHUNKHASH_H
@@ -0,0 +1,87 @@
+#include "SaveStateCache.h"
+
+SaveStateCache::SaveStateCache(size_t maxSize) : maxSize(maxSize)
+{
+}
+
+void SaveStateCache::put(const std::string& path, const std::string& romHash, std::shared_ptr<std::vector<melonDS::u8>> state, melonDS::u64 frameCount)
+{
+    std::lock_guard<std::mutex> lock(cacheMutex);
+
+    auto existingEntry = entriesByPath.find(path);
+    if (existingEntry != entriesByPath.end())
+        removeEntry(existingEntry->second);
+
+    size_t stateSize = state->size();
+    if (stateSize > maxSize)
+        return;
+
+    evictUntilSize(maxSize - stateSize);
+
+    entries.push_front(Entry {
+        .path = path,
+        .romHash = romHash,
+        .cachedState = {
+            .state = std::move(state),
+            .frameCount = frameCount,
+        },
+    });
+    entriesByPath[path] = entries.begin();
+    currentSize += stateSize;
+}
+
+bool SaveStateCache::get(const std::string& path, const std::string& romHash, CachedState& cachedState)
+{
+    std::lock_guard<std::mutex> lock(cacheMutex);
+
+    auto entry = entriesByPath.find(path);
+    if (entry == entriesByPath.end() || entry->second->romHash != romHash)
+        return false;
+
+    // Move the entry to the front of the list to mark it as the most recently used
+    entries.splice(entries.begin(), entries, entry->second);
+    cachedState = entry->second->cachedState;
+    return true;
+}
+
+void SaveStateCache::remove(const std::string& path, const std::shared_ptr<std::vector<melonDS::u8>>& state)
+{
+    std::lock_guard<std::mutex> lock(cacheMutex);
+
+    auto entry = entriesByPath.find(path);
+    if (entry != entriesByPath.end() && entry->second->cachedState.state == state)
+        removeEntry(entry->second);
+}
+
+void SaveStateCache::remove(const std::string& path)
+{
+    std::lock_guard<std::mutex> lock(cacheMutex);
+
+    auto entry = entriesByPath.find(path);
+    if (entry != entriesByPath.end())
+        removeEntry(entry->second);
+}
+
+void SaveStateCache::trimToSize(size_t size)
+{
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    evictUntilSize(size);
+}
+
+size_t SaveStateCache::getMaxSize() const
+{
+    return maxSize;
+}
+
+void SaveStateCache::removeEntry(std::list<Entry>::iterator entry)
+{
+    currentSize -= entry->cachedState.state->size();
+    entriesByPath.erase(entry->path);
+    entries.erase(entry);
+}
+
+void SaveStateCache::evictUntilSize(size_t size)
+{
+    while (currentSize > size && !entries.empty())
+        removeEntry(std::prev(entries.end()));
+}
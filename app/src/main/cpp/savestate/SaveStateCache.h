@@ -0,0 +1,68 @@
+#ifndef MELONDS_ANDROID_SAVESTATECACHE_H
+#define MELONDS_ANDROID_SAVESTATECACHE_H
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "types.h"
+
+/**
+ * Bounded LRU cache of uncompressed save states, keyed by the path of the state and the hash of the ROM it belongs to. States are
+ * added when they are saved or loaded, so that loading a slot that was recently used does not need to read and decompress it
+ * from storage. The cache is write-through: the state on storage is always written, the cache only avoids reading it back.
+ */
+class SaveStateCache
+{
+public:
+    struct CachedState
+    {
+        std::shared_ptr<std::vector<melonDS::u8>> state;
+        melonDS::u64 frameCount;
+    };
+
+    explicit SaveStateCache(size_t maxSize);
+
+    void put(const std::string& path, const std::string& romHash, std::shared_ptr<std::vector<melonDS::u8>> state, melonDS::u64 frameCount);
+    bool get(const std::string& path, const std::string& romHash, CachedState& cachedState);
+
+    /**
+     * Removes the state cached for the given path, but only if it is the given state. Used to discard states whose write failed
+     * without discarding a newer state for the same path.
+     */
+    void remove(const std::string& path, const std::shared_ptr<std::vector<melonDS::u8>>& state);
+
+    /**
+     * Removes the state cached for the given path, if any. Must be called when the state is deleted, since the cache would still
+     * serve it otherwise.
+     */
+    void remove(const std::string& path);
+
+    /**
+     * Evicts the least recently used states until the cache uses at most the given amount of memory.
+     */
+    void trimToSize(size_t size);
+    size_t getMaxSize() const;
+
+private:
+    struct Entry
+    {
+        std::string path;
+        std::string romHash;
+        CachedState cachedState;
+    };
+
+    size_t maxSize;
+    size_t currentSize = 0;
+    // Most recently used entries are at the front
+    std::list<Entry> entries;
+    std::unordered_map<std::string, std::list<Entry>::iterator> entriesByPath;
+    std::mutex cacheMutex;
+
+    void removeEntry(std::list<Entry>::iterator entry);
+    void evictUntilSize(size_t size);
+};
+
+#endif //MELONDS_ANDROID_SAVESTATECACHE_H
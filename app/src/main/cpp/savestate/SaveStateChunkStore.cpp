@@ -0,0 +1,528 @@
+#include "SaveStateChunkStore.h"
+#include <string.h>
+#include <unistd.h>
+#include <zlib.h>
+#include <MelonDS.h>
+#include "SaveStateFormat.h"
+#include "Platform.h"
+
+using namespace melonDS::Platform;
+
+bool SaveStateChunkStore::storeState(const std::string& storePath, const std::vector<melonDS::u8>& state, std::vector<ChunkHash>& chunkHashes, const std::function<void(size_t)>& onProgress)
+{
+    chunkHashes.clear();
+    chunkHashes.reserve((state.size() + CHUNK_SIZE - 1) / CHUNK_SIZE);
+    for (size_t offset = 0; offset < state.size(); offset += CHUNK_SIZE)
+    {
+        size_t chunkSize = std::min((size_t) CHUNK_SIZE, state.size() - offset);
+        chunkHashes.push_back(ChunkHash::compute(state.data() + offset, chunkSize));
+    }
+
+    std::lock_guard<std::mutex> lock(storeMutex);
+
+    pinnedChunks[storePath].insert(chunkHashes.begin(), chunkHashes.end());
+
+    auto retainedChunks = compactionRetainedChunks.find(storePath);
+    if (retainedChunks != compactionRetainedChunks.end())
+        retainedChunks->second.insert(chunkHashes.begin(), chunkHashes.end());
+
+    StoreIndex* index = getIndex(storePath);
+    if (!index)
+        return false;
+
+    bool hasNewChunks = false;
+    for (const ChunkHash& hash : chunkHashes)
+    {
+        if (index->chunks.find(hash) == index->chunks.end())
+        {
+            hasNewChunks = true;
+            break;
+        }
+    }
+
+    if (!hasNewChunks)
+        return true;
+
+    FILE* file = MelonDSAndroid::fileHandler->open(storePath.c_str(), FileMode::ReadWriteExisting);
+    if (!file)
+        return false;
+
+    bool result = appendChunks(file, *index, state, chunkHashes, onProgress);
+    if (fclose(file) != 0)
+        result = false;
+
+    if (!result)
+    {
+        // The store may have been partially updated. Read it again next time it is used
+        indices.erase(storePath);
+        Log(LogLevel::Error, "Failed to write save state chunks\n");
+    }
+
+    return result;
+}
+
+void SaveStateChunkStore::unpinChunks(const std::string& storePath, const std::vector<ChunkHash>& chunkHashes)
+{
+    std::lock_guard<std::mutex> lock(storeMutex);
+
+    auto storePinnedChunks = pinnedChunks.find(storePath);
+    if (storePinnedChunks == pinnedChunks.end())
+        return;
+
+    for (const ChunkHash& hash : chunkHashes)
+    {
+        auto pinnedChunk = storePinnedChunks->second.find(hash);
+        if (pinnedChunk != storePinnedChunks->second.end())
+            storePinnedChunks->second.erase(pinnedChunk);
+    }
+
+    if (storePinnedChunks->second.empty())
+        pinnedChunks.erase(storePinnedChunks);
+}
+
+std::shared_ptr<std::vector<melonDS::u8>> SaveStateChunkStore::loadState(const std::string& storePath, const std::vector<ChunkHash>& chunkHashes, melonDS::u32 stateSize)
+{
+    if (chunkHashes.size() != (stateSize + CHUNK_SIZE - 1) / CHUNK_SIZE)
+        return nullptr;
+
+    std::lock_guard<std::mutex> lock(storeMutex);
+
+    StoreIndex* index = getIndex(storePath);
+    if (!index)
+        return nullptr;
+
+    FILE* file = MelonDSAndroid::fileHandler->open(storePath.c_str(), FileMode::Read);
+    if (!file)
+        return nullptr;
+
+    auto state = std::make_shared<std::vector<melonDS::u8>>(stateSize);
+    std::vector<melonDS::u8> compressedBuffer;
+    bool result = true;
+
+    for (size_t i = 0; i < chunkHashes.size() && result; i++)
+    {
+        auto location = index->chunks.find(chunkHashes[i]);
+        size_t chunkOffset = i * CHUNK_SIZE;
+        size_t chunkSize = std::min((size_t) CHUNK_SIZE, stateSize - chunkOffset);
+
+        if (location == index->chunks.end() || location->second.uncompressedSize != chunkSize)
+        {
+            Log(LogLevel::Error, "Save state chunk %zu is missing from the chunk store\n", i);
+            result = false;
+            break;
+        }
+
+        result = readChunk(file, location->second, state->data() + chunkOffset, compressedBuffer);
+    }
+
+    fclose(file);
+    return result ? state : nullptr;
+}
+
+float SaveStateChunkStore::getUnreferencedRatio(const std::string& storePath, const std::unordered_set<ChunkHash>& referencedChunks)
+{
+    std::lock_guard<std::mutex> lock(storeMutex);
+
+    StoreIndex* index = getIndex(storePath);
+    if (!index)
+        return -1;
+
+    melonDS::u64 totalSize = 0;
+    melonDS::u64 unreferencedSize = 0;
+    for (const auto& [hash, location] : index->chunks)
+    {
+        melonDS::u64 recordSize = sizeof(SaveStateFormat::ChunkRecordHeader) + location.compressedSize;
+        totalSize += recordSize;
+        if (!isReferenced(storePath, hash, referencedChunks))
+            unreferencedSize += recordSize;
+    }
+
+    return totalSize == 0 ? 0 : (float) unreferencedSize / (float) totalSize;
+}
+
+void SaveStateChunkStore::beginCompaction(const std::string& storePath)
+{
+    std::lock_guard<std::mutex> lock(storeMutex);
+
+    std::unordered_set<ChunkHash>& retainedChunks = compactionRetainedChunks[storePath];
+    auto storePinnedChunks = pinnedChunks.find(storePath);
+    if (storePinnedChunks != pinnedChunks.end())
+        retainedChunks.insert(storePinnedChunks->second.begin(), storePinnedChunks->second.end());
+}
+
+void SaveStateChunkStore::endCompaction(const std::string& storePath)
+{
+    std::lock_guard<std::mutex> lock(storeMutex);
+    compactionRetainedChunks.erase(storePath);
+}
+
+bool SaveStateChunkStore::compact(const std::string& storePath, const std::string& temporaryStorePath, const std::function<bool(std::unordered_set<ChunkHash>&)>& collectReferencedChunks)
+{
+    // The store is only locked to take a snapshot of its index and to replace it at the end. Reading the states and writing the
+    // compacted store can take a while, and states must still be writable in the meantime
+    StoreIndex index;
+    {
+        std::lock_guard<std::mutex> lock(storeMutex);
+        if (compactionRetainedChunks.find(storePath) == compactionRetainedChunks.end())
+        {
+            Log(LogLevel::Error, "Chunk store compaction was not started\n");
+            return false;
+        }
+
+        StoreIndex* currentIndex = getIndex(storePath);
+        if (!currentIndex)
+            return false;
+
+        index = *currentIndex;
+    }
+
+    // States written after the states were listed, or while they are being read, have their chunks retained. Those are added
+    // once the store is locked again
+    std::unordered_set<ChunkHash> referencedChunks;
+    if (!collectReferencedChunks(referencedChunks))
+        return false;
+
+    {
+        std::lock_guard<std::mutex> lock(storeMutex);
+        const std::unordered_set<ChunkHash>& retainedChunks = compactionRetainedChunks[storePath];
+        referencedChunks.insert(retainedChunks.begin(), retainedChunks.end());
+    }
+
+    // The store is append-only, so the records in the snapshot can be read while other states are being written
+    FILE* sourceFile = MelonDSAndroid::fileHandler->open(storePath.c_str(), FileMode::Read);
+    if (!sourceFile)
+        return false;
+
+    FILE* compactedFile = MelonDSAndroid::fileHandler->open(temporaryStorePath.c_str(), FileMode::ReadWrite);
+    if (!compactedFile)
+    {
+        fclose(sourceFile);
+        return false;
+    }
+
+    StoreIndex compactedIndex {};
+    bool result = writeCompactedStore(sourceFile, compactedFile, index, compactedIndex, referencedChunks);
+
+    fclose(sourceFile);
+    if (fclose(compactedFile) != 0)
+        result = false;
+
+    if (!result)
+    {
+        Log(LogLevel::Error, "Failed to write compacted save state chunk store\n");
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(storeMutex);
+
+    // If chunks were appended, or an existing chunk was pinned by a new state after the compacted store was written, the compacted
+    // store is missing them. Give up, the next compaction will have another go. The temporary store is complete, so it must be
+    // invalidated for recover() to leave the original store alone
+    StoreIndex* currentIndex = getIndex(storePath);
+    if (!currentIndex || currentIndex->validSize != index.validSize || !containsRetainedChunks(storePath, index, compactedIndex))
+    {
+        Log(LogLevel::Info, "Save state chunk store changed while it was being compacted\n");
+        invalidateTemporaryStore(temporaryStorePath);
+        return false;
+    }
+
+    // Once the temporary store is complete, the original store can be replaced. If this is interrupted, recover() finishes the job.
+    // The copy is done with the store locked, but it only contains the chunks that are still used
+    if (!copyStore(temporaryStorePath, storePath))
+    {
+        indices.erase(storePath);
+        Log(LogLevel::Error, "Failed to replace save state chunk store with the compacted one\n");
+        return false;
+    }
+
+    // States may be added to the store from now on, so the temporary store must not be used to recover it anymore
+    if (!invalidateTemporaryStore(temporaryStorePath))
+        Log(LogLevel::Error, "Failed to invalidate temporary save state chunk store\n");
+
+    // Both stores have the same layout, so the index of the temporary store is also valid for the original one
+    indices[storePath] = std::move(compactedIndex);
+    return true;
+}
+
+bool SaveStateChunkStore::recover(const std::string& storePath, const std::string& temporaryStorePath)
+{
+    std::lock_guard<std::mutex> lock(storeMutex);
+
+    // The temporary store of a compaction that is still running is not a leftover
+    if (compactionRetainedChunks.find(storePath) != compactionRetainedChunks.end())
+        return false;
+
+    FILE* temporaryFile = MelonDSAndroid::fileHandler->open(temporaryStorePath.c_str(), FileMode::Read);
+    if (!temporaryFile)
+        return false;
+
+    SaveStateFormat::ChunkStoreHeader header {};
+    bool isComplete = fread(&header, sizeof(header), 1, temporaryFile) == 1 && memcmp(header.magic, SaveStateFormat::CHUNK_STORE_MAGIC, sizeof(header.magic)) == 0;
+    fclose(temporaryFile);
+
+    if (!isComplete)
+        return true;
+
+    indices.erase(storePath);
+    return copyStore(temporaryStorePath, storePath) && invalidateTemporaryStore(temporaryStorePath);
+}
+
+void SaveStateChunkStore::invalidate(const std::string& storePath)
+{
+    std::lock_guard<std::mutex> lock(storeMutex);
+    indices.erase(storePath);
+}
+
+SaveStateChunkStore::StoreIndex* SaveStateChunkStore::getIndex(const std::string& storePath)
+{
+    auto existingIndex = indices.find(storePath);
+    if (existingIndex != indices.end())
+        return &existingIndex->second;
+
+    FILE* file = MelonDSAndroid::fileHandler->open(storePath.c_str(), FileMode::Read);
+    if (!file)
+        return nullptr;
+
+    StoreIndex index {};
+    bool result = readIndex(file, index);
+    fclose(file);
+
+    if (!result)
+    {
+        Log(LogLevel::Error, "Save state chunk store is not valid\n");
+        return nullptr;
+    }
+
+    return &(indices[storePath] = std::move(index));
+}
+
+bool SaveStateChunkStore::readIndex(FILE* file, StoreIndex& index)
+{
+    if (fseek(file, 0, SEEK_END) != 0)
+        return false;
+
+    long fileSize = ftell(file);
+    rewind(file);
+
+    // Empty stores are created by the app. The header is written together with the first chunks
+    if (fileSize == 0)
+    {
+        index.validSize = 0;
+        return true;
+    }
+
+    SaveStateFormat::ChunkStoreHeader header {};
+    if (fread(&header, sizeof(header), 1, file) != 1)
+        return false;
+
+    if (memcmp(header.magic, SaveStateFormat::CHUNK_STORE_MAGIC, sizeof(header.magic)) != 0 || header.version != SaveStateFormat::CHUNK_STORE_VERSION)
+        return false;
+
+    index.validSize = sizeof(header);
+    for (;;)
+    {
+        SaveStateFormat::ChunkRecordHeader recordHeader {};
+        if (fread(&recordHeader, sizeof(recordHeader), 1, file) != 1)
+            break;
+
+        melonDS::u64 recordEnd = index.validSize + sizeof(recordHeader) + recordHeader.compressedSize;
+        if (recordEnd > (melonDS::u64) fileSize || fseek(file, recordHeader.compressedSize, SEEK_CUR) != 0)
+            break;
+
+        index.chunks[recordHeader.hash] = ChunkLocation {
+            .offset = index.validSize,
+            .compressedSize = recordHeader.compressedSize,
+            .uncompressedSize = recordHeader.uncompressedSize,
+        };
+        index.validSize = recordEnd;
+    }
+
+    return true;
+}
+
+bool SaveStateChunkStore::appendChunks(FILE* file, StoreIndex& index, const std::vector<melonDS::u8>& state, const std::vector<ChunkHash>& chunkHashes, const std::function<void(size_t)>& onProgress)
+{
+    if (fseek(file, (long) index.validSize, SEEK_SET) != 0)
+        return false;
+
+    if (index.validSize == 0)
+    {
+        SaveStateFormat::ChunkStoreHeader header {};
+        memcpy(header.magic, SaveStateFormat::CHUNK_STORE_MAGIC, sizeof(header.magic));
+        header.version = SaveStateFormat::CHUNK_STORE_VERSION;
+        if (fwrite(&header, sizeof(header), 1, file) != 1)
+            return false;
+
+        index.validSize = sizeof(header);
+    }
+
+    std::vector<melonDS::u8> compressedChunk(compressBound(CHUNK_SIZE));
+    std::unordered_map<ChunkHash, ChunkLocation> newChunks;
+    melonDS::u64 writeOffset = index.validSize;
+
+    for (size_t i = 0; i < chunkHashes.size(); i++)
+    {
+        const ChunkHash& hash = chunkHashes[i];
+        if (index.chunks.find(hash) != index.chunks.end() || newChunks.find(hash) != newChunks.end())
+            continue;
+
+        size_t chunkOffset = i * CHUNK_SIZE;
+        size_t chunkSize = std::min((size_t) CHUNK_SIZE, state.size() - chunkOffset);
+
+        uLongf compressedSize = compressedChunk.size();
+        if (compress2(compressedChunk.data(), &compressedSize, state.data() + chunkOffset, chunkSize, COMPRESSION_LEVEL) != Z_OK)
+            return false;
+
+        SaveStateFormat::ChunkRecordHeader recordHeader {
+            .hash = hash,
+            .compressedSize = (melonDS::u32) compressedSize,
+            .uncompressedSize = (melonDS::u32) chunkSize,
+        };
+
+        if (fwrite(&recordHeader, sizeof(recordHeader), 1, file) != 1 || fwrite(compressedChunk.data(), 1, compressedSize, file) != compressedSize)
+            return false;
+
+        newChunks[hash] = ChunkLocation {
+            .offset = writeOffset,
+            .compressedSize = (melonDS::u32) compressedSize,
+            .uncompressedSize = (melonDS::u32) chunkSize,
+        };
+        writeOffset += sizeof(recordHeader) + compressedSize;
+        onProgress(chunkOffset + chunkSize);
+    }
+
+    // Drop anything left after the new records by a previously interrupted write
+    if (fflush(file) != 0 || ftruncate(fileno(file), (off_t) writeOffset) != 0)
+        return false;
+
+    index.chunks.insert(newChunks.begin(), newChunks.end());
+    index.validSize = writeOffset;
+    return true;
+}
+
+bool SaveStateChunkStore::isReferenced(const std::string& storePath, const ChunkHash& hash, const std::unordered_set<ChunkHash>& referencedChunks)
+{
+    if (referencedChunks.find(hash) != referencedChunks.end())
+        return true;
+
+    auto storePinnedChunks = pinnedChunks.find(storePath);
+    return storePinnedChunks != pinnedChunks.end() && storePinnedChunks->second.find(hash) != storePinnedChunks->second.end();
+}
+
+bool SaveStateChunkStore::writeCompactedStore(FILE* sourceFile, FILE* compactedFile, const StoreIndex& index, StoreIndex& compactedIndex, const std::unordered_set<ChunkHash>& referencedChunks)
+{
+    // The magic is only written once all chunks have been copied. This marks the temporary store as complete
+    SaveStateFormat::ChunkStoreHeader header {};
+    header.version = SaveStateFormat::CHUNK_STORE_VERSION;
+    if (fwrite(&header, sizeof(header), 1, compactedFile) != 1)
+        return false;
+
+    compactedIndex.validSize = sizeof(header);
+
+    // Records are copied as they are, without decompressing them
+    std::vector<melonDS::u8> recordBuffer;
+    for (const auto& [hash, location] : index.chunks)
+    {
+        if (referencedChunks.find(hash) == referencedChunks.end())
+            continue;
+
+        recordBuffer.resize(sizeof(SaveStateFormat::ChunkRecordHeader) + location.compressedSize);
+        if (fseek(sourceFile, (long) location.offset, SEEK_SET) != 0
+            || fread(recordBuffer.data(), 1, recordBuffer.size(), sourceFile) != recordBuffer.size()
+            || fwrite(recordBuffer.data(), 1, recordBuffer.size(), compactedFile) != recordBuffer.size())
+        {
+            return false;
+        }
+
+        compactedIndex.chunks[hash] = ChunkLocation {
+            .offset = compactedIndex.validSize,
+            .compressedSize = location.compressedSize,
+            .uncompressedSize = location.uncompressedSize,
+        };
+        compactedIndex.validSize += recordBuffer.size();
+    }
+
+    if (fflush(compactedFile) != 0 || ftruncate(fileno(compactedFile), (off_t) compactedIndex.validSize) != 0)
+        return false;
+
+    memcpy(header.magic, SaveStateFormat::CHUNK_STORE_MAGIC, sizeof(header.magic));
+    return fseek(compactedFile, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, compactedFile) == 1;
+}
+
+bool SaveStateChunkStore::containsRetainedChunks(const std::string& storePath, const StoreIndex& index, const StoreIndex& compactedIndex)
+{
+    auto retainedChunks = compactionRetainedChunks.find(storePath);
+    if (retainedChunks == compactionRetainedChunks.end())
+        return false;
+
+    for (const ChunkHash& hash : retainedChunks->second)
+    {
+        if (index.chunks.find(hash) != index.chunks.end() && compactedIndex.chunks.find(hash) == compactedIndex.chunks.end())
+            return false;
+    }
+
+    return true;
+}
+
+bool SaveStateChunkStore::invalidateTemporaryStore(const std::string& temporaryStorePath)
+{
+    FILE* file = MelonDSAndroid::fileHandler->open(temporaryStorePath.c_str(), FileMode::ReadWriteExisting);
+    if (!file)
+        return false;
+
+    SaveStateFormat::ChunkStoreHeader header {};
+    header.version = SaveStateFormat::CHUNK_STORE_VERSION;
+    bool result = fwrite(&header, sizeof(header), 1, file) == 1;
+    if (fclose(file) != 0)
+        result = false;
+
+    return result;
+}
+
+bool SaveStateChunkStore::copyStore(const std::string& sourcePath, const std::string& destinationPath)
+{
+    FILE* sourceFile = MelonDSAndroid::fileHandler->open(sourcePath.c_str(), FileMode::Read);
+    if (!sourceFile)
+        return false;
+
+    FILE* destinationFile = MelonDSAndroid::fileHandler->open(destinationPath.c_str(), FileMode::Write);
+    if (!destinationFile)
+    {
+        fclose(sourceFile);
+        return false;
+    }
+
+    std::vector<melonDS::u8> buffer(COPY_BUFFER_SIZE);
+    bool result = true;
+    size_t bytesRead;
+    while (result && (bytesRead = fread(buffer.data(), 1, buffer.size(), sourceFile)) > 0)
+        result = fwrite(buffer.data(), 1, bytesRead, destinationFile) == bytesRead;
+
+    if (ferror(sourceFile))
+        result = false;
+
+    fclose(sourceFile);
+    if (fclose(destinationFile) != 0)
+        result = false;
+
+    return result;
+}
+
+bool SaveStateChunkStore::readChunk(FILE* file, const ChunkLocation& location, melonDS::u8* destination, std::vector<melonDS::u8>& compressedBuffer)
+{
+    compressedBuffer.resize(location.compressedSize);
+    if (fseek(file, (long) (location.offset + sizeof(SaveStateFormat::ChunkRecordHeader)), SEEK_SET) != 0)
+        return false;
+
+    if (fread(compressedBuffer.data(), 1, compressedBuffer.size(), file) != compressedBuffer.size())
+        return false;
+
+    uLongf uncompressedSize = location.uncompressedSize;
+    if (uncompress(destination, &uncompressedSize, compressedBuffer.data(), compressedBuffer.size()) != Z_OK || uncompressedSize != location.uncompressedSize)
+    {
+        Log(LogLevel::Error, "Save state chunk is corrupted\n");
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,114 @@
+#ifndef MELONDS_ANDROID_SAVESTATECHUNKSTORE_H
+#define MELONDS_ANDROID_SAVESTATECHUNKSTORE_H
+
+#include <stdio.h>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "ChunkHash.h"
+#include "types.h"
+
+/**
+ * Deduplicated storage for save states. States are split into fixed-size chunks, and each unique chunk is stored once in the chunk
+ * store of the ROM (see SaveStateFormat.h). The state itself only keeps the list of its chunks. Since the core serializes the
+ * emulator state with a fixed layout, fixed-size chunks line up between states, and unchanged memory regions end up in the same
+ * chunks.
+ *
+ * Chunk stores are append-only. Chunks that are no longer referenced by any state are only removed when the store is compacted.
+ * Compaction writes the referenced chunks to a temporary store, which is then copied over the original store. This keeps the path
+ * of the store stable, and the temporary store can be used to recover the original one if the copy is interrupted.
+ */
+class SaveStateChunkStore
+{
+public:
+    static constexpr melonDS::u32 CHUNK_SIZE = 64 * 1024;
+
+    /**
+     * Adds the chunks of the given state to the store. Only chunks that are not in the store yet are written. The chunks of the
+     * state are pinned, so that they survive compactions until the state file that references them has been written. They must be
+     * unpinned with unpinChunks() afterwards, whether this call succeeds or not.
+     * @param chunkHashes Filled with the hashes of the chunks of the state, in order
+     * @param onProgress Called with the number of bytes of the state that have been processed, as new chunks are written
+     */
+    bool storeState(const std::string& storePath, const std::vector<melonDS::u8>& state, std::vector<ChunkHash>& chunkHashes, const std::function<void(size_t)>& onProgress);
+    void unpinChunks(const std::string& storePath, const std::vector<ChunkHash>& chunkHashes);
+
+    std::shared_ptr<std::vector<melonDS::u8>> loadState(const std::string& storePath, const std::vector<ChunkHash>& chunkHashes, melonDS::u32 stateSize);
+
+    /**
+     * @return The fraction of the store that is taken by chunks that are not in the given set. Negative if the store can't be read
+     */
+    float getUnreferencedRatio(const std::string& storePath, const std::unordered_set<ChunkHash>& referencedChunks);
+
+    /**
+     * Starts tracking the chunks that are pinned in the given store, which are then kept by compact() even if no state references
+     * them. Must be called before the states of the store are listed, so that states created after the listing, which compact()
+     * doesn't know about, don't lose their chunks. Tracking stops with endCompaction().
+     */
+    void beginCompaction(const std::string& storePath);
+    void endCompaction(const std::string& storePath);
+
+    /**
+     * Removes the chunks that are not referenced by any state from the store. The store is only locked to replace it once the
+     * compacted store has been written, so states can still be written in the meantime. If that adds chunks that the compacted
+     * store doesn't have, nothing is removed. Must be called between beginCompaction() and endCompaction().
+     * @param temporaryStorePath An existing file where the compacted store is written before replacing the original store. It is
+     * invalidated once the original store has been replaced, and can be deleted if this returns true. Otherwise, it must be kept
+     * for recover()
+     * @param collectReferencedChunks Adds the chunks referenced by the states of the store to the given set. Returns false if any
+     * state can't be read, in which case nothing is removed
+     */
+    bool compact(const std::string& storePath, const std::string& temporaryStorePath, const std::function<bool(std::unordered_set<ChunkHash>&)>& collectReferencedChunks);
+
+    /**
+     * Finishes an interrupted compaction. If the temporary store was completely written, it is copied over the original store.
+     * Otherwise, the original store was not modified yet and is left as it is.
+     * @return True if the temporary store is no longer needed and can be deleted
+     */
+    bool recover(const std::string& storePath, const std::string& temporaryStorePath);
+
+    /**
+     * Forgets everything known about the given store. Must be called if the store is modified or deleted outside of this class.
+     */
+    void invalidate(const std::string& storePath);
+
+private:
+    struct ChunkLocation
+    {
+        melonDS::u64 offset;
+        melonDS::u32 compressedSize;
+        melonDS::u32 uncompressedSize;
+    };
+
+    struct StoreIndex
+    {
+        std::unordered_map<ChunkHash, ChunkLocation> chunks;
+        // End of the last complete record. Anything after it was left by an interrupted write, and is overwritten
+        melonDS::u64 validSize;
+    };
+
+    static constexpr int COMPRESSION_LEVEL = 3;
+    static constexpr size_t COPY_BUFFER_SIZE = 256 * 1024;
+
+    std::unordered_map<std::string, StoreIndex> indices;
+    std::unordered_map<std::string, std::unordered_multiset<ChunkHash>> pinnedChunks;
+    // Chunks pinned since the compaction of each store began
+    std::unordered_map<std::string, std::unordered_set<ChunkHash>> compactionRetainedChunks;
+    std::mutex storeMutex;
+
+    StoreIndex* getIndex(const std::string& storePath);
+    bool readIndex(FILE* file, StoreIndex& index);
+    bool appendChunks(FILE* file, StoreIndex& index, const std::vector<melonDS::u8>& state, const std::vector<ChunkHash>& chunkHashes, const std::function<void(size_t)>& onProgress);
+    bool readChunk(FILE* file, const ChunkLocation& location, melonDS::u8* destination, std::vector<melonDS::u8>& compressedBuffer);
+    bool isReferenced(const std::string& storePath, const ChunkHash& hash, const std::unordered_set<ChunkHash>& referencedChunks);
+    bool writeCompactedStore(FILE* sourceFile, FILE* compactedFile, const StoreIndex& index, StoreIndex& compactedIndex, const std::unordered_set<ChunkHash>& referencedChunks);
+    bool containsRetainedChunks(const std::string& storePath, const StoreIndex& index, const StoreIndex& compactedIndex);
+    bool invalidateTemporaryStore(const std::string& temporaryStorePath);
+    bool copyStore(const std::string& sourcePath, const std::string& destinationPath);
+};
+
+#endif //MELONDS_ANDROID_SAVESTATECHUNKSTORE_H
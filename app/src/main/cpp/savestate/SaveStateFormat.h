@@ -0,0 +1,122 @@
+#ifndef MELONDS_ANDROID_SAVESTATEFORMAT_H
+#define MELONDS_ANDROID_SAVESTATEFORMAT_H
+
+#include <string.h>
+#include <string>
+#include "ChunkHash.h"
+#include "types.h"
+
+/**
+ * Save states are stored in a single container file with the following layout:
+ *
+ * [header][compressed thumbnail][compressed state]
+ *
+ * The header has a fixed size and contains the metadata of the state, as well as the offsets and sizes of the other sections.
+ * This allows the slot browser to display a state by reading only its header and thumbnail. All values are little endian.
+ * States that do not start with the container magic are raw states written by older versions of the app, and are handed to
+ * the core as they are.
+ *
+ * The state section either contains the whole state as a single zlib stream, or a manifest that lists the chunks the state is made
+ * of. Chunks are stored in the chunk store of the ROM, which is shared by all of its states:
+ *
+ * [chunk store header][chunk record header][compressed chunk][chunk record header][compressed chunk]...
+ *
+ * Each unique chunk is stored only once, so identical parts of different states (or of consecutive saves to the same slot) do not
+ * take any extra space.
+ */
+namespace SaveStateFormat
+{
+    static constexpr char SAVE_STATE_MAGIC[4] = { 'M', 'D', 'S', 'S' };
+    static constexpr melonDS::u32 SAVE_STATE_VERSION = 1;
+
+    // The thumbnail is a BGRA8888 image of both screens, at half the native resolution
+    static constexpr melonDS::u32 THUMBNAIL_WIDTH = 128;
+    static constexpr melonDS::u32 THUMBNAIL_HEIGHT = 192;
+    static constexpr melonDS::u32 THUMBNAIL_SIZE = THUMBNAIL_WIDTH * THUMBNAIL_HEIGHT * 4;
+
+    static constexpr size_t ROM_HASH_LENGTH = 32;
+    static constexpr size_t EMULATOR_VERSION_LENGTH = 32;
+
+    static constexpr char CHUNK_STORE_MAGIC[4] = { 'M', 'D', 'S', 'P' };
+    static constexpr melonDS::u32 CHUNK_STORE_VERSION = 1;
+
+    enum Compression : melonDS::u32
+    {
+        COMPRESSION_ZLIB = 1,
+    };
+
+    enum StateStorage : melonDS::u32
+    {
+        // The state section contains the compressed state
+        STATE_STORAGE_INLINE = 0,
+        // The state section contains a chunk manifest. Chunks are compressed individually in the chunk store
+        STATE_STORAGE_CHUNK_STORE = 1,
+    };
+
+    struct SaveStateHeader
+    {
+        char magic[4];
+        melonDS::u32 version;
+        melonDS::u32 headerSize;
+        melonDS::u32 compression;
+        melonDS::u64 frameCount;
+        // Unix time in milliseconds
+        melonDS::s64 timestamp;
+        // Not null-terminated if the value fills the whole field
+        char romHash[ROM_HASH_LENGTH];
+        char emulatorVersion[EMULATOR_VERSION_LENGTH];
+        melonDS::u32 thumbnailOffset;
+        melonDS::u32 thumbnailCompressedSize;
+        melonDS::u32 thumbnailWidth;
+        melonDS::u32 thumbnailHeight;
+        melonDS::u32 stateOffset;
+        melonDS::u32 stateCompressedSize;
+        melonDS::u32 stateUncompressedSize;
+        melonDS::u32 stateStorage;
+    };
+
+    static_assert(sizeof(SaveStateHeader) == 128, "The save state header layout must not change");
+
+    /**
+     * Start of the state section of states stored in a chunk store. Followed by the hashes of the chunks of the state, in order.
+     */
+    struct ChunkManifestHeader
+    {
+        melonDS::u32 chunkSize;
+        melonDS::u32 chunkCount;
+    };
+
+    struct ChunkStoreHeader
+    {
+        char magic[4];
+        melonDS::u32 version;
+    };
+
+    struct ChunkRecordHeader
+    {
+        ChunkHash hash;
+        melonDS::u32 compressedSize;
+        melonDS::u32 uncompressedSize;
+    };
+
+    /**
+     * Metadata provided by the app when saving a state. The rest of the header fields are filled in by the writer.
+     */
+    struct SaveStateMetadata
+    {
+        std::string romHash;
+        std::string emulatorVersion;
+    };
+
+    inline bool isSaveStateContainer(const SaveStateHeader& header)
+    {
+        return memcmp(header.magic, SAVE_STATE_MAGIC, sizeof(SAVE_STATE_MAGIC)) == 0;
+    }
+
+    inline std::string readHeaderString(const char* field, size_t fieldLength)
+    {
+        return std::string(field, strnlen(field, fieldLength));
+    }
+}
+
+#endif //MELONDS_ANDROID_SAVESTATEFORMAT_H
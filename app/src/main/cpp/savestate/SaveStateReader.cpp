@@ -0,0 +1,206 @@
+#include "SaveStateReader.h"
+#include <zlib.h>
+#include <MelonDS.h>
+#include "SaveStateFormat.h"
+#include "Platform.h"
+
+using namespace melonDS::Platform;
+
+SaveStateReader::SaveStateReader(MemoryFileStore* memoryFileStore, SaveStateCache* saveStateCache, SaveStateChunkStore* chunkStore, std::atomic<melonDS::u64>& frameCounter) :
+    memoryFileStore(memoryFileStore),
+    saveStateCache(saveStateCache),
+    chunkStore(chunkStore),
+    frameCounter(frameCounter)
+{
+}
+
+bool SaveStateReader::loadState(const char* path, const std::string& chunkStorePath, const std::string& romHash)
+{
+    SaveStateCache::CachedState cachedState;
+    if (saveStateCache->get(path, romHash, cachedState))
+        return loadUncompressedState(cachedState.state, cachedState.frameCount);
+
+    FILE* file = MelonDSAndroid::fileHandler->open(path, FileMode::Read);
+    if (!file)
+        return false;
+
+    SaveStateFormat::SaveStateHeader header {};
+    bool isContainer = fread(&header, sizeof(header), 1, file) == 1 && SaveStateFormat::isSaveStateContainer(header);
+    if (!isContainer)
+    {
+        // Raw state. Let the core read it directly
+        fclose(file);
+        return MelonDSAndroid::loadState(path);
+    }
+
+    if (!isCompatibleState(header, chunkStorePath, romHash))
+    {
+        fclose(file);
+        return false;
+    }
+
+    std::shared_ptr<std::vector<melonDS::u8>> state;
+    if (header.stateStorage == SaveStateFormat::STATE_STORAGE_CHUNK_STORE)
+    {
+        std::vector<ChunkHash> chunkHashes;
+        bool hasManifest = readChunkManifest(file, header, chunkHashes);
+        fclose(file);
+
+        if (hasManifest)
+            state = chunkStore->loadState(chunkStorePath, chunkHashes, header.stateUncompressedSize);
+    }
+    else
+    {
+        state = decompressState(file, header);
+        fclose(file);
+    }
+
+    if (!state)
+        return false;
+
+    saveStateCache->put(path, romHash, state, header.frameCount);
+    return loadUncompressedState(state, header.frameCount);
+}
+
+bool SaveStateReader::loadUncompressedState(std::shared_ptr<std::vector<melonDS::u8>> state, melonDS::u64 frameCount)
+{
+    std::string statePath = memoryFileStore->createFile(std::move(state));
+    bool result = MelonDSAndroid::loadState(statePath.c_str());
+    memoryFileStore->deleteFile(statePath);
+
+    if (result)
+        frameCounter = frameCount;
+
+    return result;
+}
+
+bool SaveStateReader::readReferencedChunks(const char* path, std::unordered_set<ChunkHash>& referencedChunks)
+{
+    FILE* file = MelonDSAndroid::fileHandler->open(path, FileMode::Read);
+    if (!file)
+        return false;
+
+    SaveStateFormat::SaveStateHeader header {};
+    size_t headerBytesRead = fread(&header, 1, sizeof(header), file);
+    if (headerBytesRead != sizeof(header))
+    {
+        // An empty file is a state that is about to be written, whose chunks are still pinned. Anything else is a state whose
+        // header is truncated or still being written, which may reference chunks
+        bool isEmpty = headerBytesRead == 0 && !ferror(file);
+        fclose(file);
+        return isEmpty;
+    }
+
+    if (!SaveStateFormat::isSaveStateContainer(header) || header.stateStorage != SaveStateFormat::STATE_STORAGE_CHUNK_STORE)
+    {
+        fclose(file);
+        return true;
+    }
+
+    std::vector<ChunkHash> chunkHashes;
+    bool result = readChunkManifest(file, header, chunkHashes);
+    fclose(file);
+
+    referencedChunks.insert(chunkHashes.begin(), chunkHashes.end());
+    return result;
+}
+
+bool SaveStateReader::readChunkManifest(FILE* file, const SaveStateFormat::SaveStateHeader& header, std::vector<ChunkHash>& chunkHashes)
+{
+    SaveStateFormat::ChunkManifestHeader manifestHeader {};
+    if (fseek(file, header.stateOffset, SEEK_SET) != 0 || fread(&manifestHeader, sizeof(manifestHeader), 1, file) != 1)
+        return false;
+
+    if (manifestHeader.chunkSize != SaveStateChunkStore::CHUNK_SIZE || sizeof(manifestHeader) + manifestHeader.chunkCount * sizeof(ChunkHash) != header.stateCompressedSize)
+    {
+        Log(LogLevel::Error, "Save state chunk manifest is not valid\n");
+        return false;
+    }
+
+    chunkHashes.resize(manifestHeader.chunkCount);
+    return fread(chunkHashes.data(), sizeof(ChunkHash), chunkHashes.size(), file) == chunkHashes.size();
+}
+
+bool SaveStateReader::isCompatibleState(const SaveStateFormat::SaveStateHeader& header, const std::string& chunkStorePath, const std::string& romHash)
+{
+    if (header.version != SaveStateFormat::SAVE_STATE_VERSION || header.headerSize < sizeof(header))
+    {
+        Log(LogLevel::Error, "Unsupported save state version %d\n", header.version);
+        return false;
+    }
+
+    if (header.compression != SaveStateFormat::COMPRESSION_ZLIB)
+    {
+        Log(LogLevel::Error, "Unsupported save state compression %d\n", header.compression);
+        return false;
+    }
+
+    if (header.stateStorage == SaveStateFormat::STATE_STORAGE_CHUNK_STORE && chunkStorePath.empty())
+    {
+        Log(LogLevel::Error, "Save state is stored in a chunk store, but none was provided\n");
+        return false;
+    }
+
+    if (header.stateStorage != SaveStateFormat::STATE_STORAGE_INLINE && header.stateStorage != SaveStateFormat::STATE_STORAGE_CHUNK_STORE)
+    {
+        Log(LogLevel::Error, "Unsupported save state storage %d\n", header.stateStorage);
+        return false;
+    }
+
+    std::string stateRomHash = SaveStateFormat::readHeaderString(header.romHash, sizeof(header.romHash));
+    // States without a hash can be loaded with any ROM
+    if (!stateRomHash.empty() && !romHash.empty() && stateRomHash != romHash)
+    {
+        Log(LogLevel::Error, "Save state was created for a different ROM (%s)\n", stateRomHash.c_str());
+        return false;
+    }
+
+    if (header.stateUncompressedSize == 0 || header.stateCompressedSize == 0)
+    {
+        Log(LogLevel::Error, "Save state is empty\n");
+        return false;
+    }
+
+    return true;
+}
+
+std::shared_ptr<std::vector<melonDS::u8>> SaveStateReader::decompressState(FILE* file, const SaveStateFormat::SaveStateHeader& header)
+{
+    if (fseek(file, header.stateOffset, SEEK_SET) != 0)
+        return nullptr;
+
+    z_stream stream {};
+    if (inflateInit(&stream) != Z_OK)
+        return nullptr;
+
+    auto state = std::make_shared<std::vector<melonDS::u8>>(header.stateUncompressedSize);
+    std::vector<melonDS::u8> inputBuffer(DECOMPRESSION_CHUNK_SIZE);
+
+    stream.next_out = state->data();
+    stream.avail_out = header.stateUncompressedSize;
+
+    size_t remainingInput = header.stateCompressedSize;
+    int inflateResult = Z_OK;
+    while (inflateResult == Z_OK && remainingInput > 0)
+    {
+        size_t bytesRead = fread(inputBuffer.data(), 1, std::min(inputBuffer.size(), remainingInput), file);
+        if (bytesRead == 0)
+            break;
+
+        remainingInput -= bytesRead;
+        stream.next_in = inputBuffer.data();
+        stream.avail_in = (uInt) bytesRead;
+        inflateResult = inflate(&stream, Z_NO_FLUSH);
+    }
+
+    bool isComplete = inflateResult == Z_STREAM_END && stream.total_out == header.stateUncompressedSize;
+    inflateEnd(&stream);
+
+    if (!isComplete)
+    {
+        Log(LogLevel::Error, "Save state is corrupted (inflate result %d)\n", inflateResult);
+        return nullptr;
+    }
+
+    return state;
+}
@@ -0,0 +1,57 @@
+#ifndef MELONDS_ANDROID_SAVESTATEREADER_H
+#define MELONDS_ANDROID_SAVESTATEREADER_H
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "../MemoryFileStore.h"
+#include "SaveStateCache.h"
+#include "SaveStateChunkStore.h"
+#include "SaveStateFormat.h"
+#include "types.h"
+
+/**
+ * Loads save state containers written by the SaveStateWriter, as well as raw states written by older versions of the app.
+ */
+class SaveStateReader
+{
+public:
+    /**
+     * @param saveStateCache Cache that is checked before reading states from storage. States read from storage are added to it
+     * @param chunkStore Store from which the contents of states that are stored in a chunk store are read
+     * @param frameCounter The number of frames emulated since the emulator was started. Restored from the state when it is loaded
+     */
+    SaveStateReader(MemoryFileStore* memoryFileStore, SaveStateCache* saveStateCache, SaveStateChunkStore* chunkStore, std::atomic<melonDS::u64>& frameCounter);
+
+    /**
+     * Loads the state at the given path. Save state containers are validated before the core is touched, so states that were
+     * saved for a different ROM or with an unsupported format are rejected without affecting the emulator.
+     * @param chunkStorePath The chunk store of the ROM
+     * @param romHash The hash of the currently loaded ROM
+     */
+    bool loadState(const char* path, const std::string& chunkStorePath, const std::string& romHash);
+
+    /**
+     * Adds the chunks referenced by the given state to the given set. States that are not stored in a chunk store don't reference
+     * any chunks.
+     * @return False if the state could not be read, including when its header is incomplete
+     */
+    static bool readReferencedChunks(const char* path, std::unordered_set<ChunkHash>& referencedChunks);
+
+private:
+    static constexpr size_t DECOMPRESSION_CHUNK_SIZE = 256 * 1024;
+
+    MemoryFileStore* memoryFileStore;
+    SaveStateCache* saveStateCache;
+    SaveStateChunkStore* chunkStore;
+    std::atomic<melonDS::u64>& frameCounter;
+
+    static bool readChunkManifest(FILE* file, const SaveStateFormat::SaveStateHeader& header, std::vector<ChunkHash>& chunkHashes);
+    bool loadUncompressedState(std::shared_ptr<std::vector<melonDS::u8>> state, melonDS::u64 frameCount);
+    bool isCompatibleState(const SaveStateFormat::SaveStateHeader& header, const std::string& chunkStorePath, const std::string& romHash);
+    std::shared_ptr<std::vector<melonDS::u8>> decompressState(FILE* file, const SaveStateFormat::SaveStateHeader& header);
+};
+
+#endif //MELONDS_ANDROID_SAVESTATEREADER_H
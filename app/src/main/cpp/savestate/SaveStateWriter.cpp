@@ -0,0 +1,296 @@
+#include "SaveStateWriter.h"
+#include <chrono>
+#include <future>
+#include <zlib.h>
+#include <MelonDS.h>
+#include "SaveStateFormat.h"
+#include "../FrameBoundaryTaskQueue.h"
+#include "Platform.h"
+
+using namespace melonDS::Platform;
+
+SaveStateWriter::SaveStateWriter(MemoryFileStore* memoryFileStore, SaveStateCache* saveStateCache, SaveStateChunkStore* chunkStore, const melonDS::u32* screenshotBuffer, const std::atomic<melonDS::u64>& frameCounter) :
+    memoryFileStore(memoryFileStore),
+    saveStateCache(saveStateCache),
+    chunkStore(chunkStore),
+    screenshotBuffer(screenshotBuffer),
+    frameCounter(frameCounter)
+{
+    workerThread = std::thread(&SaveStateWriter::processJobs, this);
+    pthread_setname_np(workerThread.native_handle(), "SaveStateWriter");
+}
+
+bool SaveStateWriter::saveState(const std::string& path, const std::string& chunkStorePath, int requestId, const SaveStateFormat::SaveStateMetadata& metadata)
+{
+    auto snapshotPromise = std::make_shared<std::promise<std::shared_ptr<Snapshot>>>();
+    auto snapshotFuture = snapshotPromise->get_future();
+
+    bool scheduled = runAtFrameBoundary([this, snapshotPromise] {
+        snapshotPromise->set_value(takeSnapshot());
+    });
+
+    if (!scheduled)
+        return false;
+
+    std::shared_ptr<Snapshot> snapshot = snapshotFuture.get();
+    if (!snapshot)
+        return false;
+
+    // The state is cached right away, so that loading it before the write completes doesn't read a partially written file
+    saveStateCache->put(path, metadata.romHash, snapshot->state, snapshot->frameCount);
+
+    enqueueJob(WriteJob {
+        .requestId = requestId,
+        .path = path,
+        .chunkStorePath = chunkStorePath,
+        .metadata = metadata,
+        .snapshot = std::move(snapshot),
+    });
+    return true;
+}
+
+std::shared_ptr<SaveStateWriter::Snapshot> SaveStateWriter::takeSnapshot()
+{
+    auto state = std::make_shared<std::vector<melonDS::u8>>();
+    // States have roughly the same size during a session. Reserve enough memory upfront to avoid reallocations while the core writes
+    state->reserve(lastSnapshotSize);
+
+    std::string statePath = memoryFileStore->createFile(state);
+    bool result = MelonDSAndroid::saveState(statePath.c_str());
+    memoryFileStore->deleteFile(statePath);
+
+    if (!result || state->empty())
+    {
+        Log(LogLevel::Error, "Failed to snapshot emulator state\n");
+        return nullptr;
+    }
+
+    lastSnapshotSize = state->size();
+
+    auto snapshot = std::make_shared<Snapshot>();
+    snapshot->state = std::move(state);
+    snapshot->frameCount = frameCounter.load();
+    snapshot->timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    captureThumbnail(snapshot->thumbnail);
+
+    return snapshot;
+}
+
+void SaveStateWriter::captureThumbnail(std::vector<melonDS::u8>& thumbnail)
+{
+    if (!screenshotBuffer)
+        return;
+
+    constexpr melonDS::u32 sourceWidth = SaveStateFormat::THUMBNAIL_WIDTH * 2;
+
+    thumbnail.resize(SaveStateFormat::THUMBNAIL_SIZE);
+    melonDS::u32* thumbnailPixels = reinterpret_cast<melonDS::u32*>(thumbnail.data());
+
+    // Each thumbnail pixel is the average of a 2x2 block of the screenshot. Channels are averaged in parallel by halving the
+    // pixels before adding them, which loses the lowest bit of each channel but is good enough for a thumbnail
+    auto average = [](melonDS::u32 a, melonDS::u32 b) {
+        return (a & b) + (((a ^ b) & 0xFEFEFEFE) >> 1);
+    };
+
+    for (melonDS::u32 y = 0; y < SaveStateFormat::THUMBNAIL_HEIGHT; y++)
+    {
+        const melonDS::u32* topRow = screenshotBuffer + (y * 2) * sourceWidth;
+        const melonDS::u32* bottomRow = topRow + sourceWidth;
+
+        for (melonDS::u32 x = 0; x < SaveStateFormat::THUMBNAIL_WIDTH; x++)
+        {
+            melonDS::u32 top = average(topRow[x * 2], topRow[x * 2 + 1]);
+            melonDS::u32 bottom = average(bottomRow[x * 2], bottomRow[x * 2 + 1]);
+            thumbnailPixels[y * SaveStateFormat::THUMBNAIL_WIDTH + x] = average(top, bottom);
+        }
+    }
+}
+
+void SaveStateWriter::enqueueJob(WriteJob job)
+{
+    {
+        std::lock_guard<std::mutex> lock(jobsMutex);
+        pendingJobs.push_back(std::move(job));
+    }
+    jobsCondition.notify_one();
+}
+
+void SaveStateWriter::processJobs()
+{
+    for (;;)
+    {
+        WriteJob job;
+        {
+            std::unique_lock<std::mutex> lock(jobsMutex);
+            jobsCondition.wait(lock, [this] { return stopWorker || !pendingJobs.empty(); });
+
+            // Pending jobs are always written, even when stopping, so that no save state is lost
+            if (pendingJobs.empty())
+                break;
+
+            job = std::move(pendingJobs.front());
+            pendingJobs.pop_front();
+        }
+
+        WriteResult result = writeContainer(job);
+        if (result != WRITE_RESULT_OK)
+        {
+            Log(LogLevel::Error, "Failed to write save state (error %d)\n", result);
+            // Don't let the cache serve a state that is not on storage
+            saveStateCache->remove(job.path, job.snapshot->state);
+        }
+
+        eventMessenger.onSaveStateWriteCompleted(job.requestId, result);
+    }
+}
+
+SaveStateWriter::WriteResult SaveStateWriter::compressState(const WriteJob& job, std::vector<melonDS::u8>& compressedState, const std::function<void(size_t)>& onProgress)
+{
+    const std::vector<melonDS::u8>& state = *job.snapshot->state;
+
+    z_stream stream {};
+    if (deflateInit(&stream, COMPRESSION_LEVEL) != Z_OK)
+        return WRITE_RESULT_COMPRESSION_FAILED;
+
+    compressedState.resize(deflateBound(&stream, state.size()));
+    stream.next_out = compressedState.data();
+    stream.avail_out = (uInt) compressedState.size();
+
+    WriteResult result = WRITE_RESULT_OK;
+    size_t inputOffset = 0;
+
+    // The state is compressed in chunks to be able to report progress. The output buffer is big enough to hold the whole
+    // compressed state, so deflate never runs out of output space
+    while (result == WRITE_RESULT_OK)
+    {
+        size_t chunkSize = std::min(COMPRESSION_CHUNK_SIZE, state.size() - inputOffset);
+        bool isLastChunk = inputOffset + chunkSize == state.size();
+
+        stream.next_in = const_cast<melonDS::u8*>(state.data()) + inputOffset;
+        stream.avail_in = (uInt) chunkSize;
+        inputOffset += chunkSize;
+
+        int deflateResult = deflate(&stream, isLastChunk ? Z_FINISH : Z_NO_FLUSH);
+        if (deflateResult == Z_STREAM_ERROR || (isLastChunk && deflateResult != Z_STREAM_END))
+            result = WRITE_RESULT_COMPRESSION_FAILED;
+        else if (isLastChunk)
+            break;
+        else
+            onProgress(inputOffset);
+    }
+
+    compressedState.resize(stream.total_out);
+    deflateEnd(&stream);
+
+    return result;
+}
+
+SaveStateWriter::WriteResult SaveStateWriter::storeStateChunks(const WriteJob& job, std::vector<ChunkHash>& chunkHashes, std::vector<melonDS::u8>& chunkManifest, const std::function<void(size_t)>& onProgress)
+{
+    if (!chunkStore->storeState(job.chunkStorePath, *job.snapshot->state, chunkHashes, onProgress))
+        return WRITE_RESULT_CHUNK_STORE_FAILED;
+
+    SaveStateFormat::ChunkManifestHeader manifestHeader {
+        .chunkSize = SaveStateChunkStore::CHUNK_SIZE,
+        .chunkCount = (melonDS::u32) chunkHashes.size(),
+    };
+
+    chunkManifest.resize(sizeof(manifestHeader) + chunkHashes.size() * sizeof(ChunkHash));
+    memcpy(chunkManifest.data(), &manifestHeader, sizeof(manifestHeader));
+    memcpy(chunkManifest.data() + sizeof(manifestHeader), chunkHashes.data(), chunkHashes.size() * sizeof(ChunkHash));
+    return WRITE_RESULT_OK;
+}
+
+SaveStateWriter::WriteResult SaveStateWriter::writeContainer(const WriteJob& job)
+{
+    const Snapshot& snapshot = *job.snapshot;
+
+    std::vector<melonDS::u8> compressedThumbnail;
+    if (!snapshot.thumbnail.empty())
+    {
+        uLongf compressedThumbnailSize = compressBound(snapshot.thumbnail.size());
+        compressedThumbnail.resize(compressedThumbnailSize);
+        if (compress2(compressedThumbnail.data(), &compressedThumbnailSize, snapshot.thumbnail.data(), snapshot.thumbnail.size(), COMPRESSION_LEVEL) != Z_OK)
+            return WRITE_RESULT_COMPRESSION_FAILED;
+
+        compressedThumbnail.resize(compressedThumbnailSize);
+    }
+
+    // Writing the contents of the state is what takes time, especially through slow storage providers, so progress is reported
+    // while doing it
+    int lastReportedProgress = 0;
+    auto onStateProgress = [&](size_t processedBytes) {
+        int progress = (int) (processedBytes * STATE_WRITTEN_PROGRESS / snapshot.state->size());
+        if (progress - lastReportedProgress >= PROGRESS_REPORT_STEP)
+        {
+            eventMessenger.onSaveStateWriteProgress(job.requestId, progress);
+            lastReportedProgress = progress;
+        }
+    };
+
+    // When using a chunk store, chunks are written before the state file so that the state never references missing chunks
+    bool useChunkStore = !job.chunkStorePath.empty();
+    std::vector<ChunkHash> chunkHashes;
+    std::vector<melonDS::u8> stateSection;
+    WriteResult result = useChunkStore ? storeStateChunks(job, chunkHashes, stateSection, onStateProgress) : compressState(job, stateSection, onStateProgress);
+    if (result == WRITE_RESULT_OK)
+        result = writeStateFile(job, compressedThumbnail, stateSection, useChunkStore);
+
+    // The chunks no longer need to be protected from compactions. If the state file was written, it now references them
+    if (useChunkStore)
+        chunkStore->unpinChunks(job.chunkStorePath, chunkHashes);
+
+    return result;
+}
+
+SaveStateWriter::WriteResult SaveStateWriter::writeStateFile(const WriteJob& job, const std::vector<melonDS::u8>& compressedThumbnail, const std::vector<melonDS::u8>& stateSection, bool useChunkStore)
+{
+    const Snapshot& snapshot = *job.snapshot;
+
+    SaveStateFormat::SaveStateHeader header {};
+    memcpy(header.magic, SaveStateFormat::SAVE_STATE_MAGIC, sizeof(header.magic));
+    header.version = SaveStateFormat::SAVE_STATE_VERSION;
+    header.headerSize = sizeof(header);
+    header.compression = SaveStateFormat::COMPRESSION_ZLIB;
+    header.frameCount = snapshot.frameCount;
+    header.timestamp = snapshot.timestamp;
+    strncpy(header.romHash, job.metadata.romHash.c_str(), sizeof(header.romHash));
+    strncpy(header.emulatorVersion, job.metadata.emulatorVersion.c_str(), sizeof(header.emulatorVersion));
+    header.thumbnailOffset = sizeof(header);
+    header.thumbnailCompressedSize = (melonDS::u32) compressedThumbnail.size();
+    header.thumbnailWidth = compressedThumbnail.empty() ? 0 : SaveStateFormat::THUMBNAIL_WIDTH;
+    header.thumbnailHeight = compressedThumbnail.empty() ? 0 : SaveStateFormat::THUMBNAIL_HEIGHT;
+    header.stateOffset = header.thumbnailOffset + header.thumbnailCompressedSize;
+    header.stateCompressedSize = (melonDS::u32) stateSection.size();
+    header.stateUncompressedSize = (melonDS::u32) snapshot.state->size();
+    header.stateStorage = useChunkStore ? SaveStateFormat::STATE_STORAGE_CHUNK_STORE : SaveStateFormat::STATE_STORAGE_INLINE;
+
+    FILE* file = MelonDSAndroid::fileHandler->open(job.path.c_str(), FileMode::Write);
+    if (!file)
+        return WRITE_RESULT_FILE_OPEN_FAILED;
+
+    WriteResult result = WRITE_RESULT_OK;
+    if (fwrite(&header, sizeof(header), 1, file) != 1
+        || fwrite(compressedThumbnail.data(), 1, compressedThumbnail.size(), file) != compressedThumbnail.size()
+        || fwrite(stateSection.data(), 1, stateSection.size(), file) != stateSection.size())
+    {
+        result = WRITE_RESULT_WRITE_FAILED;
+    }
+
+    if (fclose(file) != 0 && result == WRITE_RESULT_OK)
+        result = WRITE_RESULT_WRITE_FAILED;
+
+    return result;
+}
+
+SaveStateWriter::~SaveStateWriter()
+{
+    {
+        std::lock_guard<std::mutex> lock(jobsMutex);
+        stopWorker = true;
+    }
+    jobsCondition.notify_one();
+
+    if (workerThread.joinable())
+        workerThread.join();
+}
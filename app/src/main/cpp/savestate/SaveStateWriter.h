@@ -0,0 +1,102 @@
+#ifndef MELONDS_ANDROID_SAVESTATEWRITER_H
+#define MELONDS_ANDROID_SAVESTATEWRITER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../AndroidMelonEventMessenger.h"
+#include "../MemoryFileStore.h"
+#include "SaveStateCache.h"
+#include "SaveStateChunkStore.h"
+#include "SaveStateFormat.h"
+#include "types.h"
+
+/**
+ * Saves states in two steps. First, the emulator state is snapshotted into memory at a frame boundary, which only stalls the
+ * emulator for the duration of a memory copy. A thumbnail of the current frame is captured at the same time. Both are then
+ * compressed and written to storage as a save state container (see SaveStateFormat.h) by a background thread. Write progress
+ * and completion are reported through the emulator message queue.
+ */
+class SaveStateWriter
+{
+public:
+    enum WriteResult
+    {
+        WRITE_RESULT_OK = 0,
+        WRITE_RESULT_COMPRESSION_FAILED = 1,
+        WRITE_RESULT_FILE_OPEN_FAILED = 2,
+        WRITE_RESULT_WRITE_FAILED = 3,
+        WRITE_RESULT_CHUNK_STORE_FAILED = 4,
+    };
+
+    /**
+     * @param saveStateCache Cache where saved states are added, so that they can be loaded without reading them from storage
+     * @param chunkStore Store where the contents of states are saved when a chunk store path is provided
+     * @param screenshotBuffer The buffer where the core renders the screenshot of the current frame
+     * @param frameCounter The number of frames emulated since the emulator was started
+     */
+    SaveStateWriter(MemoryFileStore* memoryFileStore, SaveStateCache* saveStateCache, SaveStateChunkStore* chunkStore, const melonDS::u32* screenshotBuffer, const std::atomic<melonDS::u64>& frameCounter);
+    ~SaveStateWriter();
+
+    /**
+     * Snapshots the emulator state and queues it to be written to the given path. Blocks until the snapshot has been taken.
+     * @param chunkStorePath The chunk store of the ROM. If empty, the whole state is stored in the state file
+     * @return True if the snapshot was taken. The result of the write operation is reported asynchronously
+     */
+    bool saveState(const std::string& path, const std::string& chunkStorePath, int requestId, const SaveStateFormat::SaveStateMetadata& metadata);
+
+private:
+    struct Snapshot
+    {
+        std::shared_ptr<std::vector<melonDS::u8>> state;
+        std::vector<melonDS::u8> thumbnail;
+        melonDS::u64 frameCount;
+        melonDS::s64 timestamp;
+    };
+
+    struct WriteJob
+    {
+        int requestId;
+        std::string path;
+        std::string chunkStorePath;
+        SaveStateFormat::SaveStateMetadata metadata;
+        std::shared_ptr<Snapshot> snapshot;
+    };
+
+    static constexpr size_t COMPRESSION_CHUNK_SIZE = 256 * 1024;
+    static constexpr int COMPRESSION_LEVEL = 3;
+    static constexpr int PROGRESS_REPORT_STEP = 10;
+    // Progress reached once the whole state has been compressed or stored. The rest is reported when the write completes
+    static constexpr int STATE_WRITTEN_PROGRESS = 90;
+
+    MemoryFileStore* memoryFileStore;
+    SaveStateCache* saveStateCache;
+    SaveStateChunkStore* chunkStore;
+    const melonDS::u32* screenshotBuffer;
+    const std::atomic<melonDS::u64>& frameCounter;
+    AndroidMelonEventMessenger eventMessenger;
+    size_t lastSnapshotSize = 0;
+
+    std::thread workerThread;
+    std::deque<WriteJob> pendingJobs;
+    std::mutex jobsMutex;
+    std::condition_variable jobsCondition;
+    bool stopWorker = false;
+
+    std::shared_ptr<Snapshot> takeSnapshot();
+    void captureThumbnail(std::vector<melonDS::u8>& thumbnail);
+    void enqueueJob(WriteJob job);
+    void processJobs();
+    WriteResult compressState(const WriteJob& job, std::vector<melonDS::u8>& compressedState, const std::function<void(size_t)>& onProgress);
+    WriteResult storeStateChunks(const WriteJob& job, std::vector<ChunkHash>& chunkHashes, std::vector<melonDS::u8>& chunkManifest, const std::function<void(size_t)>& onProgress);
+    WriteResult writeContainer(const WriteJob& job);
+    WriteResult writeStateFile(const WriteJob& job, const std::vector<melonDS::u8>& compressedThumbnail, const std::vector<melonDS::u8>& stateSection, bool useChunkStore);
+};
+
+#endif //MELONDS_ANDROID_SAVESTATEWRITER_H
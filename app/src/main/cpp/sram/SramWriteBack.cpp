@@ -0,0 +1,513 @@
+#include "SramWriteBack.h"
+#include <fcntl.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <android/log.h>
+
+#define LOG_TAG "SramWriteBack"
+#define LOGW(...) __android_log_print(ANDROID_LOG_WARN, LOG_TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+using namespace melonDS;
+using namespace melonDS::Platform;
+
+namespace
+{
+    struct StagedFileCookie
+    {
+        std::vector<u8> contents;
+        size_t position;
+        bool isAppend;
+        std::function<void(std::vector<u8>&)> onClose;
+    };
+
+    int readStagedFile(void* cookie, char* buffer, int size)
+    {
+        auto file = (StagedFileCookie*) cookie;
+        if (file->position >= file->contents.size())
+            return 0;
+
+        size_t bytesToRead = std::min((size_t) size, file->contents.size() - file->position);
+        memcpy(buffer, file->contents.data() + file->position, bytesToRead);
+        file->position += bytesToRead;
+        return (int) bytesToRead;
+    }
+
+    int writeStagedFile(void* cookie, const char* buffer, int size)
+    {
+        auto file = (StagedFileCookie*) cookie;
+        if (file->isAppend)
+            file->position = file->contents.size();
+
+        if (file->position + size > file->contents.size())
+            file->contents.resize(file->position + size);
+
+        memcpy(file->contents.data() + file->position, buffer, size);
+        file->position += size;
+        return size;
+    }
+
+    fpos_t seekStagedFile(void* cookie, fpos_t offset, int whence)
+    {
+        auto file = (StagedFileCookie*) cookie;
+        fpos_t newPosition;
+        switch (whence)
+        {
+            case SEEK_SET:
+                newPosition = offset;
+                break;
+            case SEEK_CUR:
+                newPosition = (fpos_t) file->position + offset;
+                break;
+            case SEEK_END:
+                newPosition = (fpos_t) file->contents.size() + offset;
+                break;
+            default:
+                return -1;
+        }
+
+        if (newPosition < 0)
+            return -1;
+
+        file->position = (size_t) newPosition;
+        return newPosition;
+    }
+
+    int closeStagedFile(void* cookie)
+    {
+        auto file = (StagedFileCookie*) cookie;
+        file->onClose(file->contents);
+        delete file;
+        return 0;
+    }
+
+    bool writeFully(int fd, const u8* data, size_t length, off64_t offset)
+    {
+        while (length > 0)
+        {
+            ssize_t bytesWritten = pwrite64(fd, data, length, offset);
+            if (bytesWritten <= 0)
+                return false;
+
+            data += bytesWritten;
+            length -= bytesWritten;
+            offset += bytesWritten;
+        }
+
+        return true;
+    }
+
+    bool readFully(int fd, u8* data, size_t length, off64_t offset)
+    {
+        while (length > 0)
+        {
+            ssize_t bytesRead = pread64(fd, data, length, offset);
+            if (bytesRead <= 0)
+                return false;
+
+            data += bytesRead;
+            length -= bytesRead;
+            offset += bytesRead;
+        }
+
+        return true;
+    }
+}
+
+SramWriteBack::SramWriteBack(FileDescriptorOpener openFileDescriptor) : openFileDescriptor(std::move(openFileDescriptor))
+{
+    workerThread = std::thread(&SramWriteBack::processWrites, this);
+    pthread_setname_np(workerThread.native_handle(), "SramWriteBack");
+}
+
+SramWriteBack::~SramWriteBack()
+{
+    {
+        std::unique_lock<std::mutex> lock(writeMutex);
+        detachLocked(lock);
+        stopWorker = true;
+    }
+
+    writeCondition.notify_one();
+    workerThread.join();
+}
+
+void SramWriteBack::setOptions(std::chrono::milliseconds coalescingWindow, const std::string& journalDirectory)
+{
+    std::lock_guard<std::mutex> lock(writeMutex);
+    this->coalescingWindow = coalescingWindow;
+    this->journalDirectory = journalDirectory;
+}
+
+bool SramWriteBack::attach(const std::string& path)
+{
+    std::unique_lock<std::mutex> lock(writeMutex);
+    detachLocked(lock);
+
+    int fileDescriptor = openFileDescriptor(path.c_str());
+    if (fileDescriptor == -1)
+        return false;
+
+    replayJournal(fileDescriptor, path);
+
+    struct stat64 fileStat {};
+    if (fstat64(fileDescriptor, &fileStat) != 0)
+    {
+        close(fileDescriptor);
+        return false;
+    }
+
+    std::vector<u8> fileContents((size_t) fileStat.st_size);
+    if (!readFully(fileDescriptor, fileContents.data(), fileContents.size(), 0))
+    {
+        close(fileDescriptor);
+        return false;
+    }
+
+    this->path = path;
+    fd = fileDescriptor;
+    contents = std::move(fileContents);
+    persistedSize = contents.size();
+    return true;
+}
+
+void SramWriteBack::detach()
+{
+    std::unique_lock<std::mutex> lock(writeMutex);
+    detachLocked(lock);
+}
+
+void SramWriteBack::detachLocked(std::unique_lock<std::mutex>& lock)
+{
+    if (fd == -1)
+        return;
+
+    bool isWritten = writePendingChanges(lock);
+    for (int attempt = 1; !isWritten && attempt < DETACH_WRITE_ATTEMPTS; attempt++)
+    {
+        writtenCondition.wait_for(lock, MIN_RETRY_DELAY * attempt, [] { return false; });
+        isWritten = writePendingChanges(lock);
+    }
+
+    if (!isWritten)
+    {
+        // Keep the latest contents in the journal, so that they are written the next time the file is attached
+        std::string journalPath = getJournalPath(path);
+        if (!journalPath.empty() && writeJournal(journalPath, path, contents))
+            LOGW("Failed to write save file %s. Changes will be written when it's loaded again", path.c_str());
+        else
+            LOGE("Failed to write save file %s. Changes have been lost", path.c_str());
+    }
+
+    close(fd);
+    fd = -1;
+    path.clear();
+    contents.clear();
+    contents.shrink_to_fit();
+    dirtyRanges.clear();
+    persistedSize = 0;
+    hasPendingWrite = false;
+    isFlushRequested = false;
+    failedWriteCount = 0;
+    retryTime = {};
+}
+
+bool SramWriteBack::writePendingChanges(std::unique_lock<std::mutex>& lock)
+{
+    if (!hasPendingWrite && !isWriting)
+        return true;
+
+    // A write that is already running may not include the latest changes, in which case the next one has to finish too
+    u64 targetWriteCount = finishedWriteCount + (hasPendingWrite && isWriting ? 2 : 1);
+    if (hasPendingWrite)
+    {
+        isFlushRequested = true;
+        writeCondition.notify_one();
+    }
+
+    writtenCondition.wait(lock, [this, targetWriteCount] {
+        return !isWriting && (!hasPendingWrite || finishedWriteCount >= targetWriteCount);
+    });
+
+    return !hasPendingWrite;
+}
+
+bool SramWriteBack::isAttachedFile(const char* path)
+{
+    std::lock_guard<std::mutex> lock(writeMutex);
+    return fd != -1 && this->path == path;
+}
+
+FILE* SramWriteBack::openForWrite(FileMode mode)
+{
+    std::string filePath;
+    auto cookie = new StagedFileCookie {
+        .position = 0,
+        .isAppend = (mode & FileMode::Append) != 0,
+    };
+
+    {
+        std::lock_guard<std::mutex> lock(writeMutex);
+        filePath = path;
+        if (!(mode & FileMode::Write) || (mode & (FileMode::Preserve | FileMode::Append | FileMode::NoCreate)))
+            cookie->contents = contents;
+    }
+
+    cookie->onClose = [this, filePath](std::vector<u8>& newContents) {
+        std::lock_guard<std::mutex> lock(writeMutex);
+        // The file may have been detached while it was open
+        if (fd != -1 && path == filePath)
+            commit(newContents);
+    };
+
+    FILE* file = funopen(cookie, (mode & FileMode::Read) ? readStagedFile : nullptr, writeStagedFile, seekStagedFile, closeStagedFile);
+    if (!file)
+        delete cookie;
+
+    return file;
+}
+
+void SramWriteBack::flush(bool wait)
+{
+    std::unique_lock<std::mutex> lock(writeMutex);
+    if (wait)
+    {
+        writePendingChanges(lock);
+    }
+    else if (hasPendingWrite)
+    {
+        isFlushRequested = true;
+        writeCondition.notify_one();
+    }
+}
+
+void SramWriteBack::commit(std::vector<u8>& newContents)
+{
+    size_t commonSize = std::min(contents.size(), newContents.size());
+    for (size_t offset = 0; offset < commonSize; offset += DIFF_BLOCK_SIZE)
+    {
+        size_t blockSize = std::min(DIFF_BLOCK_SIZE, commonSize - offset);
+        if (memcmp(contents.data() + offset, newContents.data() + offset, blockSize) != 0)
+            markDirty(offset, offset + blockSize);
+    }
+
+    if (newContents.size() > contents.size())
+        markDirty(contents.size(), newContents.size());
+
+    // Ranges past the end of the new contents no longer exist. The file is truncated when it's written
+    auto range = dirtyRanges.lower_bound(newContents.size());
+    dirtyRanges.erase(range, dirtyRanges.end());
+    if (!dirtyRanges.empty() && std::prev(dirtyRanges.end())->second > newContents.size())
+        std::prev(dirtyRanges.end())->second = newContents.size();
+
+    contents.swap(newContents);
+    if (dirtyRanges.empty() && contents.size() == persistedSize)
+        return;
+
+    hasPendingWrite = true;
+    lastChangeTime = std::chrono::steady_clock::now();
+    writeCondition.notify_one();
+}
+
+void SramWriteBack::markDirty(u64 start, u64 end)
+{
+    auto next = dirtyRanges.upper_bound(start);
+    if (next != dirtyRanges.begin())
+    {
+        auto previous = std::prev(next);
+        if (previous->second >= start)
+        {
+            start = previous->first;
+            end = std::max(end, previous->second);
+            dirtyRanges.erase(previous);
+        }
+    }
+
+    while (next != dirtyRanges.end() && next->first <= end)
+    {
+        end = std::max(end, next->second);
+        next = dirtyRanges.erase(next);
+    }
+
+    dirtyRanges[start] = end;
+}
+
+void SramWriteBack::processWrites()
+{
+    std::unique_lock<std::mutex> lock(writeMutex);
+    while (true)
+    {
+        writeCondition.wait(lock, [this] { return stopWorker || hasPendingWrite; });
+        if (!hasPendingWrite)
+            break;
+
+        // Wait for the game to stop saving. Every commit moves the end of the window. After a failure, also wait for the retry delay
+        while (!isFlushRequested && !stopWorker)
+        {
+            auto windowEnd = std::max(lastChangeTime + coalescingWindow, retryTime);
+            if (std::chrono::steady_clock::now() >= windowEnd)
+                break;
+
+            writeCondition.wait_until(lock, windowEnd);
+        }
+
+        int fileDescriptor = fd;
+        std::string filePath = path;
+        std::string journalPath = getJournalPath(path);
+        std::vector<u8> fileContents = contents;
+        std::map<u64, u64> ranges;
+        ranges.swap(dirtyRanges);
+        u64 previousSize = persistedSize;
+        hasPendingWrite = false;
+        isFlushRequested = false;
+        isWriting = true;
+
+        lock.unlock();
+        bool result = writeChanges(fileDescriptor, filePath, journalPath, fileContents, ranges, previousSize);
+        lock.lock();
+
+        isWriting = false;
+        finishedWriteCount++;
+        if (result)
+        {
+            persistedSize = fileContents.size();
+            failedWriteCount = 0;
+            retryTime = {};
+        }
+        else
+        {
+            // Keep the ranges and try again later
+            failedWriteCount++;
+            auto retryDelay = std::min(MIN_RETRY_DELAY * (1 << std::min(failedWriteCount - 1, 6)), MAX_RETRY_DELAY);
+            LOGW("Failed to write save file %s. Retrying in %lld ms", filePath.c_str(), (long long) retryDelay.count());
+
+            for (const auto& range : ranges)
+            {
+                if (range.first < contents.size())
+                    markDirty(range.first, std::min<u64>(range.second, contents.size()));
+            }
+            hasPendingWrite = true;
+            retryTime = std::chrono::steady_clock::now() + retryDelay;
+        }
+
+        writtenCondition.notify_all();
+    }
+}
+
+bool SramWriteBack::writeChanges(int fileDescriptor, const std::string& filePath, std::string journalPath, const std::vector<u8>& fileContents, const std::map<u64, u64>& ranges, u64 previousSize)
+{
+    if (!journalPath.empty() && !writeJournal(journalPath, filePath, fileContents))
+        journalPath.clear();
+
+    for (const auto& range : ranges)
+    {
+        if (!writeFully(fileDescriptor, fileContents.data() + range.first, range.second - range.first, range.first))
+            return false;
+    }
+
+    if (fileContents.size() < previousSize && ftruncate64(fileDescriptor, fileContents.size()) != 0)
+        return false;
+
+    if (fdatasync(fileDescriptor) != 0)
+        return false;
+
+    if (!journalPath.empty())
+        unlink(journalPath.c_str());
+
+    return true;
+}
+
+bool SramWriteBack::writeJournal(const std::string& journalPath, const std::string& filePath, const std::vector<u8>& fileContents)
+{
+    std::string tempPath = journalPath + ".tmp";
+    int journalFd = ::open(tempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (journalFd == -1)
+        return false;
+
+    u64 magic = JOURNAL_MAGIC;
+    u32 pathLength = filePath.size();
+    u64 contentsSize = fileContents.size();
+
+    off64_t offset = 0;
+    bool result = writeFully(journalFd, (const u8*) &magic, sizeof(magic), offset);
+    offset += sizeof(magic);
+    result = result && writeFully(journalFd, (const u8*) &pathLength, sizeof(pathLength), offset);
+    offset += sizeof(pathLength);
+    result = result && writeFully(journalFd, (const u8*) filePath.data(), pathLength, offset);
+    offset += pathLength;
+    result = result && writeFully(journalFd, (const u8*) &contentsSize, sizeof(contentsSize), offset);
+    offset += sizeof(contentsSize);
+    result = result && writeFully(journalFd, fileContents.data(), fileContents.size(), offset);
+    result = result && fsync(journalFd) == 0;
+    close(journalFd);
+
+    if (!result || rename(tempPath.c_str(), journalPath.c_str()) != 0)
+    {
+        unlink(tempPath.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+void SramWriteBack::replayJournal(int fileDescriptor, const std::string& filePath)
+{
+    std::string journalPath = getJournalPath(filePath);
+    if (journalPath.empty())
+        return;
+
+    int journalFd = ::open(journalPath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (journalFd == -1)
+        return;
+
+    u64 magic = 0;
+    u32 pathLength = 0;
+    u64 contentsSize = 0;
+    std::string journalFilePath;
+    std::vector<u8> journalContents;
+
+    off64_t offset = 0;
+    bool result = readFully(journalFd, (u8*) &magic, sizeof(magic), offset) && magic == JOURNAL_MAGIC;
+    offset += sizeof(magic);
+    result = result && readFully(journalFd, (u8*) &pathLength, sizeof(pathLength), offset);
+    offset += sizeof(pathLength);
+    if (result)
+    {
+        journalFilePath.resize(pathLength);
+        result = readFully(journalFd, (u8*) journalFilePath.data(), pathLength, offset) && journalFilePath == filePath;
+        offset += pathLength;
+    }
+    result = result && readFully(journalFd, (u8*) &contentsSize, sizeof(contentsSize), offset);
+    offset += sizeof(contentsSize);
+    if (result)
+    {
+        journalContents.resize(contentsSize);
+        result = readFully(journalFd, journalContents.data(), journalContents.size(), offset);
+    }
+    close(journalFd);
+
+    // A journal only exists if the last write of the file was interrupted, so the file has to be rewritten completely
+    if (result)
+    {
+        result = writeFully(fileDescriptor, journalContents.data(), journalContents.size(), 0)
+                 && ftruncate64(fileDescriptor, journalContents.size()) == 0
+                 && fdatasync(fileDescriptor) == 0;
+    }
+
+    if (result)
+        unlink(journalPath.c_str());
+    else
+        LOGW("Failed to replay save file journal %s", journalPath.c_str());
+}
+
+std::string SramWriteBack::getJournalPath(const std::string& filePath)
+{
+    if (journalDirectory.empty() || filePath.empty())
+        return "";
+
+    char name[32];
+    snprintf(name, sizeof(name), "%016zx.journal", std::hash<std::string>()(filePath));
+    return journalDirectory + "/" + name;
+}
@@ -0,0 +1,108 @@
+#ifndef MELONDS_ANDROID_SRAMWRITEBACK_H
+#define MELONDS_ANDROID_SRAMWRITEBACK_H
+
+#include <stdio.h>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Platform.h"
+#include "types.h"
+
+/**
+ * Persists the save memory of the running game in the background. The core rewrites the whole save file every time the game saves,
+ * which some games do several times in a row. Instead of going to storage, the writes of the core are captured in memory, compared
+ * with the previous contents of the file to find the ranges that actually changed, and written by a background thread once the game
+ * has stopped saving for the coalescing window. Only the changed ranges are written.
+ *
+ * When a journal directory is set, the full contents are first written to a journal file in app storage, so that a write that is
+ * interrupted halfway through can be completed the next time the file is attached. Save files are documents that can't be replaced
+ * atomically, so this takes the place of writing a temporary file and renaming it.
+ */
+class SramWriteBack
+{
+public:
+    /**
+     * Function used to open the save file. Must open the file for reading and writing, without truncating it.
+     */
+    using FileDescriptorOpener = std::function<int(const char*)>;
+
+    static constexpr std::chrono::milliseconds DEFAULT_COALESCING_WINDOW { 1000 };
+
+    explicit SramWriteBack(FileDescriptorOpener openFileDescriptor);
+    ~SramWriteBack();
+
+    /**
+     * @param journalDirectory Directory where journals are written. If empty, save files are written without a journal
+     */
+    void setOptions(std::chrono::milliseconds coalescingWindow, const std::string& journalDirectory);
+
+    /**
+     * Starts capturing the writes to the given save file, after writing all pending changes of the previously attached file.
+     * @return False if the file can't be opened, in which case writes to it go straight to storage
+     */
+    bool attach(const std::string& path);
+    void detach();
+    bool isAttachedFile(const char* path);
+
+    /**
+     * Opens the attached file for writing. The contents written to the file are committed when it is closed.
+     */
+    FILE* openForWrite(melonDS::Platform::FileMode mode);
+
+    /**
+     * Writes pending changes right away, instead of waiting for the coalescing window to end.
+     * @param wait Whether to block until the changes have been written, or until the write fails
+     */
+    void flush(bool wait);
+
+private:
+    static constexpr size_t DIFF_BLOCK_SIZE = 256;
+    static constexpr melonDS::u64 JOURNAL_MAGIC = 0x4C4E524A4D415253; // "SRAMJRNL"
+    // Failed writes are retried in the background after a delay that doubles with every failure
+    static constexpr std::chrono::milliseconds MIN_RETRY_DELAY { 500 };
+    static constexpr std::chrono::milliseconds MAX_RETRY_DELAY { 30000 };
+    static constexpr int DETACH_WRITE_ATTEMPTS = 3;
+
+    FileDescriptorOpener openFileDescriptor;
+    std::chrono::milliseconds coalescingWindow = DEFAULT_COALESCING_WINDOW;
+    std::string journalDirectory;
+
+    std::string path;
+    int fd = -1;
+    // Latest contents committed by the core, and size of the file in storage
+    std::vector<melonDS::u8> contents;
+    melonDS::u64 persistedSize = 0;
+    // Ranges of the contents that have not been written yet, as [start, end) pairs keyed by start
+    std::map<melonDS::u64, melonDS::u64> dirtyRanges;
+    bool hasPendingWrite = false;
+    bool isFlushRequested = false;
+    bool isWriting = false;
+    std::chrono::steady_clock::time_point lastChangeTime;
+    int failedWriteCount = 0;
+    std::chrono::steady_clock::time_point retryTime;
+    // Number of write attempts that have finished, successfully or not
+    melonDS::u64 finishedWriteCount = 0;
+
+    std::thread workerThread;
+    std::mutex writeMutex;
+    std::condition_variable writeCondition;
+    std::condition_variable writtenCondition;
+    bool stopWorker = false;
+
+    void detachLocked(std::unique_lock<std::mutex>& lock);
+    bool writePendingChanges(std::unique_lock<std::mutex>& lock);
+    void commit(std::vector<melonDS::u8>& newContents);
+    void markDirty(melonDS::u64 start, melonDS::u64 end);
+    void processWrites();
+    bool writeChanges(int fileDescriptor, const std::string& filePath, std::string journalPath, const std::vector<melonDS::u8>& fileContents, const std::map<melonDS::u64, melonDS::u64>& ranges, melonDS::u64 previousSize);
+    bool writeJournal(const std::string& journalPath, const std::string& filePath, const std::vector<melonDS::u8>& fileContents);
+    void replayJournal(int fileDescriptor, const std::string& filePath);
+    std::string getJournalPath(const std::string& filePath);
+};
+
+#endif //MELONDS_ANDROID_SRAMWRITEBACK_H
@@ -0,0 +1,41 @@
+package me.magnum.melonds
+
+import me.magnum.melonds.domain.model.CheatCodeError
+
+object MelonCheatCodeParser {
+    // Must match the values in CheatCodeParser.h
+    private const val PARSE_OK = 0
+    private const val PARSE_ERROR_EMPTY = 1
+    private const val PARSE_ERROR_INVALID_CHARACTER = 2
+    private const val PARSE_ERROR_INVALID_WORD_LENGTH = 3
+    private const val PARSE_ERROR_INCOMPLETE_LINE = 4
+
+    /**
+     * Validates the given cheat codes with the same parser that is used when cheats are enabled in the emulator.
+     *
+     * @return The error of each code, in the same order, or null if the code is valid
+     */
+    fun validateCheatCodes(codes: List<String>): List<CheatCodeError?> {
+        return decodeResults(validateCheatCodesInternal(codes.toTypedArray()))
+    }
+
+    /**
+     * Decodes the results returned by native code, which are stored as pairs of error code and position.
+     */
+    internal fun decodeResults(results: IntArray): List<CheatCodeError?> {
+        return List(results.size / 2) { index ->
+            val reason = when (results[index * 2]) {
+                PARSE_OK -> null
+                PARSE_ERROR_EMPTY -> CheatCodeError.Reason.EMPTY
+                PARSE_ERROR_INVALID_CHARACTER -> CheatCodeError.Reason.INVALID_CHARACTER
+                PARSE_ERROR_INVALID_WORD_LENGTH -> CheatCodeError.Reason.INVALID_WORD_LENGTH
+                PARSE_ERROR_INCOMPLETE_LINE -> CheatCodeError.Reason.INCOMPLETE_LINE
+                else -> CheatCodeError.Reason.INVALID_CHARACTER
+            }
+
+            reason?.let { CheatCodeError(it, results[index * 2 + 1]) }
+        }
+    }
+
+    private external fun validateCheatCodesInternal(codes: Array<String>): IntArray
+}
@@ -3,7 +3,43 @@ package me.magnum.melonds
 import me.magnum.melonds.common.UriFileHandler
 
 object MelonDSAndroidInterface {
+    /**
+     * Totals of the files opened by the emulator since setup.
+     *
+     * @param cachedOpenCount Number of opens served from native descriptor cache, without going through [UriFileHandler]
+     * @param bytesRead Bytes read from files opened for reading only
+     */
+    data class FileAccessStats(
+        val openCount: Long,
+        val cachedOpenCount: Long,
+        val openTimeMicros: Long,
+        val bytesRead: Long,
+    )
+
     external fun setup(uriFileHandler: UriFileHandler)
     external fun getEmulatorGlContext(): Long
+
+    /**
+     * Releases memory held by native caches.
+     *
+     * @param releaseAll Whether all cached memory should be released, or only part of it
+     */
+    external fun trimMemory(releaseAll: Boolean)
     external fun cleanup()
+
+    /**
+     * Configures how changes to save files are written to storage.
+     *
+     * @param coalescingWindowMs Time that has to pass after the last change before changes are written
+     * @param journalDirectory Directory where a journal of each write is kept until the write completes, so that interrupted writes
+     * can be completed later. If null, writes are not journaled
+     */
+    external fun setSramWriteBackOptions(coalescingWindowMs: Int, journalDirectory: String?)
+
+    fun getFileAccessStats(): FileAccessStats {
+        val stats = getFileAccessStatsInternal()
+        return FileAccessStats(stats[0], stats[1], stats[2], stats[3])
+    }
+
+    private external fun getFileAccessStatsInternal(): LongArray
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 package me.magnum.melonds
 
 import android.app.Application
+import android.content.ComponentCallbacks2
 import androidx.appcompat.app.AppCompatDelegate
 import androidx.core.app.NotificationChannelCompat
 import androidx.core.app.NotificationManagerCompat
@@ -62,6 +63,16 @@ class MelonDSApplication : Application(), Configuration.Provider {
         migrator.performMigrations()
     }
 
+    override fun onTrimMemory(level: Int) {
+        super.onTrimMemory(level)
+        when {
+            // Keep caches when the UI is just hidden so that they are still available if the user returns to the app
+            level == ComponentCallbacks2.TRIM_MEMORY_UI_HIDDEN -> Unit
+            level >= ComponentCallbacks2.TRIM_MEMORY_RUNNING_CRITICAL -> MelonDSAndroidInterface.trimMemory(releaseAll = true)
+            level >= ComponentCallbacks2.TRIM_MEMORY_RUNNING_MODERATE -> MelonDSAndroidInterface.trimMemory(releaseAll = false)
+        }
+    }
+
     override fun onTerminate() {
         super.onTerminate()
         MelonDSAndroidInterface.cleanup()
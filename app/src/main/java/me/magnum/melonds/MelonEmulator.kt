@@ -4,11 +4,12 @@ import android.net.Uri
 import me.magnum.melonds.common.camera.DSiCameraSource
 import me.magnum.melonds.common.ir.IRManager
 import me.magnum.melonds.domain.model.Cheat
+import me.magnum.melonds.domain.model.CheatCodeError
 import me.magnum.melonds.domain.model.EmulatorConfiguration
 import me.magnum.melonds.domain.model.Input
 import me.magnum.melonds.domain.model.retroachievements.RASimpleAchievement
 import me.magnum.melonds.domain.model.retroachievements.RASimpleLeaderboard
-import me.magnum.melonds.domain.model.retroachievements.RASimpleRuntimeAchievement
+import me.magnum.melonds.impl.emulator.EmulatorEventType
 import me.magnum.melonds.ui.emulator.render.FrameRenderCallback
 import me.magnum.melonds.ui.emulator.rewind.model.RewindSaveState
 import me.magnum.melonds.ui.emulator.rewind.model.RewindWindow
@@ -46,22 +47,62 @@ object MelonEmulator {
         MEMORY_EXPANSION,
     }
 
+    /**
+     * Sets up the emulator core. If the core was kept warm by the previous session and the configuration still allows it, the core
+     * is reused instead of being set up again.
+     *
+     * @return Whether the core of the previous session was reused
+     */
 	external fun setupEmulator(
         emulatorConfiguration: EmulatorConfiguration,
         dsiCameraSource: DSiCameraSource?,
         irManager: IRManager?,
         screenshotBuffer: ByteBuffer,
-    )
+    ): Boolean
+
+    /**
+     * Replaces the cheats that are applied by the emulator. Cheats with invalid codes are ignored.
+     *
+     * @param cheatIds The ID with which each cheat is registered, in the same order. Used to update the cheats afterwards
+     * @return The error of each cheat, in the same order, or null if the cheat is valid
+     */
+    fun setupCheats(cheats: Array<Cheat>, cheatIds: LongArray): List<CheatCodeError?> {
+        return MelonCheatCodeParser.decodeResults(setupCheatsInternal(cheats, cheatIds))
+    }
+
+    /**
+     * Adds a cheat to the ones applied by the emulator, replacing any cheat that was registered with the same ID. The code is only
+     * parsed once, so the cheat can later be toggled with [setCheatEnabled] without any parsing cost.
+     *
+     * @return The error of the cheat code, or null if it is valid. Invalid cheats are not added
+     */
+    fun addCheat(id: Long, code: String, enabled: Boolean): CheatCodeError? {
+        return MelonCheatCodeParser.decodeResults(addCheatInternal(id, code, enabled)).first()
+    }
+
+    external fun removeCheat(id: Long)
 
-    external fun setupCheats(cheats: Array<Cheat>)
+    external fun setCheatEnabled(id: Long, enabled: Boolean)
 
-    external fun setupAchievements(achievements: Array<RASimpleAchievement>, leaderboards: Array<RASimpleLeaderboard>, richPresenceScript: String?)
+    private external fun setupCheatsInternal(cheats: Array<Cheat>, cheatIds: LongArray): IntArray
+
+    private external fun addCheatInternal(id: Long, code: String, enabled: Boolean): IntArray
+
+    /**
+     * @param richPresenceUpdateIntervalFrames Number of frames between evaluations of the rich presence. Changes to the rich presence
+     * text are reported through [me.magnum.melonds.impl.emulator.EmulatorEventType.EventRARichPresenceUpdated]
+     */
+    external fun setupAchievements(achievements: Array<RASimpleAchievement>, leaderboards: Array<RASimpleLeaderboard>, richPresenceScript: String?, richPresenceUpdateIntervalFrames: Int)
 
     external fun unloadRetroAchievementsData()
 
-    external fun getRichPresenceStatus(): String?
+    /**
+     * Refreshes the native runtime achievement table with the current progress of the achievements.
+     * @return True if the table memory was reallocated, in which case the buffer must be fetched again with [getRuntimeAchievementTable]
+     */
+    external fun updateRuntimeAchievementTable(): Boolean
 
-    external fun getRuntimeAchievements(): Array<RASimpleRuntimeAchievement>
+    external fun getRuntimeAchievementTable(): ByteBuffer
 
 	fun loadRom(romUri: Uri, sramUri: Uri, gbaSlotType: GbaSlotType, gbaRomUri: Uri?, gbaSramUri: Uri?): LoadResult {
         val loadResult = loadRomInternal(romUri.toString(), sramUri.toString(), gbaSlotType.ordinal, gbaRomUri?.toString(), gbaSramUri?.toString())
@@ -89,25 +130,57 @@ object MelonEmulator {
 
 	external fun getFPS(): Float
 
+    /**
+     * @return The average time spent running cheats in each frame, in microseconds
+     */
+    external fun getCheatEngineFrameTime(): Float
+
 	external fun pauseEmulation()
 
 	external fun resumeEmulation()
 
     external fun resetEmulation()
 
-	external fun stopEmulation()
-
-    fun saveState(path: Uri): Boolean {
-        return saveStateInternal(path.toString())
+    /**
+     * Stops the emulation.
+     *
+     * @param keepWarm Whether to keep the emulator core set up, so that the next session can start faster. The core must then be
+     * released with [releaseWarmEmulator] once it's no longer needed
+     */
+	external fun stopEmulation(keepWarm: Boolean)
+
+    /**
+     * Releases the emulator core kept by [stopEmulation], if any.
+     */
+    external fun releaseWarmEmulator()
+
+    /**
+     * Snapshots the current emulator state and writes it to the given path in the background. This method only blocks until the
+     * snapshot has been taken. The result of the write is reported through an [EmulatorEventType.EventSaveStateWriteCompleted] event
+     * with the given [requestId].
+     *
+     * @param chunkStorePath The chunk store of the ROM, where the contents of the state are saved. Chunks that are shared with other
+     * states of the ROM are only stored once
+     * @param romHash The hash of the loaded ROM. Stored in the state so that it can't be loaded with a different ROM
+     * @param emulatorVersion The version of the app that created the state
+     * @return Whether the emulator state snapshot was taken. If false, the state will not be written
+     */
+    fun saveState(path: Uri, chunkStorePath: Uri, requestId: Int, romHash: String, emulatorVersion: String): Boolean {
+        return saveStateInternal(path.toString(), chunkStorePath.toString(), requestId, romHash, emulatorVersion)
     }
 
-    private external fun saveStateInternal(path: String): Boolean
+    private external fun saveStateInternal(path: String, chunkStorePath: String, requestId: Int, romHash: String, emulatorVersion: String): Boolean
 
-    fun loadState(path: Uri): Boolean {
-        return loadStateInternal(path.toString())
+    /**
+     * Loads the state at the given path. States created for a ROM other than the one with the given [romHash] are rejected.
+     *
+     * @param chunkStorePath The chunk store of the ROM. Only used if the contents of the state were saved to a chunk store
+     */
+    fun loadState(path: Uri, chunkStorePath: Uri, romHash: String): Boolean {
+        return loadStateInternal(path.toString(), chunkStorePath.toString(), romHash)
     }
 
-    private external fun loadStateInternal(path: String): Boolean
+    private external fun loadStateInternal(path: String, chunkStorePath: String, romHash: String): Boolean
 
     external fun loadRewindState(rewindSaveState: RewindSaveState): Boolean
 
@@ -0,0 +1,65 @@
+package me.magnum.melonds
+
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+import java.nio.IntBuffer
+
+/**
+ * Searches the main RAM of the running game for values, to find the addresses needed to create cheats. A search starts with every
+ * value of main RAM as a candidate, and each call to [filterCandidates] compares the current memory with the memory at the time of
+ * the previous pass, discarding the candidates that don't match.
+ */
+object MelonMemorySearch {
+    enum class SearchWidth(internal val bytes: Int) {
+        BITS_8(1),
+        BITS_16(2),
+        BITS_32(4),
+    }
+
+    // Must match the values in MemorySearch.h
+    enum class Comparison(internal val value: Int) {
+        EQUAL_TO_VALUE(0),
+        CHANGED(1),
+        UNCHANGED(2),
+        INCREASED(3),
+        DECREASED(4),
+    }
+
+    /**
+     * Starts a new search, discarding the previous one.
+     *
+     * @return False if the emulator is not running
+     */
+    fun startSearch(width: SearchWidth): Boolean {
+        return startSearchInternal(width.bytes)
+    }
+
+    /**
+     * Discards the candidates that don't match the given comparison.
+     *
+     * @param value The value to compare with. Only used by [Comparison.EQUAL_TO_VALUE]
+     * @return The number of remaining candidates, or -1 if there is no search in progress or the emulator is not running
+     */
+    fun filterCandidates(comparison: Comparison, value: Int = 0): Long {
+        return filterCandidatesInternal(comparison.value, value)
+    }
+
+    /**
+     * Returns up to [maxResults] candidates, as pairs of address and current value. The buffer is backed by native memory that is only
+     * valid until the next call to any method of this object, so values must be copied out before that.
+     */
+    fun getResults(maxResults: Int): IntBuffer? {
+        return getResultsInternal(maxResults)?.order(ByteOrder.nativeOrder())?.asIntBuffer()
+    }
+
+    /**
+     * Ends the current search and releases its memory.
+     */
+    external fun resetSearch()
+
+    private external fun startSearchInternal(width: Int): Boolean
+
+    private external fun filterCandidatesInternal(comparison: Int, value: Int): Long
+
+    private external fun getResultsInternal(maxResults: Int): ByteBuffer?
+}
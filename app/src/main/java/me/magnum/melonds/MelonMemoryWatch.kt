@@ -0,0 +1,67 @@
+package me.magnum.melonds
+
+import java.nio.ByteBuffer
+
+/**
+ * Watches ranges of main RAM of the running game. The emulator copies the values of the watched ranges into a buffer shared with
+ * native code after every frame, so reading them never has to wait for the emulator thread. The values are copied out of the buffer
+ * in native code, where the copy can be checked against the frames published in the meantime.
+ */
+object MelonMemoryWatch {
+    class WatchedRange(val address: Int, val size: Int)
+
+    private var watchBuffer: ByteBuffer? = null
+    private var rangeOffsets = IntArray(0)
+    private var rangeSizes = IntArray(0)
+    private var valuesSize = 0
+
+    /**
+     * Replaces the watched ranges. Ranges must be in main RAM, and their total size can't exceed 64 KB.
+     *
+     * @return False if the ranges are not valid, in which case nothing is watched
+     */
+    @Synchronized
+    fun setWatchedRanges(ranges: List<WatchedRange>): Boolean {
+        if (ranges.isEmpty()) {
+            clearWatchedRanges()
+            return true
+        }
+
+        // The previous buffer is released by native code, so it must not be accessed anymore
+        watchBuffer = null
+
+        val addresses = IntArray(ranges.size) { ranges[it].address }
+        val sizes = IntArray(ranges.size) { ranges[it].size }
+        val buffer = setWatchedRangesInternal(addresses, sizes) ?: return false
+
+        var offset = 0
+        rangeOffsets = IntArray(ranges.size) { index ->
+            offset.also { offset += (ranges[index].size + 3) and 3.inv() }
+        }
+        rangeSizes = sizes
+        valuesSize = offset
+        watchBuffer = buffer
+        return true
+    }
+
+    @Synchronized
+    fun clearWatchedRanges() {
+        watchBuffer = null
+        setWatchedRangesInternal(IntArray(0), IntArray(0))
+    }
+
+    /**
+     * Copies the latest values of the watched range at the given index into [destination], which must be at least as big as the range.
+     *
+     * @return The number of frames that have been published since the ranges were set, or -1 if nothing is being watched
+     */
+    @Synchronized
+    fun readRange(rangeIndex: Int, destination: ByteArray): Int {
+        val buffer = watchBuffer ?: return -1
+        return readRangeInternal(buffer, valuesSize, rangeOffsets[rangeIndex], destination, minOf(destination.size, rangeSizes[rangeIndex]))
+    }
+
+    private external fun setWatchedRangesInternal(addresses: IntArray, sizes: IntArray): ByteBuffer?
+
+    private external fun readRangeInternal(buffer: ByteBuffer, valuesSize: Int, valueOffset: Int, destination: ByteArray, size: Int): Int
+}
@@ -0,0 +1,63 @@
+package me.magnum.melonds
+
+import me.magnum.melonds.domain.model.RomMetadata
+
+object MelonRomMetadataReader {
+    const val ICON_SIZE = 32 * 32 * 4
+
+    /**
+     * Cheap fingerprint of a ROM file, used to recognise files that have been moved. The content hash only covers parts of the file,
+     * so its cost doesn't depend on the size of the file, but it can only tell that a file has changed.
+     */
+    class RomIdentity(val size: Long, val headerCrc: Int, val contentHash: Long?)
+
+    fun interface RomScanCallback {
+        /**
+         * Called on the thread that started the scan, with a chunk of scanned ROMs. [indices] are the positions of the ROMs in the
+         * scanned file descriptor array, and the metadata of ROMs that are not valid is null.
+         *
+         * @param scannedCount The number of ROMs scanned so far, including the ones in this chunk
+         * @return False to cancel the scan
+         */
+        fun onRomsScanned(indices: IntArray, metadata: Array<RomMetadata?>, scannedCount: Int): Boolean
+    }
+
+    /**
+     * Reads the metadata of the NDS ROM in the given file descriptor, without changing its offset. Only the parts of the ROM that are
+     * needed are read.
+     *
+     * @return The metadata of the ROM, or null if the file is not a valid ROM
+     */
+    external fun readRomMetadata(fileDescriptor: Int): RomMetadata?
+
+    /**
+     * Reads only the icon of the NDS ROM in the given file descriptor, without changing its offset. Unlike [readRomMetadata], the boot
+     * code of the ROM is not hashed, so only the header and the icon are read.
+     *
+     * @param icon Where the icon of the ROM is written to, as RGBA8888. Must be at least [ICON_SIZE] bytes long
+     * @return False if the file is not a valid ROM
+     */
+    external fun readRomIcon(fileDescriptor: Int, icon: ByteArray): Boolean
+
+    /**
+     * Reads the metadata of multiple NDS ROMs in parallel. Results are delivered in chunks to [callback] as they become available, not
+     * necessarily in the order of [fileDescriptors]. The file descriptors must stay open until this method returns.
+     *
+     * @return False if the scan was cancelled by the callback
+     */
+    external fun readRomMetadataBatch(fileDescriptors: IntArray, callback: RomScanCallback): Boolean
+
+    /**
+     * Reads the identity of the file in the given file descriptor, without changing its offset. Any kind of file is supported, not only
+     * NDS ROMs.
+     *
+     * @param computeContentHash Whether the content hash should be computed, which requires a few more reads
+     * @return The identity of the file, or null if it could not be read
+     */
+    fun readRomIdentity(fileDescriptor: Int, computeContentHash: Boolean): RomIdentity? {
+        val values = readRomIdentityInternal(fileDescriptor, computeContentHash) ?: return null
+        return RomIdentity(values[0], values[1].toInt(), values[2].takeIf { computeContentHash })
+    }
+
+    private external fun readRomIdentityInternal(fileDescriptor: Int, computeContentHash: Boolean): LongArray?
+}
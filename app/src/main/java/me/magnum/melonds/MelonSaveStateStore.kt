@@ -0,0 +1,50 @@
+package me.magnum.melonds
+
+/**
+ * Maintenance of the chunk stores where the contents of save states are kept. Chunk stores are shared by all states of a ROM, so
+ * chunks are not removed when a state is deleted. Instead, unreferenced chunks are removed by compacting the store.
+ */
+object MelonSaveStateStore {
+    /**
+     * Returns the fraction of the chunk store size that is used by chunks that none of the given states references, or a negative
+     * value if the store or any of the states can't be read.
+     */
+    external fun getUnreferencedChunkRatio(chunkStoreUri: String, saveStateUris: Array<String>): Float
+
+    /**
+     * Starts a compaction of the chunk store. From this point on, chunks of states that are being written are kept by
+     * [compactChunkStore], so states that are created after the states of the ROM have been listed don't lose their chunks. Must be
+     * called before listing the states, and always followed by [endChunkStoreCompaction].
+     */
+    external fun beginChunkStoreCompaction(chunkStoreUri: String)
+
+    external fun endChunkStoreCompaction(chunkStoreUri: String)
+
+    /**
+     * Removes the chunks that none of the given states references from the chunk store. States can still be written while this
+     * runs, but nothing is removed if they add chunks in the meantime, or if any state can't be read. The compacted store is first
+     * written to [temporaryChunkStoreUri], which must be an existing file, and then copied over the original store. Must be called
+     * between [beginChunkStoreCompaction] and [endChunkStoreCompaction].
+     *
+     * @return True if the temporary store can be deleted. Otherwise, it must be kept for [recoverChunkStore]
+     */
+    external fun compactChunkStore(chunkStoreUri: String, temporaryChunkStoreUri: String, saveStateUris: Array<String>): Boolean
+
+    /**
+     * Finishes a compaction that was interrupted while the compacted store was being copied over the original store.
+     *
+     * @return True if the temporary store can be deleted
+     */
+    external fun recoverChunkStore(chunkStoreUri: String, temporaryChunkStoreUri: String): Boolean
+
+    /**
+     * Must be called if a chunk store is deleted or created outside of native code.
+     */
+    external fun invalidateChunkStore(chunkStoreUri: String)
+
+    /**
+     * Removes the state from the in-memory cache of recently used states. Must be called before a state is deleted, or it could
+     * still be loaded from the cache.
+     */
+    external fun evictCachedState(saveStateUri: String)
+}
@@ -0,0 +1,24 @@
+package me.magnum.melonds
+
+import android.net.Uri
+
+/**
+ * Allows the emulator to read ROMs directly from ZIP archives, without extracting them first. Only stored and deflated ROMs are
+ * supported.
+ */
+object MelonZipRomReader {
+    // Must match the scheme in ZipRomFileStore.h
+    private const val ZIP_ROM_SCHEME = "ziprom"
+
+    /**
+     * Returns the URI that the emulator has to be given to read the ROM in the archive at [archiveUri].
+     */
+    fun getInPlaceRomUri(archiveUri: Uri): Uri {
+        return Uri.parse("$ZIP_ROM_SCHEME:$archiveUri")
+    }
+
+    /**
+     * Checks if the ROM in the ZIP archive in the given file descriptor can be read without extracting it.
+     */
+    external fun canReadRomInPlace(fileDescriptor: Int): Boolean
+}
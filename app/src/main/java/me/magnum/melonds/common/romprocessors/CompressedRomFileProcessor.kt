@@ -7,9 +7,7 @@ import io.reactivex.Single
 import me.magnum.melonds.common.uridelegates.UriHandler
 import me.magnum.melonds.domain.model.*
 import me.magnum.melonds.domain.model.rom.Rom
-import me.magnum.melonds.domain.model.rom.config.RomConfig
-import me.magnum.melonds.extensions.isBlank
-import me.magnum.melonds.extensions.nameWithoutExtension
+import me.magnum.melonds.extensions.toRom
 import me.magnum.melonds.impl.NdsRomCache
 import me.magnum.melonds.utils.RomProcessor
 import java.io.FileOutputStream
@@ -28,30 +26,21 @@ abstract class CompressedRomFileProcessor(private val context: Context, private
 
     override fun getRomFromUri(romUri: Uri, parentUri: Uri?): Rom? {
         return try {
-            context.contentResolver.openInputStream(romUri)?.use { stream ->
-                getNdsEntryStreamInFileStream(stream)?.use { romFileStream ->
-                    val romDocument = uriHandler.getUriDocument(romUri)
-                    val romMetadata = getRomMetadataInZipEntry(romFileStream)
-                    val romName = romMetadata.romTitle.takeUnless { it.isBlank() } ?: romDocument?.nameWithoutExtension ?: ""
-                    Rom(
-                        name = romName,
-                        developerName = romMetadata.developerName,
-                        fileName = romDocument?.name ?: "",
-                        uri = romUri,
-                        parentTreeUri = parentUri,
-                        config = if (romMetadata.isDSiWareTitle) RomConfig.forDsiWareTitle() else RomConfig.default(),
-                        lastPlayed = null,
-                        isDsiWareTitle = romMetadata.isDSiWareTitle,
-                        retroAchievementsHash = romMetadata.retroAchievementsHash
-                    )
-                }
-            }
+            getRomMetadata(romUri)?.toRom(romUri, parentUri, uriHandler.getUriDocument(romUri)?.name)
         } catch (e: Exception) {
             e.printStackTrace()
             null
         }
     }
 
+    override fun getRomMetadata(romUri: Uri): RomMetadata? {
+        return context.contentResolver.openInputStream(romUri)?.use { stream ->
+            getNdsEntryStreamInFileStream(stream)?.use { romFileStream ->
+                getRomMetadataInZipEntry(romFileStream)
+            }
+        }
+    }
+
     override fun getRomIcon(rom: Rom): Bitmap? {
         return try {
             getBestRomInputStream(rom)?.use {
@@ -76,8 +65,13 @@ abstract class CompressedRomFileProcessor(private val context: Context, private
 
     override fun getRealRomUri(rom: Rom): Single<Uri> {
         val cachedRomUri = ndsRomCache.getCachedRomFile(rom, true)
-        return if (cachedRomUri != null) {
-            Single.just(cachedRomUri)
+        if (cachedRomUri != null) {
+            return Single.just(cachedRomUri)
+        }
+
+        val inPlaceRomUri = getInPlaceRomUri(rom)
+        return if (inPlaceRomUri != null) {
+            Single.just(inPlaceRomUri)
         } else {
             extractRomFile(rom)
         }
@@ -141,6 +135,12 @@ abstract class CompressedRomFileProcessor(private val context: Context, private
         }
     }
 
+    /**
+     * Returns a URI through which the emulator can read the ROM directly from the compressed file, or null if the ROM has to be
+     * extracted first.
+     */
+    protected open fun getInPlaceRomUri(rom: Rom): Uri? = null
+
     /**
      * Retrieves the [RomFileStream] that points to the ROM in the compressed file. May return null if a ROM entry was not found in the compressed archive.
      */
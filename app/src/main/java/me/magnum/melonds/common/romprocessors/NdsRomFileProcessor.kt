@@ -3,45 +3,45 @@ package me.magnum.melonds.common.romprocessors
 import android.content.Context
 import android.graphics.Bitmap
 import android.net.Uri
+import androidx.core.graphics.createBitmap
 import io.reactivex.Single
+import me.magnum.melonds.MelonRomMetadataReader
 import me.magnum.melonds.common.uridelegates.UriHandler
 import me.magnum.melonds.domain.model.rom.Rom
-import me.magnum.melonds.domain.model.rom.config.RomConfig
 import me.magnum.melonds.domain.model.RomInfo
 import me.magnum.melonds.domain.model.RomMetadata
-import me.magnum.melonds.extensions.isBlank
-import me.magnum.melonds.extensions.nameWithoutExtension
+import me.magnum.melonds.extensions.toRom
 import me.magnum.melonds.utils.RomProcessor
+import java.nio.ByteBuffer
 
 class NdsRomFileProcessor(private val context: Context, private val uriHandler: UriHandler) : RomFileProcessor {
 
     override fun getRomFromUri(romUri: Uri, parentUri: Uri?): Rom? {
         return try {
-            getRomMetadata(romUri)?.let { metadata ->
-                val romDocument = uriHandler.getUriDocument(romUri)
-                val romName = metadata.romTitle.takeUnless { it.isBlank() } ?: romDocument?.nameWithoutExtension ?: ""
-                Rom(
-                    name = romName,
-                    developerName = metadata.developerName,
-                    fileName = romDocument?.name ?: "",
-                    uri = romUri,
-                    parentTreeUri = parentUri,
-                    config = if (metadata.isDSiWareTitle) RomConfig.forDsiWareTitle() else RomConfig.default(),
-                    lastPlayed = null,
-                    isDsiWareTitle = metadata.isDSiWareTitle,
-                    retroAchievementsHash = metadata.retroAchievementsHash
-                )
-            }
+            getRomMetadata(romUri)?.toRom(romUri, parentUri, uriHandler.getUriDocument(romUri)?.name)
         } catch (e: Exception) {
             e.printStackTrace()
             null
         }
     }
 
+    override fun getRomMetadata(romUri: Uri): RomMetadata? {
+        return context.contentResolver.openFileDescriptor(romUri, "r")?.use { descriptor ->
+            MelonRomMetadataReader.readRomMetadata(descriptor.fd)
+        }
+    }
+
     override fun getRomIcon(rom: Rom): Bitmap? {
         return try {
-            context.contentResolver.openInputStream(rom.uri)?.use { inputStream ->
-                RomProcessor.getRomIcon(inputStream)
+            context.contentResolver.openFileDescriptor(rom.uri, "r")?.use { descriptor ->
+                val iconData = ByteArray(MelonRomMetadataReader.ICON_SIZE)
+                if (MelonRomMetadataReader.readRomIcon(descriptor.fd, iconData)) {
+                    createBitmap(32, 32).apply {
+                        copyPixelsFromBuffer(ByteBuffer.wrap(iconData))
+                    }
+                } else {
+                    null
+                }
             }
         } catch (e: Exception) {
             e.printStackTrace()
@@ -63,10 +63,4 @@ class NdsRomFileProcessor(private val context: Context, private val uriHandler:
     override fun getRealRomUri(rom: Rom): Single<Uri> {
         return Single.just(rom.uri)
     }
-
-    private fun getRomMetadata(uri: Uri): RomMetadata? {
-        return context.contentResolver.openInputStream(uri)?.use { inputStream ->
-            RomProcessor.getRomMetadata(inputStream)
-        }
-    }
 }
\ No newline at end of file
@@ -5,9 +5,11 @@ import android.net.Uri
 import io.reactivex.Single
 import me.magnum.melonds.domain.model.rom.Rom
 import me.magnum.melonds.domain.model.RomInfo
+import me.magnum.melonds.domain.model.RomMetadata
 
 interface RomFileProcessor {
     fun getRomFromUri(romUri: Uri, parentUri: Uri?): Rom?
+    fun getRomMetadata(romUri: Uri): RomMetadata?
     fun getRomIcon(rom: Rom): Bitmap?
     fun getRomInfo(rom: Rom): RomInfo?
     fun getRealRomUri(rom: Rom): Single<Uri>
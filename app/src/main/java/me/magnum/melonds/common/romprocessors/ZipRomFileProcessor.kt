@@ -1,14 +1,29 @@
 package me.magnum.melonds.common.romprocessors
 
 import android.content.Context
+import android.net.Uri
+import me.magnum.melonds.MelonZipRomReader
 import me.magnum.melonds.common.uridelegates.UriHandler
 import me.magnum.melonds.domain.model.SizeUnit
+import me.magnum.melonds.domain.model.rom.Rom
 import me.magnum.melonds.impl.NdsRomCache
 import java.io.InputStream
 import java.util.zip.ZipEntry
 import java.util.zip.ZipInputStream
 
-class ZipRomFileProcessor(context: Context, uriHandler: UriHandler, ndsRomCache: NdsRomCache) : CompressedRomFileProcessor(context, uriHandler, ndsRomCache) {
+class ZipRomFileProcessor(private val context: Context, uriHandler: UriHandler, ndsRomCache: NdsRomCache) : CompressedRomFileProcessor(context, uriHandler, ndsRomCache) {
+
+    override fun getInPlaceRomUri(rom: Rom): Uri? {
+        val canReadRomInPlace = try {
+            context.contentResolver.openFileDescriptor(rom.uri, "r")?.use {
+                MelonZipRomReader.canReadRomInPlace(it.fd)
+            } ?: false
+        } catch (e: Exception) {
+            false
+        }
+
+        return if (canReadRomInPlace) MelonZipRomReader.getInPlaceRomUri(rom.uri) else null
+    }
 
     override fun getNdsEntryStreamInFileStream(fileStream: InputStream): RomFileStream? {
         val zipStream = ZipInputStream(fileStream)
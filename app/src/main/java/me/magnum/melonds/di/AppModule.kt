@@ -23,6 +23,8 @@ import me.magnum.melonds.common.PermissionHandler
 import me.magnum.melonds.common.UriPermissionManager
 import me.magnum.melonds.common.uridelegates.CompositeUriHandler
 import me.magnum.melonds.common.uridelegates.UriHandler
+import me.magnum.melonds.impl.image.PicassoSaveStateThumbnailRequestHandler
+import me.magnum.melonds.impl.savestate.SaveStateContainerReader
 import me.magnum.melonds.impl.system.AppForegroundStateObserver
 import me.magnum.melonds.impl.system.AppForegroundStateTracker
 import me.magnum.melonds.utils.UriTypeHierarchyAdapter
@@ -65,8 +67,10 @@ object AppModule {
 
     @Provides
     @Singleton
-    fun providePicasso(@ApplicationContext context: Context): Picasso {
-        return Picasso.Builder(context).build()
+    fun providePicasso(@ApplicationContext context: Context, saveStateContainerReader: SaveStateContainerReader): Picasso {
+        return Picasso.Builder(context)
+            .addRequestHandler(PicassoSaveStateThumbnailRequestHandler(saveStateContainerReader))
+            .build()
     }
 
     @Provides
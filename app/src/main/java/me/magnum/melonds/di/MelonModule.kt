@@ -36,6 +36,7 @@ import me.magnum.melonds.impl.layout.UILayoutProvider
 import me.magnum.melonds.impl.layout.devicemapper.AynThorLayoutDisplayMapper
 import me.magnum.melonds.impl.layout.devicemapper.DefaultLayoutDisplayMapper
 import me.magnum.melonds.impl.romprocessors.Api24RomFileProcessorFactory
+import me.magnum.melonds.impl.savestate.SaveStateContainerReader
 import me.magnum.melonds.ui.romdetails.RomDetailsUiMapper
 import me.magnum.rcheevosapi.RAApi
 import me.magnum.rcheevosapi.RAUserAuthStore
@@ -64,8 +65,20 @@ object MelonModule {
 
     @Provides
     @Singleton
-    fun provideRomsRepository(@ApplicationContext context: Context, gson: Gson, settingsRepository: SettingsRepository, romFileProcessorFactory: RomFileProcessorFactory): RomsRepository {
-        return FileSystemRomsRepository(context, gson, settingsRepository, romFileProcessorFactory)
+    fun provideRomsRepository(
+        @ApplicationContext context: Context,
+        gson: Gson,
+        settingsRepository: SettingsRepository,
+        romFileProcessorFactory: RomFileProcessorFactory,
+        romMetadataIndex: RomMetadataIndex,
+    ): RomsRepository {
+        return FileSystemRomsRepository(context, gson, settingsRepository, romFileProcessorFactory, romMetadataIndex)
+    }
+
+    @Provides
+    @Singleton
+    fun provideRomMetadataIndex(@ApplicationContext context: Context): RomMetadataIndex {
+        return RomMetadataIndex(context)
     }
 
     @Provides
@@ -76,8 +89,8 @@ object MelonModule {
 
     @Provides
     @Singleton
-    fun provideNdsRomCache(@ApplicationContext context: Context, settingsRepository: SettingsRepository): NdsRomCache {
-        return NdsRomCache(context, settingsRepository)
+    fun provideNdsRomCache(@ApplicationContext context: Context, settingsRepository: SettingsRepository, romMetadataIndex: RomMetadataIndex): NdsRomCache {
+        return NdsRomCache(context, settingsRepository, romMetadataIndex)
     }
 
     @Provides
@@ -94,8 +107,13 @@ object MelonModule {
 
     @Provides
     @Singleton
-    fun provideSaveStatesRepository(settingsRepository: SettingsRepository, saveStateScreenshotProvider: SaveStateScreenshotProvider, uriHandler: UriHandler): SaveStatesRepository {
-        return FileSystemSaveStatesRepository(settingsRepository, saveStateScreenshotProvider, uriHandler)
+    fun provideSaveStatesRepository(
+        settingsRepository: SettingsRepository,
+        saveStateScreenshotProvider: SaveStateScreenshotProvider,
+        saveStateContainerReader: SaveStateContainerReader,
+        uriHandler: UriHandler,
+    ): SaveStatesRepository {
+        return FileSystemSaveStatesRepository(settingsRepository, saveStateScreenshotProvider, saveStateContainerReader, uriHandler)
     }
 
     @Provides
@@ -130,8 +148,14 @@ object MelonModule {
 
     @Provides
     @Singleton
-    fun provideRomIconProvider(@ApplicationContext context: Context, romFileProcessorFactory: RomFileProcessorFactory): RomIconProvider {
-        return RomIconProvider(context, romFileProcessorFactory)
+    fun provideRomIconProvider(@ApplicationContext context: Context, romFileProcessorFactory: RomFileProcessorFactory, romMetadataIndex: RomMetadataIndex): RomIconProvider {
+        return RomIconProvider(context, romFileProcessorFactory, romMetadataIndex)
+    }
+
+    @Provides
+    @Singleton
+    fun provideSaveStateContainerReader(@ApplicationContext context: Context): SaveStateContainerReader {
+        return SaveStateContainerReader(context)
     }
 
     @Provides
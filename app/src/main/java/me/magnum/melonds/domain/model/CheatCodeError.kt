@@ -0,0 +1,17 @@
+package me.magnum.melonds.domain.model
+
+/**
+ * Describes why a cheat code can't be used.
+ *
+ * @property position Index of the character of the code where the problem was found
+ */
+data class CheatCodeError(val reason: Reason, val position: Int) {
+    enum class Reason {
+        EMPTY,
+        INVALID_CHARACTER,
+        // Each word must have exactly 8 hex characters
+        INVALID_WORD_LENGTH,
+        // Words must come in pairs
+        INCOMPLETE_LINE,
+    }
+}
@@ -1,6 +1,10 @@
 package me.magnum.melonds.domain.model
 
-enum class RomScanningStatus {
-    SCANNING,
-    NOT_SCANNING
-}
\ No newline at end of file
+sealed class RomScanningStatus {
+    /**
+     * @param scannedRomCount The number of new or modified ROM files that have been read so far
+     * @param romCount The number of new or modified ROM files that have to be read. 0 while the ROM directories are being listed
+     */
+    data class Scanning(val scannedRomCount: Int, val romCount: Int) : RomScanningStatus()
+    data object NotScanning : RomScanningStatus()
+}
@@ -1,6 +1,5 @@
 package me.magnum.melonds.domain.repositories
 
-import android.graphics.Bitmap
 import android.net.Uri
 import me.magnum.melonds.domain.model.rom.Rom
 import me.magnum.melonds.domain.model.SaveStateSlot
@@ -9,6 +8,27 @@ interface SaveStatesRepository {
     fun getRomSaveStates(rom: Rom): List<SaveStateSlot>
     fun getRomQuickSaveStateSlot(rom: Rom): SaveStateSlot
     fun getRomSaveStateUri(rom: Rom, saveState: SaveStateSlot): Uri
-    fun setRomSaveStateScreenshot(rom: Rom, saveState: SaveStateSlot, screenshot: Bitmap)
+
+    /**
+     * Returns the URI of the chunk store shared by all save states of the given ROM, creating it if it doesn't exist yet.
+     */
+    fun getRomSaveStateChunkStoreUri(rom: Rom): Uri
+
+    /**
+     * Returns the URI of the state that is saved when the app is moved to the background while the given ROM is running, creating
+     * it if it doesn't exist yet. This state is not part of the regular save state slots.
+     */
+    fun getRomSuspendStateUri(rom: Rom): Uri
+
+    /**
+     * Deletes the suspend state of the given ROM, if any. Used when the state could not be completely written.
+     */
+    fun deleteRomSuspendState(rom: Rom)
     fun deleteRomSaveState(rom: Rom, saveState: SaveStateSlot)
+
+    /**
+     * Removes the contents of deleted save states from the chunk store of the given ROM. The store is only rewritten if a
+     * significant part of it is no longer used by the remaining states.
+     */
+    fun compactRomSaveStateChunkStore(rom: Rom)
 }
\ No newline at end of file
@@ -1,7 +1,9 @@
 package me.magnum.melonds.domain.services
 
 import android.net.Uri
+import kotlinx.coroutines.Deferred
 import kotlinx.coroutines.flow.Flow
+import kotlinx.coroutines.flow.StateFlow
 import me.magnum.melonds.domain.model.Cheat
 import me.magnum.melonds.domain.model.ConsoleType
 import me.magnum.melonds.domain.model.emulator.EmulatorEvent
@@ -17,6 +19,11 @@ interface EmulatorManager {
 
     val emulatorEvents: Flow<EmulatorEvent>
 
+    /**
+     * Progress of the save state that is being written, from 0 to 100, or null if no save state is being written.
+     */
+    val saveStateWriteProgress: StateFlow<Int?>
+
     suspend fun loadRom(rom: Rom, cheats: List<Cheat>): RomLaunchResult
 
     suspend fun loadFirmware(consoleType: ConsoleType): FirmwareLaunchResult
@@ -29,6 +36,11 @@ interface EmulatorManager {
 
     fun getFps(): Float
 
+    /**
+     * @return The average time spent running cheats in each frame, in microseconds
+     */
+    fun getCheatEngineFrameTime(): Float
+
     suspend fun pauseEmulator()
 
     suspend fun resumeEmulator()
@@ -39,13 +51,45 @@ interface EmulatorManager {
     suspend fun setupRetroAchievements(achievementData: GameAchievementData)
     fun unloadRetroAchievementsData()
 
-    suspend fun loadRewindState(rewindSaveState: RewindSaveState): Boolean
+    /**
+     * @return The latest rich presence text reported by the emulator, or null if the game has none
+     */
+    fun getRichPresenceStatus(): String?
 
-    suspend fun saveState(saveStateFileUri: Uri): Boolean
-
-    suspend fun loadState(saveStateFileUri: Uri): Boolean
+    suspend fun loadRewindState(rewindSaveState: RewindSaveState): Boolean
 
-    fun stopEmulator()
+    /**
+     * Saves the current emulator state of the given ROM to the given file. The function returns as soon as the emulator state has
+     * been captured, at which point the emulator can resume. The state is then written in the background.
+     *
+     * @param chunkStoreUri The chunk store of the ROM, where the contents of the state are saved
+     * @return A [Deferred] that completes with the result of the write operation
+     */
+    suspend fun saveState(saveStateFileUri: Uri, chunkStoreUri: Uri, rom: Rom): Deferred<Boolean>
+
+    /**
+     * Loads the state in the given file. Fails if the state was created for a ROM other than [rom].
+     *
+     * @param chunkStoreUri The chunk store of the ROM
+     */
+    suspend fun loadState(saveStateFileUri: Uri, chunkStoreUri: Uri, rom: Rom): Boolean
+
+    /**
+     * Releases memory that the emulator doesn't need while the app is in the background, like the rewind buffer. The rewind history
+     * is lost. Call [updateRomEmulatorConfiguration] to restore the regular configuration once the app is in the foreground again.
+     */
+    suspend fun releaseBackgroundMemory(rom: Rom)
+
+    /**
+     * @param keepWarm Whether to keep the emulator core set up, so that launching another game right after is faster
+     */
+    fun stopEmulator(keepWarm: Boolean = false)
+
+    /**
+     * Releases the emulator core kept warm by [stopEmulator]. Must be called when the next launch fails before reaching the core,
+     * since the core is otherwise only released once the emulator is cleaned.
+     */
+    fun releaseWarmEmulator()
 
     fun cleanEmulator()
 
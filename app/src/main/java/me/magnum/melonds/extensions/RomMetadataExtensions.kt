@@ -0,0 +1,21 @@
+package me.magnum.melonds.extensions
+
+import android.net.Uri
+import me.magnum.melonds.domain.model.RomMetadata
+import me.magnum.melonds.domain.model.rom.Rom
+import me.magnum.melonds.domain.model.rom.config.RomConfig
+
+fun RomMetadata.toRom(romUri: Uri, parentUri: Uri?, fileName: String?): Rom {
+    val romName = romTitle.takeUnless { it.isBlank() } ?: fileName?.substringBeforeLast('.') ?: ""
+    return Rom(
+        name = romName,
+        developerName = developerName,
+        fileName = fileName ?: "",
+        uri = romUri,
+        parentTreeUri = parentUri,
+        config = if (isDSiWareTitle) RomConfig.forDsiWareTitle() else RomConfig.default(),
+        lastPlayed = null,
+        isDsiWareTitle = isDSiWareTitle,
+        retroAchievementsHash = retroAchievementsHash
+    )
+}
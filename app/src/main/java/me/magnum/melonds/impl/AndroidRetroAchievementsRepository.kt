@@ -12,7 +12,6 @@ import androidx.work.OutOfQuotaPolicy
 import androidx.work.WorkManager
 import kotlinx.coroutines.Dispatchers
 import kotlinx.coroutines.withContext
-import me.magnum.melonds.MelonEmulator
 import me.magnum.melonds.common.suspendMapCatching
 import me.magnum.melonds.common.suspendRecoverCatching
 import me.magnum.melonds.common.suspendRunCatching
@@ -33,6 +32,7 @@ import me.magnum.melonds.domain.model.retroachievements.exception.RAGameNotExist
 import me.magnum.melonds.domain.repositories.RetroAchievementsRepository
 import me.magnum.melonds.impl.mappers.retroachievements.mapToEntity
 import me.magnum.melonds.impl.mappers.retroachievements.mapToModel
+import me.magnum.melonds.impl.retroachievements.RuntimeAchievementProgressTable
 import me.magnum.melonds.utils.enumValueOfIgnoreCase
 import me.magnum.rcheevosapi.RAApi
 import me.magnum.rcheevosapi.RAUserAuthStore
@@ -63,6 +63,8 @@ class AndroidRetroAchievementsRepository(
         const val PENDING_ACHIEVEMENT_SUBMISSION_WORKER_NAME = "ra_pending_achievement_submission_worker"
     }
 
+    private val runtimeAchievementProgressTable = RuntimeAchievementProgressTable()
+
     override suspend fun isUserAuthenticated(): Boolean {
         return raUserAuthStore.getUserAuth() != null
     }
@@ -140,9 +142,9 @@ class AndroidRetroAchievementsRepository(
     }
 
     override suspend fun getRuntimeUserAchievements(achievements: List<RAUserAchievement>): List<RARuntimeUserAchievement> = withContext(Dispatchers.Default) {
-        val runtimeAchievements = MelonEmulator.getRuntimeAchievements()
+        val runtimeAchievements = runtimeAchievementProgressTable.update()
         achievements.map { userAchievement ->
-            val runtimeAchievement = runtimeAchievements.firstOrNull { it.id == userAchievement.achievement.id }
+            val runtimeAchievement = runtimeAchievements[userAchievement.achievement.id]
             RARuntimeUserAchievement(
                 userAchievement = userAchievement,
                 progress = runtimeAchievement?.value ?: 0,
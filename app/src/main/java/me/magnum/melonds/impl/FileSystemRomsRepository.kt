@@ -2,28 +2,38 @@ package me.magnum.melonds.impl
 
 import android.content.Context
 import android.net.Uri
+import android.provider.DocumentsContract
 import android.util.Log
 import androidx.documentfile.provider.DocumentFile
 import com.google.gson.Gson
 import com.google.gson.reflect.TypeToken
 import kotlinx.coroutines.CoroutineScope
 import kotlinx.coroutines.Dispatchers
+import kotlinx.coroutines.channels.ProducerScope
+import kotlinx.coroutines.channels.trySendBlocking
 import kotlinx.coroutines.flow.Flow
-import kotlinx.coroutines.flow.FlowCollector
 import kotlinx.coroutines.flow.MutableStateFlow
 import kotlinx.coroutines.flow.StateFlow
 import kotlinx.coroutines.flow.asStateFlow
+import kotlinx.coroutines.flow.channelFlow
 import kotlinx.coroutines.flow.collectLatest
 import kotlinx.coroutines.flow.emitAll
 import kotlinx.coroutines.flow.first
 import kotlinx.coroutines.flow.flow
+import kotlinx.coroutines.isActive
 import kotlinx.coroutines.launch
+import me.magnum.melonds.MelonRomMetadataReader
+import me.magnum.melonds.MelonRomMetadataReader.RomIdentity
+import me.magnum.melonds.common.romprocessors.NdsRomFileProcessor
+import me.magnum.melonds.common.romprocessors.RomFileProcessor
 import me.magnum.melonds.common.romprocessors.RomFileProcessorFactory
+import me.magnum.melonds.domain.model.RomMetadata
 import me.magnum.melonds.domain.model.RomScanningStatus
 import me.magnum.melonds.domain.model.rom.Rom
 import me.magnum.melonds.domain.model.rom.config.RomConfig
 import me.magnum.melonds.domain.repositories.RomsRepository
 import me.magnum.melonds.domain.repositories.SettingsRepository
+import me.magnum.melonds.extensions.toRom
 import me.magnum.melonds.impl.dtos.rom.RomDto
 import me.magnum.melonds.utils.FileUtils
 import me.magnum.melonds.utils.SubjectSharedFlow
@@ -39,19 +49,46 @@ class FileSystemRomsRepository(
         private val context: Context,
         private val gson: Gson,
         private val settingsRepository: SettingsRepository,
-        private val romFileProcessorFactory: RomFileProcessorFactory
+        private val romFileProcessorFactory: RomFileProcessorFactory,
+        private val romMetadataIndex: RomMetadataIndex,
 ) : RomsRepository {
 
     companion object {
         private const val TAG = "FSRomsRepository"
         private const val EXTERNAL_STORAGE_PROVIDER_AUTHORITY = "com.android.externalstorage.documents"
         private const val ROM_DATA_FILE = "rom_data.json"
+        // Limits how many file descriptors are open at the same time while scanning
+        private const val ROM_SCAN_BATCH_SIZE = 64
+        private val DIRECTORY_LISTING_PROJECTION = arrayOf(
+            DocumentsContract.Document.COLUMN_DOCUMENT_ID,
+            DocumentsContract.Document.COLUMN_DISPLAY_NAME,
+            DocumentsContract.Document.COLUMN_MIME_TYPE,
+            DocumentsContract.Document.COLUMN_SIZE,
+            DocumentsContract.Document.COLUMN_LAST_MODIFIED,
+        )
     }
 
+    private class RomFile(
+        val uri: Uri,
+        val parentUri: Uri,
+        val fileName: String,
+        val size: Long,
+        val lastModified: Long,
+        val processor: RomFileProcessor,
+    ) {
+        // Some providers don't report sizes or modification dates, in which case files always have to be read to know if they changed
+        val hasKnownModificationState get() = size >= 0 && lastModified > 0
+    }
+
+    /**
+     * @property previousUri The URI that the file of the ROM had before being moved, if it was recognised as a moved file
+     */
+    private class ScannedRom(val rom: Rom, val previousUri: Uri?)
+
     private val coroutineScope = CoroutineScope(Dispatchers.IO)
     private val romListType: Type = object : TypeToken<List<RomDto>>(){}.type
     private val romsChannel = SubjectSharedFlow<List<Rom>>()
-    private val scanningStatusSubject = MutableStateFlow(RomScanningStatus.NOT_SCANNING)
+    private val scanningStatusSubject = MutableStateFlow<RomScanningStatus>(RomScanningStatus.NotScanning)
     private val roms: ArrayList<Rom> = ArrayList()
     private var areRomsLoaded = AtomicBoolean(false)
 
@@ -174,13 +211,13 @@ class FileSystemRomsRepository(
 
     override fun rescanRoms() {
         coroutineScope.launch {
-            scanningStatusSubject.emit(RomScanningStatus.SCANNING)
+            scanningStatusSubject.emit(RomScanningStatus.Scanning(0, 0))
 
             scanForNewRoms().collect {
                 addRom(it)
             }
 
-            scanningStatusSubject.emit(RomScanningStatus.NOT_SCANNING)
+            scanningStatusSubject.emit(RomScanningStatus.NotScanning)
         }
     }
 
@@ -188,6 +225,7 @@ class FileSystemRomsRepository(
         if (areRomsLoaded.compareAndSet(true, false)) {
             roms.clear()
         }
+        romMetadataIndex.clear()
 
         val cacheFile = File(context.filesDir, ROM_DATA_FILE)
         if (cacheFile.isFile) {
@@ -195,17 +233,21 @@ class FileSystemRomsRepository(
         }
     }
 
-    private fun addRom(rom: Rom) {
-        val existingRom = roms.find { it.hasSameFileAsRom(rom) }
-        if (existingRom == rom) {
-            return
-        }
-
+    private fun addRom(scannedRom: ScannedRom) {
+        val rom = scannedRom.rom
+        val existingRom = roms.find { it.hasSameFileAsRom(rom) } ?: scannedRom.previousUri?.let { findMovedRom(it) }
         if (existingRom != null) {
-            // ROM has different metadata. Update it
+            if (existingRom.hasSameFileAsRom(rom) && existingRom.hasSameMetadataAsRom(rom)) {
+                return
+            }
+
+            // ROM has been moved or has different metadata. Update it, keeping its configuration and play data
             val updatedRom = existingRom.copy(
                 name = rom.name,
                 developerName = rom.developerName,
+                fileName = rom.fileName,
+                uri = rom.uri,
+                parentTreeUri = rom.parentTreeUri,
                 isDsiWareTitle = rom.isDsiWareTitle,
                 retroAchievementsHash = rom.retroAchievementsHash,
             )
@@ -218,6 +260,17 @@ class FileSystemRomsRepository(
         onRomsChanged()
     }
 
+    private fun findMovedRom(previousUri: Uri): Rom? {
+        // If the previous file still exists, the file was copied instead, and each copy is kept as a different ROM
+        val previousRom = roms.find { it.uri == previousUri } ?: return null
+        return previousRom.takeIf { DocumentFile.fromSingleUri(context, previousUri)?.exists() != true }
+    }
+
+    private fun Rom.hasSameMetadataAsRom(other: Rom): Boolean {
+        return name == other.name && developerName == other.developerName && fileName == other.fileName && parentTreeUri == other.parentTreeUri &&
+                isDsiWareTitle == other.isDsiWareTitle && retroAchievementsHash == other.retroAchievementsHash
+    }
+
     private fun removeRom(rom: Rom, notifyChanged: Boolean = true) {
         if (roms.removeAll { it.hasSameFileAsRom(rom) } && notifyChanged) {
             onRomsChanged()
@@ -234,7 +287,7 @@ class FileSystemRomsRepository(
     }
 
     private suspend fun loadCachedRoms() {
-        scanningStatusSubject.emit(RomScanningStatus.SCANNING)
+        scanningStatusSubject.emit(RomScanningStatus.Scanning(0, 0))
 
         val cachedRoms = getCachedRoms().filter {
             DocumentFile.fromSingleUri(context, it.uri)?.exists() == true
@@ -246,32 +299,160 @@ class FileSystemRomsRepository(
             addRom(it)
         }
 
-        scanningStatusSubject.emit(RomScanningStatus.NOT_SCANNING)
+        scanningStatusSubject.emit(RomScanningStatus.NotScanning)
     }
 
-    private fun scanForNewRoms(): Flow<Rom> = flow {
+    private fun scanForNewRoms(): Flow<ScannedRom> = channelFlow {
+        val romFiles = mutableListOf<RomFile>()
         for (directory in settingsRepository.getRomSearchDirectories()) {
-            val documentFile = DocumentFile.fromTreeUri(context, directory)
-            if (documentFile != null) {
-                findCachedRomFiles(documentFile, this)
+            val rootDocumentId = runCatching { DocumentsContract.getTreeDocumentId(directory) }.getOrNull()
+            if (rootDocumentId != null) {
+                findRomFiles(directory, rootDocumentId, romFiles)
+            }
+        }
+
+        // Only new and modified files have to be opened. The rest are taken from the index as they are
+        val changedRomFiles = romFiles.filter { romFile ->
+            if (!romFile.hasKnownModificationState) {
+                return@filter true
+            }
+
+            val indexEntry = romMetadataIndex.findUnchangedEntry(romFile.uri, romFile.size, romFile.lastModified) ?: return@filter true
+            send(ScannedRom(indexEntry.metadata.toRom(romFile.uri, romFile.parentUri, romFile.fileName), null))
+            false
+        }
+
+        var scannedRomFileCount = 0
+        scanningStatusSubject.value = RomScanningStatus.Scanning(0, changedRomFiles.size)
+        changedRomFiles.chunked(ROM_SCAN_BATCH_SIZE).forEach { batch ->
+            val previouslyScannedRomFileCount = scannedRomFileCount
+            scanChangedRomFiles(batch) { scannedBatchFileCount ->
+                scanningStatusSubject.value = RomScanningStatus.Scanning(previouslyScannedRomFileCount + scannedBatchFileCount, changedRomFiles.size)
+            }
+            scannedRomFileCount += batch.size
+        }
+
+        if (isActive) {
+            romMetadataIndex.retainEntries(romFiles.mapTo(HashSet()) { it.uri })
+        }
+        romMetadataIndex.save()
+    }
+
+    /**
+     * Lists the ROM files in the given directory and its subdirectories. Sizes and modification dates are retrieved in the same query,
+     * so unchanged files can be skipped without querying each of them.
+     */
+    private fun findRomFiles(treeUri: Uri, directoryId: String, romFiles: MutableList<RomFile>) {
+        val directoryUri = DocumentsContract.buildDocumentUriUsingTree(treeUri, directoryId)
+        val childrenUri = DocumentsContract.buildChildDocumentsUriUsingTree(treeUri, directoryId)
+        val subdirectoryIds = mutableListOf<String>()
+
+        try {
+            context.contentResolver.query(childrenUri, DIRECTORY_LISTING_PROJECTION, null, null, null)?.use { cursor ->
+                while (cursor.moveToNext()) {
+                    val documentId = cursor.getString(0) ?: continue
+                    if (cursor.getString(2) == DocumentsContract.Document.MIME_TYPE_DIR) {
+                        subdirectoryIds.add(documentId)
+                        continue
+                    }
+
+                    val fileName = cursor.getString(1) ?: continue
+                    val processor = romFileProcessorFactory.getFileRomProcessorForFileName(fileName) ?: continue
+                    romFiles.add(
+                        RomFile(
+                            uri = DocumentsContract.buildDocumentUriUsingTree(treeUri, documentId),
+                            parentUri = directoryUri,
+                            fileName = fileName,
+                            size = if (cursor.isNull(3)) -1 else cursor.getLong(3),
+                            lastModified = if (cursor.isNull(4)) -1 else cursor.getLong(4),
+                            processor = processor,
+                        )
+                    )
+                }
             }
+        } catch (e: Exception) {
+            Log.w(TAG, "Failed to list directory $directoryUri", e)
+        }
+
+        subdirectoryIds.forEach {
+            findRomFiles(treeUri, it, romFiles)
         }
     }
 
-    private suspend fun findCachedRomFiles(directory: DocumentFile, collector: FlowCollector<Rom>) {
-        val files = directory.listFiles()
-        for (file in files) {
-            if (file.isDirectory) {
-                findCachedRomFiles(file, collector)
-                continue
+    /**
+     * @param onProgress Called with the number of files in [romFiles] that have been read so far
+     */
+    private suspend fun ProducerScope<ScannedRom>.scanChangedRomFiles(romFiles: List<RomFile>, onProgress: (Int) -> Unit) {
+        val descriptors = romFiles.map {
+            try {
+                context.contentResolver.openFileDescriptor(it.uri, "r")
+            } catch (e: Exception) {
+                Log.w(TAG, "Failed to open ROM ${it.uri}", e)
+                null
             }
+        }
 
-            romFileProcessorFactory.getFileRomProcessorForDocument(file)?.let { fileRomProcessor ->
-                fileRomProcessor.getRomFromUri(file.uri, directory.uri)?.let { collector.emit(it) }
+        try {
+            val unknownNdsRomFiles = mutableListOf<Pair<RomFile, RomIdentity>>()
+            val unknownNdsRomDescriptors = mutableListOf<Int>()
+            romFiles.forEachIndexed { index, romFile ->
+                val descriptor = descriptors[index] ?: return@forEachIndexed
+                val identity = MelonRomMetadataReader.readRomIdentity(descriptor.fd, true) ?: return@forEachIndexed
+                val contentHash = identity.contentHash ?: return@forEachIndexed
+
+                // Files that keep their size, modification date and header have been moved or renamed. The content hash only samples
+                // the file, so it can only tell that a file has changed, never that two files are the same. Copies and changed files
+                // are always read again
+                val movedFileEntry = if (romFile.hasKnownModificationState) {
+                    romMetadataIndex.findEntryByIdentity(romFile.size, romFile.lastModified, identity.headerCrc)?.takeIf { it.contentHash == contentHash }
+                } else {
+                    null
+                }
+                when {
+                    movedFileEntry != null -> send(indexRomFile(romFile, identity, movedFileEntry.metadata, movedFileEntry))
+                    romFile.processor is NdsRomFileProcessor -> {
+                        unknownNdsRomFiles.add(romFile to identity)
+                        unknownNdsRomDescriptors.add(descriptor.fd)
+                    }
+                    else -> {
+                        // Compressed ROMs have to be extracted to be read, which can't be done natively
+                        romFile.processor.getRomMetadata(romFile.uri)?.let {
+                            send(indexRomFile(romFile, identity, it, null))
+                        }
+                    }
+                }
             }
+
+            // Everything but the NDS ROMs that have to be read natively is done at this point
+            val handledRomFileCount = romFiles.size - unknownNdsRomFiles.size
+            onProgress(handledRomFileCount)
+
+            if (unknownNdsRomFiles.isNotEmpty()) {
+                MelonRomMetadataReader.readRomMetadataBatch(unknownNdsRomDescriptors.toIntArray()) { indices, metadata, scannedCount ->
+                    indices.forEachIndexed { resultIndex, fileIndex ->
+                        val (romFile, identity) = unknownNdsRomFiles[fileIndex]
+                        metadata[resultIndex]?.let {
+                            trySendBlocking(indexRomFile(romFile, identity, it, null))
+                        }
+                    }
+                    onProgress(handledRomFileCount + scannedCount)
+                    isActive
+                }
+            }
+        } finally {
+            descriptors.forEach { it?.close() }
         }
     }
 
+    /**
+     * @param movedFileEntry The entry of the file that [romFile] was moved from, if any. The moved file keeps its cache key
+     */
+    private fun indexRomFile(romFile: RomFile, identity: RomIdentity, metadata: RomMetadata, movedFileEntry: RomMetadataIndex.Entry?): ScannedRom {
+        val cacheKey = movedFileEntry?.cacheKey ?: RomMetadataIndex.getDefaultCacheKey(romFile.uri)
+        romMetadataIndex.putEntry(RomMetadataIndex.Entry(romFile.uri, romFile.size, romFile.lastModified, identity.headerCrc, identity.contentHash!!, cacheKey, metadata))
+        return ScannedRom(metadata.toRom(romFile.uri, romFile.parentUri, romFile.fileName), movedFileEntry?.uri)
+    }
+
     private fun getCachedRoms(): List<Rom> {
         val cacheFile = File(context.filesDir, ROM_DATA_FILE)
         if (!cacheFile.isFile) {
@@ -1,23 +1,31 @@
 package me.magnum.melonds.impl
 
-import android.graphics.Bitmap
 import android.net.Uri
 import androidx.documentfile.provider.DocumentFile
+import me.magnum.melonds.MelonSaveStateStore
 import me.magnum.melonds.common.uridelegates.UriHandler
 import me.magnum.melonds.domain.model.rom.Rom
 import me.magnum.melonds.domain.model.SaveStateSlot
 import me.magnum.melonds.domain.repositories.SaveStatesRepository
 import me.magnum.melonds.domain.repositories.SettingsRepository
 import me.magnum.melonds.extensions.nameWithoutExtension
+import me.magnum.melonds.impl.image.PicassoSaveStateThumbnailRequestHandler
+import me.magnum.melonds.impl.savestate.SaveStateContainerReader
 import me.magnum.melonds.ui.emulator.exceptions.SaveSlotLoadException
 import java.util.*
 
 class FileSystemSaveStatesRepository(
     private val settingsRepository: SettingsRepository,
     private val saveStateScreenshotProvider: SaveStateScreenshotProvider,
+    private val saveStateContainerReader: SaveStateContainerReader,
     private val uriHandler: UriHandler
 ) : SaveStatesRepository {
 
+    private companion object {
+        // Compacting the chunk store rewrites it completely, so only do it once a significant part of it is no longer used
+        const val CHUNK_STORE_COMPACTION_THRESHOLD = 0.5f
+    }
+
     override fun getRomSaveStates(rom: Rom): List<SaveStateSlot> {
         val saveStateDirectoryDocument = getSaveStateDirectoryDocument(rom) ?: return emptyList()
         val romFileName = getRomFileNameWithoutExtension(rom) ?: return emptyList()
@@ -25,14 +33,12 @@ class FileSystemSaveStatesRepository(
         val saveStateSlots = Array(9) {
             SaveStateSlot(it, false, null, null)
         }
-        val fileNameRegex = "${Regex.escape(romFileName)}\\.ml[0-8]".toRegex()
+        val fileNameRegex = getSaveStateFileNameRegex(romFileName)
         saveStateDirectoryDocument.listFiles().forEach {
             val fileName = it.name
             if (fileName?.matches(fileNameRegex) == true) {
                 val slotNumber = fileName.last().digitToInt()
-                val slot = SaveStateSlot(slotNumber, true, Date(it.lastModified()), null)
-                val screenshotUri = saveStateScreenshotProvider.getRomSaveStateScreenshotUri(rom, slot)
-                saveStateSlots[slotNumber] = slot.copy(screenshot = screenshotUri)
+                saveStateSlots[slotNumber] = buildExistingSaveStateSlot(rom, slotNumber, it)
             }
         }
 
@@ -41,11 +47,11 @@ class FileSystemSaveStatesRepository(
 
     override fun getRomQuickSaveStateSlot(rom: Rom): SaveStateSlot {
         val quickSaveStateDocument = getRomQuickSaveStateDocument(rom)
-        val saveStateExists = quickSaveStateDocument != null
-        val lastModified = quickSaveStateDocument?.let { Date(it.lastModified()) }
-        val slot = SaveStateSlot(SaveStateSlot.QUICK_SAVE_SLOT, saveStateExists, lastModified, null)
-        val screenshotUri = saveStateScreenshotProvider.getRomSaveStateScreenshotUri(rom, slot)
-        return slot.copy(screenshot = screenshotUri)
+        return if (quickSaveStateDocument != null) {
+            buildExistingSaveStateSlot(rom, SaveStateSlot.QUICK_SAVE_SLOT, quickSaveStateDocument)
+        } else {
+            SaveStateSlot(SaveStateSlot.QUICK_SAVE_SLOT, false, null, null)
+        }
     }
 
     override fun getRomSaveStateUri(rom: Rom, saveState: SaveStateSlot): Uri {
@@ -64,8 +70,41 @@ class FileSystemSaveStatesRepository(
         return uri
     }
 
-    override fun setRomSaveStateScreenshot(rom: Rom, saveState: SaveStateSlot, screenshot: Bitmap) {
-        saveStateScreenshotProvider.saveRomSaveStateScreenshot(rom, saveState, screenshot)
+    override fun getRomSaveStateChunkStoreUri(rom: Rom): Uri {
+        val saveStateDirectoryDocument = getSaveStateDirectoryDocument(rom) ?: throw SaveSlotLoadException("Could not create parent directory document")
+        val romFileName = getRomFileNameWithoutExtension(rom) ?: throw SaveSlotLoadException("Could not determine ROM file name")
+
+        val chunkStoreName = getChunkStoreFileName(romFileName)
+        val chunkStoreFile = saveStateDirectoryDocument.findFile(chunkStoreName)
+        if (chunkStoreFile == null) {
+            val newChunkStoreFile = saveStateDirectoryDocument.createFile("*/*", chunkStoreName) ?: throw SaveSlotLoadException("Could not create save state chunk store")
+            MelonSaveStateStore.invalidateChunkStore(newChunkStoreFile.uri.toString())
+            return newChunkStoreFile.uri
+        }
+
+        recoverInterruptedChunkStoreCompaction(saveStateDirectoryDocument, romFileName, chunkStoreFile)
+        return chunkStoreFile.uri
+    }
+
+    override fun getRomSuspendStateUri(rom: Rom): Uri {
+        val saveStateDirectoryDocument = getSaveStateDirectoryDocument(rom) ?: throw SaveSlotLoadException("Could not create parent directory document")
+        val romFileName = getRomFileNameWithoutExtension(rom) ?: throw SaveSlotLoadException("Could not determine ROM file name")
+
+        val suspendStateName = getSuspendStateFileName(romFileName)
+        val suspendStateFile = saveStateDirectoryDocument.findFile(suspendStateName)
+            ?: saveStateDirectoryDocument.createFile("*/*", suspendStateName)
+            ?: throw SaveSlotLoadException("Could not create suspend state file")
+
+        return suspendStateFile.uri
+    }
+
+    override fun deleteRomSuspendState(rom: Rom) {
+        val saveStateDirectoryDocument = getSaveStateDirectoryDocument(rom) ?: return
+        val romFileName = getRomFileNameWithoutExtension(rom) ?: return
+        saveStateDirectoryDocument.findFile(getSuspendStateFileName(romFileName))?.let {
+            MelonSaveStateStore.evictCachedState(it.uri.toString())
+            it.delete()
+        }
     }
 
     override fun deleteRomSaveState(rom: Rom, saveState: SaveStateSlot) {
@@ -79,10 +118,78 @@ class FileSystemSaveStatesRepository(
         val saveStateName = "$romFileName.ml${saveState.slot}"
         val saveStateFile = saveStateDirectoryDocument.findFile(saveStateName)
 
-        saveStateFile?.delete()
+        // Evicted before the compaction of the chunk store that usually follows, so that the state can't be loaded from memory
+        // after its file is gone
+        saveStateFile?.let {
+            MelonSaveStateStore.evictCachedState(it.uri.toString())
+            it.delete()
+        }
         saveStateScreenshotProvider.deleteRomSaveStateScreenshot(rom, saveState)
     }
 
+    override fun compactRomSaveStateChunkStore(rom: Rom) {
+        val saveStateDirectoryDocument = getSaveStateDirectoryDocument(rom) ?: return
+        val romFileName = getRomFileNameWithoutExtension(rom) ?: return
+        val chunkStoreFile = saveStateDirectoryDocument.findFile(getChunkStoreFileName(romFileName)) ?: return
+        recoverInterruptedChunkStoreCompaction(saveStateDirectoryDocument, romFileName, chunkStoreFile)
+
+        val chunkStoreUri = chunkStoreFile.uri.toString()
+        MelonSaveStateStore.beginChunkStoreCompaction(chunkStoreUri)
+        try {
+            // The suspend state also keeps its contents in the chunk store
+            val fileNameRegex = getSaveStateFileNameRegex(romFileName)
+            val suspendStateName = getSuspendStateFileName(romFileName)
+            val saveStateUris = saveStateDirectoryDocument.listFiles()
+                .filter { it.name?.matches(fileNameRegex) == true || it.name == suspendStateName }
+                .map { it.uri.toString() }
+                .toTypedArray()
+
+            val unreferencedRatio = MelonSaveStateStore.getUnreferencedChunkRatio(chunkStoreUri, saveStateUris)
+            if (unreferencedRatio < CHUNK_STORE_COMPACTION_THRESHOLD) {
+                return
+            }
+
+            val temporaryChunkStoreName = getTemporaryChunkStoreFileName(romFileName)
+            val temporaryChunkStoreFile = saveStateDirectoryDocument.createFile("*/*", temporaryChunkStoreName) ?: return
+            // If the compaction fails, the original store may have been partially overwritten, and the temporary store is needed to
+            // restore it
+            if (MelonSaveStateStore.compactChunkStore(chunkStoreUri, temporaryChunkStoreFile.uri.toString(), saveStateUris)) {
+                temporaryChunkStoreFile.delete()
+            }
+        } finally {
+            MelonSaveStateStore.endChunkStoreCompaction(chunkStoreUri)
+        }
+    }
+
+    /**
+     * A leftover temporary chunk store means that a compaction was interrupted. The original store may have been partially
+     * overwritten, in which case it's restored from the temporary one.
+     */
+    private fun recoverInterruptedChunkStoreCompaction(saveStateDirectoryDocument: DocumentFile, romFileName: String, chunkStoreFile: DocumentFile) {
+        saveStateDirectoryDocument.findFile(getTemporaryChunkStoreFileName(romFileName))?.let {
+            if (MelonSaveStateStore.recoverChunkStore(chunkStoreFile.uri.toString(), it.uri.toString())) {
+                it.delete()
+            }
+        }
+    }
+
+    private fun buildExistingSaveStateSlot(rom: Rom, slotNumber: Int, saveStateDocument: DocumentFile): SaveStateSlot {
+        val header = saveStateContainerReader.readHeader(saveStateDocument.uri)
+        return if (header != null) {
+            val screenshotUri = if (header.hasThumbnail) {
+                PicassoSaveStateThumbnailRequestHandler.buildThumbnailUri(saveStateDocument.uri, header.timestamp.time)
+            } else {
+                null
+            }
+            SaveStateSlot(slotNumber, true, header.timestamp, screenshotUri)
+        } else {
+            // Raw state written by an older version of the app. Its screenshot is stored separately
+            val slot = SaveStateSlot(slotNumber, true, Date(saveStateDocument.lastModified()), null)
+            val screenshotUri = saveStateScreenshotProvider.getRomSaveStateScreenshotUri(rom, slot)
+            slot.copy(screenshot = screenshotUri)
+        }
+    }
+
     private fun getRomQuickSaveStateDocument(rom: Rom): DocumentFile? {
         val saveStateDirectoryDocument = getSaveStateDirectoryDocument(rom) ?: return null
         val romFileName = getRomFileNameWithoutExtension(rom) ?: return null
@@ -96,6 +203,22 @@ class FileSystemSaveStatesRepository(
         return uriHandler.getUriTreeDocument(saveStateDirectoryUri)
     }
 
+    private fun getSaveStateFileNameRegex(romFileName: String): Regex {
+        return "${Regex.escape(romFileName)}\\.ml[0-8]".toRegex()
+    }
+
+    private fun getSuspendStateFileName(romFileName: String): String {
+        return "$romFileName.mls"
+    }
+
+    private fun getChunkStoreFileName(romFileName: String): String {
+        return "$romFileName.mlc"
+    }
+
+    private fun getTemporaryChunkStoreFileName(romFileName: String): String {
+        return "$romFileName.mlc.tmp"
+    }
+
     private fun getRomFileNameWithoutExtension(rom: Rom): String? {
         val romDocument = uriHandler.getUriDocument(rom.uri)
         return romDocument?.nameWithoutExtension
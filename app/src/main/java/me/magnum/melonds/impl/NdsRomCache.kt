@@ -12,7 +12,7 @@ import java.io.File
 import java.io.FileOutputStream
 import java.util.*
 
-class NdsRomCache(private val context: Context, private val settingsRepository: SettingsRepository) {
+class NdsRomCache(private val context: Context, private val settingsRepository: SettingsRepository, private val romMetadataIndex: RomMetadataIndex) {
     companion object {
         private const val ROMS_CACHE_DIR = "extracted_roms"
         private const val TEMP_FILE_NAME = "temp"
@@ -35,7 +35,7 @@ class NdsRomCache(private val context: Context, private val settingsRepository:
     }
 
     fun getCachedRomFile(rom: Rom, forUse: Boolean = false): Uri? {
-        val romHash = rom.uri.hashCode().toString()
+        val romHash = getRomCacheKey(rom)
         val romCacheDir = context.externalCacheDir?.let { File(it, ROMS_CACHE_DIR) }
         if (romCacheDir == null || !romCacheDir.isDirectory) {
             return null
@@ -75,7 +75,7 @@ class NdsRomCache(private val context: Context, private val settingsRepository:
             tempCachedFile.outputStream().use {
                 val success = romExtractor.saveRomFile(it)
                 if (success) {
-                    val romHash = rom.uri.hashCode().toString()
+                    val romHash = getRomCacheKey(rom)
                     val cachedFile = File(romCacheDir, romHash)
                     tempCachedFile.renameTo(cachedFile)
                     cacheModifiedSubject.onNext(Unit)
@@ -89,6 +89,11 @@ class NdsRomCache(private val context: Context, private val settingsRepository:
         }
     }
 
+    private fun getRomCacheKey(rom: Rom): String {
+        // Indexed ROMs keep their key when they are moved, so that their cached files are still found
+        return romMetadataIndex.getCacheKey(rom.uri) ?: rom.uri.hashCode().toString()
+    }
+
     private fun calculateCacheSize(): SizeUnit {
         val romCacheDir = context.externalCacheDir?.let { File(it, ROMS_CACHE_DIR) }
         val cacheSize = romCacheDir?.listFiles()?.sumOf { file: File -> file.length() } ?: 0L
@@ -17,9 +17,10 @@ import kotlin.concurrent.withLock
  * Provider for ROM icons that supports caching. Both memory and disk caches are supported. If upon
  * request an icon is not found, it is generated and, if generated successfully, it's stored on both
  * caches.
- * The name of the file for the disk cache is the hash of the ROM's URI.
+ * The name of the file for the disk cache is the cache key of the ROM in the [RomMetadataIndex], or the hash of the ROM's URI if
+ * the ROM is not indexed.
  */
-class RomIconProvider(private val context: Context, private val romFileProcessorFactory: RomFileProcessorFactory) {
+class RomIconProvider(private val context: Context, private val romFileProcessorFactory: RomFileProcessorFactory, private val romMetadataIndex: RomMetadataIndex) {
     companion object {
         private const val ICON_CACHE_DIR = "rom_icons"
     }
@@ -28,7 +29,7 @@ class RomIconProvider(private val context: Context, private val romFileProcessor
     private val romIconLocks = Collections.synchronizedMap(mutableMapOf<String, ReentrantLock>())
 
     suspend fun getRomIcon(rom: Rom): Bitmap? = withContext(Dispatchers.IO) {
-        val romHash = rom.uri.hashCode().toString()
+        val romHash = romMetadataIndex.getCacheKey(rom.uri) ?: rom.uri.hashCode().toString()
         getRomIconLock(romHash).withLock {
             loadIconFromMemory(romHash, rom)
         }
@@ -0,0 +1,182 @@
+package me.magnum.melonds.impl
+
+import android.content.Context
+import android.net.Uri
+import android.util.Log
+import me.magnum.melonds.domain.model.RomMetadata
+import java.io.DataInputStream
+import java.io.DataOutputStream
+import java.io.File
+
+/**
+ * Persistent index of the ROM files found in the ROM search directories, which maps the identity of each file to its metadata. It
+ * allows rescans to skip the files that have not changed since they were last scanned, and to recognise files that have been moved
+ * without reading their metadata again.
+ *
+ * Each entry also holds the key for the caches of extracted ROMs and icons. The key is assigned when a file is first indexed and
+ * follows the file when it's moved, so that cached data survives moving files around. The content hash only samples the file, so
+ * it's never used as a key.
+ */
+class RomMetadataIndex(private val context: Context) {
+    companion object {
+        private const val TAG = "RomMetadataIndex"
+        private const val INDEX_FILE = "rom_index.bin"
+        private const val INDEX_TEMP_FILE = "rom_index.bin.tmp"
+        private const val INDEX_VERSION = 2
+
+        /**
+         * Returns the cache key of a file indexed for the first time. It's the key used before files were indexed, so that existing
+         * cached data is still found.
+         */
+        fun getDefaultCacheKey(uri: Uri): String {
+            return uri.hashCode().toString()
+        }
+    }
+
+    class Entry(
+        val uri: Uri,
+        val size: Long,
+        val lastModified: Long,
+        val headerCrc: Int,
+        val contentHash: Long,
+        val cacheKey: String,
+        val metadata: RomMetadata,
+    )
+
+    private val entries = mutableMapOf<Uri, Entry>()
+    private var isLoaded = false
+    private var isDirty = false
+
+    /**
+     * Returns the entry of the file at [uri] if the file has not changed since it was indexed.
+     */
+    @Synchronized
+    fun findUnchangedEntry(uri: Uri, size: Long, lastModified: Long): Entry? {
+        ensureLoaded()
+        return entries[uri]?.takeIf { it.size == size && it.lastModified == lastModified }
+    }
+
+    /**
+     * Returns the entry of a file with the same size, modification date and header as the given one. Moving a file keeps all of
+     * these.
+     */
+    @Synchronized
+    fun findEntryByIdentity(size: Long, lastModified: Long, headerCrc: Int): Entry? {
+        ensureLoaded()
+        return entries.values.find { it.size == size && it.lastModified == lastModified && it.headerCrc == headerCrc }
+    }
+
+    /**
+     * Returns the key that caches should use for the file at [uri], or null if the file is not indexed.
+     */
+    @Synchronized
+    fun getCacheKey(uri: Uri): String? {
+        ensureLoaded()
+        return entries[uri]?.cacheKey
+    }
+
+    @Synchronized
+    fun putEntry(entry: Entry) {
+        ensureLoaded()
+        entries[entry.uri] = entry
+        isDirty = true
+    }
+
+    /**
+     * Removes the entries of all files that are not in [uris]. Should be called after a complete scan, with the files that were found.
+     */
+    @Synchronized
+    fun retainEntries(uris: Set<Uri>) {
+        ensureLoaded()
+        if (entries.keys.retainAll(uris)) {
+            isDirty = true
+        }
+    }
+
+    @Synchronized
+    fun clear() {
+        entries.clear()
+        isLoaded = true
+        isDirty = false
+        File(context.filesDir, INDEX_FILE).delete()
+    }
+
+    /**
+     * Writes the index to disk, if it has changed since it was last written.
+     */
+    @Synchronized
+    fun save() {
+        if (!isDirty) {
+            return
+        }
+
+        val tempFile = File(context.filesDir, INDEX_TEMP_FILE)
+        try {
+            DataOutputStream(tempFile.outputStream().buffered()).use { stream ->
+                stream.writeInt(INDEX_VERSION)
+                stream.writeInt(entries.size)
+                entries.values.forEach {
+                    stream.writeUTF(it.uri.toString())
+                    stream.writeLong(it.size)
+                    stream.writeLong(it.lastModified)
+                    stream.writeInt(it.headerCrc)
+                    stream.writeLong(it.contentHash)
+                    stream.writeUTF(it.cacheKey)
+                    stream.writeUTF(it.metadata.romTitle)
+                    stream.writeUTF(it.metadata.developerName)
+                    stream.writeBoolean(it.metadata.isDSiWareTitle)
+                    stream.writeUTF(it.metadata.retroAchievementsHash)
+                }
+            }
+
+            if (tempFile.renameTo(File(context.filesDir, INDEX_FILE))) {
+                isDirty = false
+            }
+        } catch (e: Exception) {
+            Log.w(TAG, "Failed to save ROM index", e)
+            tempFile.delete()
+        }
+    }
+
+    private fun ensureLoaded() {
+        if (isLoaded) {
+            return
+        }
+
+        isLoaded = true
+        val indexFile = File(context.filesDir, INDEX_FILE)
+        if (!indexFile.isFile) {
+            return
+        }
+
+        try {
+            DataInputStream(indexFile.inputStream().buffered()).use { stream ->
+                if (stream.readInt() != INDEX_VERSION) {
+                    return
+                }
+
+                repeat(stream.readInt()) {
+                    val entry = Entry(
+                        uri = Uri.parse(stream.readUTF()),
+                        size = stream.readLong(),
+                        lastModified = stream.readLong(),
+                        headerCrc = stream.readInt(),
+                        contentHash = stream.readLong(),
+                        cacheKey = stream.readUTF(),
+                        metadata = RomMetadata(
+                            romTitle = stream.readUTF(),
+                            developerName = stream.readUTF(),
+                            isDSiWareTitle = stream.readBoolean(),
+                            retroAchievementsHash = stream.readUTF(),
+                        ),
+                    )
+                    entries[entry.uri] = entry
+                }
+            }
+        } catch (e: Exception) {
+            // A corrupted index only means that every ROM has to be read again
+            Log.w(TAG, "Failed to load ROM index", e)
+            entries.clear()
+        }
+    }
+}
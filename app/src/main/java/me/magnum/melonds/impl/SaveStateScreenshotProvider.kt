@@ -1,7 +1,6 @@
 package me.magnum.melonds.impl
 
 import android.content.Context
-import android.graphics.Bitmap
 import android.net.Uri
 import androidx.documentfile.provider.DocumentFile
 import com.squareup.picasso.Picasso
@@ -9,6 +8,10 @@ import me.magnum.melonds.domain.model.rom.Rom
 import me.magnum.melonds.domain.model.SaveStateSlot
 import java.io.File
 
+/**
+ * Provides the screenshots of raw save states written by older versions of the app, which were stored separately from the states.
+ * Newer states embed their own thumbnail.
+ */
 class SaveStateScreenshotProvider(
     private val context: Context,
     private val picasso: Picasso
@@ -18,17 +21,8 @@ class SaveStateScreenshotProvider(
         private const val SAVE_STATE_SCREENSHOTS_DIR = "ss_screenshots"
     }
 
-    fun saveRomSaveStateScreenshot(rom: Rom, saveState: SaveStateSlot, screenshot: Bitmap) {
-        val screenshotFile = getRomSaveStateScreenshotFile(rom, saveState, true) ?: return
-        screenshotFile.outputStream().use {
-            screenshot.compress(Bitmap.CompressFormat.PNG, 100, it)
-        }
-
-        invalidateScreenshotFile(screenshotFile)
-    }
-
     fun getRomSaveStateScreenshotUri(rom: Rom, saveState: SaveStateSlot): Uri? {
-        val screenshotFile = getRomSaveStateScreenshotFile(rom, saveState) ?: return null
+        val screenshotFile = getRomSaveStateScreenshotFile(rom, saveState)
         return if (screenshotFile.isFile) {
             DocumentFile.fromFile(screenshotFile).uri
         } else {
@@ -37,20 +31,15 @@ class SaveStateScreenshotProvider(
     }
 
     fun deleteRomSaveStateScreenshot(rom: Rom, saveState: SaveStateSlot) {
-        getRomSaveStateScreenshotFile(rom, saveState)?.let {
+        getRomSaveStateScreenshotFile(rom, saveState).let {
             invalidateScreenshotFile(it)
             it.delete()
         }
     }
 
-    private fun getRomSaveStateScreenshotFile(rom: Rom, saveState: SaveStateSlot, createDirectoriesIfNeeded: Boolean = false): File? {
+    private fun getRomSaveStateScreenshotFile(rom: Rom, saveState: SaveStateSlot): File {
         val romDirectoryName = rom.uri.hashCode().toString()
         val romDirectory = File(getScreenshotsDir(), romDirectoryName)
-
-        if (!romDirectory.isDirectory && createDirectoriesIfNeeded && !romDirectory.mkdirs()) {
-            return null
-        }
-
         return File(romDirectory, "${saveState.slot}.png")
     }
 
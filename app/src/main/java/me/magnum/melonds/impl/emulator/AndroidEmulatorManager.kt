@@ -2,19 +2,28 @@ package me.magnum.melonds.impl.emulator
 
 import android.content.Context
 import android.net.Uri
+import android.os.SystemClock
+import android.util.Log
 import androidx.documentfile.provider.DocumentFile
+import kotlinx.coroutines.CompletableDeferred
+import kotlinx.coroutines.Deferred
 import kotlinx.coroutines.Dispatchers
 import kotlinx.coroutines.flow.Flow
 import kotlinx.coroutines.flow.MutableSharedFlow
+import kotlinx.coroutines.flow.MutableStateFlow
+import kotlinx.coroutines.flow.StateFlow
 import kotlinx.coroutines.flow.asSharedFlow
+import kotlinx.coroutines.flow.asStateFlow
 import kotlinx.coroutines.isActive
 import kotlinx.coroutines.rx2.await
 import kotlinx.coroutines.withContext
+import me.magnum.melonds.MelonDSAndroidInterface
 import me.magnum.melonds.MelonEmulator
 import me.magnum.melonds.common.PermissionHandler
 import me.magnum.melonds.common.romprocessors.RomFileProcessorFactory
 import me.magnum.melonds.common.runtime.ScreenshotFrameBufferProvider
 import me.magnum.melonds.domain.model.Cheat
+import me.magnum.melonds.domain.model.CheatCodeError
 import me.magnum.melonds.domain.model.ConsoleType
 import me.magnum.melonds.domain.model.EmulatorConfiguration
 import me.magnum.melonds.domain.model.MicSource
@@ -35,6 +44,41 @@ import me.magnum.melonds.common.ir.IRManager
 import me.magnum.melonds.ui.emulator.exceptions.RomLoadException
 import me.magnum.melonds.ui.emulator.rewind.model.RewindSaveState
 import me.magnum.melonds.ui.emulator.rewind.model.RewindWindow
+import java.io.File
+import java.util.concurrent.ConcurrentHashMap
+import java.util.concurrent.atomic.AtomicInteger
+
+private const val TAG = "AndroidEmulatorManager"
+
+/**
+ * The result code reported by the native save state writer when a state is written successfully
+ */
+private const val SAVE_STATE_WRITE_OK = 0
+
+/**
+ * Time without changes to the save file after which the changes are written. Games often save in several steps in a row
+ */
+private const val SRAM_WRITE_BACK_WINDOW_MS = 1000
+private const val SRAM_JOURNAL_DIRECTORY = "sram_journal"
+
+/**
+ * Number of frames between evaluations of the rich presence. The text is only sent to RetroAchievements with each session heartbeat, so
+ * there is no point in evaluating it every frame
+ */
+private const val RICH_PRESENCE_UPDATE_INTERVAL_FRAMES = 60
+
+/**
+ * Subsystems reported in configuration change events. Must match the values of ConfigurationChange in MelonDSAndroidConfiguration.h
+ */
+private val CONFIGURATION_CHANGE_NAMES = listOf(
+    1 shl 0 to "audio",
+    1 shl 1 to "mic source",
+    1 shl 2 to "renderer",
+    1 shl 3 to "fast-forward",
+    1 shl 4 to "rewind",
+    1 shl 5 to "boot",
+    1 shl 6 to "core setup",
+)
 
 class AndroidEmulatorManager(
     private val context: Context,
@@ -52,6 +96,24 @@ class AndroidEmulatorManager(
 
     private val achievementsSharedFlow = MutableSharedFlow<RAEvent>(replay = 0, extraBufferCapacity = Int.MAX_VALUE)
 
+    // Updated by the emulator only when the text changes
+    @Volatile
+    private var richPresenceStatus: String? = null
+
+    private val appVersion by lazy {
+        val packageInfo = context.packageManager.getPackageInfo(context.packageName, 0)
+        packageInfo.versionName.orEmpty()
+    }
+
+    private val nextSaveStateRequestId = AtomicInteger(0)
+    private val pendingSaveStateWrites = ConcurrentHashMap<Int, CompletableDeferred<Boolean>>()
+    private val _saveStateWriteProgress = MutableStateFlow<Int?>(null)
+    override val saveStateWriteProgress: StateFlow<Int?> = _saveStateWriteProgress.asStateFlow()
+
+    // Code of each cheat registered in the emulator, by ID. Disabled cheats stay registered until the next ROM is loaded
+    private val registeredCheatCodes = mutableMapOf<Long, String>()
+    private val enabledCheatIds = mutableSetOf<Long>()
+
     private val messageQueue = EmulatorMessageQueue { type, data ->
         when (type) {
             EmulatorEventType.EventRumbleStart -> _emulatorEvents.tryEmit(EmulatorEvent.RumbleStart(data.getInt()))
@@ -86,20 +148,59 @@ class AndroidEmulatorManager(
                 )
                 achievementsSharedFlow.tryEmit(event)
             }
+            EmulatorEventType.EventRARichPresenceUpdated -> {
+                richPresenceStatus = String(ByteArray(data.getInt()).apply { data.get(this) }).takeUnless { it.isEmpty() }
+            }
+            EmulatorEventType.EventSaveStateWriteProgress -> {
+                val requestId = data.getInt()
+                val progress = data.getInt()
+                if (pendingSaveStateWrites.containsKey(requestId)) {
+                    _saveStateWriteProgress.value = progress
+                }
+            }
+            EmulatorEventType.EventSaveStateWriteCompleted -> {
+                val requestId = data.getInt()
+                val result = data.getInt()
+                if (result != SAVE_STATE_WRITE_OK) {
+                    Log.w(TAG, "Failed to write save state $requestId. Error: $result")
+                }
+                pendingSaveStateWrites.remove(requestId)?.complete(result == SAVE_STATE_WRITE_OK)
+                // States are written one after the other, so the next pending one, if any, starts from scratch
+                _saveStateWriteProgress.value = if (pendingSaveStateWrites.isEmpty()) null else 0
+            }
+            EmulatorEventType.EventConfigurationApplied -> {
+                val durationNs = data.getLong()
+                val changes = data.getInt()
+                val changeNames = CONFIGURATION_CHANGE_NAMES.filter { (flag, _) -> changes and flag != 0 }.joinToString { it.second }
+                Log.d(TAG, "Applied configuration changes ($changeNames) in ${durationNs / 1000} us")
+            }
         }
     }
 
     override suspend fun loadRom(rom: Rom, cheats: List<Cheat>): RomLaunchResult {
         return withContext(Dispatchers.IO) {
-            val fileRomDocument = DocumentFile.fromSingleUri(context, rom.uri) ?: return@withContext RomLaunchResult.LaunchFailedRomNotFound
-            val fileRomProcessor = romFileProcessorFactory.getFileRomProcessorForDocument(fileRomDocument)
-            val romUri = fileRomProcessor?.getRealRomUri(rom)?.await() ?: throw RomLoadException("Unsupported ROM file extension: ${fileRomDocument.extension}")
+            val romUri = try {
+                val fileRomDocument = DocumentFile.fromSingleUri(context, rom.uri)
+                if (fileRomDocument == null) {
+                    MelonEmulator.releaseWarmEmulator()
+                    return@withContext RomLaunchResult.LaunchFailedRomNotFound
+                }
+
+                val fileRomProcessor = romFileProcessorFactory.getFileRomProcessorForDocument(fileRomDocument)
+                fileRomProcessor?.getRealRomUri(rom)?.await() ?: throw RomLoadException("Unsupported ROM file extension: ${fileRomDocument.extension}")
+            } catch (exception: Exception) {
+                MelonEmulator.releaseWarmEmulator()
+                throw exception
+            }
 
-            setupEmulator(getRomEmulatorConfiguration(rom))
+            val launchStartTime = SystemClock.elapsedRealtime()
+            val isWarmLaunch = setupEmulator(getRomEmulatorConfiguration(rom))
 
             val sram = try {
                 sramProvider.getSramForRom(rom)
             } catch (exception: SramLoadException) {
+                cameraManager.stopCurrentCameraSource()
+                MelonEmulator.stopEmulation(keepWarm = false)
                 return@withContext RomLaunchResult.LaunchFailedSramProblem(exception)
             }
 
@@ -111,6 +212,10 @@ class AndroidEmulatorManager(
                 RomGbaSlotConfig.RumblePak -> MelonEmulator.GbaSlotType.RUMBLE_PAK
             }
 
+            val sramJournalDirectory = File(context.noBackupFilesDir, SRAM_JOURNAL_DIRECTORY).takeIf { it.isDirectory || it.mkdirs() }
+            MelonDSAndroidInterface.setSramWriteBackOptions(SRAM_WRITE_BACK_WINDOW_MS, sramJournalDirectory?.absolutePath)
+
+            val fileAccessStatsBeforeLoad = MelonDSAndroidInterface.getFileAccessStats()
             val loadResult = MelonEmulator.loadRom(
                 romUri = romUri,
                 sramUri = sram,
@@ -118,31 +223,51 @@ class AndroidEmulatorManager(
                 gbaRomUri = (gbaSlotRomConfig as? RomGbaSlotConfig.GbaRom)?.romPath,
                 gbaSramUri = (gbaSlotRomConfig as? RomGbaSlotConfig.GbaRom)?.savePath
             )
+            logFileAccessSince(fileAccessStatsBeforeLoad)
             if (loadResult.isTerminal || !isActive) {
                 cameraManager.stopCurrentCameraSource()
-                MelonEmulator.stopEmulation()
+                MelonEmulator.stopEmulation(keepWarm = false)
                 RomLaunchResult.LaunchFailed(loadResult)
             } else {
                 messageQueue.start()
-                MelonEmulator.setupCheats(cheats.toTypedArray())
+                setupCheats(cheats)
                 MelonEmulator.startEmulation()
+                logLaunchTime(isWarmLaunch, launchStartTime)
 
                 RomLaunchResult.LaunchSuccessful(loadResult != MelonEmulator.LoadResult.SUCCESS_GBA_FAILED)
             }
         }
     }
 
+    private fun logFileAccessSince(previousStats: MelonDSAndroidInterface.FileAccessStats) {
+        val stats = MelonDSAndroidInterface.getFileAccessStats()
+        Log.d(
+            TAG,
+            "ROM load opened ${stats.openCount - previousStats.openCount} files " +
+                    "(${stats.cachedOpenCount - previousStats.cachedOpenCount} cached) " +
+                    "in ${(stats.openTimeMicros - previousStats.openTimeMicros) / 1000} ms, " +
+                    "reading ${stats.bytesRead - previousStats.bytesRead} bytes"
+        )
+    }
+
+    private fun logLaunchTime(isWarmLaunch: Boolean, launchStartTime: Long) {
+        val launchType = if (isWarmLaunch) "Warm" else "Cold"
+        Log.d(TAG, "$launchType launch took ${SystemClock.elapsedRealtime() - launchStartTime} ms")
+    }
+
     override suspend fun loadFirmware(consoleType: ConsoleType): FirmwareLaunchResult {
         return withContext(Dispatchers.IO) {
-            setupEmulator(getFirmwareEmulatorConfiguration(consoleType))
+            val launchStartTime = SystemClock.elapsedRealtime()
+            val isWarmLaunch = setupEmulator(getFirmwareEmulatorConfiguration(consoleType))
             val result = MelonEmulator.bootFirmware()
             if (result != MelonEmulator.FirmwareLoadResult.SUCCESS) {
                 cameraManager.stopCurrentCameraSource()
-                MelonEmulator.stopEmulation()
+                MelonEmulator.stopEmulation(keepWarm = false)
                 FirmwareLaunchResult.LaunchFailed(result)
             } else {
                 messageQueue.start()
                 MelonEmulator.startEmulation()
+                logLaunchTime(isWarmLaunch, launchStartTime)
                 FirmwareLaunchResult.LaunchSuccessful
             }
         }
@@ -166,6 +291,10 @@ class AndroidEmulatorManager(
         return MelonEmulator.getFPS()
     }
 
+    override fun getCheatEngineFrameTime(): Float {
+        return MelonEmulator.getCheatEngineFrameTime()
+    }
+
     override suspend fun pauseEmulator() {
         MelonEmulator.pauseEmulation()
     }
@@ -179,7 +308,7 @@ class AndroidEmulatorManager(
     }
 
     override suspend fun updateCheats(cheats: List<Cheat>) {
-        MelonEmulator.setupCheats(cheats.toTypedArray())
+        updateRegisteredCheats(cheats)
     }
 
     override suspend fun setupRetroAchievements(achievementData: GameAchievementData) {
@@ -189,36 +318,71 @@ class AndroidEmulatorManager(
             null
         }
 
+        richPresenceStatus = null
         MelonEmulator.setupAchievements(
             achievements = achievementData.lockedAchievements.toTypedArray(),
             leaderboards = achievementData.leaderboards.toTypedArray(),
             richPresenceScript = richPresencePath,
+            richPresenceUpdateIntervalFrames = RICH_PRESENCE_UPDATE_INTERVAL_FRAMES,
         )
     }
 
     override fun unloadRetroAchievementsData() {
         MelonEmulator.unloadRetroAchievementsData()
+        richPresenceStatus = null
+    }
+
+    override fun getRichPresenceStatus(): String? {
+        return richPresenceStatus
     }
 
     override suspend fun loadRewindState(rewindSaveState: RewindSaveState): Boolean {
         return MelonEmulator.loadRewindState(rewindSaveState)
     }
 
-    override suspend fun saveState(saveStateFileUri: Uri): Boolean = withContext(Dispatchers.IO) {
-        MelonEmulator.saveState(saveStateFileUri)
+    override suspend fun saveState(saveStateFileUri: Uri, chunkStoreUri: Uri, rom: Rom): Deferred<Boolean> = withContext(Dispatchers.IO) {
+        val requestId = nextSaveStateRequestId.getAndIncrement()
+        val writeResult = CompletableDeferred<Boolean>()
+        // Register the request before calling into native code, since the write may complete before the call returns
+        pendingSaveStateWrites[requestId] = writeResult
+
+        if (MelonEmulator.saveState(saveStateFileUri, chunkStoreUri, requestId, rom.retroAchievementsHash, appVersion)) {
+            _saveStateWriteProgress.compareAndSet(null, 0)
+        } else {
+            pendingSaveStateWrites.remove(requestId)
+            writeResult.complete(false)
+        }
+        writeResult
+    }
+
+    override suspend fun loadState(saveStateFileUri: Uri, chunkStoreUri: Uri, rom: Rom): Boolean = withContext(Dispatchers.IO) {
+        MelonEmulator.loadState(saveStateFileUri, chunkStoreUri, rom.retroAchievementsHash)
     }
 
-    override suspend fun loadState(saveStateFileUri: Uri): Boolean = withContext(Dispatchers.IO) {
-        MelonEmulator.loadState(saveStateFileUri)
+    override suspend fun releaseBackgroundMemory(rom: Rom) {
+        val configuration = getRomEmulatorConfiguration(rom)
+        if (configuration.rewindEnabled) {
+            MelonEmulator.updateEmulatorConfiguration(configuration.copy(rewindEnabled = false))
+        }
+        MelonDSAndroidInterface.trimMemory(releaseAll = true)
     }
 
-    override fun stopEmulator() {
-        MelonEmulator.stopEmulation()
+    override fun stopEmulator(keepWarm: Boolean) {
+        MelonEmulator.stopEmulation(keepWarm)
         cameraManager.stopCurrentCameraSource()
         messageQueue.stop()
+        // Pending writes are still completed by the native writer, but their results can no longer be delivered
+        pendingSaveStateWrites.values.forEach { it.cancel() }
+        pendingSaveStateWrites.clear()
+        _saveStateWriteProgress.value = null
+    }
+
+    override fun releaseWarmEmulator() {
+        MelonEmulator.releaseWarmEmulator()
     }
 
     override fun cleanEmulator() {
+        MelonEmulator.releaseWarmEmulator()
         cameraManager.dispose()
         messageQueue.cleanup()
         irManager.cleanup()
@@ -228,8 +392,60 @@ class AndroidEmulatorManager(
         return achievementsSharedFlow.asSharedFlow()
     }
 
-    private fun setupEmulator(emulatorConfiguration: EmulatorConfiguration) {
-        MelonEmulator.setupEmulator(
+    private fun setupCheats(cheats: List<Cheat>) {
+        synchronized(registeredCheatCodes) {
+            // Cheats that were never saved don't have an ID. Give them one that can't clash with database IDs
+            val cheatIds = LongArray(cheats.size) { cheats[it].id ?: -(it + 1L) }
+            val cheatErrors = MelonEmulator.setupCheats(cheats.toTypedArray(), cheatIds)
+
+            registeredCheatCodes.clear()
+            enabledCheatIds.clear()
+            cheats.forEachIndexed { index, cheat ->
+                registeredCheatCodes[cheatIds[index]] = cheat.code
+                enabledCheatIds.add(cheatIds[index])
+                cheatErrors[index]?.let { logCheatError(cheat, it) }
+            }
+        }
+    }
+
+    /**
+     * Sends only the cheats that changed since the last update to the emulator. Cheats that are no longer enabled are disabled instead
+     * of removed, so that enabling them again doesn't require their code to be parsed again.
+     */
+    private fun updateRegisteredCheats(cheats: List<Cheat>) {
+        if (cheats.any { it.id == null }) {
+            setupCheats(cheats)
+            return
+        }
+
+        synchronized(registeredCheatCodes) {
+            val newEnabledCheatIds = cheats.mapTo(HashSet()) { it.id!! }
+            enabledCheatIds.filterNot { it in newEnabledCheatIds }.forEach {
+                MelonEmulator.setCheatEnabled(it, false)
+            }
+            enabledCheatIds.retainAll(newEnabledCheatIds)
+
+            cheats.forEach { cheat ->
+                val cheatId = cheat.id!!
+                if (registeredCheatCodes[cheatId] == cheat.code) {
+                    if (enabledCheatIds.add(cheatId)) {
+                        MelonEmulator.setCheatEnabled(cheatId, true)
+                    }
+                } else {
+                    registeredCheatCodes[cheatId] = cheat.code
+                    enabledCheatIds.add(cheatId)
+                    MelonEmulator.addCheat(cheatId, cheat.code, true)?.let { logCheatError(cheat, it) }
+                }
+            }
+        }
+    }
+
+    private fun logCheatError(cheat: Cheat, error: CheatCodeError) {
+        Log.w(TAG, "Ignoring cheat ${cheat.name}. Error: ${error.reason} at position ${error.position}")
+    }
+
+    private fun setupEmulator(emulatorConfiguration: EmulatorConfiguration): Boolean {
+        return MelonEmulator.setupEmulator(
             emulatorConfiguration = emulatorConfiguration,
             dsiCameraSource = cameraManager,
             irManager = irManager,
@@ -74,4 +74,43 @@ enum class EmulatorEventType(val event: Int) {
      * * formated value string (`u8[32]`)
      */
     EventRALeaderboardAttemptCompleted(213),
+
+    /**
+     * RA rich presence text changed. Data:
+     * * rich presence string size (`i32`). 0 if the game has no rich presence
+     * * rich presence string (`u8[size]`)
+     */
+    EventRARichPresenceUpdated(220),
+
+    /**
+     * Save state write progress. Data:
+     * * save state request ID (`i32`)
+     * * write progress, from 0 to 100 (`i32`)
+     */
+    EventSaveStateWriteProgress(300),
+
+    /**
+     * Save state write completed. Data:
+     * * save state request ID (`i32`)
+     * * write result (`i32`). 0 if the state was written successfully, or an error code otherwise
+     */
+    EventSaveStateWriteCompleted(301),
+
+    /**
+     * Configuration changes applied while the emulator is running. Data:
+     * * time during which the emulation was stalled to apply the changes, in ns (`i64`)
+     * * flags of the subsystems that were updated (`i32`)
+     */
+    EventConfigurationApplied(400);
+
+    companion object {
+        // Indexed by event value. Events are looked up for every record drained from the event ring, so avoid scanning the entries
+        private val typesByEvent = arrayOfNulls<EmulatorEventType>(entries.maxOf { it.event } + 1).apply {
+            entries.forEach { this[it.event] = it }
+        }
+
+        fun fromEvent(event: Int): EmulatorEventType? {
+            return typesByEvent.getOrNull(event)
+        }
+    }
 }
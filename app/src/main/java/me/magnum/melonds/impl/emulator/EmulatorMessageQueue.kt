@@ -5,46 +5,77 @@ import android.os.HandlerThread
 import android.os.Looper
 import android.os.MessageQueue
 import android.os.ParcelFileDescriptor
-import java.io.FileInputStream
+import android.util.Log
 import java.nio.ByteBuffer
 import java.nio.ByteOrder
 
+/**
+ * Receives the events fired by the emulator. Events are read straight from a ring buffer shared with the native code (see EventRing.h),
+ * and every time the thread is woken up, all pending events are dispatched at once.
+ */
 class EmulatorMessageQueue(private val eventHandler: EventHandler) {
 
     fun interface EventHandler {
         /**
          * @param type The type of event generated by the emulator
-         * @param data The buffer containing optional data associated with the event. The buffer is only valid for the duration of the call
+         * @param data The buffer containing optional data associated with the event, between its position and its limit. The buffer is a
+         * view of the event ring and is only valid for the duration of the call
          */
         fun onEmulatorEvent(type: EmulatorEventType, data: ByteBuffer)
     }
 
     companion object {
-        private const val EVENT_SIZE_BYTES = 8 // 2 ints (type, data length)
-        private const val DATA_SIZE_BYTES = 128 // 128 bytes of arbitrary data
+        private const val TAG = "EmulatorMessageQueue"
+
+        // Must match EventRing.h
+        private const val CONTROL_BLOCK_SIZE = 256
+        private const val DROPPED_EVENT_COUNT_OFFSET = 128
+        private const val OVERSIZED_EVENT_COUNT_OFFSET = 136
+        private const val RECORD_HEADER_SIZE = 8
+        private const val STATE_PADDING = 1 shl 30
+        private const val STATE_SIZE_MASK = STATE_PADDING - 1
+
+        /**
+         * Opens the native event ring, discarding any event left from a previous session.
+         * @return File descriptor that becomes readable when events are available, or -1 on error
+         */
+        @JvmStatic
+        private external fun initEventRing(): Int
+
+        /**
+         * @return Buffer mapping the whole memory of the event ring
+         */
+        @JvmStatic
+        private external fun getEventRingBuffer(): ByteBuffer
+
+        @JvmStatic
+        private external fun getEventRingReadPosition(): Long
 
         /**
-         * Initialize the native message pipe and returns the file descriptor through which the messages will be sent.
-         * @return File descriptor for reading events, or -1 on error
+         * Releases the events before [consumedPosition] and returns the position up to which events can be read. If there are no events
+         * left, the file descriptor is rearmed.
          */
         @JvmStatic
-        private external fun initMessagePipe(): Int
+        private external fun acquireEvents(consumedPosition: Long): Long
 
         /**
-         * Close the native message pipe.
+         * Stops accepting events.
          */
         @JvmStatic
-        private external fun closeMessagePipe()
+        private external fun closeEventRing()
     }
 
     private val handlerThread = HandlerThread("EmulatorMessageQueue").apply { start() }
     private val handler = Handler(handlerThread.looper)
 
-    private var messagesFileDescriptor: ParcelFileDescriptor? = null
-    private var inputStream: FileInputStream? = null
+    private var eventFileDescriptor: ParcelFileDescriptor? = null
     private var isRunning = false
-    private val eventBuffer = ByteBuffer.allocateDirect(EVENT_SIZE_BYTES).order(ByteOrder.nativeOrder())
-    private val dataBuffer = ByteBuffer.allocateDirect(DATA_SIZE_BYTES).order(ByteOrder.nativeOrder())
+    private var ringBuffer: ByteBuffer? = null
+    private var dataBuffer: ByteBuffer? = null
+    private var ringCapacity = 0
+    private var readPosition = 0L
+    private var droppedEventCount = 0L
+    private var oversizedEventCount = 0L
 
     fun start() {
         handler.post {
@@ -54,19 +85,24 @@ class EmulatorMessageQueue(private val eventHandler: EventHandler) {
 
             val looper = Looper.myLooper() ?: throw IllegalStateException("Current thread does not have a Looper")
 
-            val readPipeFd = initMessagePipe()
-            if (readPipeFd < 0) {
-                throw RuntimeException("Failed to initialize native pipe")
+            val eventFd = initEventRing()
+            if (eventFd < 0) {
+                throw RuntimeException("Failed to initialize native event ring")
             }
 
-            val fileDescriptor = ParcelFileDescriptor.adoptFd(readPipeFd)
-            if (fileDescriptor == null) {
-                throw RuntimeException("Failed to create ParcelFileDescriptor")
-            }
+            // The eventfd belongs to the native ring, which outlives this queue, so work on a copy of it
+            val fileDescriptor = ParcelFileDescriptor.fromFd(eventFd)
+
+            val buffer = getEventRingBuffer().order(ByteOrder.nativeOrder())
+            ringBuffer = buffer
+            dataBuffer = buffer.duplicate().order(ByteOrder.nativeOrder())
+            ringCapacity = buffer.capacity() - CONTROL_BLOCK_SIZE
+            readPosition = getEventRingReadPosition()
+            droppedEventCount = buffer.getLong(DROPPED_EVENT_COUNT_OFFSET)
+            oversizedEventCount = buffer.getLong(OVERSIZED_EVENT_COUNT_OFFSET)
 
-            messagesFileDescriptor = fileDescriptor
+            eventFileDescriptor = fileDescriptor
             isRunning = true
-            inputStream = FileInputStream(fileDescriptor.fileDescriptor)
 
             looper.queue.addOnFileDescriptorEventListener(fileDescriptor.fileDescriptor, MessageQueue.OnFileDescriptorEventListener.EVENT_INPUT) { _, _ ->
                 if (isRunning) {
@@ -79,6 +115,9 @@ class EmulatorMessageQueue(private val eventHandler: EventHandler) {
 
                 MessageQueue.OnFileDescriptorEventListener.EVENT_INPUT
             }
+
+            // Events may have been fired before the listener was registered
+            readEvents()
         }
     }
 
@@ -89,15 +128,16 @@ class EmulatorMessageQueue(private val eventHandler: EventHandler) {
             }
 
             isRunning = false
+            closeEventRing()
 
-            messagesFileDescriptor?.let { fd ->
+            eventFileDescriptor?.let { fd ->
                 Looper.myLooper()?.queue?.removeOnFileDescriptorEventListener(fd.fileDescriptor)
                 fd.close()
             }
 
-            inputStream = null
-            messagesFileDescriptor = null
-            closeMessagePipe()
+            eventFileDescriptor = null
+            ringBuffer = null
+            dataBuffer = null
         }
     }
 
@@ -109,32 +149,46 @@ class EmulatorMessageQueue(private val eventHandler: EventHandler) {
     }
 
     private fun readEvents() {
-        val currentInputStream = inputStream ?: return
+        val buffer = ringBuffer ?: return
+        val data = dataBuffer ?: return
+
+        var endPosition = acquireEvents(readPosition)
+        while (readPosition < endPosition) {
+            while (readPosition < endPosition) {
+                val recordOffset = CONTROL_BLOCK_SIZE + (readPosition and (ringCapacity - 1).toLong()).toInt()
+                val state = buffer.getInt(recordOffset)
+                val dataLength = state and STATE_SIZE_MASK
+
+                if (state and STATE_PADDING == 0) {
+                    val type = buffer.getInt(recordOffset + 4)
+                    EmulatorEventType.fromEvent(type)?.let {
+                        val dataOffset = recordOffset + RECORD_HEADER_SIZE
+                        data.limit(dataOffset + dataLength)
+                        data.position(dataOffset)
+                        eventHandler.onEmulatorEvent(it, data)
+                    }
+                }
 
-        eventBuffer.clear()
-        var bytesRead = currentInputStream.channel.read(eventBuffer)
-        eventBuffer.position(0)
+                readPosition += (RECORD_HEADER_SIZE + dataLength + 7) and 7.inv()
+            }
 
-        if (bytesRead < EVENT_SIZE_BYTES) {
-            return
+            endPosition = acquireEvents(readPosition)
         }
 
-        val type = eventBuffer.int
-        val dataLength = eventBuffer.int
-
-        if (dataLength > 0) {
-            dataBuffer.position(0)
-            dataBuffer.limit(dataLength)
-            bytesRead = currentInputStream.channel.read(dataBuffer)
-            dataBuffer.position(0)
+        reportLostEvents(buffer)
+    }
 
-            if (bytesRead < dataLength) {
-                return
-            }
+    private fun reportLostEvents(buffer: ByteBuffer) {
+        val newDroppedEventCount = buffer.getLong(DROPPED_EVENT_COUNT_OFFSET)
+        if (newDroppedEventCount != droppedEventCount) {
+            Log.w(TAG, "Event ring full. Dropped ${newDroppedEventCount - droppedEventCount} events")
+            droppedEventCount = newDroppedEventCount
         }
 
-        EmulatorEventType.entries.firstOrNull { it.event == type }?.let {
-            eventHandler.onEmulatorEvent(it, dataBuffer)
+        val newOversizedEventCount = buffer.getLong(OVERSIZED_EVENT_COUNT_OFFSET)
+        if (newOversizedEventCount != oversizedEventCount) {
+            Log.w(TAG, "Dropped ${newOversizedEventCount - oversizedEventCount} events that were too big for the event ring")
+            oversizedEventCount = newOversizedEventCount
         }
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,42 @@
+package me.magnum.melonds.impl.image
+
+import android.net.Uri
+import com.squareup.picasso.Picasso
+import com.squareup.picasso.Request
+import com.squareup.picasso.RequestHandler
+import me.magnum.melonds.impl.savestate.SaveStateContainerReader
+
+/**
+ * Loads the thumbnails embedded in save state containers. Thumbnail URIs must be built with [buildThumbnailUri].
+ */
+class PicassoSaveStateThumbnailRequestHandler(private val saveStateContainerReader: SaveStateContainerReader) : RequestHandler() {
+
+    companion object {
+        private const val SCHEME = "melonds-save-state-thumbnail"
+        private const val PARAM_SAVE_STATE_URI = "uri"
+        private const val PARAM_TIMESTAMP = "timestamp"
+
+        /**
+         * Builds the URI of the thumbnail of the given save state. The state's timestamp is part of the URI so that a new thumbnail
+         * is loaded whenever the state is overwritten, instead of the one that Picasso has in cache.
+         */
+        fun buildThumbnailUri(saveStateUri: Uri, timestamp: Long): Uri {
+            return Uri.Builder()
+                .scheme(SCHEME)
+                .authority("")
+                .appendQueryParameter(PARAM_SAVE_STATE_URI, saveStateUri.toString())
+                .appendQueryParameter(PARAM_TIMESTAMP, timestamp.toString())
+                .build()
+        }
+    }
+
+    override fun canHandleRequest(data: Request): Boolean {
+        return data.uri?.scheme == SCHEME
+    }
+
+    override fun load(request: Request, networkPolicy: Int): Result? {
+        val saveStateUri = request.uri.getQueryParameter(PARAM_SAVE_STATE_URI)?.let { Uri.parse(it) } ?: return null
+        val thumbnail = saveStateContainerReader.readThumbnail(saveStateUri) ?: return null
+        return Result(thumbnail, Picasso.LoadedFrom.DISK)
+    }
+}
@@ -0,0 +1,87 @@
+package me.magnum.melonds.impl.retroachievements
+
+import kotlinx.coroutines.sync.Mutex
+import kotlinx.coroutines.sync.withLock
+import me.magnum.melonds.MelonEmulator
+import me.magnum.melonds.domain.model.retroachievements.RASimpleRuntimeAchievement
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+
+/**
+ * Reads the progress of the runtime achievements from the native runtime achievement table (see RuntimeAchievementTable.h). After the
+ * first read, only the rows flagged as dirty by the native side are read again.
+ */
+class RuntimeAchievementProgressTable {
+
+    private companion object {
+        // Must match RuntimeAchievementTable.h
+        const val HEADER_SIZE = 8
+        const val ROW_SIZE = 16
+    }
+
+    private val updateLock = Mutex()
+    private var tableBuffer: ByteBuffer? = null
+    private val rows = ArrayList<RASimpleRuntimeAchievement>()
+    private var achievementsById = emptyMap<Long, RASimpleRuntimeAchievement>()
+
+    /**
+     * Refreshes the progress of the achievements.
+     * @return The progress of each achievement, by achievement ID
+     */
+    suspend fun update(): Map<Long, RASimpleRuntimeAchievement> = updateLock.withLock {
+        val wasReallocated = MelonEmulator.updateRuntimeAchievementTable()
+        val currentBuffer = tableBuffer
+        val readAllRows = wasReallocated || currentBuffer == null
+        val buffer = if (readAllRows) {
+            MelonEmulator.getRuntimeAchievementTable().order(ByteOrder.nativeOrder()).also { tableBuffer = it }
+        } else {
+            currentBuffer
+        }
+
+        val rowCount = buffer.getInt(0)
+        val rowsOffset = HEADER_SIZE + buffer.getInt(4) / 8
+        var hasChanges = readAllRows || rows.size != rowCount
+
+        if (readAllRows) {
+            rows.clear()
+            for (row in 0 until rowCount) {
+                rows.add(readRow(buffer, rowsOffset, row))
+            }
+        } else {
+            while (rows.size > rowCount) {
+                rows.removeAt(rows.lastIndex)
+            }
+
+            // Rows past the previous row count are always dirty, and bits are visited in row order, so new rows are appended in order
+            for (word in 0 until (rowCount + 63) / 64) {
+                var dirtyBits = buffer.getLong(HEADER_SIZE + word * 8)
+                while (dirtyBits != 0L) {
+                    val row = word * 64 + dirtyBits.countTrailingZeroBits()
+                    dirtyBits = dirtyBits and (dirtyBits - 1)
+
+                    val achievement = readRow(buffer, rowsOffset, row)
+                    if (row < rows.size) {
+                        rows[row] = achievement
+                    } else {
+                        rows.add(achievement)
+                    }
+                    hasChanges = true
+                }
+            }
+        }
+
+        if (hasChanges) {
+            achievementsById = rows.associateBy { it.id }
+        }
+        achievementsById
+    }
+
+    private fun readRow(buffer: ByteBuffer, rowsOffset: Int, row: Int): RASimpleRuntimeAchievement {
+        val offset = rowsOffset + row * ROW_SIZE
+        return RASimpleRuntimeAchievement(
+            id = buffer.getLong(offset),
+            value = buffer.getInt(offset + 8),
+            target = buffer.getInt(offset + 12),
+        )
+    }
+}
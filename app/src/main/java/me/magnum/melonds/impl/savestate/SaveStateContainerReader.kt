@@ -0,0 +1,169 @@
+package me.magnum.melonds.impl.savestate
+
+import android.content.Context
+import android.graphics.Bitmap
+import android.net.Uri
+import java.io.DataInputStream
+import java.io.IOException
+import java.io.InputStream
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+import java.util.Date
+import java.util.zip.DataFormatException
+import java.util.zip.Inflater
+
+/**
+ * Reads the metadata and thumbnail of save state containers written by the native save state writer. Only the beginning of the
+ * file is read, so this is cheap enough to be done for every slot when listing the save states of a ROM.
+ */
+class SaveStateContainerReader(private val context: Context) {
+
+    private companion object {
+        const val HEADER_SIZE = 128
+        const val SUPPORTED_VERSION = 1
+        const val ROM_HASH_LENGTH = 32
+        const val EMULATOR_VERSION_LENGTH = 32
+        // Thumbnails are never larger than the top screen at twice its resolution. Anything larger comes from a corrupted header
+        const val MAX_THUMBNAIL_WIDTH = 256
+        const val MAX_THUMBNAIL_HEIGHT = 384
+        val SAVE_STATE_MAGIC = "MDSS".toByteArray()
+    }
+
+    /**
+     * Reads the header of the given save state.
+     *
+     * @return The header of the save state, or null if the file is not a save state container or its version is not supported
+     */
+    fun readHeader(saveStateUri: Uri): SaveStateHeader? {
+        return try {
+            context.contentResolver.openInputStream(saveStateUri)?.use {
+                readHeader(DataInputStream(it))
+            }
+        } catch (e: IOException) {
+            null
+        }
+    }
+
+    /**
+     * Reads the thumbnail of the given save state.
+     *
+     * @return The thumbnail of the save state, or null if the state doesn't have one or it could not be read
+     */
+    fun readThumbnail(saveStateUri: Uri): Bitmap? {
+        return try {
+            context.contentResolver.openInputStream(saveStateUri)?.use {
+                val inputStream = DataInputStream(it)
+                val header = readHeader(inputStream)
+                if (header?.hasThumbnail != true || !isThumbnailValid(header)) {
+                    return null
+                }
+
+                inputStream.skipFully(header.thumbnailOffset - HEADER_SIZE)
+                val compressedThumbnail = ByteArray(header.thumbnailCompressedSize)
+                inputStream.readFully(compressedThumbnail)
+                decodeThumbnail(compressedThumbnail, header.thumbnailWidth, header.thumbnailHeight)
+            }
+        } catch (e: IOException) {
+            null
+        }
+    }
+
+    private fun readHeader(inputStream: DataInputStream): SaveStateHeader? {
+        val headerBytes = ByteArray(HEADER_SIZE)
+        try {
+            inputStream.readFully(headerBytes)
+        } catch (e: IOException) {
+            // The file is too small to be a save state container
+            return null
+        }
+
+        if (!headerBytes.copyOfRange(0, SAVE_STATE_MAGIC.size).contentEquals(SAVE_STATE_MAGIC)) {
+            return null
+        }
+
+        val buffer = ByteBuffer.wrap(headerBytes, SAVE_STATE_MAGIC.size, HEADER_SIZE - SAVE_STATE_MAGIC.size).order(ByteOrder.LITTLE_ENDIAN)
+        val version = buffer.getInt()
+        if (version != SUPPORTED_VERSION) {
+            return null
+        }
+
+        val headerSize = buffer.getInt()
+        // Skip compression type. Only zlib is supported
+        buffer.getInt()
+
+        return SaveStateHeader(
+            version = version,
+            headerSize = headerSize,
+            frameCount = buffer.getLong(),
+            timestamp = Date(buffer.getLong()),
+            romHash = buffer.getFixedLengthString(ROM_HASH_LENGTH),
+            emulatorVersion = buffer.getFixedLengthString(EMULATOR_VERSION_LENGTH),
+            thumbnailOffset = buffer.getInt(),
+            thumbnailCompressedSize = buffer.getInt(),
+            thumbnailWidth = buffer.getInt(),
+            thumbnailHeight = buffer.getInt(),
+        )
+    }
+
+    private fun isThumbnailValid(header: SaveStateHeader): Boolean {
+        if (header.thumbnailOffset < HEADER_SIZE || header.thumbnailWidth > MAX_THUMBNAIL_WIDTH || header.thumbnailHeight > MAX_THUMBNAIL_HEIGHT) {
+            return false
+        }
+
+        // Deflate only adds a few bytes per block and the zlib header and trailer, so a larger size can't be right either
+        val thumbnailSize = header.thumbnailWidth * header.thumbnailHeight * 4
+        return header.thumbnailCompressedSize <= thumbnailSize * 2 + 64
+    }
+
+    private fun decodeThumbnail(compressedThumbnail: ByteArray, width: Int, height: Int): Bitmap? {
+        if (width <= 0 || height <= 0 || width > MAX_THUMBNAIL_WIDTH || height > MAX_THUMBNAIL_HEIGHT) {
+            return null
+        }
+
+        val thumbnailData = ByteArray(width * height * 4)
+        val inflater = Inflater()
+        val inflatedBytes = try {
+            inflater.setInput(compressedThumbnail)
+            var totalInflated = 0
+            while (!inflater.finished() && totalInflated < thumbnailData.size) {
+                val inflated = inflater.inflate(thumbnailData, totalInflated, thumbnailData.size - totalInflated)
+                if (inflated == 0 && (inflater.needsInput() || inflater.needsDictionary())) {
+                    break
+                }
+                totalInflated += inflated
+            }
+            totalInflated
+        } catch (e: DataFormatException) {
+            return null
+        } finally {
+            inflater.end()
+        }
+
+        if (inflatedBytes != thumbnailData.size) {
+            return null
+        }
+
+        // Pixels are stored as BGRA. Reading them as little endian ints results in ARGB values, which is what the bitmap needs
+        val pixels = IntArray(width * height)
+        ByteBuffer.wrap(thumbnailData).order(ByteOrder.LITTLE_ENDIAN).asIntBuffer().get(pixels)
+        return Bitmap.createBitmap(pixels, width, height, Bitmap.Config.ARGB_8888)
+    }
+
+    private fun ByteBuffer.getFixedLengthString(length: Int): String {
+        val bytes = ByteArray(length)
+        get(bytes)
+        val stringLength = bytes.indexOf(0).takeIf { it >= 0 } ?: length
+        return String(bytes, 0, stringLength)
+    }
+
+    private fun InputStream.skipFully(byteCount: Int) {
+        var remaining = byteCount.toLong()
+        while (remaining > 0) {
+            val skipped = skip(remaining)
+            if (skipped <= 0) {
+                throw IOException("Unexpected end of stream")
+            }
+            remaining -= skipped
+        }
+    }
+}
@@ -0,0 +1,22 @@
+package me.magnum.melonds.impl.savestate
+
+import java.util.Date
+
+/**
+ * Header of a save state container. See SaveStateFormat.h for the details of the format.
+ */
+data class SaveStateHeader(
+    val version: Int,
+    val headerSize: Int,
+    val frameCount: Long,
+    val timestamp: Date,
+    val romHash: String,
+    val emulatorVersion: String,
+    val thumbnailOffset: Int,
+    val thumbnailCompressedSize: Int,
+    val thumbnailWidth: Int,
+    val thumbnailHeight: Int,
+) {
+
+    val hasThumbnail get() = thumbnailCompressedSize > 0 && thumbnailWidth > 0 && thumbnailHeight > 0
+}
@@ -4,6 +4,7 @@ import androidx.lifecycle.SavedStateHandle
 import androidx.lifecycle.ViewModel
 import androidx.lifecycle.viewModelScope
 import dagger.hilt.android.lifecycle.HiltViewModel
+import kotlinx.coroutines.Dispatchers
 import kotlinx.coroutines.ExperimentalCoroutinesApi
 import kotlinx.coroutines.channels.Channel
 import kotlinx.coroutines.flow.MutableStateFlow
@@ -14,6 +15,7 @@ import kotlinx.coroutines.flow.drop
 import kotlinx.coroutines.flow.filterNotNull
 import kotlinx.coroutines.flow.flatMapLatest
 import kotlinx.coroutines.flow.flow
+import kotlinx.coroutines.flow.flowOn
 import kotlinx.coroutines.flow.flowOf
 import kotlinx.coroutines.flow.map
 import kotlinx.coroutines.flow.onStart
@@ -21,8 +23,10 @@ import kotlinx.coroutines.flow.receiveAsFlow
 import kotlinx.coroutines.flow.shareIn
 import kotlinx.coroutines.flow.update
 import kotlinx.coroutines.launch
+import me.magnum.melonds.MelonCheatCodeParser
 import me.magnum.melonds.common.suspendRunCatching
 import me.magnum.melonds.domain.model.Cheat
+import me.magnum.melonds.domain.model.CheatCodeError
 import me.magnum.melonds.domain.model.CheatFolder
 import me.magnum.melonds.domain.model.CheatInFolder
 import me.magnum.melonds.domain.model.Game
@@ -155,6 +159,26 @@ class CheatsViewModel @Inject constructor(
         }.shareIn(viewModelScope, started = SharingStarted.WhileSubscribed(), replay = 1)
     }
 
+    /**
+     * Errors of the cheats in [folderCheats] that have invalid codes, by code.
+     */
+    val folderCheatCodeErrors by lazy {
+        folderCheats.map { state ->
+            val cheats = (state as? CheatsScreenUiState.Ready)?.data.orEmpty()
+            validateCheatCodes(cheats.map { it.code })
+        }.flowOn(Dispatchers.Default).shareIn(viewModelScope, started = SharingStarted.WhileSubscribed(stopTimeoutMillis = 1000L), replay = 1)
+    }
+
+    /**
+     * Errors of the cheats in [selectedGameCheats] that have invalid codes, by code.
+     */
+    val selectedGameCheatCodeErrors by lazy {
+        selectedGameCheats.map { state ->
+            val cheats = (state as? CheatsScreenUiState.Ready)?.data.orEmpty()
+            validateCheatCodes(cheats.map { it.cheat.code })
+        }.flowOn(Dispatchers.Default).shareIn(viewModelScope, started = SharingStarted.WhileSubscribed(), replay = 1)
+    }
+
     private val _openGamesEvent = Channel<OpenScreenEvent>(Channel.CONFLATED)
     val openGamesEvent = _openGamesEvent.receiveAsFlow()
 
@@ -173,6 +197,13 @@ class CheatsViewModel @Inject constructor(
     private val _cheatChangesCommittedEvent = Channel<Boolean>(Channel.CONFLATED)
     val cheatChangesCommittedEvent = _cheatChangesCommittedEvent.receiveAsFlow()
 
+    private fun validateCheatCodes(codes: List<String>): Map<String, CheatCodeError> {
+        val distinctCodes = codes.distinct()
+        return distinctCodes.zip(MelonCheatCodeParser.validateCheatCodes(distinctCodes))
+            .mapNotNull { (code, error) -> error?.let { code to it } }
+            .toMap()
+    }
+
     fun setSelectedGame(game: Game) {
         savedStateHandle[KEY_SELECTED_GAME] = GameParcelable.fromGame(game)
         _openFoldersEvent.trySend(OpenScreenEvent(game.name))
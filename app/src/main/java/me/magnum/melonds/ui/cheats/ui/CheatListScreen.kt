@@ -29,6 +29,7 @@ import androidx.compose.ui.text.style.TextAlign
 import androidx.compose.ui.unit.dp
 import me.magnum.melonds.R
 import me.magnum.melonds.domain.model.Cheat
+import me.magnum.melonds.domain.model.CheatCodeError
 import me.magnum.melonds.ui.cheats.model.CheatFormDialogState
 import me.magnum.melonds.ui.cheats.model.CheatSubmissionForm
 import me.magnum.melonds.ui.cheats.model.CheatsScreenUiState
@@ -40,6 +41,7 @@ fun CheatListScreen(
     modifier: Modifier,
     contentPadding: PaddingValues,
     cheats: CheatsScreenUiState<List<Cheat>>,
+    cheatCodeErrors: Map<String, CheatCodeError>,
     onCheatClick: (Cheat) -> Unit,
     onAddNewCheat: (CheatSubmissionForm) -> Unit,
     onUpdateCheat: (Cheat, CheatSubmissionForm) -> Unit,
@@ -51,6 +53,7 @@ fun CheatListScreen(
             modifier = modifier,
             contentPadding = contentPadding,
             cheats = cheats.data,
+            cheatCodeErrors = cheatCodeErrors,
             onCheatClick = onCheatClick,
             onAddNewCheat = onAddNewCheat,
             onUpdateCheat = onUpdateCheat,
@@ -64,6 +67,7 @@ private fun List(
     modifier: Modifier,
     contentPadding: PaddingValues,
     cheats: List<Cheat>,
+    cheatCodeErrors: Map<String, CheatCodeError>,
     onCheatClick: (Cheat) -> Unit,
     onAddNewCheat: (CheatSubmissionForm) -> Unit,
     onUpdateCheat: (Cheat, CheatSubmissionForm) -> Unit,
@@ -99,6 +103,7 @@ private fun List(
                     CheatItem(
                         modifier = Modifier.fillMaxWidth(),
                         cheat = item,
+                        codeError = cheatCodeErrors[item.code],
                         onClick = { onCheatClick(item) },
                         onEditClick = { cheatFormDialogState = CheatFormDialogState.EditCheat(item) },
                         onDeleteClick = { onDeleteCheatClick(item) },
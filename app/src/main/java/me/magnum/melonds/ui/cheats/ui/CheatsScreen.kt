@@ -190,11 +190,13 @@ fun CheatsScreen(
             }
             composable<CheatsNavigation.FolderCheats> {
                 val cheats by viewModel.folderCheats.collectAsStateWithLifecycle(CheatsScreenUiState.Loading())
+                val cheatCodeErrors by viewModel.folderCheatCodeErrors.collectAsStateWithLifecycle(emptyMap())
 
                 CheatListScreen(
                     modifier = Modifier.fillMaxSize(),
                     contentPadding = padding,
                     cheats = cheats,
+                    cheatCodeErrors = cheatCodeErrors,
                     onCheatClick = { viewModel.toggleCheat(it) },
                     onAddNewCheat = viewModel::addNewCheat,
                     onUpdateCheat = viewModel::updateCheat,
@@ -214,11 +216,13 @@ fun CheatsScreen(
             }
             composable<CheatsNavigation.EnabledCheats> {
                 val cheats by viewModel.selectedGameCheats.collectAsStateWithLifecycle(CheatsScreenUiState.Loading())
+                val cheatCodeErrors by viewModel.selectedGameCheatCodeErrors.collectAsStateWithLifecycle(emptyMap())
 
                 EnabledCheatsListScreen(
                     modifier = Modifier.fillMaxSize(),
                     contentPadding = padding,
                     cheats = cheats,
+                    cheatCodeErrors = cheatCodeErrors,
                     onCheatClick = { viewModel.toggleCheat(it.cheat) }
                 )
             }
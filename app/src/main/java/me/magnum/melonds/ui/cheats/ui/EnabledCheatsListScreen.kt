@@ -15,6 +15,7 @@ import androidx.compose.ui.res.stringResource
 import androidx.compose.ui.text.style.TextAlign
 import androidx.compose.ui.unit.dp
 import me.magnum.melonds.R
+import me.magnum.melonds.domain.model.CheatCodeError
 import me.magnum.melonds.domain.model.CheatInFolder
 import me.magnum.melonds.ui.cheats.model.CheatsScreenUiState
 import me.magnum.melonds.ui.cheats.ui.item.CheatInFolderItem
@@ -24,6 +25,7 @@ fun EnabledCheatsListScreen(
     modifier: Modifier,
     contentPadding: PaddingValues,
     cheats: CheatsScreenUiState<List<CheatInFolder>>,
+    cheatCodeErrors: Map<String, CheatCodeError>,
     onCheatClick: (CheatInFolder) -> Unit,
 ) {
     when (cheats) {
@@ -32,6 +34,7 @@ fun EnabledCheatsListScreen(
             modifier = modifier,
             contentPadding = contentPadding,
             cheats = cheats.data,
+            cheatCodeErrors = cheatCodeErrors,
             onCheatClick = onCheatClick,
         )
     }
@@ -42,6 +45,7 @@ private fun List(
     modifier: Modifier,
     contentPadding: PaddingValues,
     cheats: List<CheatInFolder>,
+    cheatCodeErrors: Map<String, CheatCodeError>,
     onCheatClick: (CheatInFolder) -> Unit,
 ) {
     if (cheats.isEmpty()) {
@@ -64,6 +68,7 @@ private fun List(
                 CheatInFolderItem(
                     modifier = Modifier.fillMaxWidth(),
                     cheatInFolder = it,
+                    codeError = cheatCodeErrors[it.cheat.code],
                     onClick = { onCheatClick(it) },
                 )
             }
@@ -0,0 +1,27 @@
+package me.magnum.melonds.ui.cheats.ui.item
+
+import androidx.compose.material.MaterialTheme
+import androidx.compose.material.Text
+import androidx.compose.runtime.Composable
+import androidx.compose.ui.Modifier
+import androidx.compose.ui.res.stringResource
+import me.magnum.melonds.R
+import me.magnum.melonds.domain.model.CheatCodeError
+
+@Composable
+fun CheatCodeErrorText(modifier: Modifier = Modifier, error: CheatCodeError) {
+    // Positions are shown to the user starting at 1
+    val message = when (error.reason) {
+        CheatCodeError.Reason.EMPTY -> stringResource(R.string.cheat_code_error_empty)
+        CheatCodeError.Reason.INVALID_CHARACTER -> stringResource(R.string.cheat_code_error_invalid_character, error.position + 1)
+        CheatCodeError.Reason.INVALID_WORD_LENGTH -> stringResource(R.string.cheat_code_error_invalid_word_length, error.position + 1)
+        CheatCodeError.Reason.INCOMPLETE_LINE -> stringResource(R.string.cheat_code_error_incomplete_line)
+    }
+
+    Text(
+        modifier = modifier,
+        text = message,
+        style = MaterialTheme.typography.caption,
+        color = MaterialTheme.colors.error,
+    )
+}
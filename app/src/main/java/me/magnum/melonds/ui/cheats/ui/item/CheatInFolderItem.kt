@@ -19,6 +19,7 @@ import androidx.compose.ui.Modifier
 import androidx.compose.ui.text.style.TextOverflow
 import androidx.compose.ui.unit.dp
 import me.magnum.melonds.domain.model.Cheat
+import me.magnum.melonds.domain.model.CheatCodeError
 import me.magnum.melonds.domain.model.CheatInFolder
 import me.magnum.melonds.ui.common.MelonPreviewSet
 import me.magnum.melonds.ui.common.component.text.CaptionText
@@ -28,6 +29,7 @@ import me.magnum.melonds.ui.theme.MelonTheme
 fun CheatInFolderItem(
     modifier: Modifier,
     cheatInFolder: CheatInFolder,
+    codeError: CheatCodeError?,
     onClick: () -> Unit,
 ) {
     Row(
@@ -67,6 +69,10 @@ fun CheatInFolderItem(
                     style = MaterialTheme.typography.body2,
                 )
             }
+
+            if (codeError != null) {
+                CheatCodeErrorText(error = codeError)
+            }
         }
     }
 }
@@ -81,6 +87,7 @@ private fun PreviewCheatInFolderItem() {
                 cheat = Cheat(0, 0, "Some random cheat", "Press some buttons to activate this cheat. What does it do?", "", false),
                 folderName = "Best cheats",
             ),
+            codeError = null,
             onClick = { },
         )
     }
@@ -37,6 +37,7 @@ import androidx.compose.ui.res.stringResource
 import androidx.compose.ui.unit.dp
 import me.magnum.melonds.R
 import me.magnum.melonds.domain.model.Cheat
+import me.magnum.melonds.domain.model.CheatCodeError
 import me.magnum.melonds.ui.common.MelonPreviewSet
 import me.magnum.melonds.ui.common.component.text.CaptionText
 import me.magnum.melonds.ui.theme.MelonTheme
@@ -45,6 +46,7 @@ import me.magnum.melonds.ui.theme.MelonTheme
 fun CheatItem(
     modifier: Modifier,
     cheat: Cheat,
+    codeError: CheatCodeError?,
     onClick: () -> Unit,
     onEditClick: () -> Unit,
     onDeleteClick: () -> Unit,
@@ -53,7 +55,7 @@ fun CheatItem(
     var showCheatOptions by remember { mutableStateOf(false) }
     val (mainFocusRequester, optionsFocusRequester) = remember { FocusRequester.createRefs() }
 
-    val verticalPadding = if (hasDescription) 12.dp else 4.dp
+    val verticalPadding = if (hasDescription || codeError != null) 12.dp else 4.dp
     Row(
         modifier = modifier
             .focusRequester(mainFocusRequester)
@@ -91,6 +93,10 @@ fun CheatItem(
                     text = cheat.description,
                 )
             }
+
+            if (codeError != null) {
+                CheatCodeErrorText(error = codeError)
+            }
         }
 
         // Cheat can always be edited even if it's not valid
@@ -141,6 +147,7 @@ private fun PreviewCheatItem() {
         CheatItem(
             modifier = Modifier.fillMaxWidth(),
             cheat = Cheat(0, 0, "Some random cheat", "Press some buttons to activate this cheat. What does it do?", "", false),
+            codeError = null,
             onClick = { },
             onEditClick = { },
             onDeleteClick = { },
@@ -442,6 +442,16 @@ class EmulatorActivity : AppCompatActivity() {
                 }
             }
         }
+        lifecycleScope.launch {
+            lifecycle.repeatOnLifecycle(Lifecycle.State.STARTED) {
+                viewModel.saveStateWriteProgress.collectLatest {
+                    binding.textSaveStateProgress.isVisible = it != null
+                    if (it != null) {
+                        binding.textSaveStateProgress.text = getString(R.string.info_saving_state, it)
+                    }
+                }
+            }
+        }
         lifecycleScope.launch {
             lifecycle.repeatOnLifecycle(Lifecycle.State.STARTED) {
                 viewModel.toastEvent.collectLatest {
@@ -585,6 +595,7 @@ class EmulatorActivity : AppCompatActivity() {
                 appForegroundStateObserver.onAppMovedToBackgroundEvent.collect {
                     presentation?.dismiss()
                     presentation = null
+                    viewModel.onAppMovedToBackground()
                 }
             }
         }
@@ -592,6 +603,7 @@ class EmulatorActivity : AppCompatActivity() {
 
     override fun onStart() {
         super.onStart()
+        viewModel.onAppMovedToForeground()
         updateDisplays()
         getSystemService<DisplayManager>()?.registerDisplayListener(displayListener, null)
         getSystemService<InputManager>()?.registerInputDeviceListener(connectedControllerManager, null)
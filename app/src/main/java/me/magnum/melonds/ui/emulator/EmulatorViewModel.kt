@@ -1,11 +1,13 @@
 package me.magnum.melonds.ui.emulator
 
 import android.net.Uri
+import android.util.Log
 import androidx.lifecycle.SavedStateHandle
 import androidx.lifecycle.ViewModel
 import androidx.lifecycle.viewModelScope
 import dagger.hilt.android.lifecycle.HiltViewModel
 import kotlinx.coroutines.CoroutineScope
+import kotlinx.coroutines.Deferred
 import kotlinx.coroutines.Dispatchers
 import kotlinx.coroutines.ExperimentalCoroutinesApi
 import kotlinx.coroutines.Job
@@ -31,7 +33,6 @@ import kotlinx.coroutines.flow.onCompletion
 import kotlinx.coroutines.flow.take
 import kotlinx.coroutines.isActive
 import kotlinx.coroutines.launch
-import me.magnum.melonds.MelonEmulator
 import me.magnum.melonds.common.romprocessors.RomFileProcessorFactory
 import me.magnum.melonds.common.runtime.ScreenshotFrameBufferProvider
 import me.magnum.melonds.domain.model.Cheat
@@ -104,11 +105,20 @@ class EmulatorViewModel @Inject constructor(
     private val emulatorManager: EmulatorManager,
     private val emulatorSession: EmulatorSession,
     private val retroAchievementsSubmissionHandler: RetroAchievementsSubmissionHandler,
-    savedStateHandle: SavedStateHandle,
+    private val savedStateHandle: SavedStateHandle,
 ) : ViewModel() {
 
+    private companion object {
+        // URI of the ROM whose suspend state must be restored if the process is killed while the app is in the background
+        const val KEY_SUSPENDED_ROM_URI = "suspended_rom_uri"
+        const val TAG = "EmulatorViewModel"
+    }
+
     private val sessionCoroutineScope = EmulatorSessionCoroutineScope()
     private var raSessionJob: Job? = null
+    private var suspendJob: Job? = null
+    private var suspendStateWrite: Deferred<Boolean>? = null
+    private var isEmulatorSuspended = false
 
     private val _emulatorState = MutableStateFlow<EmulatorState>(EmulatorState.Uninitialized)
     val emulatorState = _emulatorState.asStateFlow()
@@ -138,6 +148,9 @@ class EmulatorViewModel @Inject constructor(
     private val _currentFps = MutableStateFlow<Int?>(null)
     val currentFps = _currentFps.asStateFlow()
 
+    // Writes to slow storage providers can take a few seconds, during which the user should know that the state is not saved yet
+    val saveStateWriteProgress = emulatorManager.saveStateWriteProgress
+
     private val _toastEvent = EventSharedFlow<ToastEvent>()
     val toastEvent = _toastEvent.asSharedFlow()
 
@@ -165,8 +178,10 @@ class EmulatorViewModel @Inject constructor(
     }
 
     fun relaunchWithNewArgs(args: LaunchArgs) {
+        savedStateHandle.remove<String>(KEY_SUSPENDED_ROM_URI)
         if (_emulatorState.value.isRunning()) {
-            stopEmulator()
+            // Another game is launched right away, which can reuse the emulator core
+            stopEmulator(keepWarm = true)
         }
         launchEmulator(args)
     }
@@ -197,6 +212,7 @@ class EmulatorViewModel @Inject constructor(
                 if (rom != null) {
                     launchRom(rom)
                 } else {
+                    emulatorManager.releaseWarmEmulator()
                     _emulatorState.value = EmulatorState.RomNotFoundError(romUri.toString())
                 }
             }
@@ -211,6 +227,7 @@ class EmulatorViewModel @Inject constructor(
                 if (rom != null) {
                     launchRom(rom)
                 } else {
+                    emulatorManager.releaseWarmEmulator()
                     _emulatorState.value = EmulatorState.RomNotFoundError(romPath)
                 }
             }
@@ -243,6 +260,12 @@ class EmulatorViewModel @Inject constructor(
                 _emulatorState.value = EmulatorState.RunningRom(rom)
                 startTrackingFps()
                 startTrackingPlayTime(rom)
+
+                // The activity is being recreated after the process was killed in the background. Continue where the user left off
+                if (savedStateHandle.get<String>(KEY_SUSPENDED_ROM_URI) == rom.uri.toString()) {
+                    savedStateHandle.remove<String>(KEY_SUSPENDED_ROM_URI)
+                    restoreSuspendState(rom)
+                }
             }
         }
     }
@@ -349,6 +372,73 @@ class EmulatorViewModel @Inject constructor(
         }
     }
 
+    /**
+     * Saves the state of the running ROM to its suspend state and releases memory that is not needed while in the background. If
+     * the process is killed before the app returns to the foreground, the suspend state is restored when the activity is recreated.
+     */
+    fun onAppMovedToBackground() {
+        val currentState = _emulatorState.value as? EmulatorState.RunningRom ?: return
+        // The suspend state could not be restored anyway
+        if (isEmulatorSuspended || !emulatorSession.areSaveStateLoadsAllowed()) {
+            return
+        }
+
+        isEmulatorSuspended = true
+        suspendJob = sessionCoroutineScope.launch {
+            // Flag the state before it is written, since the activity state may be saved at any time. If the process is killed
+            // before the write completes, the partially written state is rejected when it's restored
+            savedStateHandle[KEY_SUSPENDED_ROM_URI] = currentState.rom.uri.toString()
+
+            val stateWrite = runCatching {
+                val suspendStateUri = saveStatesRepository.getRomSuspendStateUri(currentState.rom)
+                val chunkStoreUri = saveStatesRepository.getRomSaveStateChunkStoreUri(currentState.rom)
+                emulatorManager.saveState(suspendStateUri, chunkStoreUri, currentState.rom)
+            }.getOrNull()
+            suspendStateWrite = stateWrite
+
+            if (stateWrite == null) {
+                savedStateHandle.remove<String>(KEY_SUSPENDED_ROM_URI)
+            }
+
+            // The state has been captured at this point. The write completes in the background
+            emulatorManager.releaseBackgroundMemory(currentState.rom)
+
+            if (stateWrite != null) {
+                sessionCoroutineScope.launch {
+                    // A failed write may have left a partial state behind. Don't try to restore it, and don't leave it around. A
+                    // later suspend owns the file if it started in the meantime
+                    if (!stateWrite.await() && suspendStateWrite === stateWrite) {
+                        discardSuspendState(currentState.rom)
+                    }
+                }
+            }
+        }
+    }
+
+    private fun discardSuspendState(rom: Rom) {
+        if (savedStateHandle.get<String>(KEY_SUSPENDED_ROM_URI) == rom.uri.toString()) {
+            savedStateHandle.remove<String>(KEY_SUSPENDED_ROM_URI)
+        }
+        runCatching {
+            saveStatesRepository.deleteRomSuspendState(rom)
+        }
+    }
+
+    fun onAppMovedToForeground() {
+        if (!isEmulatorSuspended) {
+            return
+        }
+
+        isEmulatorSuspended = false
+        savedStateHandle.remove<String>(KEY_SUSPENDED_ROM_URI)
+        val rom = (_emulatorState.value as? EmulatorState.RunningRom)?.rom ?: return
+        sessionCoroutineScope.launch {
+            suspendJob?.join()
+            suspendJob = null
+            emulatorManager.updateRomEmulatorConfiguration(rom)
+        }
+    }
+
     fun resetEmulator() {
         if (_emulatorState.value.isRunning()) {
             sessionCoroutineScope.launch {
@@ -367,15 +457,21 @@ class EmulatorViewModel @Inject constructor(
         }
     }
 
-    private fun stopEmulator() {
+    private fun stopEmulator(keepWarm: Boolean) {
         viewModelScope.launch {
             _achievementsEvent.emit(RAEventUi.Reset)
         }
-        emulatorManager.stopEmulator()
+        emulatorManager.stopEmulator(keepWarm)
         screenshotFrameBufferProvider.clearBuffer()
     }
 
     private fun stopEmulatorAndExit() {
+        // The session ended normally, so there's nothing to continue from. Deleting the suspend state also stops it from keeping its
+        // chunks in the chunk store
+        (_emulatorState.value as? EmulatorState.RunningRom)?.let {
+            suspendStateWrite = null
+            discardSuspendState(it.rom)
+        }
         emulatorManager.stopEmulator()
         _uiEvent.tryEmit(EmulatorUiEvent.CloseEmulator)
     }
@@ -467,10 +563,13 @@ class EmulatorViewModel @Inject constructor(
     fun saveStateToSlot(slot: SaveStateSlot) {
         sessionCoroutineScope.launch {
             (_emulatorState.value as? EmulatorState.RunningRom)?.let {
-                if (!saveRomState(it.rom, slot)) {
+                // The emulator can be resumed as soon as the state has been captured, while it's written in the background
+                val saveSuccessful = saveRomState(it.rom, slot) {
+                    emulatorManager.resumeEmulator()
+                }
+                if (!saveSuccessful) {
                     _toastEvent.emit(ToastEvent.StateSaveFailed)
                 }
-                emulatorManager.resumeEmulator()
             }
         }
     }
@@ -495,12 +594,13 @@ class EmulatorViewModel @Inject constructor(
         when (currentState) {
             is EmulatorState.RunningRom -> {
                 sessionCoroutineScope.launch {
-                    emulatorManager.pauseEmulator()
+                    // No need to pause the emulator. The state is captured between frames
                     val quickSlot = saveStatesRepository.getRomQuickSaveStateSlot(currentState.rom)
                     if (saveRomState(currentState.rom, quickSlot)) {
                         _toastEvent.emit(ToastEvent.QuickSaveSuccessful)
+                    } else {
+                        _toastEvent.emit(ToastEvent.StateSaveFailed)
                     }
-                    emulatorManager.resumeEmulator()
                 }
             }
             is EmulatorState.RunningFirmware -> {
@@ -541,19 +641,27 @@ class EmulatorViewModel @Inject constructor(
     fun deleteSaveStateSlot(slot: SaveStateSlot): List<SaveStateSlot>? {
         return (_emulatorState.value as? EmulatorState.RunningRom)?.let {
             saveStatesRepository.deleteRomSaveState(it.rom, slot)
+            sessionCoroutineScope.launch(Dispatchers.IO) {
+                saveStatesRepository.compactRomSaveStateChunkStore(it.rom)
+            }
             getRomSaveStateSlots(it.rom)
         }
     }
 
-    private suspend fun saveRomState(rom: Rom, slot: SaveStateSlot): Boolean {
+    /**
+     * Saves the current emulator state to the given slot.
+     *
+     * @param onStateCaptured Callback invoked once the emulator state has been captured, before it is written to storage
+     * @return Whether the state was saved successfully
+     */
+    private suspend fun saveRomState(rom: Rom, slot: SaveStateSlot, onStateCaptured: suspend () -> Unit = {}): Boolean {
         val slotUri = saveStatesRepository.getRomSaveStateUri(rom, slot)
-        return if (emulatorManager.saveState(slotUri)) {
-            val screenshot = screenshotFrameBufferProvider.getScreenshot()
-            saveStatesRepository.setRomSaveStateScreenshot(rom, slot, screenshot)
-            true
-        } else {
-            false
-        }
+        val chunkStoreUri = saveStatesRepository.getRomSaveStateChunkStoreUri(rom)
+        // The state thumbnail is captured natively together with the state
+        val stateWrite = emulatorManager.saveState(slotUri, chunkStoreUri, rom)
+        onStateCaptured()
+
+        return stateWrite.await()
     }
 
     private suspend fun loadRomState(rom: Rom, slot: SaveStateSlot): Boolean {
@@ -562,7 +670,8 @@ class EmulatorViewModel @Inject constructor(
         }
 
         val slotUri = saveStatesRepository.getRomSaveStateUri(rom, slot)
-        val success = emulatorManager.loadState(slotUri)
+        val chunkStoreUri = saveStatesRepository.getRomSaveStateChunkStoreUri(rom)
+        val success = emulatorManager.loadState(slotUri, chunkStoreUri, rom)
         if (success) {
             _achievementsEvent.emit(RAEventUi.Reset)
         }
@@ -570,6 +679,31 @@ class EmulatorViewModel @Inject constructor(
         return success
     }
 
+    private suspend fun restoreSuspendState(rom: Rom) {
+        if (!emulatorSession.areSaveStateLoadsAllowed()) {
+            return
+        }
+
+        emulatorManager.pauseEmulator()
+        // If the state can't be loaded (for example, if it was not completely written), the ROM simply starts from the beginning
+        val success = runCatching {
+            val suspendStateUri = saveStatesRepository.getRomSuspendStateUri(rom)
+            val chunkStoreUri = saveStatesRepository.getRomSaveStateChunkStoreUri(rom)
+            emulatorManager.loadState(suspendStateUri, chunkStoreUri, rom)
+        }.getOrDefault(false)
+
+        if (success) {
+            _achievementsEvent.emit(RAEventUi.Reset)
+        }
+        emulatorManager.resumeEmulator()
+
+        // The state is only restored once. Its chunks are no longer needed either, unless a save state shares them
+        discardSuspendState(rom)
+        sessionCoroutineScope.launch(Dispatchers.IO) {
+            saveStatesRepository.compactRomSaveStateChunkStore(rom)
+        }
+    }
+
     private fun startObservingRuntimeInputLayoutConfiguration() {
         sessionCoroutineScope.launch {
             combine(
@@ -927,7 +1061,7 @@ class EmulatorViewModel @Inject constructor(
                     delay(30.seconds)
                     while (isActive) {
                         // TODO: Should we pause the session if the app goes to background? If so, how?
-                        val richPresenceDescription = MelonEmulator.getRichPresenceStatus()
+                        val richPresenceDescription = emulatorManager.getRichPresenceStatus()
                         retroAchievementsRepository.sendSessionHeartbeat(rom.retroAchievementsHash, isHardcoreModeEnabled, richPresenceDescription)
                         delay(2.minutes)
                     }
@@ -941,6 +1075,12 @@ class EmulatorViewModel @Inject constructor(
             while (isActive) {
                 delay(1.seconds)
                 _currentFps.value = emulatorManager.getFps().roundToInt()
+
+                // Not shown to the user, but logged so that slow cheats can be spotted while debugging
+                val cheatEngineFrameTime = emulatorManager.getCheatEngineFrameTime()
+                if (cheatEngineFrameTime > 0) {
+                    Log.d(TAG, "Cheats took ${"%.1f".format(cheatEngineFrameTime)} µs per frame")
+                }
             }
         }
     }
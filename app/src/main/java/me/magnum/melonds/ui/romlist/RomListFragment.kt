@@ -119,8 +119,8 @@ class RomListFragment : Fragment() {
         lifecycleScope.launch {
             viewLifecycleOwner.repeatOnLifecycle(Lifecycle.State.STARTED) {
                 romListViewModel.romScanningStatus.collectLatest { status ->
-                    binding.swipeRefreshRoms.isRefreshing = status == RomScanningStatus.SCANNING
-                    displayEmptyListViewIfRequired()
+                    binding.swipeRefreshRoms.isRefreshing = status is RomScanningStatus.Scanning
+                    displayEmptyListViewIfRequired(status)
                 }
             }
         }
@@ -129,7 +129,7 @@ class RomListFragment : Fragment() {
             viewLifecycleOwner.repeatOnLifecycle(Lifecycle.State.STARTED) {
                 romListViewModel.roms.filterNotNull().collectLatest { roms ->
                     romListAdapter.setRoms(roms)
-                    displayEmptyListViewIfRequired()
+                    displayEmptyListViewIfRequired(romListViewModel.romScanningStatus.value)
                 }
             }
         }
@@ -143,10 +143,16 @@ class RomListFragment : Fragment() {
         }
     }
 
-    private fun displayEmptyListViewIfRequired() {
-        val isScanning = binding.swipeRefreshRoms.isRefreshing
-        val emptyViewVisible = !isScanning && romListViewModel.roms.value?.isEmpty() == true
-        binding.textRomListEmpty.isVisible = emptyViewVisible
+    private fun displayEmptyListViewIfRequired(scanningStatus: RomScanningStatus) {
+        val isListEmpty = romListViewModel.roms.value?.isEmpty() == true
+        // The first scan of a big library can take a while, so show how far it is while there's nothing else to show
+        val scanProgressVisible = isListEmpty && scanningStatus is RomScanningStatus.Scanning && scanningStatus.romCount > 0
+        binding.textRomListEmpty.isVisible = isListEmpty && (scanningStatus is RomScanningStatus.NotScanning || scanProgressVisible)
+        binding.textRomListEmpty.text = if (scanningStatus is RomScanningStatus.Scanning) {
+            getString(R.string.scanning_roms_progress, scanningStatus.scannedRomCount, scanningStatus.romCount)
+        } else {
+            getString(R.string.no_roms_found)
+        }
     }
 
     private fun buildRomEnabledFilter(romEnableCriteria: RomEnableCriteria): RomEnabledFilter {
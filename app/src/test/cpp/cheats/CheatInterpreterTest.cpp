@@ -0,0 +1,314 @@
+#include <cstdio>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+#include "CheatCompiler.h"
+#include "CheatInterpreter.h"
+
+using namespace melonDS;
+
+namespace
+{
+    struct MemoryBus
+    {
+        std::map<u32, u8> memory;
+
+        u8 read8(u32 address) { auto it = memory.find(address); return it != memory.end() ? it->second : 0; }
+        u16 read16(u32 address) { return read8(address) | (read8(address + 1) << 8); }
+        u32 read32(u32 address) { return read16(address) | ((u32) read16(address + 2) << 16); }
+        void write8(u32 address, u8 value) { memory[address] = value; }
+        void write16(u32 address, u16 value) { write8(address, (u8) value); write8(address + 1, (u8) (value >> 8)); }
+        void write32(u32 address, u32 value) { write16(address, (u16) value); write16(address + 2, (u16) (value >> 16)); }
+    };
+
+    /**
+     * Runs a code line by line, the way the Action Replay does. This is the behaviour the compiled code must reproduce.
+     */
+    void runReference(MemoryBus& bus, const std::vector<u32>& code)
+    {
+        u32 offset = 0;
+        u32 data = 0;
+        u32 condition = 1;
+        u32 conditionStack = 0;
+        u32 counter = 0;
+
+        size_t loopStart = 0;
+        u32 loopCount = 0;
+        u32 loopCondition = 1;
+        u32 loopConditionStack = 0;
+
+        size_t i = 0;
+        while (i + 1 < code.size())
+        {
+            u32 a = code[i];
+            u32 b = code[i + 1];
+            i += 2;
+
+            u8 op = a >> 24;
+            u32 address = a & 0x0FFFFFFF;
+            if ((op < 0xD0 && op != 0xC5) || op > 0xD2)
+            {
+                if (!condition)
+                {
+                    if ((op & 0xF0) == 0xE0)
+                        i += ((b + 7) / 8) * 2;
+
+                    continue;
+                }
+            }
+
+            auto pushCondition = [&](bool result) {
+                conditionStack = (conditionStack << 1) | condition;
+                condition = result ? 1 : 0;
+            };
+            auto conditionAddress = address != 0 ? address : offset;
+            auto maskedRead16 = [&]() {
+                return (u16) (bus.read16(conditionAddress) & ~(b >> 16));
+            };
+
+            switch (op >> 4)
+            {
+                case 0x0: bus.write32(address + offset, b); break;
+                case 0x1: bus.write16(address + offset, (u16) b); break;
+                case 0x2: bus.write8(address + offset, (u8) b); break;
+                case 0x3: pushCondition(b > bus.read32(conditionAddress)); break;
+                case 0x4: pushCondition(b < bus.read32(conditionAddress)); break;
+                case 0x5: pushCondition(b == bus.read32(conditionAddress)); break;
+                case 0x6: pushCondition(b != bus.read32(conditionAddress)); break;
+                case 0x7: pushCondition((b & 0xFFFF) > maskedRead16()); break;
+                case 0x8: pushCondition((b & 0xFFFF) < maskedRead16()); break;
+                case 0x9: pushCondition((b & 0xFFFF) == maskedRead16()); break;
+                case 0xA: pushCondition((b & 0xFFFF) != maskedRead16()); break;
+                case 0xB: offset = bus.read32(address + offset); break;
+                case 0xE:
+                    for (u32 byte = 0; byte < b; byte++)
+                        bus.write8(address + offset + byte, (u8) (code[i + byte / 4] >> ((byte % 4) * 8)));
+
+                    i += ((b + 7) / 8) * 2;
+                    break;
+                case 0xF:
+                    for (u32 byte = 0; byte < b; byte++)
+                        bus.write8(address + byte, bus.read8(offset + byte));
+                    break;
+            }
+
+            switch (op)
+            {
+                case 0xC0:
+                    loopStart = i;
+                    loopCount = b;
+                    loopCondition = condition;
+                    loopConditionStack = conditionStack;
+                    break;
+                case 0xC5:
+                    counter++;
+                    conditionStack = (conditionStack << 1) | condition;
+                    if (condition)
+                        condition = (counter & (b & 0xFFFF)) == (b >> 16) ? 1 : 0;
+                    break;
+                case 0xC6: bus.write32(b, offset); break;
+                case 0xD0:
+                    condition = conditionStack & 1;
+                    conditionStack >>= 1;
+                    break;
+                case 0xD1:
+                case 0xD2:
+                    if (loopCount > 0)
+                    {
+                        loopCount--;
+                        i = loopStart;
+                        break;
+                    }
+
+                    if (op == 0xD2)
+                    {
+                        offset = 0;
+                        data = 0;
+                    }
+                    condition = loopCondition;
+                    conditionStack = loopConditionStack;
+                    break;
+                case 0xD3: offset = b; break;
+                case 0xD4: data += b; break;
+                case 0xD5: data = b; break;
+                case 0xD6: bus.write32(b + offset, data); offset += 4; break;
+                case 0xD7: bus.write16(b + offset, (u16) data); offset += 2; break;
+                case 0xD8: bus.write8(b + offset, (u8) data); offset += 1; break;
+                case 0xD9: data = bus.read32(b + offset); break;
+                case 0xDA: data = bus.read16(b + offset); break;
+                case 0xDB: data = bus.read8(b + offset); break;
+                case 0xDC: offset += b; break;
+            }
+        }
+    }
+
+    /**
+     * Runs a code for a few frames on both interpreters, changing the values its conditions check between frames.
+     */
+    bool matchesReference(const std::string& name, const std::vector<u32>& code, u32 seed)
+    {
+        auto compiledCheat = CheatCompiler::compile(code);
+        if (!compiledCheat)
+        {
+            printf("FAIL %s: code didn't compile\n", name.c_str());
+            return false;
+        }
+
+        MemoryBus referenceBus;
+        MemoryBus compiledBus;
+        std::mt19937 random(seed);
+        for (int frame = 0; frame < 8; frame++)
+        {
+            for (u32 address = 0x02000000; address < 0x02000010; address += 4)
+            {
+                u32 value = random() % 4;
+                referenceBus.write32(address, value);
+                compiledBus.write32(address, value);
+            }
+
+            runReference(referenceBus, code);
+            CheatInterpreter::run(compiledBus, *compiledCheat);
+            if (referenceBus.memory != compiledBus.memory)
+            {
+                printf("FAIL %s: memory differs after frame %d\n", name.c_str(), frame);
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    std::vector<u32> generateCode(std::mt19937& random)
+    {
+        static const u8 operations[] = {
+            0x02, 0x12, 0x22, 0x32, 0x42, 0x52, 0x62, 0x72, 0x82, 0x92, 0xA2, 0xB2, 0xC0, 0xC5, 0xC6, 0xD0, 0xD0, 0xD0, 0xD1, 0xD2,
+            0xD3, 0xD4, 0xD5, 0xD6, 0xD7, 0xD8, 0xD9, 0xDA, 0xDB, 0xDC, 0xE2, 0xF2,
+        };
+
+        std::vector<u32> code;
+        int lineCount = 4 + random() % 20;
+        for (int line = 0; line < lineCount; line++)
+        {
+            u8 operation = operations[random() % sizeof(operations)];
+            u32 a = ((u32) operation << 24) | ((random() % 16) & ~3);
+            u32 b;
+            switch (operation)
+            {
+                case 0xB2: b = 0; break;
+                case 0xC0: b = random() % 4; break;
+                case 0xC5: b = ((random() % 2) << 16) | (random() % 4); break;
+                case 0xC6: b = 0x02000040 + (random() % 16); break;
+                case 0xD3: b = 0x02000000 + (random() % 16); break;
+                case 0xD4: case 0xD5: b = random() % 8; break;
+                case 0xD6: case 0xD7: case 0xD8: case 0xD9: case 0xDA: case 0xDB: case 0xDC: b = random() % 16; break;
+                case 0xE2: b = random() % 12; break;
+                case 0xF2: b = random() % 8; break;
+                default: b = (operation >= 0x70 && operation <= 0xA2) ? ((random() % 2) << 17) | (random() % 4) : random() % 4; break;
+            }
+
+            code.push_back(a);
+            code.push_back(b);
+            if (operation == 0xE2)
+            {
+                for (u32 word = 0; word < ((b + 7) / 8) * 2; word++)
+                    code.push_back(random());
+            }
+        }
+
+        return code;
+    }
+}
+
+int main()
+{
+    struct TestCase
+    {
+        std::string name;
+        std::vector<u32> code;
+    };
+
+    std::vector<TestCase> testCases = {
+        {
+            // When the outer condition is false, the inner IF is skipped, so its D0 closes the outer one instead
+            "nested IF",
+            {
+                0x52000000, 0x00000001,
+                0x52000004, 0x00000002,
+                0x02000100, 0x11111111,
+                0xD0000000, 0x00000000,
+                0x02000104, 0x22222222,
+                0xD0000000, 0x00000000,
+                0x02000108, 0x33333333,
+            },
+        },
+        {
+            // The counter advances even when the enclosing condition is false
+            "C5 inside a false IF",
+            {
+                0xC0000000, 0x00000007,
+                0x52000000, 0x00000001,
+                0xC5000000, 0x00010001,
+                0xD4000000, 0x00000001,
+                0xD0000000, 0x00000000,
+                0xD0000000, 0x00000000,
+                0xD1000000, 0x00000000,
+                0xC5000000, 0x00000003,
+                0xD6000000, 0x02000200,
+                0xD0000000, 0x00000000,
+                0xD2000000, 0x00000000,
+            },
+        },
+        {
+            // D1 keeps a false condition while looping, and only restores the loop condition once the loop is done
+            "D1 with a false condition",
+            {
+                0xC0000000, 0x00000003,
+                0x52000004, 0x00000002,
+                0xD4000000, 0x00000001,
+                0xD1000000, 0x00000000,
+                0xD6000000, 0x02000300,
+                0xD2000000, 0x00000000,
+            },
+        },
+        {
+            // D2 ends the loop by restoring the condition it started with
+            "D2 at the end of a loop",
+            {
+                0x52000000, 0x00000001,
+                0xC0000000, 0x00000002,
+                0x52000008, 0x00000003,
+                0x12000400, 0x0000BEEF,
+                0xD2000000, 0x00000000,
+                0x02000404, 0x44444444,
+                0xD0000000, 0x00000000,
+                0x02000408, 0x55555555,
+            },
+        },
+        {
+            "patch in a false IF",
+            {
+                0x9200000C, 0xFFFC0001,
+                0xE2000500, 0x0000000C,
+                0x01020304, 0x05060708,
+                0x090A0B0C, 0x00000000,
+                0xD0000000, 0x00000000,
+                0x02000510, 0x66666666,
+            },
+        },
+    };
+
+    std::mt19937 random(0x4D454C4F);
+    for (int i = 0; i < 2000; i++)
+        testCases.push_back({ "random code " + std::to_string(i), generateCode(random) });
+
+    int failureCount = 0;
+    for (u32 i = 0; i < testCases.size(); i++)
+    {
+        if (!matchesReference(testCases[i].name, testCases[i].code, i))
+            failureCount++;
+    }
+
+    printf("%d of %zu cheat tests failed\n", failureCount, testCases.size());
+    return failureCount == 0 ? 0 : 1;
+}
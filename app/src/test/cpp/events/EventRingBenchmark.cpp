@@ -0,0 +1,212 @@
+#include <atomic>
+#include <chrono>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+#include "EventRing.h"
+
+using namespace melonDS;
+
+namespace
+{
+    // Same capacity as the ring used by the app
+    constexpr size_t RING_CAPACITY = 64 * 1024;
+    constexpr u32 MAX_PAYLOAD_SIZE = 64;
+    constexpr int FIRST_EVENT_TYPE = 100;
+
+    struct PayloadHeader
+    {
+        u32 producer;
+        u32 sequence;
+    };
+
+    u32 getPayloadSize(u32 producer, u32 sequence)
+    {
+        return sizeof(PayloadHeader) + (producer * 7 + sequence * 13) % (MAX_PAYLOAD_SIZE - sizeof(PayloadHeader) + 1);
+    }
+
+    u8 getPayloadByte(u32 producer, u32 sequence, u32 index)
+    {
+        return (u8) (producer * 31 + sequence * 17 + index * 7);
+    }
+
+    /**
+     * Pushes numbered events at a fixed rate. The sequence number only advances when an event is accepted, so the consumer must
+     * see every sequence number of every producer, in order. Gives up at the deadline, in case a broken ring never frees any space.
+     */
+    void runProducer(EventRing& ring, u32 producer, u32 eventCount, std::chrono::nanoseconds interval, std::chrono::steady_clock::time_point deadline, std::atomic<u32>& rejectedPushCount)
+    {
+        u8 payload[MAX_PAYLOAD_SIZE];
+        auto nextPush = std::chrono::steady_clock::now();
+        u32 sequence = 0;
+        while (sequence < eventCount && std::chrono::steady_clock::now() < deadline)
+        {
+            if (interval.count() > 0)
+            {
+                std::this_thread::sleep_until(nextPush);
+                nextPush += interval;
+            }
+
+            u32 size = getPayloadSize(producer, sequence);
+            PayloadHeader header { producer, sequence };
+            memcpy(payload, &header, sizeof(header));
+            for (u32 i = sizeof(header); i < size; i++)
+                payload[i] = getPayloadByte(producer, sequence, i);
+
+            if (ring.push(FIRST_EVENT_TYPE + (int) producer, payload, size))
+                sequence++;
+            else
+                rejectedPushCount++;
+        }
+    }
+
+    struct ConsumerResult
+    {
+        u64 eventCount = 0;
+        u64 wakeupCount = 0;
+        u64 errorCount = 0;
+    };
+
+    /**
+     * Drains the ring the same way EmulatorMessageQueue.kt does, checking every record.
+     */
+    ConsumerResult runConsumer(EventRing& ring, u32 producerCount, const std::atomic_bool& areProducersDone)
+    {
+        ConsumerResult result;
+        std::vector<u32> nextSequences(producerCount, 0);
+        const u8* records = (const u8*) ring.getMemory() + EventRing::CONTROL_BLOCK_SIZE;
+        u64 readPosition = ring.getReadPosition();
+
+        for (;;)
+        {
+            // Checked before draining, so that events pushed right before the producers finished are still read
+            bool isLastRound = areProducersDone.load(std::memory_order_acquire);
+
+            u64 endPosition = ring.acquire(readPosition);
+            while (readPosition < endPosition)
+            {
+                while (readPosition < endPosition)
+                {
+                    const u8* record = records + (readPosition & (RING_CAPACITY - 1));
+                    u32 state;
+                    int type;
+                    memcpy(&state, record, sizeof(state));
+                    memcpy(&type, record + sizeof(state), sizeof(type));
+                    u32 size = state & EventRing::STATE_SIZE_MASK;
+
+                    if (!(state & EventRing::STATE_PADDING))
+                    {
+                        const u8* payload = record + EventRing::RECORD_HEADER_SIZE;
+                        PayloadHeader header {};
+                        bool isValid = size >= sizeof(header);
+                        if (isValid)
+                        {
+                            memcpy(&header, payload, sizeof(header));
+                            isValid = header.producer < producerCount
+                                && type == FIRST_EVENT_TYPE + (int) header.producer
+                                && header.sequence == nextSequences[header.producer]
+                                && size == getPayloadSize(header.producer, header.sequence);
+                        }
+
+                        for (u32 i = sizeof(header); isValid && i < size; i++)
+                            isValid = payload[i] == getPayloadByte(header.producer, header.sequence, i);
+
+                        if (isValid)
+                        {
+                            nextSequences[header.producer]++;
+                        }
+                        else
+                        {
+                            if (result.errorCount == 0)
+                                fprintf(stderr, "Lost or torn event at position %llu (type %d, size %u)\n", (unsigned long long) readPosition, type, size);
+
+                            result.errorCount++;
+                            // Resynchronize with the producer, so that a single lost event is only reported once
+                            if (size >= sizeof(header) && header.producer < producerCount)
+                                nextSequences[header.producer] = header.sequence + 1;
+                        }
+
+                        result.eventCount++;
+                    }
+
+                    readPosition += (EventRing::RECORD_HEADER_SIZE + size + 7) & ~(u64) 7;
+                }
+
+                endPosition = ring.acquire(readPosition);
+            }
+
+            if (isLastRound)
+                break;
+
+            pollfd eventFd { ring.getEventFd(), POLLIN, 0 };
+            if (poll(&eventFd, 1, 100) > 0)
+                result.wakeupCount++;
+        }
+
+        return result;
+    }
+}
+
+/**
+ * Stress test of the event ring. Several producer threads push numbered events while a single consumer drains them, and checks that
+ * no accepted event is lost, reordered or torn. Events the ring rejects because it's full are retried and counted.
+ *
+ * Usage: event-ring-benchmark [producers] [events per second, 0 for as fast as possible] [seconds]
+ */
+int main(int argc, char** argv)
+{
+    u32 producerCount = argc > 1 ? (u32) atoi(argv[1]) : 4;
+    u32 eventsPerSecond = argc > 2 ? (u32) atoi(argv[2]) : 10000;
+    u32 seconds = argc > 3 ? (u32) atoi(argv[3]) : 5;
+    if (producerCount == 0 || seconds == 0)
+    {
+        fprintf(stderr, "Usage: %s [producers] [events per second, 0 for as fast as possible] [seconds]\n", argv[0]);
+        return 1;
+    }
+
+    // When unthrottled, each producer pushes as many events as it would at 1M events/s in total
+    u32 totalEventCount = (eventsPerSecond > 0 ? eventsPerSecond : 1000000) * seconds;
+    u32 eventsPerProducer = totalEventCount / producerCount;
+    std::chrono::nanoseconds interval = eventsPerSecond > 0 ? std::chrono::nanoseconds(1000000000ull * producerCount / eventsPerSecond) : std::chrono::nanoseconds::zero();
+
+    EventRing ring(RING_CAPACITY);
+    if (!ring.isValid())
+    {
+        fprintf(stderr, "Failed to create the event ring\n");
+        return 1;
+    }
+
+    ring.setOpen(true);
+
+    std::atomic_bool areProducersDone = false;
+    std::atomic<u32> rejectedPushCount = 0;
+    ConsumerResult consumerResult;
+
+    auto start = std::chrono::steady_clock::now();
+    auto deadline = start + std::chrono::seconds(seconds * 4 + 10);
+    std::thread consumer([&] {
+        consumerResult = runConsumer(ring, producerCount, areProducersDone);
+    });
+
+    std::vector<std::thread> producers;
+    for (u32 i = 0; i < producerCount; i++)
+        producers.emplace_back(runProducer, std::ref(ring), i, eventsPerProducer, interval, deadline, std::ref(rejectedPushCount));
+
+    for (std::thread& producer : producers)
+        producer.join();
+
+    areProducersDone.store(true, std::memory_order_release);
+    consumer.join();
+    double elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    u64 expectedEventCount = (u64) eventsPerProducer * producerCount;
+    printf("%u producers, %llu events in %.2f s (%.0f events/s)\n", producerCount, (unsigned long long) consumerResult.eventCount, elapsedSeconds, consumerResult.eventCount / elapsedSeconds);
+    printf("%llu consumer wakeups (%.1f events per wakeup), %u pushes rejected because the ring was full\n", (unsigned long long) consumerResult.wakeupCount,
+           consumerResult.wakeupCount > 0 ? (double) consumerResult.eventCount / consumerResult.wakeupCount : 0.0, rejectedPushCount.load());
+    printf("%llu lost or torn events\n", (unsigned long long) consumerResult.errorCount);
+
+    return consumerResult.errorCount == 0 && consumerResult.eventCount == expectedEventCount ? 0 : 1;
+}
@@ -0,0 +1,98 @@
+#include <chrono>
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string>
+#include <strings.h>
+#include <unistd.h>
+#include <vector>
+#include "RomBatchScanner.h"
+
+using namespace melonDS;
+
+namespace
+{
+    std::vector<int> openRoms(const std::string& directoryPath)
+    {
+        std::vector<int> fds;
+        DIR* directory = opendir(directoryPath.c_str());
+        if (!directory)
+            return fds;
+
+        while (dirent* entry = readdir(directory))
+        {
+            std::string name = entry->d_name;
+            if (name.size() < 4 || strcasecmp(name.c_str() + name.size() - 4, ".nds") != 0)
+                continue;
+
+            int fd = open((directoryPath + "/" + name).c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd >= 0)
+                fds.push_back(fd);
+        }
+
+        closedir(directory);
+        return fds;
+    }
+
+    double millisecondsSince(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+/**
+ * Compares the time it takes to read the metadata of every ROM in a directory one by one, the way the library used to be scanned,
+ * against a batch scan. Run it twice to compare warm page cache results, or drop the caches between runs for cold ones.
+ *
+ * Usage: rom-scan-benchmark <directory with .nds files>
+ */
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "Usage: %s <directory with .nds files>\n", argv[0]);
+        return 1;
+    }
+
+    std::vector<int> fds = openRoms(argv[1]);
+    if (fds.empty())
+    {
+        fprintf(stderr, "No ROMs found in %s\n", argv[1]);
+        return 1;
+    }
+
+    auto sequentialStart = std::chrono::steady_clock::now();
+    u32 sequentialValidCount = 0;
+    for (int fd : fds)
+    {
+        RomMetadataReader::RomMetadata metadata;
+        if (RomMetadataReader::readRomMetadata(fd, metadata))
+            sequentialValidCount++;
+    }
+    double sequentialTime = millisecondsSince(sequentialStart);
+
+    auto batchStart = std::chrono::steady_clock::now();
+    u32 batchValidCount = 0;
+    u32 chunkCount = 0;
+    u32 lastScannedCount = 0;
+    RomBatchScanner::scanRoms(fds, [&](std::vector<RomBatchScanner::ScanResult>& results, u32 scannedCount) {
+        for (const auto& result : results)
+        {
+            if (result.metadata)
+                batchValidCount++;
+        }
+
+        chunkCount++;
+        lastScannedCount = scannedCount;
+        return true;
+    });
+    double batchTime = millisecondsSince(batchStart);
+
+    for (int fd : fds)
+        close(fd);
+
+    printf("%zu files, %u valid ROMs\n", fds.size(), sequentialValidCount);
+    printf("sequential: %.1f ms\n", sequentialTime);
+    printf("batch:      %.1f ms (%u chunks, %u valid ROMs)\n", batchTime, chunkCount, batchValidCount);
+    return sequentialValidCount == batchValidCount && lastScannedCount == fds.size() ? 0 : 1;
+}
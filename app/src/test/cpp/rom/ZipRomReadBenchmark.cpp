@@ -0,0 +1,130 @@
+#include <chrono>
+#include <fcntl.h>
+#include <random>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "ZipEntryReader.h"
+
+using namespace melonDS;
+
+namespace
+{
+    // About the size of the reads the core does when it streams data from the cartridge
+    constexpr size_t READ_SIZE = 64 * 1024;
+    constexpr size_t RANDOM_READ_SIZE = 4 * 1024;
+
+    double millisecondsSince(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    std::unique_ptr<ZipEntryReader> openReader(const char* path)
+    {
+        int fd = open(path, O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+            return nullptr;
+
+        // The reader takes ownership of the descriptor
+        return ZipEntryReader::open(fd);
+    }
+
+    /**
+     * Reads the whole ROM from start to end. For deflated entries, this is also when the checkpoints are recorded.
+     */
+    bool readSequentially(ZipEntryReader& reader, std::vector<u8>& rom)
+    {
+        rom.resize(reader.getSize());
+        for (u64 offset = 0; offset < rom.size(); offset += READ_SIZE)
+        {
+            size_t length = std::min<u64>(READ_SIZE, rom.size() - offset);
+            if (reader.read(rom.data() + offset, offset, length) != (ssize_t) length)
+                return false;
+        }
+
+        return true;
+    }
+}
+
+/**
+ * Measures how fast the NDS ROM inside a ZIP archive can be read in place. The first sequential read also builds the checkpoint
+ * index of deflated entries, so it is timed separately from a second one. Random reads are then checked against the data of the
+ * sequential read, to make sure that restarting from a checkpoint produces the same bytes.
+ *
+ * Usage: zip-rom-read-benchmark <zip with an .nds file> [random reads]
+ */
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "Usage: %s <zip with an .nds file> [random reads]\n", argv[0]);
+        return 1;
+    }
+
+    u32 randomReadCount = argc > 2 ? (u32) atoi(argv[2]) : 200;
+
+    auto openStart = std::chrono::steady_clock::now();
+    auto reader = openReader(argv[1]);
+    double openTime = millisecondsSince(openStart);
+    if (!reader)
+    {
+        fprintf(stderr, "No supported ROM found in %s\n", argv[1]);
+        return 1;
+    }
+
+    double romSize = reader->getSize() / (1024.0 * 1024.0);
+    printf("%.1f MB ROM, opened in %.2f ms\n", romSize, openTime);
+
+    std::vector<u8> rom;
+    auto indexStart = std::chrono::steady_clock::now();
+    if (!readSequentially(*reader, rom))
+    {
+        fprintf(stderr, "Failed to read the ROM\n");
+        return 1;
+    }
+    double indexTime = millisecondsSince(indexStart);
+    printf("first sequential read (builds the index): %.1f ms, %.0f MB/s\n", indexTime, romSize / (indexTime / 1000));
+
+    std::vector<u8> secondRead;
+    auto sequentialStart = std::chrono::steady_clock::now();
+    if (!readSequentially(*reader, secondRead) || secondRead != rom)
+    {
+        fprintf(stderr, "Second sequential read doesn't match the first one\n");
+        return 1;
+    }
+    double sequentialTime = millisecondsSince(sequentialStart);
+    printf("second sequential read: %.1f ms, %.0f MB/s\n", sequentialTime, romSize / (sequentialTime / 1000));
+
+    // Random offsets, so that almost every read has to restart from a checkpoint
+    std::mt19937_64 random(0x4D454C4F);
+    std::vector<u8> buffer(RANDOM_READ_SIZE);
+    u32 mismatchCount = 0;
+    double totalRandomReadTime = 0;
+    double maxRandomReadTime = 0;
+    for (u32 i = 0; i < randomReadCount; i++)
+    {
+        u64 offset = random() % rom.size();
+        size_t length = std::min<u64>(RANDOM_READ_SIZE, rom.size() - offset);
+
+        auto readStart = std::chrono::steady_clock::now();
+        ssize_t bytesRead = reader->read(buffer.data(), offset, length);
+        double readTime = millisecondsSince(readStart);
+
+        totalRandomReadTime += readTime;
+        maxRandomReadTime = std::max(maxRandomReadTime, readTime);
+        if (bytesRead != (ssize_t) length || memcmp(buffer.data(), rom.data() + offset, length) != 0)
+            mismatchCount++;
+    }
+
+    if (randomReadCount > 0)
+        printf("random %zu KB reads: %.2f ms average, %.2f ms max\n", RANDOM_READ_SIZE / 1024, totalRandomReadTime / randomReadCount, maxRandomReadTime);
+
+    if (mismatchCount > 0)
+    {
+        fprintf(stderr, "%u random reads returned the wrong data\n", mismatchCount);
+        return 1;
+    }
+
+    return 0;
+}